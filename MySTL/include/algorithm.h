@@ -0,0 +1,137 @@
+#ifndef __ALGORITHM_H__
+#define __ALGORITHM_H__
+
+// 通用算法
+// sort: 内省排序 (快速排序, 递归过深时改用堆排序), 长度不超过16的区间交给排序网络
+
+#include <cstddef>
+#include <functional>
+#include "iterator.h"
+#include "utils.h"
+#include "sorting_network.h"
+
+namespace mySTL
+{
+    // 不超过这个长度的区间不再划分
+    static constexpr size_t __sort_threshold = 16;
+
+    // 插入排序, 用于不能无分支比较交换的类型
+    template <class RandomIter, class Compare>
+    void __insertion_sort(RandomIter first, RandomIter last, Compare& comp)
+    {
+        if(first == last) return;
+        for(RandomIter i = first + 1; i != last; ++i)
+        {
+            auto value = mySTL::move(*i);
+            RandomIter j = i;
+            for(; j != first && comp(value, *(j - 1)); --j) *j = mySTL::move(*(j - 1));
+            *j = mySTL::move(value);
+        }
+    }
+
+    template <class RandomIter, class Compare>
+    void __small_sort(RandomIter first, RandomIter last, Compare& comp)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type value_type;
+        if constexpr(__select_exchange<value_type>::value)
+            __network_dispatch<__sort_threshold, RandomIter, Compare>::apply(first, static_cast<size_t>(last - first), comp);
+        else
+            mySTL::__insertion_sort(first, last, comp);
+    }
+
+    template <class RandomIter, class Compare>
+    void __sift_down(RandomIter first, ptrdiff_t hole, ptrdiff_t len, Compare& comp)
+    {
+        auto value = mySTL::move(first[hole]);
+        for(ptrdiff_t child; (child = 2 * hole + 1) < len; hole = child)
+        {
+            if(child + 1 < len && comp(first[child], first[child + 1])) ++child;
+            if(!comp(value, first[child])) break;
+            first[hole] = mySTL::move(first[child]);
+        }
+        first[hole] = mySTL::move(value);
+    }
+
+    template <class RandomIter, class Compare>
+    void __heap_sort(RandomIter first, RandomIter last, Compare& comp)
+    {
+        ptrdiff_t len = last - first;
+        for(ptrdiff_t i = len / 2 - 1; i >= 0; i--) mySTL::__sift_down(first, i, len, comp);
+        for(ptrdiff_t n = len - 1; n > 0; n--)
+        {
+            mySTL::swap(first[0], first[n]);
+            mySTL::__sift_down(first, 0, n, comp);
+        }
+    }
+
+    // 三数取中作为pivot, 划分后返回pivot的最终位置
+    template <class RandomIter, class Compare>
+    RandomIter __partition_pivot(RandomIter first, RandomIter last, Compare& comp)
+    {
+        RandomIter mid = first + (last - first) / 2;
+        RandomIter a = first + 1, b = mid, c = last - 1;
+        if(comp(*b, *a)) mySTL::swap(*a, *b);
+        if(comp(*c, *b)) mySTL::swap(*b, *c);
+        if(comp(*b, *a)) mySTL::swap(*a, *b);
+        mySTL::swap(*first, *b);
+        // *a <= pivot <= *c 作为两端的哨兵
+        RandomIter l = a, r = c;
+        for(;;)
+        {
+            do ++l; while(comp(*l, *first));
+            do --r; while(comp(*first, *r));
+            if(!(l < r)) break;
+            mySTL::swap(*l, *r);
+        }
+        mySTL::swap(*first, *r);
+        return r;
+    }
+
+    template <class RandomIter, class Compare>
+    void __introsort(RandomIter first, RandomIter last, int depth, Compare& comp)
+    {
+        while(static_cast<size_t>(last - first) > __sort_threshold)
+        {
+            if(depth-- == 0)
+            {
+                mySTL::__heap_sort(first, last, comp);
+                return;
+            }
+            RandomIter p = mySTL::__partition_pivot(first, last, comp);
+            // 短的一边递归, 长的一边循环, 栈深度不超过log(n)
+            if(p - first < last - p)
+            {
+                mySTL::__introsort(first, p, depth, comp);
+                first = p + 1;
+            }
+            else
+            {
+                mySTL::__introsort(p + 1, last, depth, comp);
+                last = p;
+            }
+        }
+        mySTL::__small_sort(first, last, comp);
+    }
+
+    /**
+     * @brief sort
+     * 不稳定排序, O(n log n)
+     * @tparam RandomIter 随机访问迭代器
+     */
+    template <class RandomIter, class Compare>
+    void sort(RandomIter first, RandomIter last, Compare comp)
+    {
+        ptrdiff_t n = last - first;
+        if(n < 2) return;
+        int depth = 0;
+        for(ptrdiff_t i = n; i > 1; i >>= 1) depth += 2;
+        mySTL::__introsort(first, last, depth, comp);
+    }
+
+    template <class RandomIter>
+    void sort(RandomIter first, RandomIter last)
+    {
+        mySTL::sort(first, last, std::less<>());
+    }
+}
+#endif // __ALGORITHM_H__
@@ -3,8 +3,127 @@
 
 #include <cstddef>
 #include <new>
+
+// 定义 MYSTL_ALLOC_TRACKING 后开启分配统计 (按value type分类), 否则统计代码完全不参与编译
+#ifdef MYSTL_ALLOC_TRACKING
+#include <atomic>
+#include <ostream>
+#include <typeinfo>
+#endif
+
 namespace mySTL
 {
+#ifdef MYSTL_ALLOC_TRACKING
+    /**
+     * @brief 单个value type的分配统计
+     * 所有alloc_stats在第一次使用时挂到全局链表上, 供alloc_stats_report遍历
+     */
+    struct alloc_stats
+    {
+        static constexpr size_t histogram_size = 32; // 第i个桶: [2^i, 2^(i+1)) bytes, 最后一个桶包含更大的分配
+
+        const char*          name;
+        std::atomic<size_t>  allocs;
+        std::atomic<size_t>  deallocs;
+        std::atomic<size_t>  total_bytes;
+        std::atomic<size_t>  live_bytes;
+        std::atomic<size_t>  peak_bytes;
+        std::atomic<size_t>  histogram[histogram_size];
+        alloc_stats*         next;
+
+        explicit alloc_stats(const char* type_name)
+            : name(type_name), allocs(0), deallocs(0), total_bytes(0),
+              live_bytes(0), peak_bytes(0), next(nullptr)
+        {
+            for(size_t i = 0; i < histogram_size; i++)
+                histogram[i].store(0, std::memory_order_relaxed);
+            // 无锁地挂到全局链表头部
+            alloc_stats* head = registry().load(std::memory_order_relaxed);
+            do { next = head; }
+            while(!registry().compare_exchange_weak(head, this, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+        }
+
+        static std::atomic<alloc_stats*>& registry()
+        {
+            static std::atomic<alloc_stats*> head(nullptr);
+            return head;
+        }
+
+        static size_t bucket_of(size_t bytes)
+        {
+            size_t i = 0;
+            while(bytes > 1 && i < histogram_size - 1)
+            {
+                bytes >>= 1;
+                ++i;
+            }
+            return i;
+        }
+
+        void on_allocate(size_t bytes)
+        {
+            allocs.fetch_add(1, std::memory_order_relaxed);
+            total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            histogram[bucket_of(bytes)].fetch_add(1, std::memory_order_relaxed);
+            size_t live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            size_t peak = peak_bytes.load(std::memory_order_relaxed);
+            while(live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        }
+
+        void on_deallocate(size_t bytes)
+        {
+            deallocs.fetch_add(1, std::memory_order_relaxed);
+            live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        void reset()
+        {
+            allocs = 0; deallocs = 0; total_bytes = 0; live_bytes = 0; peak_bytes = 0;
+            for(size_t i = 0; i < histogram_size; i++) histogram[i] = 0;
+        }
+    };
+
+    // 获取类型T的统计数据 (线程安全的静态初始化)
+    template <class T>
+    inline alloc_stats& get_alloc_stats()
+    {
+        static alloc_stats stats(typeid(T).name());
+        return stats;
+    }
+
+    // 清零所有类型的统计数据
+    inline void alloc_stats_reset()
+    {
+        for(alloc_stats* s = alloc_stats::registry().load(std::memory_order_acquire); s; s = s->next)
+            s->reset();
+    }
+
+    // 打印所有类型的统计数据以及总和
+    inline void alloc_stats_report(std::ostream& os)
+    {
+        size_t allocs = 0, deallocs = 0, total = 0, live = 0;
+        for(alloc_stats* s = alloc_stats::registry().load(std::memory_order_acquire); s; s = s->next)
+        {
+            os << "[" << s->name << "] allocs: " << s->allocs << " deallocs: " << s->deallocs
+               << " total: " << s->total_bytes << " live: " << s->live_bytes
+               << " peak: " << s->peak_bytes << " [B]\n    histogram:";
+            for(size_t i = 0; i < alloc_stats::histogram_size; i++)
+                if(s->histogram[i]) os << " " << (size_t(1) << i) << "B+:" << s->histogram[i];
+            os << "\n";
+            allocs += s->allocs; deallocs += s->deallocs; total += s->total_bytes; live += s->live_bytes;
+        }
+        os << "[total] allocs: " << allocs << " deallocs: " << deallocs
+           << " total: " << total << " live: " << live << " [B]\n";
+    }
+
+#define __MYSTL_TRACK_ALLOCATE(T, bytes)   mySTL::get_alloc_stats<T>().on_allocate(bytes)
+#define __MYSTL_TRACK_DEALLOCATE(T, bytes) mySTL::get_alloc_stats<T>().on_deallocate(bytes)
+#else
+#define __MYSTL_TRACK_ALLOCATE(T, bytes)   ((void)(bytes))
+#define __MYSTL_TRACK_DEALLOCATE(T, bytes) ((void)(bytes))
+#endif
+
     /**
      * @brief 模板类： allocator
      * 
@@ -40,6 +159,7 @@ namespace mySTL
     template <class T>
     T* allocator<T>::allocate()
     {
+        __MYSTL_TRACK_ALLOCATE(T, sizeof(T));
         return static_cast<pointer>(::operator new(sizeof(T)));
     }
 
@@ -47,6 +167,7 @@ namespace mySTL
     T* allocator<T>::allocate(size_type n)
     {
         if(n==0) return nullptr;
+        __MYSTL_TRACK_ALLOCATE(T, n*sizeof(T));
         return static_cast<pointer>(::operator new(n*sizeof(T)));
     }
 
@@ -54,13 +175,15 @@ namespace mySTL
     void allocator<T>::deallocate(pointer ptr)
     {
         if(!ptr) return;
+        __MYSTL_TRACK_DEALLOCATE(T, sizeof(T));
         ::operator delete(ptr);
     }
 
     template <class T>
-    void allocator<T>::deallocate(pointer ptr, size_type)
+    void allocator<T>::deallocate(pointer ptr, size_type n)
     {
         if(!ptr) return;
+        __MYSTL_TRACK_DEALLOCATE(T, n*sizeof(T));
         ::operator delete(ptr);
     }
 
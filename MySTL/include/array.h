@@ -2,21 +2,147 @@
 #define __ARRAY_H__
 
 // 固定大小数组, 封装自带数组, 提供iterator接口
+// 聚合类型, 可以用 array<int, 3> a = {1, 2, 3}; 初始化, 所有操作都是constexpr
+// 小数组的排序和最值用sorting_network.h中的网络实现, 没有数据相关的分支
 
 #include <cstddef>
 #include <cassert>
+#include <stdexcept>
+#include <functional>
 #include <initializer_list>
 #include "allocator.h"
 #include "utils.h"
 #include "iterator.h"
 #include "construct.h"
+#include "pair.h"
+#include "sorting_network.h"
 
 namespace mySTL
 {
-    template <class T>
-    class array // TODO
+    template <class T, size_t N>
+    struct array
     {
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef const T*    const_pointer;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
 
+        typedef T*          iterator;
+        typedef const T*    const_iterator;
+
+        // 为了保持聚合类型只能是public; N == 0时仍占一个元素, 但size()为0
+        T __elems[N == 0 ? 1 : N];
+
+        constexpr iterator       begin()       noexcept {return __elems;}
+        constexpr const_iterator begin() const noexcept {return __elems;}
+        constexpr iterator       end()         noexcept {return __elems + N;}
+        constexpr const_iterator end()   const noexcept {return __elems + N;}
+
+        constexpr size_type size()     const noexcept {return N;}
+        constexpr size_type max_size() const noexcept {return N;}
+        constexpr bool      empty()    const noexcept {return N == 0;}
+
+        constexpr reference       operator[](size_type i)       noexcept {return __elems[i];}
+        constexpr const_reference operator[](size_type i) const noexcept {return __elems[i];}
+
+        constexpr reference at(size_type i)
+        {
+            if(i >= N) throw std::out_of_range("array::at");
+            return __elems[i];
+        }
+        constexpr const_reference at(size_type i) const
+        {
+            if(i >= N) throw std::out_of_range("array::at");
+            return __elems[i];
+        }
+
+        constexpr reference       front()       noexcept {return __elems[0];}
+        constexpr const_reference front() const noexcept {return __elems[0];}
+        constexpr reference       back()        noexcept {return __elems[N - 1];}
+        constexpr const_reference back()  const noexcept {return __elems[N - 1];}
+
+        constexpr pointer       data()       noexcept {return __elems;}
+        constexpr const_pointer data() const noexcept {return __elems;}
+
+        constexpr void fill(const T& value)
+        {
+            for(size_type i = 0; i < N; i++) __elems[i] = value;
+        }
+
+        constexpr void swap(array& other)
+        {
+            for(size_type i = 0; i < N; i++)
+            {
+                T tmp = mySTL::move(__elems[i]);
+                __elems[i] = mySTL::move(other.__elems[i]);
+                other.__elems[i] = mySTL::move(tmp);
+            }
+        }
     };
+
+    template <class T, size_t N>
+    constexpr bool operator==(const array<T, N>& lhs, const array<T, N>& rhs)
+    {
+        for(size_t i = 0; i < N; i++)
+            if(!(lhs[i] == rhs[i])) return false;
+        return true;
+    }
+
+    template <class T, size_t N>
+    constexpr bool operator!=(const array<T, N>& lhs, const array<T, N>& rhs) {return !(lhs == rhs);}
+
+    // 字典序
+    template <class T, size_t N>
+    constexpr bool operator<(const array<T, N>& lhs, const array<T, N>& rhs)
+    {
+        for(size_t i = 0; i < N; i++)
+        {
+            if(lhs[i] < rhs[i]) return true;
+            if(rhs[i] < lhs[i]) return false;
+        }
+        return false;
+    }
+
+    template <class T, size_t N>
+    constexpr void swap(array<T, N>& lhs, array<T, N>& rhs) {lhs.swap(rhs);}
+
+    /*** 排序网络 ***/
+
+    // N <= 32, 用排序网络排序
+    template <class T, size_t N, class Compare = std::less<>>
+    constexpr void sort(array<T, N>& a, Compare comp = Compare())
+    {
+        sort_network<N>(a.begin(), comp);
+    }
+
+    template <class T, size_t N, class Compare = std::less<>>
+    constexpr T min(const array<T, N>& a, Compare comp = Compare())
+    {
+        return network_min<N>(a.begin(), comp);
+    }
+
+    template <class T, size_t N, class Compare = std::less<>>
+    constexpr T max(const array<T, N>& a, Compare comp = Compare())
+    {
+        return network_max<N>(a.begin(), comp);
+    }
+
+    template <class T, size_t N, class Compare = std::less<>>
+    constexpr pair<T, T> minmax(const array<T, N>& a, Compare comp = Compare())
+    {
+        return pair<T, T>(network_min<N>(a.begin(), comp), network_max<N>(a.begin(), comp));
+    }
+
+    // 对连续存放的count个array逐个排序
+    // 数据本来就按列存放 (第k个元素在第k行) 时, 用sort_network_lanes可以一次对整行做SIMD min/max;
+    // 对array数组先转置再排序反而更慢, 所以这里逐个用排序网络
+    template <class T, size_t N, class Compare = std::less<>>
+    void sort_each(array<T, N>* groups, size_t count, Compare comp = Compare())
+    {
+        for(size_t g = 0; g < count; g++) sort_network<N>(groups[g].begin(), comp);
+    }
 }
-#endif // __ARRAY_H__
\ No newline at end of file
+#endif // __ARRAY_H__
@@ -0,0 +1,492 @@
+#ifndef __BASIC_STRING_H__
+#define __BASIC_STRING_H__
+
+// 字符串, 带小字符串优化 (SSO)
+// 对象大小为3个字 (64位下24 bytes), 短字符串 (char时最多23个字符) 直接存放在对象内部
+// 文件名不用string.h, 避免和C标准库的<string.h>冲突
+
+#include <cstddef>
+#include <cstring>
+#include <cassert>
+#include <string>
+#include <ostream>
+#include <stdexcept>
+#include <initializer_list>
+#include "allocator.h"
+#include "utils.h"
+#include "iterator.h"
+#include "string_view.h"
+
+namespace mySTL
+{
+    /**
+     * @brief basic_string
+     * 内存布局 (以64位, char为例):
+     *   长字符串: {CharT* ptr; size_t size; size_t cap_field;}, cap_field的最后一个字节最高位为1
+     *   短字符串: CharT buf[24], buf[23] = 23 - size, size==23时buf[23]恰好是结尾的'\0'
+     * 通过最后一个字节的最高位区分两种模式
+     * @tparam CharT
+     * @tparam Traits
+     */
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    class basic_string
+    {
+    public:
+        typedef Traits                                      traits_type;
+        typedef mySTL::allocator<CharT>                     data_allocator;
+
+        typedef typename data_allocator::value_type         value_type;
+        typedef typename data_allocator::pointer            pointer;
+        typedef typename data_allocator::const_pointer      const_pointer;
+        typedef typename data_allocator::referece           reference;
+        typedef typename data_allocator::const_reference    const_reference;
+        typedef typename data_allocator::size_type          size_type;
+        typedef typename data_allocator::difference_type    difference_type;
+
+        typedef CharT*                                      iterator;
+        typedef const CharT*                                const_iterator;
+        typedef basic_string_view<CharT, Traits>            view_type;
+
+        static constexpr size_type npos = size_type(-1);
+
+    private:
+        struct __long_rep
+        {
+            CharT*    ptr;
+            size_type size;
+            size_type cap_field; // 编码后的容量, 带长字符串标记
+        };
+
+        static constexpr size_type __rep_bytes    = sizeof(__long_rep);
+        static constexpr size_type __rep_chars    = __rep_bytes / sizeof(CharT);
+        static constexpr size_type __sso_capacity = __rep_chars - 1;
+
+        union __rep
+        {
+            __long_rep    l;
+            CharT         s[__rep_chars];
+            unsigned char bytes[__rep_bytes];
+        } __r;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        static size_type __encode_cap(size_type cap) noexcept {return (cap << 8) | 0x80;}
+        static size_type __decode_cap(size_type field) noexcept {return field >> 8;}
+#else
+        static constexpr size_type __long_bit = size_type(1) << (sizeof(size_type) * 8 - 1);
+        static size_type __encode_cap(size_type cap) noexcept {return cap | __long_bit;}
+        static size_type __decode_cap(size_type field) noexcept {return field & ~__long_bit;}
+#endif
+
+    public:
+        // 构造函数
+        basic_string() noexcept {__set_short_size(0);}
+        basic_string(const CharT* str) {__init(str, Traits::length(str));}
+        basic_string(const CharT* str, size_type n) {__init(str, n);}
+        basic_string(size_type n, CharT ch)
+        {
+            CharT* p = __init_uninitialized(n);
+            Traits::assign(p, n, ch);
+        }
+        explicit basic_string(view_type sv) {__init(sv.data(), sv.size());}
+        basic_string(std::initializer_list<CharT> ilist) {__init(ilist.begin(), ilist.size());}
+        basic_string(const basic_string& other) {__init(other.data(), other.size());}
+        // 移动构造: 直接拿走对方的表示, 对方变为空的短字符串
+        basic_string(basic_string&& other) noexcept
+        {
+            __r = other.__r;
+            other.__set_short_size(0);
+        }
+
+        ~basic_string()
+        {
+            if(__is_long()) data_allocator::deallocate(__r.l.ptr, capacity() + 1);
+        }
+
+        basic_string& operator=(const basic_string& other)
+        {
+            if(this != &other) assign(other.data(), other.size());
+            return *this;
+        }
+        basic_string& operator=(basic_string&& other) noexcept
+        {
+            if(this != &other)
+            {
+                if(__is_long()) data_allocator::deallocate(__r.l.ptr, capacity() + 1);
+                __r = other.__r;
+                other.__set_short_size(0);
+            }
+            return *this;
+        }
+        basic_string& operator=(const CharT* str) {return assign(str, Traits::length(str));}
+        basic_string& operator=(view_type sv)     {return assign(sv.data(), sv.size());}
+
+    public:
+        /*** 访问接口 ***/
+        iterator       begin()       noexcept {return __ptr();}
+        const_iterator begin() const noexcept {return __ptr();}
+        iterator       end()         noexcept {return __ptr() + size();}
+        const_iterator end()   const noexcept {return __ptr() + size();}
+        const CharT*   data()  const noexcept {return __ptr();}
+        CharT*         data()        noexcept {return __ptr();}
+        const CharT*   c_str() const noexcept {return __ptr();}
+
+        size_type size()     const noexcept
+        {return __is_long() ? __r.l.size : __sso_capacity - static_cast<size_type>(__r.s[__sso_capacity]);}
+        size_type length()   const noexcept {return size();}
+        size_type capacity() const noexcept {return __is_long() ? __decode_cap(__r.l.cap_field) : __sso_capacity;}
+        bool      empty()    const noexcept {return size() == 0;}
+        // 当前是否存放在对象内部
+        bool      is_inline() const noexcept {return !__is_long();}
+
+        reference       operator[](size_type i)       {assert(i <= size()); return __ptr()[i];}
+        const_reference operator[](size_type i) const {assert(i <= size()); return __ptr()[i];}
+        reference at(size_type i)
+        {
+            if(i >= size()) throw std::out_of_range("basic_string::at");
+            return __ptr()[i];
+        }
+        const_reference at(size_type i) const
+        {
+            if(i >= size()) throw std::out_of_range("basic_string::at");
+            return __ptr()[i];
+        }
+        reference       front()       {assert(!empty()); return __ptr()[0];}
+        const_reference front() const {assert(!empty()); return __ptr()[0];}
+        reference       back()        {assert(!empty()); return __ptr()[size() - 1];}
+        const_reference back()  const {assert(!empty()); return __ptr()[size() - 1];}
+
+        operator view_type() const noexcept {return view_type(data(), size());}
+
+    public:
+        /*** 容量接口 ***/
+        // 保证capacity() >= n, 之后append不超过n个字符都不会重新分配
+        void reserve(size_type n)
+        {
+            if(n > capacity()) __reallocate(n);
+        }
+        // 长字符串的容量缩小到size(), 能放进对象内部时转为短字符串
+        void shrink_to_fit();
+
+    public:
+        /*** 修改接口 ***/
+        basic_string& assign(const CharT* str, size_type n);
+        basic_string& assign(view_type sv) {return assign(sv.data(), sv.size());}
+
+        basic_string& append(const CharT* str, size_type n);
+        basic_string& append(const CharT* str)        {return append(str, Traits::length(str));}
+        basic_string& append(view_type sv)            {return append(sv.data(), sv.size());}
+        basic_string& append(const basic_string& str) {return append(str.data(), str.size());}
+        basic_string& append(size_type n, CharT ch);
+
+        basic_string& operator+=(const basic_string& str) {return append(str.data(), str.size());}
+        basic_string& operator+=(const CharT* str)        {return append(str);}
+        basic_string& operator+=(view_type sv)            {return append(sv.data(), sv.size());}
+        basic_string& operator+=(CharT ch)                {push_back(ch); return *this;}
+
+        void push_back(CharT ch)
+        {
+            size_type n = size();
+            if(n == capacity()) // 扩容后一定是长字符串, 新字符在搬移时一起写入
+            {
+                __reallocate(__recommend(n + 1), &ch, 1);
+                return;
+            }
+            Traits::assign(__ptr()[n], ch);
+            __set_size(n + 1);
+        }
+        void pop_back() {assert(!empty()); __set_size(size() - 1);}
+        void clear() noexcept {__set_size(0);}
+
+        void resize(size_type n, CharT ch = CharT())
+        {
+            size_type old = size();
+            if(n <= old) __set_size(n);
+            else append(n - old, ch);
+        }
+
+        // 删除从pos开始的n个字符
+        basic_string& erase(size_type pos = 0, size_type n = npos);
+
+        void swap(basic_string& other) noexcept
+        {
+            __rep tmp = __r;
+            __r = other.__r;
+            other.__r = tmp;
+        }
+
+    public:
+        /*** 查找/比较, 都转到string_view ***/
+        basic_string substr(size_type pos = 0, size_type n = npos) const
+        {return basic_string(view_type(*this).substr(pos, n));}
+
+        size_type find(view_type str, size_type pos = 0) const noexcept   {return view_type(*this).find(str, pos);}
+        size_type find(const CharT* str, size_type pos = 0) const         {return find(view_type(str), pos);}
+        size_type find(CharT ch, size_type pos = 0) const noexcept        {return view_type(*this).find(ch, pos);}
+        size_type rfind(view_type str, size_type pos = npos) const noexcept {return view_type(*this).rfind(str, pos);}
+        size_type rfind(const CharT* str, size_type pos = npos) const     {return rfind(view_type(str), pos);}
+        size_type rfind(CharT ch, size_type pos = npos) const noexcept    {return view_type(*this).rfind(ch, pos);}
+
+        int compare(view_type str) const noexcept {return view_type(*this).compare(str);}
+        int compare(const CharT* str) const       {return compare(view_type(str));}
+
+        bool starts_with(view_type prefix) const noexcept {return view_type(*this).starts_with(prefix);}
+        bool ends_with(view_type suffix) const noexcept   {return view_type(*this).ends_with(suffix);}
+
+    private: // helper function
+        bool __is_long() const noexcept {return (__r.bytes[__rep_bytes - 1] & 0x80) != 0;}
+
+        CharT*       __ptr()       noexcept {return __is_long() ? __r.l.ptr : __r.s;}
+        const CharT* __ptr() const noexcept {return __is_long() ? __r.l.ptr : __r.s;}
+
+        // 短字符串: 剩余容量存在最后一个字符里, 同时写入结尾'\0'
+        void __set_short_size(size_type n) noexcept
+        {
+            Traits::assign(__r.s[n], CharT());
+            __r.s[__sso_capacity] = static_cast<CharT>(__sso_capacity - n);
+        }
+        void __set_long(CharT* p, size_type n, size_type cap) noexcept
+        {
+            __r.l.ptr = p;
+            __r.l.size = n;
+            __r.l.cap_field = __encode_cap(cap);
+        }
+        void __set_size(size_type n) noexcept
+        {
+            if(__is_long())
+            {
+                __r.l.size = n;
+                Traits::assign(__r.l.ptr[n], CharT());
+            }
+            else
+            {
+                __set_short_size(n);
+            }
+        }
+
+        // 几何增长: 至少翻倍
+        size_type __recommend(size_type required) const noexcept
+        {
+            size_type doubled = capacity() * 2;
+            return required > doubled ? required : doubled;
+        }
+
+        // 设置长度为n但不初始化内容, 返回数据指针 (只在构造时使用)
+        CharT* __init_uninitialized(size_type n)
+        {
+            if(n <= __sso_capacity)
+            {
+                __set_short_size(n);
+                return __r.s;
+            }
+            CharT* p = data_allocator::allocate(n + 1);
+            Traits::assign(p[n], CharT());
+            __set_long(p, n, n);
+            return p;
+        }
+        void __init(const CharT* str, size_type n)
+        {
+            CharT* p = __init_uninitialized(n);
+            if(n) Traits::copy(p, str, n);
+        }
+
+        // 分配容量为cap的新空间并搬移已有内容, str非空时同时追加[str, str+n)
+        // 旧空间在追加之后才释放, 所以str可以指向自身
+        void __reallocate(size_type cap, const CharT* str = nullptr, size_type n = 0);
+    };
+
+    template <class CharT, class Traits>
+    constexpr typename basic_string<CharT, Traits>::size_type basic_string<CharT, Traits>::npos;
+
+    /**
+     * @brief Implementation
+     *
+     */
+
+    template <class CharT, class Traits>
+    void basic_string<CharT, Traits>::__reallocate(size_type cap, const CharT* str, size_type n)
+    {
+        size_type old_size = size();
+        CharT* p = data_allocator::allocate(cap + 1);
+        Traits::copy(p, __ptr(), old_size);
+        if(n) Traits::copy(p + old_size, str, n);
+        Traits::assign(p[old_size + n], CharT());
+        if(__is_long()) data_allocator::deallocate(__r.l.ptr, capacity() + 1);
+        __set_long(p, old_size + n, cap);
+    }
+
+    template <class CharT, class Traits>
+    void basic_string<CharT, Traits>::shrink_to_fit()
+    {
+        if(!__is_long()) return;
+        size_type n = size();
+        if(n == capacity()) return;
+        CharT* old = __r.l.ptr;
+        size_type old_cap = capacity();
+        if(n <= __sso_capacity)
+        {
+            Traits::copy(__r.s, old, n); // 先拷贝, 会覆盖长字符串的表示
+            __set_short_size(n);
+        }
+        else
+        {
+            CharT* p = data_allocator::allocate(n + 1);
+            Traits::copy(p, old, n + 1);
+            __set_long(p, n, n);
+        }
+        data_allocator::deallocate(old, old_cap + 1);
+    }
+
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits>& basic_string<CharT, Traits>::assign(const CharT* str, size_type n)
+    {
+        if(n <= capacity())
+        {
+            Traits::move(__ptr(), str, n); // str可能指向自身
+            __set_size(n);
+        }
+        else
+        {
+            CharT* p = data_allocator::allocate(n + 1);
+            Traits::copy(p, str, n);
+            Traits::assign(p[n], CharT());
+            if(__is_long()) data_allocator::deallocate(__r.l.ptr, capacity() + 1);
+            __set_long(p, n, n);
+        }
+        return *this;
+    }
+
+    // 容量足够时只拷贝字符, 不分配
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits>& basic_string<CharT, Traits>::append(const CharT* str, size_type n)
+    {
+        size_type old_size = size();
+        if(old_size + n <= capacity())
+        {
+            if(n)
+            {
+                Traits::copy(__ptr() + old_size, str, n);
+                __set_size(old_size + n);
+            }
+        }
+        else
+        {
+            __reallocate(__recommend(old_size + n), str, n);
+        }
+        return *this;
+    }
+
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits>& basic_string<CharT, Traits>::append(size_type n, CharT ch)
+    {
+        size_type old_size = size();
+        if(old_size + n > capacity()) __reallocate(__recommend(old_size + n));
+        Traits::assign(__ptr() + old_size, n, ch);
+        __set_size(old_size + n);
+        return *this;
+    }
+
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits>& basic_string<CharT, Traits>::erase(size_type pos, size_type n)
+    {
+        size_type old_size = size();
+        if(pos > old_size) throw std::out_of_range("basic_string::erase");
+        if(n > old_size - pos) n = old_size - pos;
+        CharT* p = __ptr();
+        Traits::move(p + pos, p + pos + n, old_size - pos - n);
+        __set_size(old_size - n);
+        return *this;
+    }
+
+    // 拼接
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits> operator+(const basic_string<CharT, Traits>& lhs, const basic_string<CharT, Traits>& rhs)
+    {
+        basic_string<CharT, Traits> res;
+        res.reserve(lhs.size() + rhs.size());
+        res.append(lhs).append(rhs);
+        return res;
+    }
+
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits> operator+(basic_string<CharT, Traits>&& lhs, const basic_string<CharT, Traits>& rhs)
+    {
+        return mySTL::move(lhs.append(rhs));
+    }
+
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits> operator+(const basic_string<CharT, Traits>& lhs, const CharT* rhs)
+    {
+        size_t n = Traits::length(rhs);
+        basic_string<CharT, Traits> res;
+        res.reserve(lhs.size() + n);
+        res.append(lhs).append(rhs, n);
+        return res;
+    }
+
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits> operator+(basic_string<CharT, Traits>&& lhs, const CharT* rhs)
+    {
+        return mySTL::move(lhs.append(rhs));
+    }
+
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits> operator+(const CharT* lhs, const basic_string<CharT, Traits>& rhs)
+    {
+        size_t n = Traits::length(lhs);
+        basic_string<CharT, Traits> res;
+        res.reserve(n + rhs.size());
+        res.append(lhs, n).append(rhs);
+        return res;
+    }
+
+    template <class CharT, class Traits>
+    basic_string<CharT, Traits> operator+(const basic_string<CharT, Traits>& lhs, CharT rhs)
+    {
+        basic_string<CharT, Traits> res;
+        res.reserve(lhs.size() + 1);
+        res.append(lhs).push_back(rhs);
+        return res;
+    }
+
+    // 比较
+    template <class CharT, class Traits>
+    inline bool operator==(const basic_string<CharT, Traits>& lhs, const basic_string<CharT, Traits>& rhs) noexcept
+    {return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;}
+
+    template <class CharT, class Traits>
+    inline bool operator==(const basic_string<CharT, Traits>& lhs, const CharT* rhs)
+    {return lhs.compare(rhs) == 0;}
+
+    template <class CharT, class Traits>
+    inline bool operator==(const CharT* lhs, const basic_string<CharT, Traits>& rhs)
+    {return rhs.compare(lhs) == 0;}
+
+    template <class CharT, class Traits>
+    inline bool operator!=(const basic_string<CharT, Traits>& lhs, const basic_string<CharT, Traits>& rhs) noexcept
+    {return !(lhs == rhs);}
+
+    template <class CharT, class Traits>
+    inline bool operator!=(const basic_string<CharT, Traits>& lhs, const CharT* rhs)
+    {return !(lhs == rhs);}
+
+    template <class CharT, class Traits>
+    inline bool operator<(const basic_string<CharT, Traits>& lhs, const basic_string<CharT, Traits>& rhs) noexcept
+    {return lhs.compare(rhs) < 0;}
+
+    template <class CharT, class Traits>
+    void swap(basic_string<CharT, Traits>& lhs, basic_string<CharT, Traits>& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    template <class CharT, class Traits>
+    inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os,
+                                                         const basic_string<CharT, Traits>& str)
+    {
+        return os.write(str.data(), static_cast<std::streamsize>(str.size()));
+    }
+
+    typedef basic_string<char>     string;
+    typedef basic_string<wchar_t>  wstring;
+}
+#endif // __BASIC_STRING_H__
@@ -0,0 +1,555 @@
+#ifndef __BITSET_H__
+#define __BITSET_H__
+
+// 位集合: 固定大小的 bitset<N> 和运行时大小的 dynamic_bitset
+// 都以64位字存储, 按字做 & | ^ / popcount / tzcnt, 编译时开启AVX2 (-mavx2) 则每次处理4个字
+// rank_select_index 在位集合上建立rank/select索引
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "allocator.h"
+#include "utils.h"
+#include "iterator.h"
+
+namespace mySTL
+{
+    typedef uint64_t __bit_word;
+    static constexpr size_t __bits_per_word = 64;
+    static constexpr size_t __bit_npos = size_t(-1);
+
+    constexpr size_t __bit_words(size_t nbits) {return (nbits + __bits_per_word - 1) / __bits_per_word;}
+
+    // popcnt / tzcnt, 编译器支持时为单条指令 (需要 -mpopcnt / -mbmi)
+    inline size_t __popcount(__bit_word w) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_popcountll(w));
+#else
+        size_t n = 0;
+        for(; w; w &= w - 1) ++n;
+        return n;
+#endif
+    }
+
+    // w != 0
+    inline size_t __ctz(__bit_word w) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_ctzll(w));
+#else
+        size_t n = 0;
+        for(; !(w & 1); w >>= 1) ++n;
+        return n;
+#endif
+    }
+
+    // w中第k个 (从0开始) 为1的位的下标, 调用者保证 k < popcount(w)
+    inline size_t __select_in_word(__bit_word w, size_t k) noexcept
+    {
+        for(; k > 0; --k) w &= w - 1;
+        return __ctz(w);
+    }
+
+    /**
+     * @brief 按字批量操作
+     */
+    inline void __bits_and(__bit_word* dst, const __bit_word* src, size_t n) noexcept
+    {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for(; i + 4 <= n; i += 4)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(a, b));
+        }
+#endif
+        for(; i < n; i++) dst[i] &= src[i];
+    }
+
+    inline void __bits_or(__bit_word* dst, const __bit_word* src, size_t n) noexcept
+    {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for(; i + 4 <= n; i += 4)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(a, b));
+        }
+#endif
+        for(; i < n; i++) dst[i] |= src[i];
+    }
+
+    inline void __bits_xor(__bit_word* dst, const __bit_word* src, size_t n) noexcept
+    {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for(; i + 4 <= n; i += 4)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(a, b));
+        }
+#endif
+        for(; i < n; i++) dst[i] ^= src[i];
+    }
+
+    // 4路独立累加, 让多条popcnt并行执行
+    inline size_t __bits_count(const __bit_word* w, size_t n) noexcept
+    {
+        size_t c0 = 0, c1 = 0, c2 = 0, c3 = 0, i = 0;
+        for(; i + 4 <= n; i += 4)
+        {
+            c0 += __popcount(w[i]);
+            c1 += __popcount(w[i + 1]);
+            c2 += __popcount(w[i + 2]);
+            c3 += __popcount(w[i + 3]);
+        }
+        for(; i < n; i++) c0 += __popcount(w[i]);
+        return c0 + c1 + c2 + c3;
+    }
+
+    // popcount(a & b), 不产生中间结果
+    inline size_t __bits_count_and(const __bit_word* a, const __bit_word* b, size_t n) noexcept
+    {
+        size_t c0 = 0, c1 = 0, i = 0;
+        for(; i + 2 <= n; i += 2)
+        {
+            c0 += __popcount(a[i] & b[i]);
+            c1 += __popcount(a[i + 1] & b[i + 1]);
+        }
+        for(; i < n; i++) c0 += __popcount(a[i] & b[i]);
+        return c0 + c1;
+    }
+
+    // 从pos开始 (包含pos) 的第一个1的位置, 找不到返回__bit_npos
+    inline size_t __bits_find_from(const __bit_word* w, size_t nbits, size_t pos) noexcept
+    {
+        if(pos >= nbits) return __bit_npos;
+        size_t i = pos / __bits_per_word, n = __bit_words(nbits);
+        __bit_word curr = w[i] & (~__bit_word(0) << (pos % __bits_per_word));
+        while(!curr)
+        {
+            if(++i == n) return __bit_npos;
+            curr = w[i];
+        }
+        return i * __bits_per_word + __ctz(curr);
+    }
+
+    // 最后一个字中超出nbits的部分
+    constexpr __bit_word __bits_tail_mask(size_t nbits)
+    {
+        return nbits % __bits_per_word ? (__bit_word(1) << (nbits % __bits_per_word)) - 1 : ~__bit_word(0);
+    }
+
+    /**
+     * @brief 遍历所有为1的位, 解引用得到位的下标
+     */
+    struct __set_bit_iterator: public mySTL::iterator<mySTL::forward_iterator_tag, size_t, ptrdiff_t,
+                                                      const size_t*, size_t>
+    {
+        typedef __set_bit_iterator self;
+
+        const __bit_word* words;
+        size_t            nbits;
+        size_t            pos; // 当前位, 结束时为nbits
+
+        __set_bit_iterator() : words(nullptr), nbits(0), pos(0) {}
+        __set_bit_iterator(const __bit_word* w, size_t n, size_t p) : words(w), nbits(n), pos(p) {}
+
+        bool operator==(const self& other) const {return pos == other.pos;}
+        bool operator!=(const self& other) const {return pos != other.pos;}
+
+        size_t operator*() const {return pos;}
+
+        self& operator++()
+        {
+            size_t next = __bits_find_from(words, nbits, pos + 1);
+            pos = next == __bit_npos ? nbits : next;
+            return *this;
+        }
+        self operator++(int)
+        {
+            self tmp = *this;
+            ++*this;
+            return tmp;
+        }
+    };
+
+    /**
+     * @brief bitset
+     * 固定N位, 存放在对象内部
+     * @tparam N 位数
+     */
+    template <size_t N>
+    class bitset
+    {
+    public:
+        typedef size_t             size_type;
+        typedef __set_bit_iterator iterator; // 遍历为1的位
+        static constexpr size_type npos = __bit_npos;
+        static constexpr size_type word_count = __bit_words(N) ? __bit_words(N) : 1;
+
+    private:
+        __bit_word __words[word_count];
+
+    public:
+        constexpr bitset() noexcept : __words{} {}
+
+        static constexpr size_type size() noexcept {return N;}
+        const __bit_word* words() const noexcept {return __words;}
+
+        bool test(size_type i) const {assert(i < N); return (__words[i / 64] >> (i % 64)) & 1;}
+        bool operator[](size_type i) const {return test(i);}
+
+        bitset& set(size_type i, bool value = true)
+        {
+            assert(i < N);
+            __bit_word mask = __bit_word(1) << (i % 64);
+            if(value) __words[i / 64] |= mask;
+            else      __words[i / 64] &= ~mask;
+            return *this;
+        }
+        bitset& reset(size_type i) {return set(i, false);}
+        bitset& flip(size_type i) {assert(i < N); __words[i / 64] ^= __bit_word(1) << (i % 64); return *this;}
+
+        bitset& set()
+        {
+            std::memset(__words, 0xff, sizeof(__words));
+            __words[word_count - 1] &= __bits_tail_mask(N);
+            return *this;
+        }
+        bitset& reset() {std::memset(__words, 0, sizeof(__words)); return *this;}
+        bitset& flip()
+        {
+            for(size_type i = 0; i < word_count; i++) __words[i] = ~__words[i];
+            __words[word_count - 1] &= __bits_tail_mask(N);
+            return *this;
+        }
+
+        size_type count() const noexcept {return __bits_count(__words, word_count);}
+        bool any()  const noexcept {return find_first() != npos;}
+        bool none() const noexcept {return !any();}
+        bool all()  const noexcept {return count() == N;}
+
+        size_type find_first() const noexcept {return __bits_find_from(__words, N, 0);}
+        size_type find_next(size_type pos) const noexcept {return __bits_find_from(__words, N, pos + 1);}
+
+        iterator begin() const
+        {
+            size_type first = find_first();
+            return iterator(__words, N, first == npos ? N : first);
+        }
+        iterator end() const {return iterator(__words, N, N);}
+
+        bitset& operator&=(const bitset& other) noexcept {__bits_and(__words, other.__words, word_count); return *this;}
+        bitset& operator|=(const bitset& other) noexcept {__bits_or(__words, other.__words, word_count); return *this;}
+        bitset& operator^=(const bitset& other) noexcept {__bits_xor(__words, other.__words, word_count); return *this;}
+        bitset  operator~() const {return bitset(*this).flip();}
+
+        bool operator==(const bitset& other) const noexcept
+        {return std::memcmp(__words, other.__words, sizeof(__words)) == 0;}
+        bool operator!=(const bitset& other) const noexcept {return !(*this == other);}
+    };
+
+    template <size_t N>
+    inline bitset<N> operator&(const bitset<N>& lhs, const bitset<N>& rhs) {return bitset<N>(lhs) &= rhs;}
+    template <size_t N>
+    inline bitset<N> operator|(const bitset<N>& lhs, const bitset<N>& rhs) {return bitset<N>(lhs) |= rhs;}
+    template <size_t N>
+    inline bitset<N> operator^(const bitset<N>& lhs, const bitset<N>& rhs) {return bitset<N>(lhs) ^= rhs;}
+
+    /**
+     * @brief dynamic_bitset
+     * 运行时确定位数, 字数组由mySTL::allocator分配
+     */
+    class dynamic_bitset
+    {
+    public:
+        typedef size_t                       size_type;
+        typedef __set_bit_iterator           iterator; // 遍历为1的位
+        typedef mySTL::allocator<__bit_word> word_allocator;
+        static constexpr size_type npos = __bit_npos;
+
+    private:
+        __bit_word* __words;
+        size_type   __nbits;
+        size_type   __cap_words;
+
+    public:
+        dynamic_bitset() noexcept : __words(nullptr), __nbits(0), __cap_words(0) {}
+        explicit dynamic_bitset(size_type nbits, bool value = false)
+            : __words(nullptr), __nbits(0), __cap_words(0)
+        {resize(nbits, value);}
+
+        dynamic_bitset(const dynamic_bitset& other) : __words(nullptr), __nbits(0), __cap_words(0)
+        {
+            reserve(other.__nbits);
+            if(other.word_count()) std::memcpy(__words, other.__words, other.word_count() * sizeof(__bit_word));
+            __nbits = other.__nbits;
+        }
+        dynamic_bitset(dynamic_bitset&& other) noexcept
+            : __words(other.__words), __nbits(other.__nbits), __cap_words(other.__cap_words)
+        {
+            other.__words = nullptr;
+            other.__nbits = other.__cap_words = 0;
+        }
+        dynamic_bitset& operator=(dynamic_bitset other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+        ~dynamic_bitset() {word_allocator::deallocate(__words, __cap_words);}
+
+        void swap(dynamic_bitset& other) noexcept
+        {
+            mySTL::swap(__words, other.__words);
+            mySTL::swap(__nbits, other.__nbits);
+            mySTL::swap(__cap_words, other.__cap_words);
+        }
+
+    public:
+        size_type size() const noexcept {return __nbits;}
+        bool      empty() const noexcept {return __nbits == 0;}
+        size_type word_count() const noexcept {return __bit_words(__nbits);}
+        const __bit_word* words() const noexcept {return __words;}
+        // 需要特殊操作时直接访问字数组, 调用者负责保持最后一个字超出size()的位为0
+        __bit_word*       words() noexcept {return __words;}
+
+        bool test(size_type i) const {assert(i < __nbits); return (__words[i / 64] >> (i % 64)) & 1;}
+        bool operator[](size_type i) const {return test(i);}
+
+        dynamic_bitset& set(size_type i, bool value = true)
+        {
+            assert(i < __nbits);
+            __bit_word mask = __bit_word(1) << (i % 64);
+            if(value) __words[i / 64] |= mask;
+            else      __words[i / 64] &= ~mask;
+            return *this;
+        }
+        dynamic_bitset& reset(size_type i) {return set(i, false);}
+        dynamic_bitset& flip(size_type i) {assert(i < __nbits); __words[i / 64] ^= __bit_word(1) << (i % 64); return *this;}
+
+        dynamic_bitset& set()
+        {
+            if(word_count())
+            {
+                std::memset(__words, 0xff, word_count() * sizeof(__bit_word));
+                __words[word_count() - 1] &= __bits_tail_mask(__nbits);
+            }
+            return *this;
+        }
+        dynamic_bitset& reset()
+        {
+            if(word_count()) std::memset(__words, 0, word_count() * sizeof(__bit_word));
+            return *this;
+        }
+        dynamic_bitset& flip()
+        {
+            for(size_type i = 0; i < word_count(); i++) __words[i] = ~__words[i];
+            if(word_count()) __words[word_count() - 1] &= __bits_tail_mask(__nbits);
+            return *this;
+        }
+
+        void reserve(size_type nbits)
+        {
+            size_type need = __bit_words(nbits);
+            if(need <= __cap_words) return;
+            __bit_word* w = word_allocator::allocate(need);
+            if(word_count()) std::memcpy(w, __words, word_count() * sizeof(__bit_word));
+            word_allocator::deallocate(__words, __cap_words);
+            __words = w;
+            __cap_words = need;
+        }
+
+        // 新增的位为value
+        void resize(size_type nbits, bool value = false);
+
+        void push_back(bool value)
+        {
+            if(__nbits == __cap_words * __bits_per_word)
+                reserve(__nbits ? __nbits * 2 : __bits_per_word);
+            if(__nbits % __bits_per_word == 0) __words[__nbits / 64] = 0;
+            ++__nbits;
+            set(__nbits - 1, value);
+        }
+
+        void clear() noexcept {__nbits = 0;}
+
+        size_type count() const noexcept {return __bits_count(__words, word_count());}
+        // 与other的交集大小, 不产生新的bitset
+        size_type intersect_count(const dynamic_bitset& other) const noexcept
+        {
+            assert(__nbits == other.__nbits);
+            return __bits_count_and(__words, other.__words, word_count());
+        }
+        bool any()  const noexcept {return find_first() != npos;}
+        bool none() const noexcept {return !any();}
+
+        size_type find_first() const noexcept {return __bits_find_from(__words, __nbits, 0);}
+        size_type find_next(size_type pos) const noexcept {return __bits_find_from(__words, __nbits, pos + 1);}
+
+        iterator begin() const
+        {
+            size_type first = find_first();
+            return iterator(__words, __nbits, first == npos ? __nbits : first);
+        }
+        iterator end() const {return iterator(__words, __nbits, __nbits);}
+
+        // 两个bitset的位数必须相同
+        dynamic_bitset& operator&=(const dynamic_bitset& other) noexcept
+        {
+            assert(__nbits == other.__nbits);
+            __bits_and(__words, other.__words, word_count());
+            return *this;
+        }
+        dynamic_bitset& operator|=(const dynamic_bitset& other) noexcept
+        {
+            assert(__nbits == other.__nbits);
+            __bits_or(__words, other.__words, word_count());
+            return *this;
+        }
+        dynamic_bitset& operator^=(const dynamic_bitset& other) noexcept
+        {
+            assert(__nbits == other.__nbits);
+            __bits_xor(__words, other.__words, word_count());
+            return *this;
+        }
+        dynamic_bitset operator~() const {return dynamic_bitset(*this).flip();}
+
+        bool operator==(const dynamic_bitset& other) const noexcept
+        {
+            return __nbits == other.__nbits &&
+                   (!word_count() || std::memcmp(__words, other.__words, word_count() * sizeof(__bit_word)) == 0);
+        }
+        bool operator!=(const dynamic_bitset& other) const noexcept {return !(*this == other);}
+    };
+
+    inline void dynamic_bitset::resize(size_type nbits, bool value)
+    {
+        if(nbits > __nbits)
+        {
+            reserve(nbits);
+            size_type old_words = word_count();
+            // 补齐原来最后一个字
+            if(__nbits % __bits_per_word)
+            {
+                __bit_word tail = ~__bits_tail_mask(__nbits);
+                if(value) __words[old_words - 1] |= tail;
+                else      __words[old_words - 1] &= ~tail;
+            }
+            size_type new_words = __bit_words(nbits);
+            if(new_words > old_words)
+                std::memset(__words + old_words, value ? 0xff : 0, (new_words - old_words) * sizeof(__bit_word));
+            __nbits = nbits;
+            __words[new_words - 1] &= __bits_tail_mask(nbits);
+        }
+        else
+        {
+            __nbits = nbits;
+            if(word_count()) __words[word_count() - 1] &= __bits_tail_mask(nbits);
+        }
+    }
+
+    inline dynamic_bitset operator&(const dynamic_bitset& lhs, const dynamic_bitset& rhs) {return dynamic_bitset(lhs) &= rhs;}
+    inline dynamic_bitset operator|(const dynamic_bitset& lhs, const dynamic_bitset& rhs) {return dynamic_bitset(lhs) |= rhs;}
+    inline dynamic_bitset operator^(const dynamic_bitset& lhs, const dynamic_bitset& rhs) {return dynamic_bitset(lhs) ^= rhs;}
+
+    inline void swap(dynamic_bitset& lhs, dynamic_bitset& rhs) noexcept {lhs.swap(rhs);}
+
+    /**
+     * @brief rank/select索引
+     * 每512位 (8个字) 记录一次之前的1的个数, 额外空间为1/8
+     * rank(i): [0, i)中1的个数, O(1)
+     * select(k): 第k个 (从0开始) 1的位置, 对块二分, O(log n)
+     * 只引用原位集合的字数组, 位集合修改后需要重新build
+     */
+    class rank_select_index
+    {
+    public:
+        typedef size_t                     size_type;
+        typedef mySTL::allocator<uint64_t> block_allocator;
+        static constexpr size_type words_per_block = 8;
+        static constexpr size_type npos = __bit_npos;
+
+    private:
+        const __bit_word* __words;
+        size_type         __nbits;
+        uint64_t*         __blocks;   // __blocks[b] = 第b块之前的1的个数, 最后多存一个总数
+        size_type         __nblocks;
+
+    public:
+        rank_select_index() noexcept : __words(nullptr), __nbits(0), __blocks(nullptr), __nblocks(0) {}
+        explicit rank_select_index(const dynamic_bitset& bits)
+            : __words(nullptr), __nbits(0), __blocks(nullptr), __nblocks(0)
+        {build(bits.words(), bits.size());}
+        template <size_t N>
+        explicit rank_select_index(const bitset<N>& bits)
+            : __words(nullptr), __nbits(0), __blocks(nullptr), __nblocks(0)
+        {build(bits.words(), N);}
+
+        rank_select_index(const rank_select_index&) = delete;
+        rank_select_index& operator=(const rank_select_index&) = delete;
+        ~rank_select_index() {block_allocator::deallocate(__blocks, __nblocks + 1);}
+
+        void build(const __bit_word* words, size_type nbits)
+        {
+            block_allocator::deallocate(__blocks, __nblocks + 1);
+            __words = words;
+            __nbits = nbits;
+            size_type nwords = __bit_words(nbits);
+            __nblocks = (nwords + words_per_block - 1) / words_per_block;
+            __blocks = block_allocator::allocate(__nblocks + 1);
+            uint64_t total = 0;
+            for(size_type b = 0; b < __nblocks; b++)
+            {
+                __blocks[b] = total;
+                size_type first = b * words_per_block;
+                size_type n = nwords - first < words_per_block ? nwords - first : words_per_block;
+                total += __bits_count(words + first, n);
+            }
+            __blocks[__nblocks] = total;
+        }
+
+        size_type count() const noexcept {return __blocks ? __blocks[__nblocks] : 0;}
+
+        size_type rank(size_type i) const noexcept
+        {
+            assert(i <= __nbits);
+            size_type w = i / __bits_per_word, b = w / words_per_block;
+            size_type res = b < __nblocks ? __blocks[b] : count();
+            for(size_type j = b * words_per_block; j < w; j++) res += __popcount(__words[j]);
+            if(i % __bits_per_word)
+                res += __popcount(__words[w] & ((__bit_word(1) << (i % __bits_per_word)) - 1));
+            return res;
+        }
+
+        size_type select(size_type k) const noexcept
+        {
+            if(k >= count()) return npos;
+            // 最后一个 __blocks[b] <= k 的块
+            size_type lo = 0, hi = __nblocks;
+            while(hi - lo > 1)
+            {
+                size_type mid = lo + (hi - lo) / 2;
+                if(__blocks[mid] <= k) lo = mid;
+                else hi = mid;
+            }
+            k -= __blocks[lo];
+            for(size_type w = lo * words_per_block; ; w++)
+            {
+                size_type c = __popcount(__words[w]);
+                if(k < c) return w * __bits_per_word + __select_in_word(__words[w], k);
+                k -= c;
+            }
+        }
+    };
+}
+#endif // __BITSET_H__
@@ -0,0 +1,454 @@
+#ifndef __CONCURRENT_SKIP_LIST_H__
+#define __CONCURRENT_SKIP_LIST_H__
+
+// 无锁有序map (跳表, Harris/Fraser的标记指针算法)
+// 删除时先在next指针的最低位打标记 (逻辑删除, 从上层到底层), 之后遍历到它的线程用CAS把它摘除 (物理删除)
+// 节点在所有层都摘除后交给epoch_domain延迟释放, 持有epoch_guard的线程 (包括迭代器) 读到的节点不会被释放
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <new>
+#include <optional>
+#include "allocator.h"
+#include "construct.h"
+#include "iterator.h"
+#include "pair.h"
+#include "utils.h"
+#include "epoch.h"
+
+namespace mySTL
+{
+    template <class Value>
+    struct __skip_node
+    {
+        typedef std::atomic<uintptr_t> link_type;
+
+        // 插入线程和删除线程都完成后节点才能退休, 见 __finish
+        std::atomic<int>    pending;
+        int                 level;
+        alignas(Value) unsigned char storage[sizeof(Value)];
+        link_type           next[1];    // 实际长度为level
+
+        Value&       value()       noexcept {return *reinterpret_cast<Value*>(storage);}
+        const Value& value() const noexcept {return *reinterpret_cast<const Value*>(storage);}
+
+        static size_t bytes(int level) noexcept
+        {
+            return sizeof(__skip_node) + (level - 1) * sizeof(link_type);
+        }
+    };
+
+    // next指针的最低位表示所在节点已被删除
+    inline bool      __skip_marked(uintptr_t p)   noexcept {return p & 1;}
+    inline uintptr_t __skip_mark(uintptr_t p)     noexcept {return p | 1;}
+    inline uintptr_t __skip_unmark(uintptr_t p)   noexcept {return p & ~uintptr_t(1);}
+
+    /**
+     * @brief concurrent_skip_list
+     * 元素为 pair<const Key, T>, 插入后value不再修改, 所以读取不需要额外同步
+     * insert / erase / find / 迭代都是无锁的, 可以在任意线程并发调用
+     * 迭代器内含epoch_guard, 在并发修改期间一直有效: 遍历到的是某一时刻仍在表中的元素, 可能看到也可能看不到并发的插入
+     * 迭代器不能跨线程使用
+     * @tparam Key
+     * @tparam T
+     * @tparam Compare
+     */
+    template <class Key, class T, class Compare = std::less<Key>>
+    class concurrent_skip_list
+    {
+    public:
+        typedef Key                 key_type;
+        typedef T                   mapped_type;
+        typedef pair<const Key, T>  value_type;
+        typedef size_t              size_type;
+        typedef Compare             key_compare;
+
+        static constexpr int max_level = 24;
+
+    private:
+        typedef __skip_node<value_type>     node_type;
+        typedef typename node_type::link_type link_type;
+        typedef mySTL::allocator<uintptr_t> word_allocator;   // 节点按字分配, 塔高可变
+
+        node_type*              __head;     // 哨兵, 不构造value
+        std::atomic<size_t>     __size;
+        // epoch域 + 比较器, 无状态的Compare通过EBO不占空间
+        compressed_pair<epoch_domain*, Compare> __domain_comp;
+
+        epoch_domain*  __domain() const noexcept {return __domain_comp.first();}
+        const Compare& __comp()   const noexcept {return __domain_comp.second();}
+
+    public:
+        class iterator
+        {
+            friend class concurrent_skip_list;
+
+        public:
+            typedef forward_iterator_tag    iterator_category;
+            typedef typename concurrent_skip_list::value_type value_type;
+            typedef const value_type*       pointer;
+            typedef const value_type&       reference;
+            typedef ptrdiff_t               difference_type;
+
+        private:
+            epoch_guard                 __guard;
+            const concurrent_skip_list* __list;
+            node_type*                  __node;     // nullptr表示结束
+            std::optional<Key>          __hi;       // 区间上界 (不含) 的拷贝, 为空表示没有上界
+
+        public:
+            iterator() noexcept : __guard(), __list(nullptr), __node(nullptr), __hi() {}
+
+            reference operator*()  const noexcept {return __node->value();}
+            pointer   operator->() const noexcept {return &__node->value();}
+
+            iterator& operator++()
+            {
+                __node = __list->__next_live(__node);
+                __check_bound();
+                return *this;
+            }
+            iterator operator++(int) {iterator tmp = *this; ++*this; return tmp;}
+
+            friend bool operator==(const iterator& a, const iterator& b) noexcept {return a.__node == b.__node;}
+            friend bool operator!=(const iterator& a, const iterator& b) noexcept {return a.__node != b.__node;}
+
+        private:
+            iterator(const concurrent_skip_list* list, node_type* node, const Key* hi)
+                : __guard(*list->__domain()), __list(list), __node(node), __hi()
+            {
+                // 拷贝上界: range_view可能是临时对象, 迭代器不能指向它
+                if(hi) __hi.emplace(*hi);
+                __check_bound();
+            }
+
+            // 构造前node已在guard之外读取, 只有在guard之内重新读取的节点才能保证有效, 见begin()
+            void __check_bound()
+            {
+                if(__node && __hi && !__list->__comp()(__node->value().first, *__hi)) __node = nullptr;
+            }
+        };
+
+        typedef iterator const_iterator;
+
+        /**
+         * @brief range_view
+         * [lo, hi) 区间, 保存上下界的拷贝; begin()时才定位起点, 返回的迭代器自己保存上界, 不依赖view的生命周期
+         */
+        class range_view
+        {
+        private:
+            const concurrent_skip_list* __list;
+            Key                         __lo;
+            Key                         __hi;
+
+        public:
+            range_view(const concurrent_skip_list* list, const Key& lo, const Key& hi) : __list(list), __lo(lo), __hi(hi) {}
+
+            iterator begin() const {return __list->__lower_bound(__lo, &__hi);}
+            iterator end()   const noexcept {return iterator();}
+        };
+
+    public:
+        // domain默认为全局的epoch_domain::global()
+        explicit concurrent_skip_list(const Compare& comp = Compare(), epoch_domain& domain = epoch_domain::global())
+            : __head(__allocate_node(max_level)), __size(0), __domain_comp(&domain, comp)
+        {
+            for(int i = 0; i < max_level; i++) __head->next[i].store(0, std::memory_order_relaxed);
+        }
+
+        concurrent_skip_list(const concurrent_skip_list&) = delete;
+        concurrent_skip_list& operator=(const concurrent_skip_list&) = delete;
+
+        // 析构时不能有其他线程在访问
+        ~concurrent_skip_list()
+        {
+            node_type* p = __node(__head->next[0].load(std::memory_order_acquire));
+            while(p)
+            {
+                node_type* next = __node(p->next[0].load(std::memory_order_relaxed));
+                __destroy_node(p);
+                p = next;
+            }
+            __deallocate_node(__head);
+        }
+
+    public:
+        size_type size()  const noexcept {return __size.load(std::memory_order_relaxed);}
+        bool      empty() const noexcept {return size() == 0;}
+
+        iterator begin() const
+        {
+            epoch_guard guard(*__domain());
+            return iterator(this, __next_live(__head), nullptr);
+        }
+        iterator end() const noexcept {return iterator();}
+
+        // 第一个不小于key的元素
+        iterator lower_bound(const Key& key) const {return __lower_bound(key, nullptr);}
+
+        // [lo, hi)
+        range_view range(const Key& lo, const Key& hi) const {return range_view(this, lo, hi);}
+
+        iterator find(const Key& key) const
+        {
+            iterator it = lower_bound(key);
+            if(it != end() && __comp()(key, it->first)) return end();
+            return it;
+        }
+
+        // 找到时拷贝value到out
+        bool find(const Key& key, T& out) const
+        {
+            epoch_guard guard(*__domain());
+            node_type* p = __next_live_from(key);
+            if(!p || __comp()(key, p->value().first)) return false;
+            out = p->value().second;
+            return true;
+        }
+
+        bool contains(const Key& key) const
+        {
+            epoch_guard guard(*__domain());
+            node_type* p = __next_live_from(key);
+            return p && !__comp()(key, p->value().first);
+        }
+
+    public:
+        /*** 修改接口 ***/
+
+        // key已存在时返回false
+        bool insert(const Key& key, const T& value) {return emplace(key, value);}
+        bool insert(const value_type& v) {return emplace(v.first, v.second);}
+
+        template <class... Args>
+        bool emplace(const Key& key, Args&&... args)
+        {
+            epoch_guard guard(*__domain());
+            node_type* preds[max_level];
+            node_type* succs[max_level];
+            node_type* node = nullptr;
+            int level = __random_level();
+            for(;;)
+            {
+                if(__find(key, preds, succs, false))
+                {
+                    if(node) __destroy_node(node);  // 从未公开, 直接释放
+                    return false;
+                }
+                if(!node) node = __create_node(level, key, mySTL::forward<Args>(args)...);
+                for(int i = 0; i < level; i++) node->next[i].store(__link(succs[i]), std::memory_order_relaxed);
+                uintptr_t expected = __link(succs[0]);
+                // 底层链接成功即插入成功 (线性化点)
+                if(preds[0]->next[0].compare_exchange_strong(expected, __link(node), std::memory_order_release,
+                                                             std::memory_order_relaxed))
+                    break;
+            }
+            __size.fetch_add(1, std::memory_order_relaxed);
+            for(int i = 1; i < level; i++)
+            {
+                for(;;)
+                {
+                    // 节点在这一层已被标记删除, 不再链接更高层
+                    uintptr_t cur = node->next[i].load(std::memory_order_acquire);
+                    if(__skip_marked(cur)) goto done;
+                    if(cur != __link(succs[i]) &&
+                       !node->next[i].compare_exchange_strong(cur, __link(succs[i]), std::memory_order_acq_rel))
+                        goto done;
+                    uintptr_t expected = __link(succs[i]);
+                    if(preds[i]->next[i].compare_exchange_strong(expected, __link(node), std::memory_order_release,
+                                                                 std::memory_order_relaxed))
+                        break;
+                    __find(key, preds, succs, false);
+                    if(succs[0] != node) goto done;  // 已经被删除
+                }
+            }
+        done:
+            __finish(node);
+            return true;
+        }
+
+        bool erase(const Key& key)
+        {
+            epoch_guard guard(*__domain());
+            node_type* preds[max_level];
+            node_type* succs[max_level];
+            if(!__find(key, preds, succs, false)) return false;
+            node_type* node = succs[0];
+            // 从上到下标记
+            for(int i = node->level - 1; i >= 1; i--)
+            {
+                uintptr_t cur = node->next[i].load(std::memory_order_acquire);
+                while(!__skip_marked(cur) &&
+                      !node->next[i].compare_exchange_weak(cur, __skip_mark(cur), std::memory_order_acq_rel))
+                    ;
+            }
+            uintptr_t cur = node->next[0].load(std::memory_order_acquire);
+            for(;;)
+            {
+                if(__skip_marked(cur)) return false;  // 其他线程先删除了
+                if(node->next[0].compare_exchange_weak(cur, __skip_mark(cur), std::memory_order_acq_rel))
+                    break;
+            }
+            __size.fetch_sub(1, std::memory_order_relaxed);
+            __finish(node);
+            return true;
+        }
+
+    private:
+        /*** 节点 ***/
+
+        static node_type* __node(uintptr_t link) noexcept {return reinterpret_cast<node_type*>(__skip_unmark(link));}
+        static uintptr_t  __link(node_type* p)   noexcept {return reinterpret_cast<uintptr_t>(p);}
+
+        static size_t __words(int level) noexcept
+        {
+            return (node_type::bytes(level) + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+        }
+
+        static node_type* __allocate_node(int level)
+        {
+            static_assert(alignof(node_type) <= alignof(std::max_align_t), "over-aligned value_type");
+            node_type* p = reinterpret_cast<node_type*>(word_allocator::allocate(__words(level)));
+            ::new (static_cast<void*>(&p->pending)) std::atomic<int>(2);
+            p->level = level;
+            for(int i = 0; i < level; i++) ::new (static_cast<void*>(p->next + i)) link_type(0);
+            return p;
+        }
+
+        static void __deallocate_node(node_type* p) noexcept
+        {
+            word_allocator::deallocate(reinterpret_cast<uintptr_t*>(p), __words(p->level));
+        }
+
+        template <class... Args>
+        static node_type* __create_node(int level, const Key& key, Args&&... args)
+        {
+            node_type* p = __allocate_node(level);
+            try
+            {
+                ::new (static_cast<void*>(p->storage)) value_type(piecewise_construct, std::forward_as_tuple(key),
+                                                                  std::forward_as_tuple(mySTL::forward<Args>(args)...));
+            }
+            catch(...)
+            {
+                __deallocate_node(p);
+                throw;
+            }
+            return p;
+        }
+
+        static void __destroy_node(node_type* p) noexcept
+        {
+            mySTL::destroy(&p->value());
+            __deallocate_node(p);
+        }
+
+        static void __destroy_node_erased(void* p) noexcept {__destroy_node(static_cast<node_type*>(p));}
+
+        // 插入线程链接完所有层、删除线程打完标记后各调用一次, 第二次调用的线程负责把节点彻底摘除并退休
+        // 只有插入线程会链接节点, 所以第二次调用时不会再有新的链接出现
+        void __finish(node_type* node)
+        {
+            if(node->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            node_type* preds[max_level];
+            node_type* succs[max_level];
+            __find(node->value().first, preds, succs, true);
+            __domain()->retire(node, &__destroy_node_erased);
+        }
+
+        int __random_level() const noexcept
+        {
+            static thread_local uint64_t x = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(&x);
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            // 每层概率1/4
+            int level = 1;
+            uint64_t r = x;
+            while(level < max_level && (r & 3) == 0)
+            {
+                ++level;
+                r >>= 2;
+            }
+            return level;
+        }
+
+    private:
+        /*** 查找, 调用时必须持有epoch_guard ***/
+
+        /**
+         * @brief 每一层找到key的前驱和后继, 顺便摘除遇到的已标记节点
+         * through_equal为true时越过所有等于key的节点, 用于彻底摘除某个已删除的节点
+         * @return 底层后继是否等于key
+         */
+        bool __find(const Key& key, node_type** preds, node_type** succs, bool through_equal) const
+        {
+        retry:
+            node_type* pred = __head;
+            for(int i = max_level - 1; i >= 0; i--)
+            {
+                node_type* curr = __node(pred->next[i].load(std::memory_order_acquire));
+                for(;;)
+                {
+                    if(!curr) break;
+                    uintptr_t succ = curr->next[i].load(std::memory_order_acquire);
+                    while(__skip_marked(succ))
+                    {
+                        uintptr_t expected = __link(curr);
+                        if(!pred->next[i].compare_exchange_strong(expected, __skip_unmark(succ), std::memory_order_acq_rel))
+                            goto retry;  // pred变化或者pred也被删除
+                        curr = __node(succ);
+                        if(!curr) break;
+                        succ = curr->next[i].load(std::memory_order_acquire);
+                    }
+                    if(!curr) break;
+                    const Key& k = curr->value().first;
+                    if(__comp()(k, key) || (through_equal && !__comp()(key, k)))
+                    {
+                        pred = curr;
+                        curr = __node(succ);
+                    }
+                    else break;
+                }
+                preds[i] = pred;
+                succs[i] = curr;
+            }
+            return succs[0] && !__comp()(key, succs[0]->value().first);
+        }
+
+        // p之后底层第一个没有被删除的节点
+        node_type* __next_live(node_type* p) const
+        {
+            node_type* q = __node(p->next[0].load(std::memory_order_acquire));
+            while(q && __skip_marked(q->next[0].load(std::memory_order_acquire)))
+                q = __node(q->next[0].load(std::memory_order_acquire));
+            return q;
+        }
+
+        // 第一个不小于key的未删除节点, 只读不摘除
+        node_type* __next_live_from(const Key& key) const
+        {
+            node_type* pred = __head;
+            for(int i = max_level - 1; i >= 0; i--)
+            {
+                node_type* curr = __node(pred->next[i].load(std::memory_order_acquire));
+                while(curr && __comp()(curr->value().first, key))
+                {
+                    pred = curr;
+                    curr = __node(curr->next[i].load(std::memory_order_acquire));
+                }
+            }
+            return __next_live(pred);
+        }
+
+        iterator __lower_bound(const Key& key, const Key* hi) const
+        {
+            epoch_guard guard(*__domain());
+            return iterator(this, __next_live_from(key), hi);
+        }
+    };
+}
+#endif // __CONCURRENT_SKIP_LIST_H__
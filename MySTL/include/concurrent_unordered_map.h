@@ -0,0 +1,671 @@
+#ifndef __CONCURRENT_UNORDERED_MAP_H__
+#define __CONCURRENT_UNORDERED_MAP_H__
+
+// 并发哈希表, 开放寻址 (线性探测)
+// 读: 无锁, 每个槽位带一个seqlock版本号, 读者拷贝槽位内容后检查版本号没有变化, 否则重读
+// 写: 按key的哈希值分段加锁 (striped lock) 保证同一个key的写操作串行, 槽位本身用版本号的奇偶作为自旋锁
+// 扩容: 新表挂在旧表的next上, 之后每个写操作顺带迁移一小段旧表 (不会全局停顿), 迁移完成后切换当前表
+// 回收: 所有访问都持有epoch_guard, 切换后的旧表交给epoch_domain延迟释放 (见epoch.h)
+// key和value必须是平凡可拷贝类型, 以原子字的形式保存, 读者读到被并发修改的内容时不会有数据竞争
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include "allocator.h"
+#include "construct.h"
+#include "type_traits.h"
+#include "pair.h"
+#include "utils.h"
+#include "epoch.h"
+
+namespace mySTL
+{
+    // 把平凡可拷贝类型保存为若干个原子64位字
+    template <class T>
+    struct __atomic_words
+    {
+        static constexpr size_t word_num = (sizeof(T) + 7) / 8;
+
+        std::atomic<uint64_t> words[word_num];
+
+        void load(T& out) const noexcept
+        {
+            uint64_t buf[word_num];
+            for(size_t i = 0; i < word_num; i++) buf[i] = words[i].load(std::memory_order_relaxed);
+            std::memcpy(&out, buf, sizeof(T));
+        }
+
+        void store(const T& value) noexcept
+        {
+            uint64_t buf[word_num] = {};
+            std::memcpy(buf, &value, sizeof(T));
+            for(size_t i = 0; i < word_num; i++) words[i].store(buf[i], std::memory_order_relaxed);
+        }
+    };
+
+    // 槽位状态
+    enum : uint32_t
+    {
+        __cmap_empty = 0,   // 从未使用, 探测到这里结束
+        __cmap_full,
+        __cmap_deleted,     // 墓碑, 探测继续, 插入时可以复用
+        __cmap_sealed,      // 迁移时的空槽位, 探测到这里结束, 不能再插入
+        __cmap_moved        // 迁移时的非空槽位 (保留key), 元素已经在下一张表中
+    };
+
+    template <class Key, class T>
+    struct __cmap_slot
+    {
+        std::atomic<uint32_t> seq;    // 偶数: 稳定; 奇数: 有写者持有该槽位
+        std::atomic<uint32_t> state;
+        __atomic_words<Key>   key;
+        __atomic_words<T>     value;
+    };
+
+    template <class Key, class T>
+    struct __cmap_table
+    {
+        typedef __cmap_slot<Key, T> slot_type;
+
+        size_t                      mask;       // 容量 - 1, 容量为2的幂
+        slot_type*                  slots;
+        std::atomic<__cmap_table*>  next;       // 扩容时的新表
+        std::atomic<size_t>         used;       // full + deleted, 用于判断是否需要扩容
+        std::atomic<size_t>         cursor;     // 下一个待迁移的槽位
+        std::atomic<size_t>         migrated;   // 已经迁移完成的槽位个数
+
+        size_t capacity() const noexcept {return mask + 1;}
+    };
+
+    /**
+     * @brief concurrent_unordered_map
+     * find / contains / find_many 无锁; insert / insert_or_assign / update / erase 加分段锁
+     * 扩容不阻塞读者, 写者每次操作最多迁移 migrate_chunk 个槽位
+     * 废弃的旧表交给epoch_domain, 等所有可能还在读它的操作结束后释放; 每次开始扩容时顺带回收,
+     * 所以即使反复原地重建 (清理墓碑), 每个线程未释放的旧表也只有一两张
+     * @tparam Key  平凡可拷贝
+     * @tparam T    平凡可拷贝
+     */
+    template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+    class concurrent_unordered_map
+    {
+        static_assert(mySTL::is_trivially_copyable<Key>::value, "concurrent_unordered_map requires trivially copyable Key");
+        static_assert(mySTL::is_trivially_copyable<T>::value, "concurrent_unordered_map requires trivially copyable T");
+
+    public:
+        typedef Key         key_type;
+        typedef T           mapped_type;
+        typedef size_t      size_type;
+        typedef Hash        hasher;
+        typedef KeyEqual    key_equal;
+
+        static constexpr size_t migrate_chunk = 64;
+
+    private:
+        typedef __cmap_slot<Key, T>                 slot_type;
+        typedef __cmap_table<Key, T>                table_type;
+        typedef mySTL::allocator<slot_type>         slot_allocator;
+        typedef mySTL::allocator<table_type>        table_allocator;
+
+        struct alignas(64) __stripe
+        {
+            std::mutex m;
+        };
+        typedef mySTL::allocator<__stripe>          stripe_allocator;
+
+        enum __op_result {__op_done, __op_restart};
+
+        std::atomic<table_type*> __current;
+        std::atomic<size_t>      __size;
+        __stripe*                __stripes;
+        size_t                   __stripe_mask;
+        std::mutex               __resize_mutex;
+        // epoch域 + hasher/key_equal, 无状态的Hash和KeyEqual通过EBO不占空间
+        compressed_pair<epoch_domain*, compressed_pair<Hash, KeyEqual>> __domain_policy;
+
+        epoch_domain*   __domain() const noexcept {return __domain_policy.first();}
+        const Hash&     __hasher() const noexcept {return __domain_policy.second().first();}
+        const KeyEqual& __equal()  const noexcept {return __domain_policy.second().second();}
+
+    public:
+        // capacity和stripes会向上取整为2的幂, domain默认为全局的epoch_domain::global()
+        explicit concurrent_unordered_map(size_t capacity = 16, size_t stripes = 64,
+                                          const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual(),
+                                          epoch_domain& domain = epoch_domain::global())
+            : __current(nullptr), __size(0), __stripes(nullptr), __stripe_mask(__round_pow2(stripes) - 1),
+              __domain_policy(&domain, compressed_pair<Hash, KeyEqual>(hash, equal))
+        {
+            __stripes = stripe_allocator::allocate(__stripe_mask + 1);
+            for(size_t i = 0; i <= __stripe_mask; i++) mySTL::construct(__stripes + i);
+            __current.store(__new_table(__round_pow2(capacity < 8 ? 8 : capacity)), std::memory_order_release);
+        }
+
+        concurrent_unordered_map(const concurrent_unordered_map&) = delete;
+        concurrent_unordered_map& operator=(const concurrent_unordered_map&) = delete;
+
+        // 析构时不能有其他线程在访问; 已经交给domain的旧表由domain释放
+        ~concurrent_unordered_map()
+        {
+            table_type* t = __current.load(std::memory_order_relaxed);
+            while(t)
+            {
+                table_type* next = t->next.load(std::memory_order_relaxed);
+                __delete_table(t);
+                t = next;
+            }
+            for(size_t i = 0; i <= __stripe_mask; i++) mySTL::destroy(__stripes + i);
+            stripe_allocator::deallocate(__stripes, __stripe_mask + 1);
+        }
+
+    public:
+        /*** 读接口 (无锁) ***/
+        size_type size()  const noexcept {return __size.load(std::memory_order_relaxed);}
+        bool      empty() const noexcept {return size() == 0;}
+
+        // 当前表 (扩容中为旧表) 的容量
+        size_type capacity() const
+        {
+            epoch_guard guard(*__domain());
+            return __current.load(std::memory_order_acquire)->capacity();
+        }
+        bool resizing() const
+        {
+            epoch_guard guard(*__domain());
+            return __current.load(std::memory_order_acquire)->next.load(std::memory_order_acquire) != nullptr;
+        }
+
+        bool find(const Key& key, T& out) const
+        {
+            epoch_guard guard(*__domain());
+            return __find(key, __mix_hash(key), out);
+        }
+
+        bool contains(const Key& key) const
+        {
+            T tmp;
+            return find(key, tmp);
+        }
+
+        /**
+         * @brief 批量查找
+         * 先算出一组key的哈希值并预取各自的第一个槽位, 再逐个查找, 让多个cache miss重叠
+         * @return 找到的个数, found[i]表示keys[i]是否存在
+         */
+        size_t find_many(const Key* keys, size_t n, T* out, bool* found) const
+        {
+            static constexpr size_t group = 16;
+            uint64_t hashes[group];
+            size_t hit = 0;
+            epoch_guard guard(*__domain());
+            for(size_t base = 0; base < n; base += group)
+            {
+                size_t m = n - base < group ? n - base : group;
+                const table_type* t = __current.load(std::memory_order_acquire);
+                for(size_t i = 0; i < m; i++)
+                {
+                    hashes[i] = __mix_hash(keys[base + i]);
+                    mySTL::prefetch(t->slots + (hashes[i] & t->mask));
+                }
+                for(size_t i = 0; i < m; i++)
+                {
+                    found[base + i] = __find(keys[base + i], hashes[i], out[base + i]);
+                    hit += found[base + i];
+                }
+            }
+            return hit;
+        }
+
+    public:
+        /*** 写接口 ***/
+
+        // key已存在时不修改, 返回false
+        bool insert(const Key& key, const T& value)
+        {
+            bool inserted = false;
+            __write(key, [&](table_type* t, uint64_t h) {
+                return __insert(t, key, h, value, false, inserted);
+            });
+            return inserted;
+        }
+
+        // 返回true表示新插入, false表示覆盖
+        bool insert_or_assign(const Key& key, const T& value)
+        {
+            bool inserted = false;
+            __write(key, [&](table_type* t, uint64_t h) {
+                return __insert(t, key, h, value, true, inserted);
+            });
+            return inserted;
+        }
+
+        // 在锁内对已有的value调用f(T&), 用于读-改-写; key不存在时返回false
+        template <class F>
+        bool update(const Key& key, F f)
+        {
+            bool found = false;
+            __write(key, [&](table_type* t, uint64_t h) {
+                return __update(t, key, h, f, found);
+            });
+            return found;
+        }
+
+        bool erase(const Key& key)
+        {
+            bool erased = false;
+            __write(key, [&](table_type* t, uint64_t h) {
+                return __erase(t, key, h, erased);
+            });
+            return erased;
+        }
+
+    private:
+        /*** 槽位的seqlock ***/
+
+        // 持有槽位的写者可能被抢占 (线程数多于核心数时), 自旋一段时间后让出CPU
+        static void __backoff(unsigned& spins) noexcept
+        {
+            if(++spins < 64) mySTL::cpu_relax();
+            else std::this_thread::yield();
+        }
+
+        // 写者持有槽位: 版本号从偶数CAS为奇数
+        static uint32_t __lock_slot(slot_type& s) noexcept
+        {
+            uint32_t v = s.seq.load(std::memory_order_relaxed);
+            unsigned spins = 0;
+            for(;;)
+            {
+                if(!(v & 1) && s.seq.compare_exchange_weak(v, v + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    std::atomic_thread_fence(std::memory_order_release); // 之后的写入不能早于奇数版本号
+                    return v + 1;
+                }
+                __backoff(spins);
+                v = s.seq.load(std::memory_order_relaxed);
+            }
+        }
+
+        static void __unlock_slot(slot_type& s, uint32_t locked) noexcept
+        {
+            s.seq.store(locked + 1, std::memory_order_release);
+        }
+
+        // 读取槽位状态和key的一致快照; 状态为full且key匹配时同时读出value
+        bool __snapshot(const slot_type& s, const Key& key, uint32_t& state, Key& k, T* value) const
+        {
+            unsigned spins = 0;
+            for(;;)
+            {
+                uint32_t v1 = s.seq.load(std::memory_order_acquire);
+                if(v1 & 1)
+                {
+                    __backoff(spins);
+                    continue;
+                }
+                state = s.state.load(std::memory_order_relaxed);
+                bool match = false;
+                if(state == __cmap_full || state == __cmap_moved)
+                {
+                    s.key.load(k);
+                    match = __equal()(k, key);
+                    if(match && value && state == __cmap_full) s.value.load(*value);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(s.seq.load(std::memory_order_relaxed) == v1) return match;
+            }
+        }
+
+    private:
+        /*** 查找 ***/
+
+        uint64_t __mix_hash(const Key& key) const {return __hash_mix(static_cast<uint64_t>(__hasher()(key)));}
+
+        // 依次查找当前表和扩容中的新表
+        bool __find(const Key& key, uint64_t h, T& out) const
+        {
+            for(const table_type* t = __current.load(std::memory_order_acquire); t;
+                t = t->next.load(std::memory_order_acquire))
+            {
+                for(size_t i = h & t->mask, probes = 0; probes <= t->mask; i = (i + 1) & t->mask, ++probes)
+                {
+                    uint32_t state;
+                    Key k;
+                    bool match = __snapshot(t->slots[i], key, state, k, &out);
+                    if(state == __cmap_empty || state == __cmap_sealed) break;  // 不在这张表中
+                    if(match)
+                    {
+                        if(state == __cmap_full) return true;
+                        break;  // moved: 在下一张表中
+                    }
+                }
+            }
+            return false;
+        }
+
+        // 在表t中找key所在的槽位, 没有时返回第一个可以插入的槽位 (墓碑或空槽)
+        // restart表示t已经开始迁移, 需要重新从链尾开始
+        __op_result __probe(table_type* t, const Key& key, uint64_t h, size_t& pos, bool& found, uint32_t& state) const
+        {
+            size_t insert_pos = size_t(-1);
+            uint32_t insert_state = __cmap_empty;
+            for(size_t i = h & t->mask, probes = 0; probes <= t->mask; i = (i + 1) & t->mask, ++probes)
+            {
+                Key k;
+                uint32_t st;
+                bool match = __snapshot(t->slots[i], key, st, k, nullptr);
+                if(st == __cmap_sealed || st == __cmap_moved) return __op_restart;
+                if(match)
+                {
+                    pos = i;
+                    found = true;
+                    state = st;
+                    return __op_done;
+                }
+                if(st == __cmap_deleted && insert_pos == size_t(-1))
+                {
+                    insert_pos = i;
+                    insert_state = st;
+                }
+                if(st == __cmap_empty)
+                {
+                    if(insert_pos == size_t(-1))
+                    {
+                        insert_pos = i;
+                        insert_state = st;
+                    }
+                    break;
+                }
+            }
+            found = false;
+            pos = insert_pos;
+            state = insert_state;
+            return __op_done;
+        }
+
+    private:
+        /*** 写操作, 调用时持有key所在的分段锁 ***/
+
+        __op_result __insert(table_type* t, const Key& key, uint64_t h, const T& value, bool assign, bool& inserted)
+        {
+            size_t pos;
+            bool found;
+            uint32_t state;
+            if(__probe(t, key, h, pos, found, state) == __op_restart) return __op_restart;
+            if(found)
+            {
+                inserted = false;
+                if(!assign) return __op_done;
+                slot_type& s = t->slots[pos];
+                uint32_t v = __lock_slot(s);
+                if(s.state.load(std::memory_order_relaxed) != __cmap_full)  // 被迁移了
+                {
+                    __unlock_slot(s, v);
+                    return __op_restart;
+                }
+                s.value.store(value);
+                __unlock_slot(s, v);
+                return __op_done;
+            }
+            if(pos == size_t(-1)) return __op_restart;  // 表满, 等扩容
+            slot_type& s = t->slots[pos];
+            uint32_t v = __lock_slot(s);
+            if(s.state.load(std::memory_order_relaxed) != state)  // 被其他key占用或者被迁移
+            {
+                __unlock_slot(s, v);
+                return __op_restart;
+            }
+            s.key.store(key);
+            s.value.store(value);
+            s.state.store(__cmap_full, std::memory_order_relaxed);
+            __unlock_slot(s, v);
+            if(state == __cmap_empty) t->used.fetch_add(1, std::memory_order_relaxed);
+            __size.fetch_add(1, std::memory_order_relaxed);
+            inserted = true;
+            return __op_done;
+        }
+
+        template <class F>
+        __op_result __update(table_type* t, const Key& key, uint64_t h, F& f, bool& found)
+        {
+            size_t pos;
+            uint32_t state;
+            if(__probe(t, key, h, pos, found, state) == __op_restart) return __op_restart;
+            if(!found) return __op_done;
+            slot_type& s = t->slots[pos];
+            uint32_t v = __lock_slot(s);
+            if(s.state.load(std::memory_order_relaxed) != __cmap_full)
+            {
+                __unlock_slot(s, v);
+                return __op_restart;
+            }
+            T value;
+            s.value.load(value);
+            f(value);
+            s.value.store(value);
+            __unlock_slot(s, v);
+            return __op_done;
+        }
+
+        __op_result __erase(table_type* t, const Key& key, uint64_t h, bool& erased)
+        {
+            size_t pos;
+            bool found;
+            uint32_t state;
+            if(__probe(t, key, h, pos, found, state) == __op_restart) return __op_restart;
+            if(!found) return __op_done;
+            slot_type& s = t->slots[pos];
+            uint32_t v = __lock_slot(s);
+            if(s.state.load(std::memory_order_relaxed) != __cmap_full)
+            {
+                __unlock_slot(s, v);
+                return __op_restart;
+            }
+            s.state.store(__cmap_deleted, std::memory_order_relaxed);
+            __unlock_slot(s, v);
+            __size.fetch_sub(1, std::memory_order_relaxed);
+            erased = true;
+            return __op_done;
+        }
+
+        /**
+         * @brief 写操作的公共流程
+         * 1. 不持有任何锁, 帮忙迁移一段旧表
+         * 2. 持有key的分段锁, 如果key还在旧表中, 先把它迁移到链尾的表, 再在链尾的表上执行op
+         * 3. op发现表已经开始迁移 (或者表满) 时返回restart, 从头再来
+         */
+        template <class Op>
+        void __write(const Key& key, Op op)
+        {
+            uint64_t h = __mix_hash(key);
+            epoch_guard guard(*__domain());
+            for(;;)
+            {
+                __help_migrate();
+                table_type* t;
+                __op_result res;
+                {
+                    std::lock_guard<std::mutex> lock(__stripes[(h >> 40) & __stripe_mask].m);
+                    t = __current.load(std::memory_order_acquire);
+                    while(table_type* n = t->next.load(std::memory_order_acquire))
+                    {
+                        __migrate_key(t, n, key, h);
+                        t = n;
+                    }
+                    res = op(t, h);
+                }
+                if(res == __op_done)
+                {
+                    __maybe_resize(t);
+                    return;
+                }
+                __maybe_resize(t);
+                mySTL::cpu_relax();
+            }
+        }
+
+    private:
+        /*** 扩容和迁移 ***/
+
+        static size_t __round_pow2(size_t n) noexcept
+        {
+            size_t p = 1;
+            while(p < n) p <<= 1;
+            return p;
+        }
+
+        static table_type* __new_table(size_t capacity)
+        {
+            table_type* t = table_allocator::allocate(1);
+            mySTL::construct(t);
+            t->mask = capacity - 1;
+            t->slots = slot_allocator::allocate(capacity);
+            for(size_t i = 0; i < capacity; i++)
+            {
+                slot_type* s = t->slots + i;
+                mySTL::construct(s);
+                s->seq.store(0, std::memory_order_relaxed);
+                s->state.store(__cmap_empty, std::memory_order_relaxed);
+            }
+            t->next.store(nullptr, std::memory_order_relaxed);
+            t->used.store(0, std::memory_order_relaxed);
+            t->cursor.store(0, std::memory_order_relaxed);
+            t->migrated.store(0, std::memory_order_relaxed);
+            return t;
+        }
+
+        static void __delete_table(table_type* t)
+        {
+            slot_allocator::deallocate(t->slots, t->capacity());
+            table_allocator::deallocate(t);
+        }
+
+        // 负载 (包括墓碑) 超过一半时开始扩容, 只有当前表且没有在迁移时才能开始, 所以链上最多两张表
+        void __maybe_resize(table_type* t)
+        {
+            if(t->used.load(std::memory_order_relaxed) * 2 <= t->capacity()) return;
+            std::lock_guard<std::mutex> lock(__resize_mutex);
+            if(__current.load(std::memory_order_acquire) != t || t->next.load(std::memory_order_acquire)) return;
+            // 墓碑较多时只重建, 不扩大
+            size_t capacity = size() * 4 > t->capacity() ? t->capacity() * 2 : t->capacity();
+            t->next.store(__new_table(capacity), std::memory_order_release);
+            // 释放本线程之前退休的、已经没有读者的旧表
+            __domain()->collect();
+        }
+
+        void __help_migrate()
+        {
+            table_type* t = __current.load(std::memory_order_acquire);
+            table_type* n = t->next.load(std::memory_order_acquire);
+            if(!n) return;
+            // 正常情况下迁移完成时新表负载不超过一半多一点, 这里只是防止大量并发插入把新表填满
+            while(n->used.load(std::memory_order_relaxed) * 4 > n->capacity() * 3 &&
+                  t->cursor.load(std::memory_order_relaxed) <= t->mask)
+                __migrate_chunk(t, n);
+            __migrate_chunk(t, n);
+        }
+
+        void __migrate_chunk(table_type* t, table_type* n)
+        {
+            size_t begin = t->cursor.fetch_add(migrate_chunk, std::memory_order_relaxed);
+            if(begin > t->mask) return;
+            size_t end = begin + migrate_chunk > t->capacity() ? t->capacity() : begin + migrate_chunk;
+            for(size_t i = begin; i < end; i++) __migrate_slot(t, n, i);
+            if(t->migrated.fetch_add(end - begin, std::memory_order_acq_rel) + (end - begin) == t->capacity())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(__resize_mutex);
+                    __current.store(n, std::memory_order_release);
+                }
+                // 读者和写者可能仍持有t, 等它们的epoch_guard都结束后再释放
+                __domain()->retire(t, [](void* p) {__delete_table(static_cast<table_type*>(p));});
+                __domain()->collect();
+            }
+        }
+
+        // 迁移旧表的一个槽位, 不持有任何锁时调用
+        void __migrate_slot(table_type* t, table_type* n, size_t i)
+        {
+            slot_type& s = t->slots[i];
+            for(;;)
+            {
+                uint32_t state = s.state.load(std::memory_order_acquire);
+                if(state == __cmap_sealed || state == __cmap_moved) return;
+                if(state != __cmap_full)
+                {
+                    uint32_t v = __lock_slot(s);
+                    uint32_t st = s.state.load(std::memory_order_relaxed);
+                    if(st == __cmap_empty || st == __cmap_deleted)
+                        s.state.store(st == __cmap_empty ? __cmap_sealed : __cmap_moved, std::memory_order_relaxed);
+                    __unlock_slot(s, v);
+                    if(st != __cmap_full) return;
+                    continue;
+                }
+                // 非空槽位: 先拿key的分段锁 (与写者的加锁顺序一致: 分段锁 -> 槽位)
+                Key key;
+                uint32_t v = __lock_slot(s);
+                bool full = s.state.load(std::memory_order_relaxed) == __cmap_full;
+                if(full) s.key.load(key);
+                __unlock_slot(s, v);
+                if(!full) continue;
+                uint64_t h = __mix_hash(key);
+                std::lock_guard<std::mutex> lock(__stripes[(h >> 40) & __stripe_mask].m);
+                __migrate_key(t, n, key, h);
+                if(s.state.load(std::memory_order_acquire) != __cmap_full) return;
+                // key在拿锁之前被删除, 槽位又被其他key占用, 重新处理
+            }
+        }
+
+        // 持有key的分段锁, 把key从t迁移到n
+        void __migrate_key(table_type* t, table_type* n, const Key& key, uint64_t h)
+        {
+            for(size_t i = h & t->mask, probes = 0; probes <= t->mask; i = (i + 1) & t->mask, ++probes)
+            {
+                slot_type& s = t->slots[i];
+                Key k;
+                uint32_t st;
+                bool match = __snapshot(s, key, st, k, nullptr);
+                if(st == __cmap_empty || st == __cmap_sealed) return;
+                if(!match) continue;
+                if(st != __cmap_full) return;
+                uint32_t v = __lock_slot(s);
+                if(s.state.load(std::memory_order_relaxed) == __cmap_full)
+                {
+                    T value;
+                    s.value.load(value);
+                    __insert_migrated(n, key, h, value);
+                    s.state.store(__cmap_moved, std::memory_order_relaxed);
+                }
+                __unlock_slot(s, v);
+                return;
+            }
+        }
+
+        // 新表在迁移完成之前不会开始扩容, 而且key在新表中一定不存在, 直接占用第一个空槽位或墓碑
+        void __insert_migrated(table_type* n, const Key& key, uint64_t h, const T& value)
+        {
+            for(size_t i = h & n->mask;; i = (i + 1) & n->mask)
+            {
+                slot_type& s = n->slots[i];
+                uint32_t st = s.state.load(std::memory_order_acquire);
+                if(st != __cmap_empty && st != __cmap_deleted) continue;
+                uint32_t v = __lock_slot(s);
+                st = s.state.load(std::memory_order_relaxed);
+                if(st == __cmap_empty || st == __cmap_deleted)
+                {
+                    s.key.store(key);
+                    s.value.store(value);
+                    s.state.store(__cmap_full, std::memory_order_relaxed);
+                    __unlock_slot(s, v);
+                    if(st == __cmap_empty) n->used.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                __unlock_slot(s, v);
+            }
+        }
+    };
+}
+#endif // __CONCURRENT_UNORDERED_MAP_H__
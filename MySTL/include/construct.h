@@ -4,9 +4,11 @@
 // 包含两个函数 construct, destroy
 // construct    -> 对象的构造
 // destroy      -> 对象的构析
+// 以及在未初始化内存上批量构造的 uninitialized_copy / uninitialized_fill_n
 
 #include <new>
-#include <type_traits>
+#include <cstring>
+#include "type_traits.h"
 #include "utils.h"
 #include "iterator.h"
 
@@ -33,37 +35,105 @@ namespace mySTL
 
     // destroy object
     template <class T>
-    inline void __destroy_one(T* ptr, std::false_type)
+    inline void destroy(T* ptr);
+
+    template <class T>
+    inline void __destroy_one(T* ptr, mySTL::false_type)
     {
         if(ptr) ptr->~T();  // 调用析构函数
     }
 
     template <class T>
-    inline void __destroy_one(T, std::true_type) {}
+    inline void __destroy_one(T, mySTL::true_type) {}
 
     template <class ForwardIter>
-    inline void __destroy_byIters(ForwardIter, ForwardIter, std::true_type) {}
+    inline void __destroy_byIters(ForwardIter, ForwardIter, mySTL::true_type) {}
 
     template <class ForwardIter>
-    inline void __destroy_byIters(ForwardIter first, ForwardIter last, std::false_type)
+    inline void __destroy_byIters(ForwardIter first, ForwardIter last, mySTL::false_type)
     {
         for(;first!=last;++first)
-            destroy(&*first);
+            mySTL::destroy(&*first);
     }
 
     // 自动判断类型是否有析构函数， 如果有就调用
     template <class T>
     inline void destroy(T* ptr)
     {
-        __destroy_one(ptr, std::is_trivially_destructible<T>()); // 没办法还是用了标准库type traits,
-        // 元编程实在太难了， 以后学会了再自己实现
+        __destroy_one(ptr, mySTL::is_trivially_destructible<T>());
     }
 
     template <class ForwardIter>
     inline void destroy(ForwardIter first, ForwardIter last)
     {
         __destroy_byIters(first, last, 
-            std::is_trivially_destructible<typename mySTL::iterator_traits<ForwardIter>::value_type>());
+            mySTL::is_trivially_destructible<typename mySTL::iterator_traits<ForwardIter>::value_type>());
+    }
+
+    // 两个指针之间是否可以直接memmove
+    template <class In, class Out>
+    struct __is_memmovable : public mySTL::false_type {};
+
+    template <class T>
+    struct __is_memmovable<T*, T*> : public mySTL::is_trivially_copyable<T> {};
+
+    template <class T>
+    struct __is_memmovable<const T*, T*> : public mySTL::is_trivially_copyable<T> {};
+
+    template <class T>
+    inline T* __uninitialized_copy_aux(const T* first, const T* last, T* result, mySTL::true_type)
+    {
+        const size_t n = static_cast<size_t>(last - first);
+        if(n) std::memmove(result, first, n * sizeof(T));
+        return result + n;
+    }
+
+    template <class InputIter, class ForwardIter>
+    inline ForwardIter __uninitialized_copy_aux(InputIter first, InputIter last, ForwardIter result, mySTL::false_type)
+    {
+        ForwardIter curr = result;
+        try
+        {
+            for(;first!=last;++first,++curr)
+                mySTL::construct(&*curr, *first);
+        }
+        catch(...)
+        {
+            mySTL::destroy(result, curr);
+            throw;
+        }
+        return curr;
+    }
+
+    // 把[first, last)拷贝构造到result开始的未初始化内存
+    // 连续迭代器先退化为原生指针, 平凡可拷贝类型直接memmove
+    template <class InputIter, class ForwardIter>
+    inline ForwardIter uninitialized_copy(InputIter first, InputIter last, ForwardIter result)
+    {
+        auto ufirst  = mySTL::__unwrap_iter(first);
+        auto ulast   = mySTL::__unwrap_iter(last);
+        auto uresult = mySTL::__unwrap_iter(result);
+        typedef __is_memmovable<decltype(ufirst), decltype(uresult)> memmovable;
+        return mySTL::__rewrap_iter(result, __uninitialized_copy_aux(ufirst, ulast, uresult, 
+            mySTL::integral_constant<bool, memmovable::value>()));
+    }
+
+    // 在first开始的未初始化内存上构造n个value
+    template <class ForwardIter, class Size, class T>
+    inline ForwardIter uninitialized_fill_n(ForwardIter first, Size n, const T& value)
+    {
+        ForwardIter curr = first;
+        try
+        {
+            for(;n>0;--n,++curr)
+                mySTL::construct(&*curr, value);
+        }
+        catch(...)
+        {
+            mySTL::destroy(first, curr);
+            throw;
+        }
+        return curr;
     }
 
 }
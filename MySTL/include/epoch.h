@@ -0,0 +1,309 @@
+#ifndef __EPOCH_H__
+#define __EPOCH_H__
+
+// 基于epoch的内存回收 (EBR), 供无锁容器使用
+// 线程访问共享结构前用epoch_guard进入当前epoch, 摘除的节点用retire延迟释放
+// 全局epoch只有在所有活跃线程都已经进入当前epoch时才能前进, 在epoch e退休的对象在全局epoch到达e+2后释放,
+// 此时不可能还有线程持有它的指针
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include "allocator.h"
+#include "construct.h"
+
+namespace mySTL
+{
+    class epoch_domain;
+
+    /**
+     * @brief epoch_guard
+     * 构造时进入epoch, 析构时离开; 同一线程可以嵌套, 最外层离开时才真正离开
+     * 可以拷贝 (拷贝也持有epoch), 但不能跨线程使用
+     */
+    class epoch_guard
+    {
+    private:
+        epoch_domain* __domain;
+        void*         __record;
+
+    public:
+        epoch_guard() noexcept : __domain(nullptr), __record(nullptr) {}
+        explicit epoch_guard(epoch_domain& domain);
+        epoch_guard(const epoch_guard& other);
+        epoch_guard(epoch_guard&& other) noexcept : __domain(other.__domain), __record(other.__record)
+        {
+            other.__domain = nullptr;
+            other.__record = nullptr;
+        }
+        epoch_guard& operator=(epoch_guard other) noexcept
+        {
+            epoch_domain* d = __domain;
+            void* r = __record;
+            __domain = other.__domain;
+            __record = other.__record;
+            other.__domain = d;
+            other.__record = r;
+            return *this;
+        }
+        ~epoch_guard();
+    };
+
+    /**
+     * @brief epoch_domain
+     * 一组共享同一个全局epoch的数据结构, 一般直接用global()
+     * 每个线程第一次使用时分配一条线程记录, 线程退出后记录 (以及其中未释放的对象) 留给之后的线程复用
+     * 自己创建的domain必须比所有使用过它的线程活得久
+     */
+    class epoch_domain
+    {
+        friend class epoch_guard;
+
+    private:
+        struct __retired
+        {
+            void*       ptr;
+            void        (*deleter)(void*);
+            __retired*  next;
+        };
+
+        static constexpr size_t __bucket_num = 3;
+
+        struct alignas(64) __record
+        {
+            std::atomic<uint64_t>       epoch;      // 0: 不活跃; 否则为 (进入时的epoch << 1) | 1
+            std::atomic<bool>           in_use;
+            std::atomic<std::thread::id> owner;
+            __record*                   next;       // 只增不减的记录链表
+            unsigned                    nest;       // 嵌套层数, 只有拥有者线程访问
+            __retired*                  buckets[__bucket_num];
+            uint64_t                    bucket_epoch[__bucket_num];
+            size_t                      retired_count;
+        };
+
+        typedef mySTL::allocator<__record>  record_allocator;
+        typedef mySTL::allocator<__retired> retired_allocator;
+
+        // 每个线程缓存最近使用的几个 (domain, record)
+        struct __thread_cache
+        {
+            static constexpr size_t size = 4;
+
+            epoch_domain* domains[size] = {};
+            __record*     records[size] = {};
+            size_t        victim = 0;
+
+            ~__thread_cache()
+            {
+                for(size_t i = 0; i < size; i++)
+                    if(domains[i]) domains[i]->__release(records[i]);
+            }
+        };
+
+        std::atomic<uint64_t>   __epoch;
+        std::atomic<__record*>  __records;
+
+    public:
+        // 每退休这么多个对象尝试推进一次epoch
+        static constexpr size_t collect_threshold = 64;
+
+        epoch_domain() : __epoch(1), __records(nullptr) {}
+        epoch_domain(const epoch_domain&) = delete;
+        epoch_domain& operator=(const epoch_domain&) = delete;
+
+        ~epoch_domain()
+        {
+            __thread_cache& cache = __cache();
+            for(size_t i = 0; i < __thread_cache::size; i++)
+                if(cache.domains[i] == this) cache.domains[i] = nullptr;
+            __record* r = __records.load(std::memory_order_acquire);
+            while(r)
+            {
+                __record* next = r->next;
+                for(size_t b = 0; b < __bucket_num; b++) __free_list(r->buckets[b]);
+                mySTL::destroy(r);
+                record_allocator::deallocate(r);
+                r = next;
+            }
+        }
+
+        static epoch_domain& global()
+        {
+            static epoch_domain domain;
+            return domain;
+        }
+
+        uint64_t epoch() const noexcept {return __epoch.load(std::memory_order_acquire);}
+
+        /**
+         * @brief 延迟释放p, 调用者必须已经把p从共享结构中摘除
+         * 可以在epoch_guard内外调用
+         */
+        void retire(void* p, void (*deleter)(void*))
+        {
+            __record* r = __local();
+            uint64_t e = __epoch.load(std::memory_order_acquire);
+            size_t b = e % __bucket_num;
+            if(r->bucket_epoch[b] != e)
+            {
+                // 这个桶里是e-3或更早退休的对象, 已经可以释放
+                r->retired_count -= __free_list(r->buckets[b]);
+                r->bucket_epoch[b] = e;
+            }
+            __retired* item = retired_allocator::allocate();
+            item->ptr = p;
+            item->deleter = deleter;
+            item->next = r->buckets[b];
+            r->buckets[b] = item;
+            if(++r->retired_count >= collect_threshold) __collect(r);
+        }
+
+        template <class T>
+        void retire(T* p)
+        {
+            retire(p, [](void* q) {delete static_cast<T*>(q);});
+        }
+
+        // 尝试推进epoch并释放本线程可以释放的对象
+        void collect() {__collect(__local());}
+
+        // 本线程还没释放的对象个数
+        size_t pending() {return __local()->retired_count;}
+
+    private:
+        static __thread_cache& __cache()
+        {
+            static thread_local __thread_cache cache;
+            return cache;
+        }
+
+        __record* __local()
+        {
+            __thread_cache& cache = __cache();
+            for(size_t i = 0; i < __thread_cache::size; i++)
+                if(cache.domains[i] == this) return cache.records[i];
+            __record* r = __acquire();
+            size_t i = cache.victim++ % __thread_cache::size;
+            if(cache.domains[i]) cache.domains[i]->__release(cache.records[i]);
+            cache.domains[i] = this;
+            cache.records[i] = r;
+            return r;
+        }
+
+        // 本线程已有的记录 (被挤出缓存的), 空闲的记录, 或者新分配一条
+        __record* __acquire()
+        {
+            std::thread::id self = std::this_thread::get_id();
+            for(__record* r = __records.load(std::memory_order_acquire); r; r = r->next)
+                if(r->in_use.load(std::memory_order_acquire) && r->owner.load(std::memory_order_relaxed) == self)
+                    return r;
+            for(__record* r = __records.load(std::memory_order_acquire); r; r = r->next)
+            {
+                bool expected = false;
+                if(!r->in_use.load(std::memory_order_relaxed) &&
+                   r->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                {
+                    r->owner.store(self, std::memory_order_relaxed);
+                    return r;
+                }
+            }
+            __record* r = record_allocator::allocate();
+            mySTL::construct(r);
+            r->epoch.store(0, std::memory_order_relaxed);
+            r->in_use.store(true, std::memory_order_relaxed);
+            r->owner.store(self, std::memory_order_relaxed);
+            r->nest = 0;
+            for(size_t b = 0; b < __bucket_num; b++)
+            {
+                r->buckets[b] = nullptr;
+                r->bucket_epoch[b] = 0;
+            }
+            r->retired_count = 0;
+            __record* head = __records.load(std::memory_order_relaxed);
+            do r->next = head;
+            while(!__records.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+            return r;
+        }
+
+        // 线程不再使用这条记录 (线程退出或者被挤出缓存), 已退休的对象留在记录中
+        void __release(__record* r) noexcept
+        {
+            if(r->nest) return;  // 仍在epoch_guard中, 之后通过__acquire找回
+            r->owner.store(std::thread::id(), std::memory_order_relaxed);
+            r->in_use.store(false, std::memory_order_release);
+        }
+
+        void __enter(__record* r)
+        {
+            if(r->nest++) return;
+            uint64_t e = __epoch.load(std::memory_order_relaxed);
+            r->epoch.store((e << 1) | 1, std::memory_order_relaxed);
+            // 之后对共享结构的读取不能早于公开epoch, 否则推进epoch的线程看不到本线程
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        void __leave(__record* r) noexcept
+        {
+            if(--r->nest) return;
+            r->epoch.store(0, std::memory_order_release);
+        }
+
+        // 所有活跃线程都在当前epoch时推进一步
+        bool __try_advance()
+        {
+            uint64_t e = __epoch.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for(__record* r = __records.load(std::memory_order_acquire); r; r = r->next)
+            {
+                uint64_t local = r->epoch.load(std::memory_order_acquire);
+                if((local & 1) && (local >> 1) != e) return false;
+            }
+            return __epoch.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+        }
+
+        void __collect(__record* r)
+        {
+            __try_advance();
+            uint64_t e = __epoch.load(std::memory_order_acquire);
+            for(size_t b = 0; b < __bucket_num; b++)
+            {
+                if(r->buckets[b] && r->bucket_epoch[b] + 2 <= e)
+                {
+                    r->retired_count -= __free_list(r->buckets[b]);
+                    r->buckets[b] = nullptr;
+                }
+            }
+        }
+
+        static size_t __free_list(__retired*& head)
+        {
+            size_t n = 0;
+            while(head)
+            {
+                __retired* next = head->next;
+                head->deleter(head->ptr);
+                retired_allocator::deallocate(head);
+                head = next;
+                ++n;
+            }
+            return n;
+        }
+    };
+
+    inline epoch_guard::epoch_guard(epoch_domain& domain) : __domain(&domain), __record(domain.__local())
+    {
+        __domain->__enter(static_cast<epoch_domain::__record*>(__record));
+    }
+
+    inline epoch_guard::epoch_guard(const epoch_guard& other) : __domain(other.__domain), __record(other.__record)
+    {
+        if(__domain) __domain->__enter(static_cast<epoch_domain::__record*>(__record));
+    }
+
+    inline epoch_guard::~epoch_guard()
+    {
+        if(__domain) __domain->__leave(static_cast<epoch_domain::__record*>(__record));
+    }
+}
+#endif // __EPOCH_H__
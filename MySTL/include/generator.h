@@ -0,0 +1,151 @@
+#ifndef __GENERATOR_H__
+#define __GENERATOR_H__
+
+// 基于C++20协程的generator, 需要 -std=c++20
+// 惰性地逐个产生元素, 迭代器是mySTL的输入迭代器, 可以直接用于range-for和ranges.h中的视图
+
+#if !defined(__cpp_impl_coroutine)
+#error "generator.h requires C++20 coroutines (-std=c++20)"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include "type_traits.h"
+#include "utils.h"
+#include "iterator.h"
+
+namespace mySTL
+{
+    /**
+     * @brief generator
+     * 协程体中用 co_yield 产生元素; 只能移动, 只能遍历一次
+     * co_yield 非const左值或右值时不拷贝, 迭代器直接引用协程中的对象, 下一次++之前有效
+     * 协程体中抛出的异常在begin()或++时重新抛出
+     * @tparam T 元素类型
+     */
+    template <class T>
+    class generator
+    {
+    public:
+        typedef T   value_type;
+        typedef T&  reference;
+
+        struct promise_type
+        {
+            T*                  __value = nullptr;
+            std::optional<T>    __copy;       // co_yield const左值时保存一份拷贝
+            std::exception_ptr  __exception;
+
+            generator get_return_object() noexcept
+            {
+                return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept {return {};}
+            std::suspend_always final_suspend()   noexcept {return {};}
+
+            std::suspend_always yield_value(T& value) noexcept
+            {
+                __value = &value;
+                return {};
+            }
+
+            // 临时对象在co_yield所在的完整表达式结束前一直有效, 包括挂起期间
+            std::suspend_always yield_value(T&& value) noexcept
+            {
+                __value = &value;
+                return {};
+            }
+
+            template <class U = T, class = typename enable_if<!mySTL::is_same<const U&, U&>::value>::type>
+            std::suspend_always yield_value(const U& value)
+            {
+                __copy.emplace(value);
+                __value = &*__copy;
+                return {};
+            }
+
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept {__exception = std::current_exception();}
+
+            // 禁止在generator中co_await
+            template <class U>
+            std::suspend_never await_transform(U&&) = delete;
+        };
+
+        typedef std::coroutine_handle<promise_type> handle_type;
+
+        class iterator
+        {
+        public:
+            typedef input_iterator_tag  iterator_category;
+            typedef T                   value_type;
+            typedef T*                  pointer;
+            typedef T&                  reference;
+            typedef ptrdiff_t           difference_type;
+
+        private:
+            handle_type __h;  // 空表示结束
+
+        public:
+            iterator() noexcept : __h(nullptr) {}
+            explicit iterator(handle_type h) noexcept : __h(h) {}
+
+            reference operator*()  const noexcept {return *__h.promise().__value;}
+            pointer   operator->() const noexcept {return __h.promise().__value;}
+
+            iterator& operator++()
+            {
+                __resume(__h);
+                if(__h.done()) __h = nullptr;
+                return *this;
+            }
+            void operator++(int) {++*this;}
+
+            friend bool operator==(const iterator& a, const iterator& b) noexcept {return a.__h == b.__h;}
+            friend bool operator!=(const iterator& a, const iterator& b) noexcept {return a.__h != b.__h;}
+        };
+
+    private:
+        handle_type __h;
+
+        explicit generator(handle_type h) noexcept : __h(h) {}
+
+    public:
+        generator() noexcept : __h(nullptr) {}
+        generator(generator&& other) noexcept : __h(other.__h) {other.__h = nullptr;}
+        generator& operator=(generator&& other) noexcept
+        {
+            if(this != &other)
+            {
+                if(__h) __h.destroy();
+                __h = other.__h;
+                other.__h = nullptr;
+            }
+            return *this;
+        }
+        generator(const generator&) = delete;
+        generator& operator=(const generator&) = delete;
+
+        // 协程没有运行完时销毁协程帧, 其中的局部变量正常析构
+        ~generator() {if(__h) __h.destroy();}
+
+        // 运行到第一个co_yield, 只能调用一次
+        iterator begin()
+        {
+            if(!__h) return iterator();
+            __resume(__h);
+            return __h.done() ? iterator() : iterator(__h);
+        }
+        iterator end() noexcept {return iterator();}
+
+    private:
+        static void __resume(handle_type h)
+        {
+            h.resume();
+            if(h.promise().__exception) std::rethrow_exception(mySTL::move(h.promise().__exception));
+        }
+    };
+}
+#endif // __GENERATOR_H__
@@ -0,0 +1,203 @@
+#ifndef __HUGE_PAGE_RESOURCE_H__
+#define __HUGE_PAGE_RESOURCE_H__
+
+// 大页内存 (Linux), 用于减少大容器随机访问时的TLB miss
+// 先尝试MAP_HUGETLB显式大页 (需要系统预留 vm.nr_hugepages), 失败则映射2MB对齐的普通内存
+// 并用madvise(MADV_HUGEPAGE)请求透明大页, 都不可用时就是普通页, 只影响性能不影响正确性
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <atomic>
+#include <sys/mman.h>
+#include "allocator.h"
+#include "utils.h"
+
+namespace mySTL
+{
+    static constexpr size_t huge_page_size = size_t(2) << 20; // 2MB
+
+    constexpr size_t __huge_page_round(size_t bytes)
+    {
+        return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+
+    /**
+     * @brief huge_page_resource
+     * 以2MB为单位直接向内核申请内存, 适合大块分配
+     * 统计每种方式成功的次数, 便于确认实际是否用上了大页
+     */
+    class huge_page_resource
+    {
+    public:
+        struct stats
+        {
+            std::atomic<size_t> hugetlb;     // MAP_HUGETLB成功的次数
+            std::atomic<size_t> transparent; // 退化为对齐映射 + MADV_HUGEPAGE 的次数
+        };
+
+        static stats& get_stats()
+        {
+            static stats s{{0}, {0}};
+            return s;
+        }
+
+        // 分配至少bytes字节, 起始地址2MB对齐, 失败抛出bad_alloc
+        static void* allocate(size_t bytes)
+        {
+            if(bytes == 0) return nullptr;
+            size_t len = __huge_page_round(bytes);
+#if defined(MAP_HUGETLB)
+            void* p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if(p != MAP_FAILED)
+            {
+                get_stats().hugetlb.fetch_add(1, std::memory_order_relaxed);
+                return p;
+            }
+#endif
+            // 多映射2MB, 再把首尾不对齐的部分还给内核
+            size_t raw_len = len + huge_page_size;
+            void* raw = ::mmap(nullptr, raw_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(raw == MAP_FAILED) throw std::bad_alloc();
+            uintptr_t begin   = reinterpret_cast<uintptr_t>(raw);
+            uintptr_t aligned = (begin + huge_page_size - 1) & ~(uintptr_t(huge_page_size) - 1);
+            if(aligned > begin) ::munmap(raw, aligned - begin);
+            size_t tail = (begin + raw_len) - (aligned + len);
+            if(tail) ::munmap(reinterpret_cast<void*>(aligned + len), tail);
+            void* res = reinterpret_cast<void*>(aligned);
+#if defined(MADV_HUGEPAGE)
+            ::madvise(res, len, MADV_HUGEPAGE);
+#endif
+            get_stats().transparent.fetch_add(1, std::memory_order_relaxed);
+            return res;
+        }
+
+        // bytes必须与allocate时相同
+        static void deallocate(void* ptr, size_t bytes) noexcept
+        {
+            if(!ptr) return;
+            ::munmap(ptr, __huge_page_round(bytes));
+        }
+    };
+
+    /**
+     * @brief huge_page_allocator
+     * 与allocator.h中的allocator接口相同 (静态方法), 可以直接替换
+     * 不小于一个大页一半的分配走huge_page_resource, 更小的分配仍然走operator new,
+     * 所以deallocate必须传入与allocate相同的n; 不带n的版本只用于单个对象
+     * @tparam T
+     */
+    template <class T>
+    class huge_page_allocator
+    {
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef const T*    const_pointer;
+        typedef T&          referece;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        static constexpr size_type huge_threshold = huge_page_size / 2;
+
+    public:
+        static pointer allocate() {return allocate(1);}
+
+        static pointer allocate(size_type n)
+        {
+            if(n == 0) return nullptr;
+            size_type bytes = n * sizeof(T);
+            __MYSTL_TRACK_ALLOCATE(T, bytes);
+            if(bytes >= huge_threshold)
+                return static_cast<pointer>(huge_page_resource::allocate(bytes));
+            return static_cast<pointer>(::operator new(bytes));
+        }
+
+        static void deallocate(pointer ptr) {deallocate(ptr, 1);}
+
+        static void deallocate(pointer ptr, size_type n)
+        {
+            if(!ptr) return;
+            size_type bytes = n * sizeof(T);
+            __MYSTL_TRACK_DEALLOCATE(T, bytes);
+            if(bytes >= huge_threshold)
+                huge_page_resource::deallocate(ptr, bytes);
+            else
+                ::operator delete(ptr);
+        }
+    };
+
+    /**
+     * @brief huge_page_arena
+     * 从2MB对齐的大页区域中顺序分配 (bump pointer), 单个对象不能释放, 析构或release时整体归还
+     * 适合一次性建好之后只读的大量小对象 (例如哈希表节点)
+     */
+    class huge_page_arena
+    {
+    private:
+        struct region
+        {
+            region* next;
+            size_t  size;  // 整个区域的字节数, 包括这个头部
+        };
+
+        region* __regions;
+        char*   __curr;
+        char*   __end;
+        size_t  __region_size;
+
+    public:
+        explicit huge_page_arena(size_t region_size = huge_page_size)
+            : __regions(nullptr), __curr(nullptr), __end(nullptr),
+              __region_size(__huge_page_round(region_size)) {}
+
+        huge_page_arena(const huge_page_arena&) = delete;
+        huge_page_arena& operator=(const huge_page_arena&) = delete;
+
+        ~huge_page_arena() {release();}
+
+        // align必须是2的幂
+        void* allocate(size_t bytes, size_t align = alignof(std::max_align_t))
+        {
+            uintptr_t p = (reinterpret_cast<uintptr_t>(__curr) + align - 1) & ~(uintptr_t(align) - 1);
+            if(!__curr || p + bytes > reinterpret_cast<uintptr_t>(__end))
+            {
+                __new_region(bytes + align);
+                p = (reinterpret_cast<uintptr_t>(__curr) + align - 1) & ~(uintptr_t(align) - 1);
+            }
+            __curr = reinterpret_cast<char*>(p + bytes);
+            return reinterpret_cast<void*>(p);
+        }
+
+        template <class T>
+        T* allocate_array(size_t n) {return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));}
+
+        // 归还所有区域
+        void release() noexcept
+        {
+            while(__regions)
+            {
+                region* next = __regions->next;
+                huge_page_resource::deallocate(__regions, __regions->size);
+                __regions = next;
+            }
+            __curr = __end = nullptr;
+        }
+
+    private:
+        void __new_region(size_t min_bytes)
+        {
+            size_t size = __huge_page_round(sizeof(region) + min_bytes);
+            if(size < __region_size) size = __region_size;
+            region* r = static_cast<region*>(huge_page_resource::allocate(size));
+            r->next = __regions;
+            r->size = size;
+            __regions = r;
+            __curr = reinterpret_cast<char*>(r + 1);
+            __end = reinterpret_cast<char*>(r) + size;
+        }
+    };
+}
+#endif // __HUGE_PAGE_RESOURCE_H__
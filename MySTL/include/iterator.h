@@ -3,11 +3,12 @@
 
 
 #include <cstddef>
+#include <iterator>
 
 namespace mySTL
 {
     /**
-     * @brief 5种不同的迭代器类型
+     * @brief 6种不同的迭代器类型
      * 空struct只用于编译器期间区别不同的迭代器类型
      */
     struct input_iterator_tag {};
@@ -15,6 +16,7 @@ namespace mySTL
     struct forward_iterator_tag: public input_iterator_tag {}; // 输入iter的超集
     struct bidirectional_iterator_tag: public forward_iterator_tag {}; // 单向iter的超集
     struct random_access_iterator_tag: public bidirectional_iterator_tag {}; // 双向iter的超集
+    struct contiguous_iterator_tag: public random_access_iterator_tag {}; // 元素在内存中连续, 可以退化为原生指针
 
     // iterator的5种标准属性， 定义iterator的时候继承这个类
     template <class Category, class T, class Distance = ptrdiff_t,
@@ -28,23 +30,42 @@ namespace mySTL
         typedef Distance  difference_type;
     };
 
+    // 把标准库迭代器的tag映射到mySTL的tag, 使标准库容器的迭代器也能参与tag分发
+    template <class Category>
+    struct __mystl_category {typedef Category type;};
+
+    template <>
+    struct __mystl_category<std::input_iterator_tag> {typedef input_iterator_tag type;};
+
+    template <>
+    struct __mystl_category<std::output_iterator_tag> {typedef output_iterator_tag type;};
+
+    template <>
+    struct __mystl_category<std::forward_iterator_tag> {typedef forward_iterator_tag type;};
+
+    template <>
+    struct __mystl_category<std::bidirectional_iterator_tag> {typedef bidirectional_iterator_tag type;};
+
+    template <>
+    struct __mystl_category<std::random_access_iterator_tag> {typedef random_access_iterator_tag type;};
+
     // iterator traits, 用于编译器提取对应的iterator类型 （class或者原生指针）
     // iterator traits for class
     template <class Iterator>
     struct iterator_traits
     {
-        typedef typename Iterator::iterator_category iterator_category;
+        typedef typename __mystl_category<typename Iterator::iterator_category>::type iterator_category;
         typedef typename Iterator::value_type        value_type;
-        typedef typename Iterator::Pointer           pointer;
-        typedef typename Iterator::Reference         reference;
-        typedef typename Iterator::Distance          difference_type;
+        typedef typename Iterator::pointer           pointer;
+        typedef typename Iterator::reference         reference;
+        typedef typename Iterator::difference_type   difference_type;
     };
 
     // iterator traits for raw pointer
     template <class T>
     struct iterator_traits<T*>
     {
-        typedef random_access_iterator_tag  iterator_category;
+        typedef contiguous_iterator_tag     iterator_category;
         typedef T                           value_type;
         typedef T*                          pointer;
         typedef T&                          reference;
@@ -55,7 +76,7 @@ namespace mySTL
     template <class T>
     struct iterator_traits<const T*>
     {
-        typedef random_access_iterator_tag  iterator_category;
+        typedef contiguous_iterator_tag     iterator_category;
         typedef T                           value_type;
         typedef const T*                    pointer;
         typedef const T&                    reference;
@@ -72,6 +93,43 @@ namespace mySTL
         return Category(); // 临时对象
     }
 
+    /**
+     * @brief to_address / unwrap: 把连续迭代器退化为原生指针
+     * 类迭代器只要把iterator_category定义为contiguous_iterator_tag, 并且operator->直接返回内部指针
+     * (不解引用, 对end()也合法), 批量算法就可以用__unwrap_iter拿到指针走memcpy/memmove路径,
+     * 最后用__rewrap_iter把结果指针换回原来的迭代器类型
+     */
+    template <class T>
+    constexpr T* to_address(T* ptr) noexcept {return ptr;}
+
+    template <class Iterator>
+    constexpr auto to_address(const Iterator& iter) noexcept -> decltype(iter.operator->())
+    {return iter.operator->();}
+
+    template <class Iterator>
+    inline Iterator __unwrap_iter_aux(Iterator iter, input_iterator_tag) {return iter;}
+
+    template <class Iterator>
+    inline typename iterator_traits<Iterator>::pointer
+    __unwrap_iter_aux(Iterator iter, contiguous_iterator_tag) {return mySTL::to_address(iter);}
+
+    // 连续迭代器 -> 原生指针, 其他迭代器原样返回
+    template <class Iterator>
+    inline auto __unwrap_iter(Iterator iter) -> decltype(__unwrap_iter_aux(iter, iterator_category(iter)))
+    {return __unwrap_iter_aux(iter, iterator_category(iter));}
+
+    template <class Iterator, class Unwrapped>
+    inline Iterator __rewrap_iter_aux(Iterator, Unwrapped res, input_iterator_tag) {return res;}
+
+    template <class Iterator, class Unwrapped>
+    inline Iterator __rewrap_iter_aux(Iterator orig, Unwrapped res, contiguous_iterator_tag)
+    {return orig + (res - mySTL::to_address(orig));}
+
+    // 把__unwrap_iter之后得到的结果换回原迭代器类型, orig为unwrap之前的迭代器
+    template <class Iterator, class Unwrapped>
+    inline Iterator __rewrap_iter(Iterator orig, Unwrapped res)
+    {return __rewrap_iter_aux(orig, res, iterator_category(orig));}
+
 
     // 下面实现distance函数： 计算两个迭代器之前元素个数
     // 注意在函数中无法使用偏特化， 所以需要其他方式（形参）
@@ -6,6 +6,8 @@
 #include <cassert>
 #include <initializer_list>
 #include "allocator.h"
+#include "pair.h"
+#include "type_traits.h"
 #include "utils.h"
 #include "iterator.h"
 #include "construct.h"
@@ -23,6 +25,24 @@ namespace mySTL
         void unlink() { prev = next = this;}
     };
 
+    // 一次分配的一块连续节点 (slab), 批量构造时使用
+    // 节点本身不记录所属slab: 释放总是成批进行 (shrink_to_fit/relayout/析构), 由release_chain扫描slab统一计数
+    // slab中未释放的节点prev总是非空 (使用中的节点已链接, spare cache中的指向自身), 已释放的节点prev指向所属slab
+    template <class T>
+    struct __list_slab
+    {
+        __list_slab*    next;     // list持有的下一个slab
+        __list_node<T>* nodes;    // 连续的capacity个节点
+        size_t          capacity;
+        size_t          live;     // 仍在使用中的节点数, 为0时释放整个slab
+    };
+
+    // 元素个数不少于该值时才走slab路径, 避免为很短的插入创建slab
+    static constexpr size_t __list_slab_min_nodes = 8;
+
+    // for_each预取的距离 (节点个数)
+    static constexpr size_t __list_prefetch_distance = 4;
+
     // list iterator
     template <class T>
     struct __list_iterator: public mySTL::iterator<mySTL::bidirectional_iterator_tag, T>
@@ -40,7 +60,6 @@ namespace mySTL
         // 构造函数
         __list_iterator(link_type node) : node(node) {}
         __list_iterator() {}
-        __list_iterator(const self& other):node(other.node) {}
 
         // 逻辑判断重载
         bool operator==(const self& other) const {return node==other.node;}
@@ -105,6 +124,8 @@ namespace mySTL
         typedef list_node*                                  link_type;
         typedef mySTL::allocator<T>                         data_allocator;
         typedef mySTL::allocator<list_node>                 node_allocator;
+        typedef __list_slab<T>                              slab_type;
+        typedef mySTL::allocator<slab_type>                 slab_allocator;
 
         typedef typename data_allocator::value_type         value_type;
         typedef typename data_allocator::pointer            pointer;
@@ -117,8 +138,12 @@ namespace mySTL
         typedef __list_iterator<T>                          iterator;
             
     private:
-        link_type __node; // 虚拟节点, 对应end()
-        size_type __size; // size of the list
+        link_type  __node;       // 虚拟节点, 对应end()
+        size_type  __size;       // size of the list
+        // node allocator + 批量分配的节点块, 无状态的allocator通过EBO不占空间
+        compressed_pair<node_allocator, slab_type*> __alloc_slabs;
+        link_type  __spare;      // spare cache: 已析构但未释放的节点, 通过next连成单链表
+        size_type  __spare_size; // spare cache中的节点个数
 
     public:
         // 构造函数
@@ -133,7 +158,8 @@ namespace mySTL
         {fill_init(n, value_type(value));}
 
         // 拷贝构造, 分别是从顺序容器的iterators/initialization list/其他list实例中拷贝
-        template <class InputIterator>
+        template <class InputIterator, class = typename mySTL::enable_if<
+            !mySTL::is_integral<InputIterator>::value>::type>
         list(InputIterator first, InputIterator last)
         {copy_init(first, last);}
 
@@ -144,19 +170,24 @@ namespace mySTL
         {copy_init(other.begin(), other.end());}
 
         // 移动构造
-        list(list&& other) : __node(other.__node), __size(other.__size)
+        list(list&& other) : __node(other.__node), __size(other.__size),
+                             __alloc_slabs(mySTL::move(other.get_node_allocator()), other.slabs()),
+                             __spare(other.__spare), __spare_size(other.__spare_size)
         {
             other.__node = nullptr;
             other.__size = 0;
+            other.slabs() = nullptr;
+            other.__spare = nullptr;
+            other.__spare_size = 0;
         }
 
-        // 拷贝赋值
-        list& operator=(const list& other) // TODO
+        // 拷贝赋值, 复用已有节点
+        list& operator=(const list& other)
         {
             //避免自赋值, 检查地址是否一样
             if(this != &other)
             {
-
+                copy_assign(other.begin(), other.end());
             }
             return *this;
         }
@@ -166,7 +197,8 @@ namespace mySTL
             if(__node)
             {
                 clear();
-                node_allocator::deallocate(__node);
+                shrink_to_fit();
+                get_node_allocator().deallocate(__node);
                 __node = nullptr;
                 __size = 0;
             }
@@ -182,21 +214,36 @@ namespace mySTL
         reference front() const{assert(!empty()); return *begin();}
         // 返回尾部元素
         reference back()  const{assert(!empty()); return *(--end());}
+        // 容器占用的总内存 (bytes): 对象本身 + 哨兵节点 + 数据节点 + spare cache
+        size_type memory_footprint() const;
+
+    public:
+        /*** 容量接口 ***/
+        // 不需要再分配内存就能容纳的元素个数
+        size_type capacity() const {return __size + __spare_size;}
+        // 预先分配节点放入spare cache, 使capacity() >= n
+        void reserve(size_type n);
+        // 释放spare cache中的所有节点
+        void shrink_to_fit();
 
     public:
         /*** 修改元素接口 ***/
         // assign操作 
         void assign(size_type n, const value_type& value); 
         void assign(std::initializer_list<value_type> ilist);
-        template <class InputIterator>
-        void assign(InputIterator first, InputIterator last); // TODO
+        template <class InputIterator, class = typename mySTL::enable_if<
+            !mySTL::is_integral<InputIterator>::value>::type>
+        void assign(InputIterator first, InputIterator last);
 
         // 插入操作
         iterator insert(iterator pos, const_reference x); // 插入单个元素
         iterator insert(iterator pos, value_type&& x); // 支持移动构造的插入
         iterator insert(iterator pos, size_type n, const_reference x); // 插入n个相同元素
-        template <class InputIterator> // TODO
+        template <class InputIterator, class = typename mySTL::enable_if<
+            !mySTL::is_integral<InputIterator>::value>::type>
         iterator insert(iterator pos, InputIterator first, InputIterator last); // 插入其他迭代器的元素值
+        iterator insert(iterator pos, std::initializer_list<value_type> ilist)
+        {return copy_insert(pos, ilist.begin(), ilist.end());}
 
         template <class... Args>
         void emplace_front(Args&&... args);
@@ -216,8 +263,8 @@ namespace mySTL
         void clear();
 
         // resize操作
-        void resize(size_type n); //TODO
-        void resize(size_type n, const_reference value); // TODO
+        void resize(size_type n) {resize(n, value_type());}
+        void resize(size_type n, const_reference value);
 
         // 交换两个链表数据
         void swap(list& other) noexcept;
@@ -236,19 +283,56 @@ namespace mySTL
         // 反转链表
         void reverse(); // TODO
 
+        // 把所有节点按遍历顺序搬到一个新的连续slab中, 恢复长时间增删后的内存局部性
+        // 所有迭代器失效, 原节点的内存直接释放 (不进入spare cache)
+        void relayout();
+
+        // 依次对每个元素调用f, 遍历时提前预取后面第distance个节点
+        template <class UnaryFunction>
+        UnaryFunction for_each(UnaryFunction f, size_type distance = __list_prefetch_distance);
+
     private: // helper function
+        node_allocator& get_node_allocator() {return __alloc_slabs.first();}
+        slab_type*&     slabs()              {return __alloc_slabs.second();}
+        slab_type*      slabs() const        {return __alloc_slabs.second();}
+
         // 创建空节点， 初始化__size
         inline void empty_init();
         inline void fill_init(size_type n, const_reference value);
         template <class InputIterator>
         inline void copy_init(InputIterator first, InputIterator last);
 
-        // create new node
+        // create new node, 优先复用spare cache中的节点
         template <class ...Args>
         link_type create_node(Args&&... args);
-        // destroy one node
+        // destroy one node, 节点内存放回spare cache
         void      destroy_node(link_type node);
 
+        // 取出n个未构造的节点, 通过next连成以nullptr结尾的链
+        // 先取spare cache, 不够的部分个数足够多时从一个slab分配
+        link_type acquire_nodes(size_type n);
+        // 批量创建节点并连成链 [head, tail]
+        void create_fill_nodes(size_type n, const_reference value, link_type& head, link_type& tail);
+        template <class ForwardIterator>
+        void create_copy_nodes(ForwardIterator first, size_type n, link_type& head, link_type& tail);
+        // 构造失败时, 析构[head, constructed)的数据, 整条链放回spare cache
+        void abort_chain(link_type head, link_type constructed);
+        // 析构已断开的一段节点 [first, last] 并整段放回spare cache, 返回节点个数
+        size_type recycle_nodes(link_type first, link_type last);
+        // relayout时把旧数据搬到新节点, 移动构造可能抛异常时退化为拷贝
+        static void relocate_data(link_type dst, link_type src, mySTL::true_type)
+        {construct(&dst->data, mySTL::move(src->data));}
+        static void relocate_data(link_type dst, link_type src, mySTL::false_type)
+        {construct(&dst->data, static_cast<const_reference>(src->data));}
+        // 未构造的节点放回spare cache
+        void push_spare(link_type node);
+        // 真正释放一条以nullptr结尾的节点链 (数据已析构, 通过next连接), 空出来的slab整块归还
+        void release_chain(link_type first);
+
+        // slab管理
+        link_type  allocate_slab(size_type n);
+        void       release_slab(slab_type* slab);
+
         // 根据iterator插入一段nodes
         inline iterator link_nodes_at(iterator pos, link_type first, link_type last);
         // 断开中间一段nodes
@@ -264,6 +348,10 @@ namespace mySTL
         // 拷贝多个元素
         template <class InputIterator>
         iterator copy_insert(iterator pos, InputIterator first, InputIterator last); 
+        template <class InputIterator>
+        iterator copy_insert_aux(iterator pos, InputIterator first, InputIterator last, input_iterator_tag);
+        template <class ForwardIterator>
+        iterator copy_insert_aux(iterator pos, ForwardIterator first, ForwardIterator last, forward_iterator_tag);
     };
 
     /**
@@ -283,6 +371,27 @@ namespace mySTL
         copy_assign(ilist.begin(), ilist.end());
     }
 
+    template <class T>
+    template <class InputIterator, class>
+    void list<T>::assign(InputIterator first, InputIterator last)
+    {
+        copy_assign(first, last);
+    }
+
+    // 对象本身 + 单独分配的节点 + slab (头部和整块节点)
+    template <class T>
+    typename list<T>::size_type list<T>::memory_footprint() const
+    {
+        if(!__node) return sizeof(list);
+        size_type heap_nodes = __size + 1 + __spare_size, bytes = sizeof(list);
+        for(slab_type* s = slabs(); s; s = s->next)
+        {
+            heap_nodes -= s->live;
+            bytes += sizeof(slab_type) + s->capacity * sizeof(list_node);
+        }
+        return bytes + heap_nodes * sizeof(list_node);
+    }
+
 
     
     // *** 插入元素 ***
@@ -308,6 +417,13 @@ namespace mySTL
         return fill_insert(pos, n, x);
     }
 
+    template <class T>
+    template <class InputIterator, class>
+    typename list<T>::iterator list<T>::insert(iterator pos, InputIterator first, InputIterator last)
+    {
+        return copy_insert(pos, first, last);
+    }
+
     template<class T>
     template <class... Args>
     void list<T>::emplace_front(Args&&... args) 
@@ -364,13 +480,9 @@ namespace mySTL
     {
         if(first != last)
         {
-            unlink_nodes(first.node, last.node->prev);
-            while(first!=last)
-            {
-                destroy_node(first.node);
-                ++first;
-                --__size;
-            }
+            link_type last_node = last.node->prev;
+            unlink_nodes(first.node, last_node);
+            __size -= recycle_nodes(first.node, last_node);
             if(__size==0) __node->unlink();
         }
         return last;
@@ -385,7 +497,7 @@ namespace mySTL
     template <class T>
     void list<T>::pop_front()
     {
-        erase(++end());
+        erase(begin());
     }
 
     // 清空list
@@ -394,27 +506,123 @@ namespace mySTL
     {
         if(__size!=0)
         {
-            auto curr = __node->next;
-            for(auto next = curr->next; curr!=__node; curr = next, next = curr->next)
-            {
-                destroy_node(curr);
-            }
+            recycle_nodes(__node->next, __node->prev);
             __node->unlink();
             __size = 0;
         }
     }
 
+    template <class T>
+    void list<T>::resize(size_type n, const_reference value)
+    {
+        if(n < __size)
+        {
+            iterator first = end();
+            mySTL::advance(first, -static_cast<difference_type>(__size - n));
+            erase(first, end());
+        }
+        else
+        {
+            fill_insert(end(), n - __size, value);
+        }
+    }
+
+    template <class T>
+    void list<T>::relayout()
+    {
+        if(__size == 0) return;
+        link_type nodes = allocate_slab(__size);
+        slab_type* slab = slabs();
+        size_type i = 0;
+        link_type old = __node->next;
+        try
+        {
+            for(; i < __size; i++, old = old->next)
+                relocate_data(&nodes[i], old, mySTL::is_nothrow_move_constructible<value_type>());
+        }
+        catch (...)
+        {
+            while(i > 0) destroy(&nodes[--i].data);
+            release_slab(slab);
+            throw;
+        }
+        // 析构旧节点的数据, 旧节点断开成以nullptr结尾的链, 重新链接后一起释放
+        link_type first = __node->next;
+        for(old = first; old != __node; old = old->next)
+            destroy(&old->data);
+        __node->prev->next = nullptr;
+        // 按内存顺序重新链接
+        link_type prev = __node;
+        for(i = 0; i < __size; i++)
+        {
+            prev->next = &nodes[i];
+            nodes[i].prev = prev;
+            prev = &nodes[i];
+        }
+        prev->next = __node;
+        __node->prev = prev;
+        release_chain(first);
+    }
+
+    template <class T>
+    template <class UnaryFunction>
+    UnaryFunction list<T>::for_each(UnaryFunction f, size_type distance)
+    {
+        // ahead领先curr distance个节点, 提前发出对后续节点的访存
+        link_type ahead = __node->next;
+        for(size_type i = 0; i < distance && ahead != __node; i++)
+        {
+            mySTL::prefetch(ahead);
+            ahead = ahead->next;
+        }
+        for(link_type curr = __node->next; curr != __node; curr = curr->next)
+        {
+            if(ahead != __node)
+            {
+                mySTL::prefetch(ahead->next);
+                ahead = ahead->next;
+            }
+            f(curr->data);
+        }
+        return f;
+    }
+
+    template <class T>
+    void list<T>::reserve(size_type n)
+    {
+        if(n <= capacity()) return;
+        size_type extra = n - capacity();
+        link_type nodes = allocate_slab(extra);
+        // 倒序放入, 取出时按内存顺序
+        while(extra > 0) push_spare(&nodes[--extra]);
+    }
+
+    template <class T>
+    void list<T>::shrink_to_fit()
+    {
+        link_type chain = __spare;
+        __spare = nullptr;
+        __spare_size = 0;
+        release_chain(chain);
+    }
+
     template <class T>
     void list<T>::swap(list<T>& other) noexcept
     {
         mySTL::swap(__node, other.__node);
         mySTL::swap(__size, other.__size);
+        __alloc_slabs.swap(other.__alloc_slabs);
+        mySTL::swap(__spare, other.__spare);
+        mySTL::swap(__spare_size, other.__spare_size);
     }
 
     // *** helper function ***
     template<class T>
     inline void list<T>::empty_init() 
     {
+        slabs() = nullptr;
+        __spare = nullptr;
+        __spare_size = 0;
         __node = create_node();
         __node->unlink();
         __size = 0;
@@ -424,15 +632,13 @@ namespace mySTL
     inline void list<T>::fill_init(size_type n, const_reference value) 
     {
         empty_init();
-        __size = n;
         try {
-            while (n-- > 0) {
-            link_type node = create_node(value);
-            link_nodes_at(end(), node, node);
-            }
+            fill_insert(end(), n, value);
         } catch (...) {
+            // 已经放入spare cache的节点和它们所在的slab一起归还
             clear();
-            node_allocator::deallocate(__node);
+            shrink_to_fit();
+            get_node_allocator().deallocate(__node);
             __node = nullptr;
             throw;
         }
@@ -445,18 +651,13 @@ namespace mySTL
         empty_init();
         try 
         {
-            while (first != last) 
-            {
-                auto node = create_node(*first);
-                link_nodes_at(end(), node, node);
-                ++first;
-                ++__size;
-            }
+            copy_insert(end(), first, last);
         } 
         catch (...) 
         {
             clear();
-            node_allocator::deallocate(__node);
+            shrink_to_fit();
+            get_node_allocator().deallocate(__node);
             __node = nullptr;
             throw;
         }
@@ -467,7 +668,17 @@ namespace mySTL
     template<class ...Args>
     typename list<T>::link_type list<T>::create_node(Args&&... args)
     {
-        link_type ptr = node_allocator::allocate(1); // 分配一个节点内存
+        link_type ptr;
+        if(__spare) // 复用spare cache
+        {
+            ptr = __spare;
+            __spare = ptr->next;
+            --__spare_size;
+        }
+        else
+        {
+            ptr = get_node_allocator().allocate(1); // 分配一个节点内存
+        }
         try 
         {
             construct(&ptr->data, mySTL::forward<Args>(args)...);
@@ -476,18 +687,219 @@ namespace mySTL
         } 
         catch (...) 
         {
-            node_allocator::deallocate(ptr);
-            throw("Failed to create node");
+            push_spare(ptr);
+            throw;
         }
         return ptr;
     }
 
-    // 删除节点
+    // 删除节点, 内存留在spare cache中, 由shrink_to_fit或析构函数释放
     template <class T>
     void list<T>::destroy_node(link_type node)
     {
         destroy(&node->data);//析构
-        node_allocator::deallocate(node); // 删除内存空间
+        push_spare(node);
+    }
+
+    template <class T>
+    inline void list<T>::push_spare(link_type node)
+    {
+        node->prev = node;
+        node->next = __spare;
+        __spare = node;
+        ++__spare_size;
+    }
+
+    // 不逐个查找节点所属的slab: 先把链上节点的prev置空, 再扫描每个slab,
+    // prev为空的节点就是本次释放的, 计数后把prev改成所属slab; 链上剩下的是单独分配的节点, 直接归还
+    // 复杂度 O(链长 + slab总容量), 不分配内存
+    template <class T>
+    void list<T>::release_chain(link_type first)
+    {
+        const bool has_slabs = slabs() != nullptr;
+        if(has_slabs)
+        {
+            for(link_type curr = first; curr; curr = curr->next)
+                curr->prev = nullptr;
+            for(slab_type* s = slabs(); s; s = s->next)
+            {
+                for(size_type i = 0; i < s->capacity; i++)
+                {
+                    if(s->nodes[i].prev == nullptr)
+                    {
+                        s->nodes[i].prev = reinterpret_cast<link_type>(s);
+                        --s->live;
+                    }
+                }
+            }
+        }
+        while(first)
+        {
+            link_type next = first->next;
+            if(!has_slabs || first->prev == nullptr) get_node_allocator().deallocate(first);
+            first = next;
+        }
+        // 一遍扫描归还所有节点都已释放的slab
+        for(slab_type** curr = &slabs(); *curr; )
+        {
+            slab_type* s = *curr;
+            if(s->live == 0)
+            {
+                *curr = s->next;
+                get_node_allocator().deallocate(s->nodes, s->capacity);
+                slab_allocator::deallocate(s);
+            }
+            else curr = &s->next;
+        }
+    }
+
+    // 和push_spare一样把prev指向自身: 未链接的节点 (如copy_insert_aux中的head) prev可能为空
+    template <class T>
+    typename list<T>::size_type list<T>::recycle_nodes(link_type first, link_type last)
+    {
+        size_type n = 1;
+        for(link_type curr = first; curr != last; curr = curr->next, ++n)
+        {
+            destroy(&curr->data);
+            curr->prev = curr;
+        }
+        destroy(&last->data);
+        last->prev = last;
+        last->next = __spare;
+        __spare = first;
+        __spare_size += n;
+        return n;
+    }
+
+    // 分配n个连续节点 (只分配内存, 不构造数据), 并登记到slabs()
+    template <class T>
+    typename list<T>::link_type list<T>::allocate_slab(size_type n)
+    {
+        slab_type* slab = slab_allocator::allocate(1);
+        try
+        {
+            slab->nodes = get_node_allocator().allocate(n);
+        }
+        catch (...)
+        {
+            slab_allocator::deallocate(slab);
+            throw;
+        }
+        for(size_type i = 0; i < n; i++) // 未使用的slab节点prev也不能为空, 见release_chain
+            slab->nodes[i].prev = &slab->nodes[i];
+        slab->capacity = n;
+        slab->live = n;
+        slab->next = slabs();
+        slabs() = slab;
+        return slab->nodes;
+    }
+
+    // 从slabs()中移除并释放整个slab, 调用者保证其中的节点都已不再使用
+    template <class T>
+    void list<T>::release_slab(slab_type* slab)
+    {
+        slab_type** curr = &slabs();
+        while(*curr != slab) curr = &(*curr)->next;
+        *curr = slab->next;
+        get_node_allocator().deallocate(slab->nodes, slab->capacity);
+        slab_allocator::deallocate(slab);
+    }
+
+    template <class T>
+    typename list<T>::link_type list<T>::acquire_nodes(size_type n)
+    {
+        link_type  head = nullptr;
+        link_type* tail = &head;
+        for(; n > 0 && __spare; --n) // 先取spare cache
+        {
+            *tail = __spare;
+            tail = &__spare->next;
+            __spare = __spare->next;
+            --__spare_size;
+        }
+        try
+        {
+            if(n >= __list_slab_min_nodes) // 一次分配, 按内存顺序链接
+            {
+                link_type nodes = allocate_slab(n);
+                for(size_type i = 0; i < n; i++)
+                {
+                    *tail = &nodes[i];
+                    tail = &nodes[i].next;
+                }
+            }
+            else
+            {
+                for(; n > 0; --n)
+                {
+                    *tail = get_node_allocator().allocate(1);
+                    tail = &(*tail)->next;
+                }
+            }
+        }
+        catch (...)
+        {
+            *tail = nullptr;
+            abort_chain(head, head);
+            throw;
+        }
+        *tail = nullptr;
+        return head;
+    }
+
+    template <class T>
+    void list<T>::abort_chain(link_type head, link_type constructed)
+    {
+        for(link_type curr = head; curr != constructed; curr = curr->next)
+            destroy(&curr->data);
+        for(link_type next; head; head = next)
+        {
+            next = head->next;
+            push_spare(head);
+        }
+    }
+
+    template <class T>
+    void list<T>::create_fill_nodes(size_type n, const_reference value, link_type& head, link_type& tail)
+    {
+        head = acquire_nodes(n);
+        link_type curr = head, prev = nullptr;
+        try
+        {
+            for(; curr; prev = curr, curr = curr->next)
+            {
+                construct(&curr->data, value);
+                curr->prev = prev;
+            }
+        }
+        catch (...)
+        {
+            abort_chain(head, curr);
+            throw;
+        }
+        tail = prev;
+    }
+
+    template <class T>
+    template <class ForwardIterator>
+    void list<T>::create_copy_nodes(ForwardIterator first, size_type n, link_type& head, link_type& tail)
+    {
+        head = acquire_nodes(n);
+        link_type curr = head, prev = nullptr;
+        try
+        {
+            for(; curr; prev = curr, curr = curr->next, ++first)
+            {
+                construct(&curr->data, *first);
+                curr->prev = prev;
+            }
+        }
+        catch (...)
+        {
+            abort_chain(head, curr);
+            throw;
+        }
+        tail = prev;
     }
 
     template <class T>
@@ -542,38 +954,63 @@ namespace mySTL
     template <class T>
     typename list<T>::iterator list<T>::fill_insert(iterator pos, size_type n, const_reference value)
     {
-        link_type pos_node = create_node(value);
-        link_type curr = pos_node;
-        for(int i = 1; i<n; i++)
-        {
-            link_type tmp = create_node(value);
-            curr->next = tmp;
-            tmp->prev = curr;
-            curr = curr->next;
-        }
-        link_nodes_at(pos.node, pos_node, curr);
+        if(n == 0) return pos;
+        link_type head, tail;
+        create_fill_nodes(n, value, head, tail);
+        link_nodes_at(pos, head, tail);
         __size += n;
-        return pos_node;
+        return head;
     }
 
     template <class T>
     template <class InputIterator>
     typename list<T>::iterator list<T>::copy_insert(iterator pos, InputIterator first, InputIterator last)
     {
-        link_type pos_node = create_node(*first);
-        link_type curr = pos_node;
-        ++first;
-        while(first!=last)
+        return copy_insert_aux(pos, first, last, iterator_category(first));
+    }
+
+    // 单遍迭代器, 个数未知, 逐个创建节点
+    template <class T>
+    template <class InputIterator>
+    typename list<T>::iterator list<T>::copy_insert_aux(iterator pos, InputIterator first, InputIterator last,
+                                                        input_iterator_tag)
+    {
+        if(first == last) return pos;
+        link_type head = create_node(*first), tail = head;
+        size_type n = 1;
+        try
         {
-            link_type tmp = create_node(*first);
-            curr->next = tmp;
-            tmp->prev = curr;
-            curr = curr->next;
-            ++first;
-            ++__size;
+            for(++first; first != last; ++first, ++n)
+            {
+                link_type tmp = create_node(*first);
+                tail->next = tmp;
+                tmp->prev = tail;
+                tail = tmp;
+            }
+        }
+        catch (...)
+        {
+            recycle_nodes(head, tail);
+            throw;
         }
-        link_nodes_at(pos.node, pos_node, curr);
-        return pos_node;
+        link_nodes_at(pos, head, tail);
+        __size += n;
+        return head;
+    }
+
+    // 多遍迭代器, 先求个数, 再批量创建
+    template <class T>
+    template <class ForwardIterator>
+    typename list<T>::iterator list<T>::copy_insert_aux(iterator pos, ForwardIterator first, ForwardIterator last,
+                                                        forward_iterator_tag)
+    {
+        size_type n = static_cast<size_type>(mySTL::distance(first, last));
+        if(n == 0) return pos;
+        link_type head, tail;
+        create_copy_nodes(first, n, head, tail);
+        link_nodes_at(pos, head, tail);
+        __size += n;
+        return head;
     }
 }
 #endif // __LIST_H__
\ No newline at end of file
@@ -0,0 +1,553 @@
+#ifndef __LRU_CACHE_H__
+#define __LRU_CACHE_H__
+
+// 固定容量的缓存: lru_cache (最近最少使用) 和 clock_cache (CLOCK近似LRU)
+// 所有条目放在构造时一次分配的节点池中, 节点之间用32位下标链接, 插入和淘汰不再分配内存
+// 查找走内嵌的开放寻址索引 (线性探测, 删除时后移, 没有墓碑), 索引槽只存hash和节点下标
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <functional>
+#include <new>
+#include "allocator.h"
+#include "construct.h"
+#include "iterator.h"
+#include "pair.h"
+#include "utils.h"
+
+namespace mySTL
+{
+    // 缓存节点, prev/next在lru_cache中是LRU链表, 在两种缓存中空闲节点都用next串成空闲链表
+    template <class Value>
+    struct __cache_node
+    {
+        uint32_t    prev;
+        uint32_t    next;
+        uint32_t    hash;
+        bool        referenced;     // clock_cache的访问位
+        alignas(Value) unsigned char storage[sizeof(Value)];
+
+        Value&       value()       noexcept {return *reinterpret_cast<Value*>(storage);}
+        const Value& value() const noexcept {return *reinterpret_cast<const Value*>(storage);}
+    };
+
+    // 索引槽, node == npos 表示空
+    struct __cache_slot
+    {
+        uint32_t hash;
+        uint32_t node;
+    };
+
+    /**
+     * @brief __cache_table
+     * 两种缓存共用的节点池 + 开放寻址索引, 不负责淘汰顺序
+     */
+    template <class Key, class T, class Hash, class KeyEqual>
+    class __cache_table
+    {
+    public:
+        typedef pair<const Key, T>          value_type;
+        typedef __cache_node<value_type>    node_type;
+
+        static constexpr uint32_t npos = 0xFFFFFFFFu;
+
+    protected:
+        typedef mySTL::allocator<node_type>     node_allocator;
+        typedef mySTL::allocator<__cache_slot>  slot_allocator;
+
+        node_type*      __nodes;        // capacity + 1 个, 最后一个是lru_cache的链表哨兵
+        // 索引 + hasher/key_equal, 无状态的Hash和KeyEqual通过EBO不占空间
+        compressed_pair<__cache_slot*, compressed_pair<Hash, KeyEqual>> __slots_policy;
+        uint32_t        __capacity;
+        uint32_t        __mask;         // 索引大小 - 1, 索引大小是不小于2 * capacity的2的幂
+        uint32_t        __size;
+        uint32_t        __used;         // 从未使用过的节点从这里开始
+        uint32_t        __free;         // 空闲链表
+        size_t          __hits;
+        size_t          __misses;
+        size_t          __evictions;
+
+    public:
+        explicit __cache_table(size_t capacity, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : __nodes(nullptr), __slots_policy(nullptr, compressed_pair<Hash, KeyEqual>(hash, equal)),
+              __capacity(static_cast<uint32_t>(capacity ? capacity : 1)), __mask(0),
+              __size(0), __used(0), __free(npos), __hits(0), __misses(0), __evictions(0)
+        {
+            assert(capacity < npos / 2);
+            size_t slots = 2;
+            while(slots < 2 * size_t(__capacity)) slots <<= 1;
+            __mask = static_cast<uint32_t>(slots - 1);
+            __nodes = node_allocator::allocate(__capacity + 1);
+            try
+            {
+                __slots() = slot_allocator::allocate(slots);
+            }
+            catch(...)
+            {
+                node_allocator::deallocate(__nodes, __capacity + 1);
+                throw;
+            }
+            for(size_t i = 0; i < slots; i++) __slots()[i].node = npos;
+        }
+
+        __cache_table(const __cache_table&) = delete;
+        __cache_table& operator=(const __cache_table&) = delete;
+
+        ~__cache_table()
+        {
+            if(!__nodes) return;
+            __destroy_all();
+            slot_allocator::deallocate(__slots(), __mask + 1);
+            node_allocator::deallocate(__nodes, __capacity + 1);
+        }
+
+        size_t size()     const noexcept {return __size;}
+        size_t capacity() const noexcept {return __capacity;}
+        bool   empty()    const noexcept {return __size == 0;}
+        bool   full()     const noexcept {return __size == __capacity;}
+
+        bool contains(const Key& key) const {return __find(key, __hash(key)) != npos;}
+
+        // 不改变淘汰顺序, 也不计入命中统计
+        const T* peek(const Key& key) const
+        {
+            uint32_t n = __find(key, __hash(key));
+            return n == npos ? nullptr : &__nodes[n].value().second;
+        }
+
+        /*** 统计 ***/
+        size_t hits()      const noexcept {return __hits;}
+        size_t misses()    const noexcept {return __misses;}
+        size_t evictions() const noexcept {return __evictions;}
+        double hit_rate()  const noexcept
+        {
+            size_t total = __hits + __misses;
+            return total ? double(__hits) / total : 0.0;
+        }
+        void reset_stats() noexcept {__hits = __misses = __evictions = 0;}
+
+    protected:
+        __cache_slot*&  __slots() noexcept        {return __slots_policy.first();}
+        __cache_slot*   __slots() const noexcept  {return __slots_policy.first();}
+        const Hash&     __hasher() const noexcept {return __slots_policy.second().first();}
+        const KeyEqual& __equal()  const noexcept {return __slots_policy.second().second();}
+
+        uint32_t __hash(const Key& key) const
+        {
+            // std::hash对整数是恒等映射, 再混合一次让低位分布均匀
+            return static_cast<uint32_t>(__hash_mix(static_cast<uint64_t>(__hasher()(key))) >> 32);
+        }
+
+        uint32_t __find(const Key& key, uint32_t h) const
+        {
+            for(uint32_t i = h & __mask;; i = (i + 1) & __mask)
+            {
+                const __cache_slot& s = __slots()[i];
+                if(s.node == npos) return npos;
+                if(s.hash == h && __equal()(__nodes[s.node].value().first, key)) return s.node;
+            }
+        }
+
+        void __index_insert(uint32_t h, uint32_t node) noexcept
+        {
+            uint32_t i = h & __mask;
+            while(__slots()[i].node != npos) i = (i + 1) & __mask;
+            __slots()[i].hash = h;
+            __slots()[i].node = node;
+        }
+
+        // 删除后把探测链上后面的槽往前移, 保持每个槽都能从它的起始位置连续探测到
+        void __index_erase(uint32_t node) noexcept
+        {
+            uint32_t i = __nodes[node].hash & __mask;
+            while(__slots()[i].node != node) i = (i + 1) & __mask;
+            for(uint32_t j = (i + 1) & __mask;; j = (j + 1) & __mask)
+            {
+                if(__slots()[j].node == npos) break;
+                uint32_t home = __slots()[j].hash & __mask;
+                if(((j - home) & __mask) >= ((j - i) & __mask))
+                {
+                    __slots()[i] = __slots()[j];
+                    i = j;
+                }
+            }
+            __slots()[i].node = npos;
+        }
+
+        // 取一个空闲节点, 调用前必须确认没有满
+        uint32_t __take_node() noexcept
+        {
+            if(__free != npos)
+            {
+                uint32_t n = __free;
+                __free = __nodes[n].next;
+                return n;
+            }
+            return __used++;
+        }
+
+        void __put_node(uint32_t n) noexcept
+        {
+            __nodes[n].next = __free;
+            __free = n;
+        }
+
+        // 在节点n上构造元素并加入索引, 构造失败时节点放回空闲链表
+        template <class K, class... Args>
+        void __construct(uint32_t n, uint32_t h, K&& key, Args&&... args)
+        {
+            node_type& node = __nodes[n];
+            try
+            {
+                ::new (static_cast<void*>(node.storage)) value_type(piecewise_construct,
+                    std::forward_as_tuple(mySTL::forward<K>(key)), std::forward_as_tuple(mySTL::forward<Args>(args)...));
+            }
+            catch(...)
+            {
+                __put_node(n);
+                throw;
+            }
+            node.hash = h;
+            node.referenced = false;
+            __index_insert(h, n);
+            ++__size;
+        }
+
+        // 从索引中删除并析构, 节点由调用者处理
+        void __destroy(uint32_t n) noexcept
+        {
+            __index_erase(n);
+            mySTL::destroy(&__nodes[n].value());
+            --__size;
+        }
+
+        void __destroy_all() noexcept
+        {
+            for(uint32_t i = 0; i <= __mask; i++)
+            {
+                if(__slots()[i].node != npos)
+                {
+                    mySTL::destroy(&__nodes[__slots()[i].node].value());
+                    __slots()[i].node = npos;
+                }
+            }
+            __size = 0;
+            __used = 0;
+            __free = npos;
+        }
+    };
+
+    /**
+     * @brief lru_cache
+     * 容量满时插入新key会淘汰最久没有访问的条目; get/put把条目移到链表头, 只修改几个下标
+     * 返回的指针在条目被淘汰或删除之前有效
+     * @tparam Key
+     * @tparam T
+     * @tparam Hash
+     * @tparam KeyEqual
+     */
+    template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+    class lru_cache : public __cache_table<Key, T, Hash, KeyEqual>
+    {
+    private:
+        typedef __cache_table<Key, T, Hash, KeyEqual>   base;
+        typedef typename base::node_type                node_type;
+        using base::npos;
+        using base::__nodes;
+        using base::__capacity;
+        using base::__size;
+        using base::__hits;
+        using base::__misses;
+        using base::__evictions;
+
+    public:
+        typedef Key                             key_type;
+        typedef T                               mapped_type;
+        typedef typename base::value_type       value_type;
+        typedef size_t                          size_type;
+
+        // 从最近访问到最久未访问的顺序遍历, 遍历本身不改变顺序
+        class iterator : public mySTL::iterator<mySTL::bidirectional_iterator_tag, value_type>
+        {
+        private:
+            node_type*  __pool;
+            uint32_t    __n;
+
+        public:
+            typedef value_type* pointer;
+            typedef value_type& reference;
+
+            iterator() noexcept : __pool(nullptr), __n(0) {}
+            iterator(node_type* pool, uint32_t n) noexcept : __pool(pool), __n(n) {}
+
+            reference operator*()  const noexcept {return __pool[__n].value();}
+            pointer   operator->() const noexcept {return &__pool[__n].value();}
+
+            iterator& operator++() noexcept {__n = __pool[__n].next; return *this;}
+            iterator& operator--() noexcept {__n = __pool[__n].prev; return *this;}
+            iterator  operator++(int) noexcept {iterator tmp = *this; ++*this; return tmp;}
+            iterator  operator--(int) noexcept {iterator tmp = *this; --*this; return tmp;}
+
+            bool operator==(const iterator& other) const noexcept {return __n == other.__n;}
+            bool operator!=(const iterator& other) const noexcept {return __n != other.__n;}
+        };
+
+    public:
+        explicit lru_cache(size_t capacity, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : base(capacity, hash, equal)
+        {
+            node_type& head = __nodes[__head()];
+            head.prev = head.next = __head();
+        }
+
+        iterator begin() noexcept {return iterator(__nodes, __nodes[__head()].next);}
+        iterator end()   noexcept {return iterator(__nodes, __head());}
+
+        // 最久未访问的条目, 也就是下一个被淘汰的
+        value_type& back() noexcept {assert(!this->empty()); return __nodes[__nodes[__head()].prev].value();}
+
+        // 命中时移到最前并返回value的指针, 否则返回nullptr
+        T* get(const Key& key)
+        {
+            uint32_t n = this->__find(key, this->__hash(key));
+            if(n == npos)
+            {
+                ++__misses;
+                return nullptr;
+            }
+            ++__hits;
+            __move_to_front(n);
+            return &__nodes[n].value().second;
+        }
+
+        // 插入或覆盖并移到最前, 插入新key时返回true
+        template <class U>
+        bool put(const Key& key, U&& value)
+        {
+            uint32_t h = this->__hash(key);
+            uint32_t n = this->__find(key, h);
+            if(n != npos)
+            {
+                __nodes[n].value().second = mySTL::forward<U>(value);
+                __move_to_front(n);
+                return false;
+            }
+            __emplace(h, key, mySTL::forward<U>(value));
+            return true;
+        }
+
+        // 未命中时用make()的结果插入, 返回value的引用
+        template <class F>
+        T& get_or_put(const Key& key, F&& make)
+        {
+            uint32_t h = this->__hash(key);
+            uint32_t n = this->__find(key, h);
+            if(n != npos)
+            {
+                ++__hits;
+                __move_to_front(n);
+                return __nodes[n].value().second;
+            }
+            ++__misses;
+            return __nodes[__emplace(h, key, make())].value().second;
+        }
+
+        bool erase(const Key& key)
+        {
+            uint32_t n = this->__find(key, this->__hash(key));
+            if(n == npos) return false;
+            __unlink(n);
+            this->__destroy(n);
+            this->__put_node(n);
+            return true;
+        }
+
+        void clear() noexcept
+        {
+            this->__destroy_all();
+            node_type& head = __nodes[__head()];
+            head.prev = head.next = __head();
+        }
+
+    private:
+        uint32_t __head() const noexcept {return __capacity;}
+
+        // 对应list的link_nodes_at / unlink_nodes, 只是指针换成了下标
+        void __link_at(uint32_t pos, uint32_t n) noexcept
+        {
+            node_type& p = __nodes[pos];
+            node_type& x = __nodes[n];
+            x.prev = p.prev;
+            x.next = pos;
+            __nodes[p.prev].next = n;
+            p.prev = n;
+        }
+
+        void __unlink(uint32_t n) noexcept
+        {
+            node_type& x = __nodes[n];
+            __nodes[x.prev].next = x.next;
+            __nodes[x.next].prev = x.prev;
+        }
+
+        void __move_to_front(uint32_t n) noexcept
+        {
+            uint32_t first = __nodes[__head()].next;
+            if(first == n) return;
+            __unlink(n);
+            __link_at(first, n);
+        }
+
+        // 满时先淘汰链表尾, 新条目放在链表头
+        template <class... Args>
+        uint32_t __emplace(uint32_t h, const Key& key, Args&&... args)
+        {
+            uint32_t n;
+            if(__size == __capacity)
+            {
+                n = __nodes[__head()].prev;
+                __unlink(n);
+                this->__destroy(n);
+                ++__evictions;
+            }
+            else n = this->__take_node();
+            this->__construct(n, h, key, mySTL::forward<Args>(args)...);
+            __link_at(__nodes[__head()].next, n);
+            return n;
+        }
+    };
+
+    /**
+     * @brief clock_cache
+     * CLOCK算法: 命中只设置访问位, 不移动节点, get只写一个字节, 比lru_cache便宜
+     * 淘汰时指针在节点池上循环, 跳过 (并清除) 访问位为1的节点, 淘汰第一个访问位为0的节点
+     * 命中率接近LRU, 返回的指针在条目被淘汰或删除之前有效
+     * @tparam Key
+     * @tparam T
+     * @tparam Hash
+     * @tparam KeyEqual
+     */
+    template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+    class clock_cache : public __cache_table<Key, T, Hash, KeyEqual>
+    {
+    private:
+        typedef __cache_table<Key, T, Hash, KeyEqual>   base;
+        typedef typename base::node_type                node_type;
+        using base::npos;
+        using base::__nodes;
+        using base::__capacity;
+        using base::__size;
+        using base::__hits;
+        using base::__misses;
+        using base::__evictions;
+
+        uint32_t    __hand;
+
+    public:
+        typedef Key                             key_type;
+        typedef T                               mapped_type;
+        typedef typename base::value_type       value_type;
+        typedef size_t                          size_type;
+
+    public:
+        explicit clock_cache(size_t capacity, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : base(capacity, hash, equal), __hand(0) {}
+
+        T* get(const Key& key)
+        {
+            uint32_t n = this->__find(key, this->__hash(key));
+            if(n == npos)
+            {
+                ++__misses;
+                return nullptr;
+            }
+            ++__hits;
+            __nodes[n].referenced = true;
+            return &__nodes[n].value().second;
+        }
+
+        template <class U>
+        bool put(const Key& key, U&& value)
+        {
+            uint32_t h = this->__hash(key);
+            uint32_t n = this->__find(key, h);
+            if(n != npos)
+            {
+                __nodes[n].value().second = mySTL::forward<U>(value);
+                __nodes[n].referenced = true;
+                return false;
+            }
+            __emplace(h, key, mySTL::forward<U>(value));
+            return true;
+        }
+
+        template <class F>
+        T& get_or_put(const Key& key, F&& make)
+        {
+            uint32_t h = this->__hash(key);
+            uint32_t n = this->__find(key, h);
+            if(n != npos)
+            {
+                ++__hits;
+                __nodes[n].referenced = true;
+                return __nodes[n].value().second;
+            }
+            ++__misses;
+            return __nodes[__emplace(h, key, make())].value().second;
+        }
+
+        bool erase(const Key& key)
+        {
+            uint32_t n = this->__find(key, this->__hash(key));
+            if(n == npos) return false;
+            this->__destroy(n);
+            this->__put_node(n);
+            return true;
+        }
+
+        void clear() noexcept
+        {
+            this->__destroy_all();
+            __hand = 0;
+        }
+
+        // 遍历所有条目 (顺序为节点池顺序)
+        template <class F>
+        void for_each(F f)
+        {
+            for(uint32_t i = 0; i <= this->__mask; i++)
+                if(this->__slots()[i].node != npos) f(__nodes[this->__slots()[i].node].value());
+        }
+
+    private:
+        // 满时节点池里每个节点都在用, 指针转一圈之内一定能找到访问位为0的节点
+        uint32_t __evict() noexcept
+        {
+            for(;;)
+            {
+                node_type& x = __nodes[__hand];
+                uint32_t n = __hand;
+                __hand = __hand + 1 == __capacity ? 0 : __hand + 1;
+                if(!x.referenced) return n;
+                x.referenced = false;
+            }
+        }
+
+        template <class... Args>
+        uint32_t __emplace(uint32_t h, const Key& key, Args&&... args)
+        {
+            uint32_t n;
+            if(__size == __capacity)
+            {
+                n = __evict();
+                this->__destroy(n);
+                ++__evictions;
+            }
+            else n = this->__take_node();
+            this->__construct(n, h, key, mySTL::forward<Args>(args)...);
+            return n;
+        }
+    };
+}
+#endif // __LRU_CACHE_H__
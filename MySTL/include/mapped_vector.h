@@ -0,0 +1,177 @@
+#ifndef __MAPPED_VECTOR_H__
+#define __MAPPED_VECTOR_H__
+
+// 映射到文件上的vector, 元素必须是平凡可拷贝类型
+// 文件内容就是元素数组本身 (没有文件头), 打开已有文件不需要读入和拷贝
+
+#include <cstddef>
+#include <cassert>
+#include <stdexcept>
+#include "mmap_resource.h"
+#include "type_traits.h"
+#include "utils.h"
+#include "iterator.h"
+
+namespace mySTL
+{
+    /**
+     * @brief mapped_vector
+     * 扩容时先用ftruncate扩大文件再mremap, 数据不拷贝, 但映射地址可能改变 (迭代器失效)
+     * 打开期间文件长度为capacity()*sizeof(T), 析构 (或shrink_to_fit) 时截断为size()*sizeof(T)
+     * @tparam T 平凡可拷贝类型
+     */
+    template <class T>
+    class mapped_vector
+    {
+        static_assert(mySTL::is_trivially_copyable<T>::value, "mapped_vector requires trivially copyable T");
+
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef const T*    const_pointer;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        typedef T*          iterator;
+        typedef const T*    const_iterator;
+
+        typedef mmap_resource::open_mode open_mode;
+
+    private:
+        mmap_resource __res;
+        size_type     __size;
+
+        // 至少按一页扩容
+        static constexpr size_type __min_grow_bytes = 4096;
+
+    public:
+        // 匿名映射, 不对应文件
+        mapped_vector() : __res(), __size(0) {}
+
+        // 打开文件, 元素个数由文件长度决定
+        explicit mapped_vector(const char* path, open_mode mode = mmap_resource::read_only,
+                               const mmap_options& options = mmap_options())
+            : __res(path, mode, options), __size(__res.size() / sizeof(T))
+        {
+            if(__res.size() % sizeof(T) != 0)
+                throw std::runtime_error("mapped_vector: file size is not a multiple of sizeof(T)");
+        }
+
+        mapped_vector(mapped_vector&& other) noexcept : __res(mySTL::move(other.__res)), __size(other.__size)
+        {
+            other.__size = 0;
+        }
+
+        mapped_vector& operator=(mapped_vector&& other) noexcept
+        {
+            if(this != &other)
+            {
+                __truncate();
+                __res = mySTL::move(other.__res);
+                __size = other.__size;
+                other.__size = 0;
+            }
+            return *this;
+        }
+
+        ~mapped_vector() {__truncate();}
+
+    public:
+        /*** 访问接口 ***/
+        iterator       begin()       noexcept {return data();}
+        const_iterator begin() const noexcept {return data();}
+        iterator       end()         noexcept {return data() + __size;}
+        const_iterator end()   const noexcept {return data() + __size;}
+        pointer        data()        noexcept {return static_cast<pointer>(__res.data());}
+        const_pointer  data()  const noexcept {return static_cast<const_pointer>(__res.data());}
+
+        size_type size()     const noexcept {return __size;}
+        size_type capacity() const noexcept {return __res.size() / sizeof(T);}
+        bool      empty()    const noexcept {return __size == 0;}
+        bool      writable() const noexcept {return __res.writable();}
+
+        reference       operator[](size_type i)       {assert(i < __size); return data()[i];}
+        const_reference operator[](size_type i) const {assert(i < __size); return data()[i];}
+        reference at(size_type i)
+        {
+            if(i >= __size) throw std::out_of_range("mapped_vector::at");
+            return data()[i];
+        }
+        const_reference at(size_type i) const
+        {
+            if(i >= __size) throw std::out_of_range("mapped_vector::at");
+            return data()[i];
+        }
+        reference       front()       {assert(!empty()); return data()[0];}
+        const_reference front() const {assert(!empty()); return data()[0];}
+        reference       back()        {assert(!empty()); return data()[__size - 1];}
+        const_reference back()  const {assert(!empty()); return data()[__size - 1];}
+
+    public:
+        /*** 修改接口 ***/
+        void reserve(size_type n)
+        {
+            if(n > capacity()) __res.resize(n * sizeof(T));
+        }
+
+        void push_back(const T& x)
+        {
+            if(__size == capacity())
+            {
+                T tmp = x; // x可能指向映射内部, 扩容后失效
+                __grow(__size + 1);
+                data()[__size++] = tmp;
+                return;
+            }
+            data()[__size++] = x;
+        }
+
+        void pop_back() {assert(!empty()); --__size;}
+        void clear() noexcept {__size = 0;}
+
+        void resize(size_type n, const T& value = T())
+        {
+            if(n > __size)
+            {
+                T tmp = value;
+                if(n > capacity()) __grow(n);
+                for(size_type i = __size; i < n; i++) data()[i] = tmp;
+            }
+            __size = n;
+        }
+
+        // 文件长度截断为size()
+        void shrink_to_fit()
+        {
+            if(__res.writable() && capacity() != __size) __res.resize(__size * sizeof(T));
+        }
+
+        void advise(mmap_advice advice) {__res.advise(advice);}
+        void sync(bool async = false)   {__res.sync(async);}
+
+    private:
+        // 几何扩容
+        void __grow(size_type required)
+        {
+            size_type cap = capacity() * 2;
+            size_type min_cap = __min_grow_bytes / sizeof(T) ? __min_grow_bytes / sizeof(T) : 1;
+            if(cap < min_cap) cap = min_cap;
+            if(cap < required) cap = required;
+            __res.resize(cap * sizeof(T));
+        }
+
+        void __truncate() noexcept
+        {
+            try
+            {
+                shrink_to_fit();
+            }
+            catch(...)
+            {
+            }
+        }
+    };
+}
+#endif // __MAPPED_VECTOR_H__
@@ -0,0 +1,709 @@
+#ifndef __MEMBERSHIP_FILTER_H__
+#define __MEMBERSHIP_FILTER_H__
+
+// 近似成员查询 (approximate membership): 只会误报, 不会漏报, 用来在昂贵的查找之前做一次廉价的否定检查
+// blocked_bloom_filter: 每个key的所有探测位都落在同一个64字节的块 (一条cache line) 里, 查询只有一次cache miss
+//     块按 k 等分成扇区, 每个扇区置一位; 16个32位字的掩码用SIMD一次算出并比较 (SSE2, 开启 -mavx2 时用AVX2)
+// cuckoo_filter: 每个桶4个f位指纹, 两个候选桶 (partial-key cuckoo hashing, Fan et al. 2014), 支持删除
+//     桶按位紧密排列, 一次64位读取取出整个桶, 用SWAR同时比较4个指纹
+// 两者都按期望的key数和误报率确定大小, 内存从mySTL::allocator分配, 并提供预取的批量查询
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include <functional>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "allocator.h"
+#include "pair.h"
+#include "utils.h"
+
+namespace mySTL
+{
+    // 把32位的x均匀映射到[0, n), 比取模快 (Lemire's fastrange)
+    inline size_t __filter_range(uint32_t x, size_t n) noexcept
+    {
+        return static_cast<size_t>((static_cast<uint64_t>(x) * n) >> 32);
+    }
+
+    // x != 0
+    inline size_t __filter_ctz(uint64_t x) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_ctzll(x));
+#else
+        size_t n = 0;
+        for(; !(x & 1); x >>= 1) ++n;
+        return n;
+#endif
+    }
+
+    static constexpr size_t __filter_batch = 16;     // 批量接口每组先算哈希并预取, 再逐个处理
+
+    /*************************************************************************************/
+    /*                              blocked_bloom_filter                                 */
+    /*************************************************************************************/
+
+    struct alignas(64) __bloom_block
+    {
+        uint32_t words[16];
+    };
+
+    // 每个扇区的乘法盐值, 都是奇数 (同Impala/Parquet的split block Bloom filter)
+    static constexpr uint32_t __bloom_salts[16] = {
+        0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+        0x8a2bf6b5u, 0x3b6ad2d9u, 0xd8bc5f6fu, 0x1f123bb5u, 0x6a09e667u, 0xbb67ae85u, 0x3c6ef373u, 0xa54ff53bu
+    };
+
+    /**
+     * @brief blocked_bloom_filter
+     * 一个块512位, 分成k个扇区 (k = 1, 2, 4, 8, 16), 每个扇区 512/k 位, 每个key在每个扇区置一位
+     * 扇区按32位字对齐, 所以第j个字只可能被它所在扇区的探测命中: 16个字的掩码可以逐字并行算出
+     * k和每个key的位数在构造时按块内负载的泊松分布精确估算, 取满足误报率的最省内存的组合
+     * @tparam Key
+     * @tparam Hash 返回值转换成64位后再混合
+     */
+    template <class Key, class Hash = std::hash<Key>>
+    class blocked_bloom_filter
+    {
+    public:
+        typedef Key     key_type;
+        typedef Hash    hasher;
+        typedef size_t  size_type;
+
+    private:
+        typedef mySTL::allocator<__bloom_block> block_allocator;
+
+        static constexpr uint32_t __block_bits = 512;
+        static constexpr double   __max_bits_per_key = 64;
+
+        // allocator返回的地址 (只保证16字节对齐) + hasher, 无状态的Hash通过EBO不占空间
+        compressed_pair<__bloom_block*, Hash> __raw_hash;
+        __bloom_block*  __blocks;       // 按64字节对齐后的起点
+        size_t          __block_count;
+        size_t          __size;         // insert的次数 (重复的key也计入)
+        uint32_t        __k_log;        // k = 1 << __k_log
+        alignas(32) uint32_t __salt[16];    // 第j个字所在扇区的盐值
+        alignas(32) uint32_t __lane[16];    // 第j个字在扇区内的序号
+
+    public:
+        /**
+         * @param expected_keys 预计插入的key数, 超出后误报率逐渐升高
+         * @param fpr           目标误报率, (0, 1)
+         */
+        explicit blocked_bloom_filter(size_t expected_keys, double fpr = 0.01, const Hash& hash = Hash())
+            : __raw_hash(nullptr, hash), __blocks(nullptr), __block_count(0), __size(0), __k_log(0)
+        {
+            if(!(fpr > 0 && fpr < 1)) throw std::invalid_argument("blocked_bloom_filter: fpr must be in (0, 1)");
+            double bits = __choose(fpr, __k_log);
+            double n = static_cast<double>(expected_keys ? expected_keys : 1);
+            __block_count = static_cast<size_t>(std::ceil(n * bits / __block_bits));
+            if(__block_count == 0) __block_count = 1;
+            __init_lanes();
+            __allocate();
+        }
+
+        blocked_bloom_filter(const blocked_bloom_filter& other)
+            : __raw_hash(nullptr, other.__hasher()), __blocks(nullptr), __block_count(other.__block_count),
+              __size(other.__size), __k_log(other.__k_log)
+        {
+            __init_lanes();
+            __allocate();
+            std::memcpy(__blocks, other.__blocks, __block_count * sizeof(__bloom_block));
+        }
+
+        blocked_bloom_filter(blocked_bloom_filter&& other) noexcept
+            : __raw_hash(other.__raw(), other.__hasher()), __blocks(other.__blocks), __block_count(other.__block_count),
+              __size(other.__size), __k_log(other.__k_log)
+        {
+            __init_lanes();
+            other.__raw() = other.__blocks = nullptr;
+            other.__block_count = other.__size = 0;
+        }
+
+        blocked_bloom_filter& operator=(blocked_bloom_filter other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~blocked_bloom_filter() {block_allocator::deallocate(__raw(), __block_count + 1);}
+
+        void swap(blocked_bloom_filter& other) noexcept
+        {
+            __raw_hash.swap(other.__raw_hash);
+            mySTL::swap(__blocks, other.__blocks);
+            mySTL::swap(__block_count, other.__block_count);
+            mySTL::swap(__size, other.__size);
+            mySTL::swap(__k_log, other.__k_log);
+            __init_lanes();
+            other.__init_lanes();
+        }
+
+    public:
+        void insert(const Key& key) noexcept {__insert_hash(__key_hash(key));}
+
+        bool contains(const Key& key) const noexcept {return __contains_hash(__key_hash(key));}
+
+        // 批量插入, 每组预取所有目标块
+        void insert_many(const Key* keys, size_t n) noexcept
+        {
+            uint64_t hashes[__filter_batch];
+            for(size_t base = 0; base < n; base += __filter_batch)
+            {
+                size_t m = n - base < __filter_batch ? n - base : __filter_batch;
+                for(size_t i = 0; i < m; i++)
+                {
+                    hashes[i] = __key_hash(keys[base + i]);
+                    mySTL::prefetch(__block_of(hashes[i]));
+                }
+                for(size_t i = 0; i < m; i++) __insert_hash(hashes[i]);
+            }
+        }
+
+        /**
+         * @brief 批量查询
+         * @return 可能存在的个数, found[i]表示keys[i]可能存在
+         */
+        size_t contains_many(const Key* keys, size_t n, bool* found) const noexcept
+        {
+            uint64_t hashes[__filter_batch];
+            size_t hit = 0;
+            for(size_t base = 0; base < n; base += __filter_batch)
+            {
+                size_t m = n - base < __filter_batch ? n - base : __filter_batch;
+                for(size_t i = 0; i < m; i++)
+                {
+                    hashes[i] = __key_hash(keys[base + i]);
+                    mySTL::prefetch(__block_of(hashes[i]));
+                }
+                for(size_t i = 0; i < m; i++)
+                {
+                    found[base + i] = __contains_hash(hashes[i]);
+                    hit += found[base + i];
+                }
+            }
+            return hit;
+        }
+
+        void clear() noexcept
+        {
+            std::memset(__blocks, 0, __block_count * sizeof(__bloom_block));
+            __size = 0;
+        }
+
+    public:
+        size_t size()         const noexcept {return __size;}
+        size_t block_count()  const noexcept {return __block_count;}
+        size_t hash_count()   const noexcept {return size_t(1) << __k_log;}
+        size_t memory_bytes() const noexcept {return __block_count * sizeof(__bloom_block);}
+
+        // 按当前插入次数估算的误报率
+        double expected_fpr() const noexcept
+        {
+            if(__size == 0) return 0;
+            return __model_fpr(static_cast<double>(__block_count) * __block_bits / static_cast<double>(__size), __k_log);
+        }
+
+    private:
+        __bloom_block*& __raw() noexcept          {return __raw_hash.first();}
+        const Hash&     __hasher() const noexcept {return __raw_hash.second();}
+
+        // 高32位定位块, 低32位选择块内的位
+        uint64_t __key_hash(const Key& key) const noexcept
+        {
+            return __hash_mix(static_cast<uint64_t>(__hasher()(key)));
+        }
+
+        __bloom_block* __block_of(uint64_t h) const noexcept
+        {
+            return __blocks + __filter_range(static_cast<uint32_t>(h >> 32), __block_count);
+        }
+
+        void __insert_hash(uint64_t h) noexcept
+        {
+            __bloom_block* b = __block_of(h);
+            uint32_t x = static_cast<uint32_t>(h);
+#if defined(__AVX2__)
+            __m256i lo, hi;
+            __masks(x, lo, hi);
+            __m256i* w = reinterpret_cast<__m256i*>(b->words);
+            _mm256_store_si256(w, _mm256_or_si256(_mm256_load_si256(w), lo));
+            _mm256_store_si256(w + 1, _mm256_or_si256(_mm256_load_si256(w + 1), hi));
+#else
+            alignas(16) uint32_t m[16];
+            __masks(x, m);
+            for(int j = 0; j < 16; j++) b->words[j] |= m[j];
+#endif
+            ++__size;
+        }
+
+        bool __contains_hash(uint64_t h) const noexcept
+        {
+            const __bloom_block* b = __block_of(h);
+            uint32_t x = static_cast<uint32_t>(h);
+#if defined(__AVX2__)
+            __m256i lo, hi;
+            __masks(x, lo, hi);
+            const __m256i* w = reinterpret_cast<const __m256i*>(b->words);
+            // testc: (~w & m) == 0, 即m中的位在块中全部为1
+            return _mm256_testc_si256(_mm256_load_si256(w), lo) & _mm256_testc_si256(_mm256_load_si256(w + 1), hi);
+#else
+            alignas(16) uint32_t m[16];
+            __masks(x, m);
+#if defined(__SSE2__)
+            const __m128i* w = reinterpret_cast<const __m128i*>(b->words);
+            const __m128i* v = reinterpret_cast<const __m128i*>(m);
+            __m128i miss = _mm_andnot_si128(_mm_load_si128(w), _mm_load_si128(v));
+            miss = _mm_or_si128(miss, _mm_andnot_si128(_mm_load_si128(w + 1), _mm_load_si128(v + 1)));
+            miss = _mm_or_si128(miss, _mm_andnot_si128(_mm_load_si128(w + 2), _mm_load_si128(v + 2)));
+            miss = _mm_or_si128(miss, _mm_andnot_si128(_mm_load_si128(w + 3), _mm_load_si128(v + 3)));
+            return _mm_movemask_epi8(_mm_cmpeq_epi32(miss, _mm_setzero_si128())) == 0xffff;
+#else
+            uint32_t miss = 0;
+            for(int j = 0; j < 16; j++) miss |= m[j] & ~b->words[j];
+            return miss == 0;
+#endif
+#endif
+        }
+
+        // 第j个字的掩码: 扇区内的位置 p = (x * salt) >> (32 - log2(扇区位数)), p落在第j个字时置 1 << (p & 31)
+#if defined(__AVX2__)
+        void __masks(uint32_t x, __m256i& lo, __m256i& hi) const noexcept
+        {
+            const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(32 - (9 - __k_log)));
+            const __m256i h = _mm256_set1_epi32(static_cast<int>(x));
+            const __m256i one = _mm256_set1_epi32(1);
+            const __m256i low5 = _mm256_set1_epi32(31);
+            __m256i r[2];
+            for(int half = 0; half < 2; half++)
+            {
+                __m256i salt = _mm256_load_si256(reinterpret_cast<const __m256i*>(__salt + 8 * half));
+                __m256i lane = _mm256_load_si256(reinterpret_cast<const __m256i*>(__lane + 8 * half));
+                __m256i p = _mm256_srl_epi32(_mm256_mullo_epi32(h, salt), shift);
+                __m256i bit = _mm256_sllv_epi32(one, _mm256_and_si256(p, low5));
+                r[half] = _mm256_and_si256(bit, _mm256_cmpeq_epi32(_mm256_srli_epi32(p, 5), lane));
+            }
+            lo = r[0];
+            hi = r[1];
+        }
+#else
+        // 没有AVX2时逐字计算需要16次乘法和变长移位, 只算k个扇区各自的那一位
+        void __masks(uint32_t x, uint32_t* m) const noexcept
+        {
+            const uint32_t shift = 32 - (9 - __k_log);
+            const uint32_t words_per_sector = 16u >> __k_log;
+            for(int j = 0; j < 16; j++) m[j] = 0;
+            for(uint32_t s = 0; s < (1u << __k_log); s++)
+            {
+                uint32_t p = (x * __bloom_salts[s]) >> shift;
+                m[s * words_per_sector + (p >> 5)] |= uint32_t(1) << (p & 31);
+            }
+        }
+#endif
+
+        void __init_lanes() noexcept
+        {
+            uint32_t words_per_sector = 16u >> __k_log;
+            for(uint32_t j = 0; j < 16; j++)
+            {
+                __salt[j] = __bloom_salts[j / words_per_sector];
+                __lane[j] = j & (words_per_sector - 1);
+            }
+        }
+
+        // 块地址按64字节对齐: 多分配一个块, 从第一个对齐的位置开始用
+        void __allocate()
+        {
+            __raw() = block_allocator::allocate(__block_count + 1);
+            uintptr_t p = (reinterpret_cast<uintptr_t>(__raw()) + 63) & ~uintptr_t(63);
+            __blocks = reinterpret_cast<__bloom_block*>(p);
+            std::memset(__blocks, 0, __block_count * sizeof(__bloom_block));
+        }
+
+        /**
+         * @brief 每个key平均占 bits_per_key 位时的误报率
+         * 块内key数服从 λ = 512 / bits_per_key 的泊松分布; 块内有i个key时, 扇区中某一位被置的概率是 1 - (1 - 1/b)^i
+         */
+        static double __model_fpr(double bits_per_key, uint32_t k_log) noexcept
+        {
+            const double k = static_cast<double>(1u << k_log);
+            const double sector = __block_bits / k;
+            const double lambda = __block_bits / bits_per_key;
+            const double stay = 1 - 1 / sector;
+            const size_t last = static_cast<size_t>(lambda + 12 * std::sqrt(lambda) + 32);
+            double p = std::exp(-lambda);   // P(i个key)
+            double fpr = 0;
+            for(size_t i = 1; i <= last; i++)
+            {
+                p *= lambda / static_cast<double>(i);
+                fpr += p * std::pow(1 - std::pow(stay, static_cast<double>(i)), k);
+            }
+            return fpr;
+        }
+
+        // 对每个k二分最少的每key位数, 返回其中最小的, 并设置k_log
+        static double __choose(double fpr, uint32_t& k_log) noexcept
+        {
+            double best = __max_bits_per_key;
+            k_log = 3;
+            for(uint32_t kl = 0; kl <= 4; kl++)
+            {
+                if(__model_fpr(__max_bits_per_key, kl) > fpr) continue;
+                double lo = 1, hi = __max_bits_per_key;
+                while(hi - lo > 0.05)
+                {
+                    double mid = (lo + hi) / 2;
+                    if(__model_fpr(mid, kl) <= fpr) hi = mid;
+                    else lo = mid;
+                }
+                if(hi < best)
+                {
+                    best = hi;
+                    k_log = kl;
+                }
+            }
+            return best;
+        }
+    };
+
+    /*************************************************************************************/
+    /*                                  cuckoo_filter                                    */
+    /*************************************************************************************/
+
+    // 按小端序读写8个字节, 桶按位排列时相邻的桶共享字节
+    inline uint64_t __filter_load64(const unsigned char* p) noexcept
+    {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = __builtin_bswap64(v);
+#endif
+        return v;
+    }
+
+    inline void __filter_store64(unsigned char* p, uint64_t v) noexcept
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = __builtin_bswap64(v);
+#endif
+        std::memcpy(p, &v, sizeof(v));
+    }
+
+    /**
+     * @brief cuckoo_filter
+     * 每个桶4个指纹, 指纹f位 (4 <= f <= 16, 偶数), 一个桶正好 f/2 个字节; 指纹0表示空槽
+     * key的两个候选桶: i1由哈希决定, i2 = (H(fp) - i1) mod n; 这是对合映射, 只凭指纹和一个桶号就能算出另一个
+     * 桶数n不必是2的幂 (i1 ^ H(fp) 要求2的幂, 最坏时一半内存空着), 按容量和 __max_load 取最小的n
+     * 两个桶都满时随机踢出一个指纹到它的另一个桶, 最多 __max_kicks 次; 仍然失败时最后被踢出的指纹放进victim,
+     * 之后的insert返回false (已插入的key不会丢失)
+     * 只能erase插入过的key, 否则可能删掉另一个key的指纹
+     */
+    template <class Key, class Hash = std::hash<Key>>
+    class cuckoo_filter
+    {
+    public:
+        typedef Key     key_type;
+        typedef Hash    hasher;
+        typedef size_t  size_type;
+
+    private:
+        typedef mySTL::allocator<unsigned char> byte_allocator;
+
+        static constexpr size_t   __slots = 4;
+        static constexpr size_t   __max_kicks = 500;
+        static constexpr double   __max_load = 0.95;
+
+        unsigned char*  __table;
+        size_t          __bucket_count;     // 小于2^32, 桶号用32位的fastrange得到
+        size_t          __size;
+        uint32_t        __bits;             // 指纹位数
+        uint64_t        __lo;               // 每个槽的最低位为1
+        uint64_t        __hi;               // 每个槽的最高位为1
+        uint64_t        __bucket_mask;      // 低 4f 位为1
+        size_t          __victim_index;
+        uint32_t        __victim_fp;        // 0表示没有victim
+        // 换出用的随机数状态 + hasher, 无状态的Hash通过EBO不占空间
+        compressed_pair<uint64_t, Hash> __rng_hash;
+
+    public:
+        /**
+         * @param capacity 预计的最大key数
+         * @param fpr      目标误报率, 满载时约为 8 / 2^f
+         */
+        explicit cuckoo_filter(size_t capacity, double fpr = 0.01, const Hash& hash = Hash())
+            : __table(nullptr), __bucket_count(1), __size(0), __bits(0), __victim_index(0), __victim_fp(0),
+              __rng_hash(0x9e3779b97f4a7c15ull, hash)
+        {
+            if(!(fpr > 0 && fpr < 1)) throw std::invalid_argument("cuckoo_filter: fpr must be in (0, 1)");
+            double f = std::ceil(std::log2(2.0 * __slots / fpr));
+            __bits = f < 4 ? 4 : f > 16 ? 16 : static_cast<uint32_t>(f);
+            __bits += __bits & 1;
+            double buckets = std::ceil(static_cast<double>(capacity) / (__slots * __max_load));
+            if(buckets > 4294967295.0) throw std::length_error("cuckoo_filter: capacity too large");
+            __bucket_count = buckets < 1 ? 1 : static_cast<size_t>(buckets);
+            __init_masks();
+            __allocate();
+        }
+
+        cuckoo_filter(const cuckoo_filter& other)
+            : __table(nullptr), __bucket_count(other.__bucket_count), __size(other.__size), __bits(other.__bits),
+              __victim_index(other.__victim_index), __victim_fp(other.__victim_fp),
+              __rng_hash(other.__rng_hash)
+        {
+            __init_masks();
+            __allocate();
+            std::memcpy(__table, other.__table, __table_bytes());
+        }
+
+        cuckoo_filter(cuckoo_filter&& other) noexcept
+            : __table(other.__table), __bucket_count(other.__bucket_count), __size(other.__size),
+              __bits(other.__bits), __lo(other.__lo), __hi(other.__hi), __bucket_mask(other.__bucket_mask),
+              __victim_index(other.__victim_index), __victim_fp(other.__victim_fp),
+              __rng_hash(other.__rng_hash)
+        {
+            other.__table = nullptr;
+            other.__size = 0;
+            other.__victim_fp = 0;
+        }
+
+        cuckoo_filter& operator=(cuckoo_filter other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~cuckoo_filter() {byte_allocator::deallocate(__table, __table_bytes());}
+
+        void swap(cuckoo_filter& other) noexcept
+        {
+            mySTL::swap(__table, other.__table);
+            mySTL::swap(__bucket_count, other.__bucket_count);
+            mySTL::swap(__size, other.__size);
+            mySTL::swap(__bits, other.__bits);
+            mySTL::swap(__lo, other.__lo);
+            mySTL::swap(__hi, other.__hi);
+            mySTL::swap(__bucket_mask, other.__bucket_mask);
+            mySTL::swap(__victim_index, other.__victim_index);
+            mySTL::swap(__victim_fp, other.__victim_fp);
+            __rng_hash.swap(other.__rng_hash);
+        }
+
+    public:
+        // 过滤器已满 (存在victim) 时返回false, 此时key没有插入
+        bool insert(const Key& key)
+        {
+            if(__victim_fp) return false;
+            size_t i;
+            uint32_t fp;
+            __index_fp(__key_hash(key), i, fp);
+            ++__size;
+            __insert_fp(i, fp);
+            return true;
+        }
+
+        bool contains(const Key& key) const noexcept
+        {
+            size_t i;
+            uint32_t fp;
+            __index_fp(__key_hash(key), i, fp);
+            return __contains_fp(i, fp);
+        }
+
+        // 删除key的一个指纹; key必须插入过
+        bool erase(const Key& key) noexcept
+        {
+            size_t i;
+            uint32_t fp;
+            __index_fp(__key_hash(key), i, fp);
+            size_t j = __alt_index(i, fp);
+            if(__erase_in(i, fp) || __erase_in(j, fp))
+            {
+                --__size;
+                // 腾出了位置, 把victim放回表中
+                if(__victim_fp)
+                {
+                    uint32_t vfp = __victim_fp;
+                    __victim_fp = 0;
+                    __insert_fp(__victim_index, vfp);
+                }
+                return true;
+            }
+            if(__victim_fp == fp && (__victim_index == i || __victim_index == j))
+            {
+                __victim_fp = 0;
+                --__size;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief 批量查询, 每组预取每个key的两个候选桶
+         * @return 可能存在的个数, found[i]表示keys[i]可能存在
+         */
+        size_t contains_many(const Key* keys, size_t n, bool* found) const noexcept
+        {
+            size_t index[__filter_batch];
+            uint32_t fps[__filter_batch];
+            size_t hit = 0;
+            for(size_t base = 0; base < n; base += __filter_batch)
+            {
+                size_t m = n - base < __filter_batch ? n - base : __filter_batch;
+                for(size_t k = 0; k < m; k++)
+                {
+                    __index_fp(__key_hash(keys[base + k]), index[k], fps[k]);
+                    mySTL::prefetch(__bucket_ptr(index[k]));
+                    mySTL::prefetch(__bucket_ptr(__alt_index(index[k], fps[k])));
+                }
+                for(size_t k = 0; k < m; k++)
+                {
+                    found[base + k] = __contains_fp(index[k], fps[k]);
+                    hit += found[base + k];
+                }
+            }
+            return hit;
+        }
+
+        void clear() noexcept
+        {
+            std::memset(__table, 0, __table_bytes());
+            __size = 0;
+            __victim_fp = 0;
+        }
+
+    public:
+        size_t size()             const noexcept {return __size;}
+        bool   empty()            const noexcept {return __size == 0;}
+        size_t bucket_count()     const noexcept {return __bucket_count;}
+        size_t slot_count()       const noexcept {return __bucket_count * __slots;}
+        size_t fingerprint_bits() const noexcept {return __bits;}
+        size_t memory_bytes()     const noexcept {return __table_bytes();}
+        double load_factor()      const noexcept {return static_cast<double>(__size) / static_cast<double>(slot_count());}
+
+        // 当前负载下的误报率: 查询两个桶共 8 * load 个非空槽, 每个以 1/(2^f - 1) 的概率撞上指纹
+        double expected_fpr() const noexcept
+        {
+            double probes = 2.0 * __slots * load_factor();
+            return 1 - std::pow(1 - 1 / static_cast<double>((uint32_t(1) << __bits) - 1), probes);
+        }
+
+    private:
+        const Hash& __hasher() const noexcept {return __rng_hash.second();}
+
+        uint64_t __key_hash(const Key& key) const noexcept
+        {
+            return __hash_mix(static_cast<uint64_t>(__hasher()(key)));
+        }
+
+        // 低32位定桶, 高32位取指纹
+        void __index_fp(uint64_t h, size_t& i, uint32_t& fp) const noexcept
+        {
+            i = __filter_range(static_cast<uint32_t>(h), __bucket_count);
+            fp = static_cast<uint32_t>(h >> 32) & ((uint32_t(1) << __bits) - 1);
+            fp += fp == 0;
+        }
+
+        size_t __alt_index(size_t i, uint32_t fp) const noexcept
+        {
+            uint64_t n = __bucket_count;
+            uint64_t t = static_cast<uint32_t>(fp * 0x5bd1e995u) % n + n - i;
+            return static_cast<size_t>(t >= n ? t - n : t);
+        }
+
+        // 桶i占用的字节: [i * f/2, (i+1) * f/2), 表尾多留8个字节, 读写总是8个字节
+        size_t __table_bytes() const noexcept {return __bucket_count * __bits / 2 + sizeof(uint64_t);}
+
+        const unsigned char* __bucket_ptr(size_t i) const noexcept {return __table + i * (__bits / 2);}
+        unsigned char* __bucket_ptr(size_t i) noexcept {return __table + i * (__bits / 2);}
+
+        uint64_t __load(size_t i) const noexcept {return __filter_load64(__bucket_ptr(i)) & __bucket_mask;}
+
+        void __store(size_t i, uint64_t bucket) noexcept
+        {
+            unsigned char* p = __bucket_ptr(i);
+            __filter_store64(p, (__filter_load64(p) & ~__bucket_mask) | bucket);
+        }
+
+        // 值为0的槽对应的最高位为1, 其余为0 (只有最低的那个0槽是精确的, 用来判断有无和定位第一个)
+        uint64_t __zero_slots(uint64_t x) const noexcept {return (x - __lo) & ~x & __hi;}
+
+        uint64_t __match(uint64_t bucket, uint32_t fp) const noexcept {return __zero_slots(bucket ^ (__lo * fp));}
+
+        bool __contains_fp(size_t i, uint32_t fp) const noexcept
+        {
+            size_t j = __alt_index(i, fp);
+            bool found = (__match(__load(i), fp) | __match(__load(j), fp)) != 0;
+            return found || (__victim_fp == fp && (__victim_index == i || __victim_index == j));
+        }
+
+        bool __try_place(size_t i, uint32_t fp) noexcept
+        {
+            uint64_t bucket = __load(i);
+            uint64_t empty = __zero_slots(bucket);
+            if(!empty) return false;
+            uint32_t shift = static_cast<uint32_t>(mySTL::__filter_ctz(empty)) + 1 - __bits;
+            __store(i, bucket | (static_cast<uint64_t>(fp) << shift));
+            return true;
+        }
+
+        bool __erase_in(size_t i, uint32_t fp) noexcept
+        {
+            uint64_t bucket = __load(i);
+            uint64_t hit = __match(bucket, fp);
+            if(!hit) return false;
+            uint32_t shift = static_cast<uint32_t>(mySTL::__filter_ctz(hit)) + 1 - __bits;
+            __store(i, bucket & ~(((uint64_t(1) << __bits) - 1) << shift));
+            return true;
+        }
+
+        void __insert_fp(size_t i, uint32_t fp) noexcept
+        {
+            if(__try_place(i, fp)) return;
+            i = __alt_index(i, fp);
+            if(__try_place(i, fp)) return;
+            for(size_t kick = 0; kick < __max_kicks; kick++)
+            {
+                // 随机换出一个槽, 被换出的指纹去它的另一个桶
+                uint64_t& rng = __rng_hash.first();
+                rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+                uint32_t shift = static_cast<uint32_t>(rng & (__slots - 1)) * __bits;
+                uint64_t bucket = __load(i);
+                uint32_t old = static_cast<uint32_t>(bucket >> shift) & ((uint32_t(1) << __bits) - 1);
+                bucket &= ~(((uint64_t(1) << __bits) - 1) << shift);
+                __store(i, bucket | (static_cast<uint64_t>(fp) << shift));
+                fp = old;
+                i = __alt_index(i, fp);
+                if(__try_place(i, fp)) return;
+            }
+            __victim_index = i;
+            __victim_fp = fp;
+        }
+
+        void __init_masks() noexcept
+        {
+            __lo = 0;
+            for(size_t s = 0; s < __slots; s++) __lo |= uint64_t(1) << (s * __bits);
+            __hi = __lo << (__bits - 1);
+            __bucket_mask = __bits * __slots == 64 ? ~uint64_t(0) : (uint64_t(1) << (__bits * __slots)) - 1;
+        }
+
+        void __allocate()
+        {
+            __table = byte_allocator::allocate(__table_bytes());
+            std::memset(__table, 0, __table_bytes());
+        }
+    };
+
+    template <class Key, class Hash>
+    inline void swap(blocked_bloom_filter<Key, Hash>& a, blocked_bloom_filter<Key, Hash>& b) noexcept {a.swap(b);}
+
+    template <class Key, class Hash>
+    inline void swap(cuckoo_filter<Key, Hash>& a, cuckoo_filter<Key, Hash>& b) noexcept {a.swap(b);}
+}
+#endif // __MEMBERSHIP_FILTER_H__
@@ -0,0 +1,248 @@
+#ifndef __MMAP_RESOURCE_H__
+#define __MMAP_RESOURCE_H__
+
+// 基于mmap的内存资源 (POSIX)
+// 映射一个文件 (MAP_SHARED, 多个进程共享page cache) 或者匿名内存, 可以用mremap原地扩容
+
+#include <cstddef>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "utils.h"
+
+namespace mySTL
+{
+    // 访问模式提示, 对应madvise
+    enum class mmap_advice
+    {
+        normal,
+        sequential, // 顺序访问, 内核加大预读
+        random,     // 随机访问, 关闭预读
+        willneed    // 马上要用, 异步预读全部
+    };
+
+    struct mmap_options
+    {
+        bool        populate = false;               // MAP_POPULATE: 映射时预先读入所有页
+        mmap_advice advice   = mmap_advice::normal;
+    };
+
+    /**
+     * @brief mmap_resource
+     * 文件映射的生命周期管理, 只能移动不能拷贝
+     * 映射长度与文件长度相同, resize同时修改两者; 映射地址可能在resize后改变
+     */
+    class mmap_resource
+    {
+    public:
+        enum open_mode
+        {
+            read_only,  // 只读打开已有文件
+            read_write, // 读写打开已有文件
+            create      // 读写, 不存在则创建, 已存在则清空
+        };
+
+    private:
+        int         __fd;
+        void*       __addr;
+        size_t      __size;
+        bool        __writable;
+        mmap_options __options;
+
+    public:
+        // 匿名映射, 不对应文件
+        explicit mmap_resource(size_t bytes = 0, const mmap_options& options = mmap_options())
+            : __fd(-1), __addr(nullptr), __size(0), __writable(true), __options(options)
+        {
+            resize(bytes);
+        }
+
+        mmap_resource(const char* path, open_mode mode, const mmap_options& options = mmap_options())
+            : __fd(-1), __addr(nullptr), __size(0), __writable(mode != read_only), __options(options)
+        {
+            int flags = mode == read_only ? O_RDONLY : (mode == read_write ? O_RDWR : (O_RDWR | O_CREAT | O_TRUNC));
+            __fd = ::open(path, flags | O_CLOEXEC, 0644);
+            if(__fd < 0) throw std::system_error(errno, std::generic_category(), "open");
+            struct stat st;
+            if(::fstat(__fd, &st) != 0)
+            {
+                int err = errno;
+                ::close(__fd);
+                throw std::system_error(err, std::generic_category(), "fstat");
+            }
+            try
+            {
+                __map(static_cast<size_t>(st.st_size));
+            }
+            catch(...)
+            {
+                ::close(__fd);
+                throw;
+            }
+        }
+
+        mmap_resource(const mmap_resource&) = delete;
+        mmap_resource& operator=(const mmap_resource&) = delete;
+
+        mmap_resource(mmap_resource&& other) noexcept
+            : __fd(other.__fd), __addr(other.__addr), __size(other.__size),
+              __writable(other.__writable), __options(other.__options)
+        {
+            other.__fd = -1;
+            other.__addr = nullptr;
+            other.__size = 0;
+        }
+
+        mmap_resource& operator=(mmap_resource&& other) noexcept
+        {
+            if(this != &other)
+            {
+                __release();
+                __fd = other.__fd;
+                __addr = other.__addr;
+                __size = other.__size;
+                __writable = other.__writable;
+                __options = other.__options;
+                other.__fd = -1;
+                other.__addr = nullptr;
+                other.__size = 0;
+            }
+            return *this;
+        }
+
+        ~mmap_resource() {__release();}
+
+    public:
+        void*       data()        noexcept {return __addr;}
+        const void* data()  const noexcept {return __addr;}
+        size_t      size()  const noexcept {return __size;}
+        bool        writable() const noexcept {return __writable;}
+        bool        file_backed() const noexcept {return __fd >= 0;}
+
+        // 修改映射长度 (文件映射同时修改文件长度), 尽量原地扩展, 否则整体移动映射 (不拷贝数据)
+        // 没有mremap的平台 (或定义MYSTL_MMAP_NO_MREMAP) 先建立新映射, 匿名映射的内容拷贝过去
+        // 扩大时先扩展文件, 映射失败则把文件截回原长度; 缩小时先缩小映射再截断文件, 映射失败时文件不变
+        void resize(size_t bytes)
+        {
+            if(bytes == __size) return;
+            if(!__writable) throw std::system_error(EACCES, std::generic_category(), "resize read-only mapping");
+            const size_t old_size = __size;
+            const bool grow = bytes > old_size;
+            if(grow) __truncate(bytes);
+            try
+            {
+                __remap(bytes);
+            }
+            catch(...)
+            {
+                // 扩展出的部分还没有写入过, 截回去不会丢数据; 这里失败也只能保留较长的文件
+                if(grow && __fd >= 0 && ::ftruncate(__fd, static_cast<off_t>(old_size)) != 0) {}
+                throw;
+            }
+            if(!grow) __truncate(bytes);
+        }
+
+        // 对整个映射设置访问模式提示
+        void advise(mmap_advice advice)
+        {
+            __options.advice = advice;
+            __apply_advice();
+        }
+
+        // 把修改写回文件, async为true时只发起写回
+        void sync(bool async = false)
+        {
+            if(__addr && __fd >= 0 && __writable)
+                if(::msync(__addr, __size, async ? MS_ASYNC : MS_SYNC) != 0)
+                    throw std::system_error(errno, std::generic_category(), "msync");
+        }
+
+    private:
+        void __truncate(size_t bytes)
+        {
+            if(__fd >= 0 && ::ftruncate(__fd, static_cast<off_t>(bytes)) != 0)
+                throw std::system_error(errno, std::generic_category(), "ftruncate");
+        }
+
+        // 只修改映射, 失败时保留原映射
+        void __remap(size_t bytes)
+        {
+            if(!__addr || bytes == 0)
+            {
+                if(__addr) ::munmap(__addr, __size);
+                __addr = nullptr;
+                __size = 0;
+                __map(bytes);
+                return;
+            }
+#if defined(__linux__) && !defined(MYSTL_MMAP_NO_MREMAP)
+            void* addr = ::mremap(__addr, __size, bytes, MREMAP_MAYMOVE);
+            if(addr == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mremap");
+            __addr = addr;
+            __size = bytes;
+            __apply_advice();
+#else
+            // 新映射失败时保留旧映射; 文件映射的内容就在文件里, 新映射直接可见
+            void* old_addr = __addr;
+            size_t old_size = __size;
+            __addr = nullptr;
+            __size = 0;
+            try
+            {
+                __map(bytes);
+            }
+            catch(...)
+            {
+                __addr = old_addr;
+                __size = old_size;
+                throw;
+            }
+            if(__fd < 0) std::memcpy(__addr, old_addr, old_size < bytes ? old_size : bytes);
+            ::munmap(old_addr, old_size);
+#endif
+        }
+
+        void __map(size_t bytes)
+        {
+            if(bytes == 0) return;
+            int prot  = PROT_READ | (__writable ? PROT_WRITE : 0);
+            int flags = __fd >= 0 ? MAP_SHARED : (MAP_PRIVATE | MAP_ANONYMOUS);
+#if defined(MAP_POPULATE)
+            if(__options.populate) flags |= MAP_POPULATE;
+#endif
+            void* addr = ::mmap(nullptr, bytes, prot, flags, __fd, 0);
+            if(addr == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap");
+            __addr = addr;
+            __size = bytes;
+            __apply_advice();
+        }
+
+        void __apply_advice()
+        {
+            if(!__addr) return;
+            int advice = MADV_NORMAL;
+            switch(__options.advice)
+            {
+                case mmap_advice::sequential: advice = MADV_SEQUENTIAL; break;
+                case mmap_advice::random:     advice = MADV_RANDOM;     break;
+                case mmap_advice::willneed:   advice = MADV_WILLNEED;   break;
+                default: break;
+            }
+            ::madvise(__addr, __size, advice); // 只是提示, 失败不影响正确性
+        }
+
+        void __release() noexcept
+        {
+            if(__addr) ::munmap(__addr, __size);
+            if(__fd >= 0) ::close(__fd);
+            __addr = nullptr;
+            __fd = -1;
+            __size = 0;
+        }
+    };
+}
+#endif // __MMAP_RESOURCE_H__
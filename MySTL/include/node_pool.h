@@ -0,0 +1,146 @@
+#ifndef __NODE_POOL_H__
+#define __NODE_POOL_H__
+
+// 定长对象池: 从成块分配的内存中切出固定大小的槽, 释放的槽串成空闲链表, 分配和释放都是O(1)且不调用operator new
+// 块的大小从一页左右开始倍增, 块只在池析构或release()时整体归还
+// 另外两处成块分配节点的容器不使用node_pool:
+//   list的slab: 批量插入/reserve/relayout要求一次拿到n个地址连续的节点, 并且shrink_to_fit要能单独归还空出来的slab
+//   lru_cache的节点数组: 容量固定, 节点之间用32位下标而不是指针链接, 整个数组一次分配
+
+#include <cstddef>
+#include <cassert>
+#include "allocator.h"
+#include "utils.h"
+
+namespace mySTL
+{
+    /**
+     * @brief node_pool
+     * 只管理内存, 不构造对象; 适合链表, 树等节点大小相同的容器
+     * @tparam T 槽的类型, 对齐不能超过max_align_t
+     */
+    template <class T>
+    class node_pool
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "node_pool does not support over-aligned types");
+
+    private:
+        union __slot
+        {
+            __slot* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        // 块头占用块开头的若干个槽
+        struct __block
+        {
+            __block*    next;
+            size_t      slots;     // 包括块头
+        };
+
+        typedef mySTL::allocator<__slot> slot_allocator;
+
+        static constexpr size_t __header_slots = (sizeof(__block) + sizeof(__slot) - 1) / sizeof(__slot);
+        static constexpr size_t __min_block_bytes = 4096;
+        static constexpr size_t __max_block_bytes = size_t(256) << 10;
+
+        __block*    __blocks;       // 最新的块在链表头
+        __slot*     __free;
+        __slot*     __cur;          // 当前块中还没用过的部分
+        __slot*     __cur_end;
+        size_t      __live;
+        size_t      __reserved;     // 所有块的字节数
+
+    public:
+        node_pool() noexcept
+            : __blocks(nullptr), __free(nullptr), __cur(nullptr), __cur_end(nullptr), __live(0), __reserved(0) {}
+
+        node_pool(const node_pool&) = delete;
+        node_pool& operator=(const node_pool&) = delete;
+
+        node_pool(node_pool&& other) noexcept
+            : __blocks(other.__blocks), __free(other.__free), __cur(other.__cur), __cur_end(other.__cur_end),
+              __live(other.__live), __reserved(other.__reserved)
+        {
+            other.__blocks = nullptr;
+            other.__free = other.__cur = other.__cur_end = nullptr;
+            other.__live = other.__reserved = 0;
+        }
+
+        node_pool& operator=(node_pool&& other) noexcept
+        {
+            if(this != &other)
+            {
+                release();
+                mySTL::swap(__blocks, other.__blocks);
+                mySTL::swap(__free, other.__free);
+                mySTL::swap(__cur, other.__cur);
+                mySTL::swap(__cur_end, other.__cur_end);
+                mySTL::swap(__live, other.__live);
+                mySTL::swap(__reserved, other.__reserved);
+            }
+            return *this;
+        }
+
+        ~node_pool() {release();}
+
+        // 返回未初始化的一个T大小的内存
+        T* allocate()
+        {
+            __slot* s = __free;
+            if(s) __free = s->next;
+            else
+            {
+                if(__cur == __cur_end) __new_block();
+                s = __cur++;
+            }
+            ++__live;
+            return reinterpret_cast<T*>(s->storage);
+        }
+
+        void deallocate(T* p) noexcept
+        {
+            if(!p) return;
+            __slot* s = reinterpret_cast<__slot*>(p);
+            s->next = __free;
+            __free = s;
+            --__live;
+        }
+
+        // 归还所有块, 之前分配的对象必须已经析构
+        void release() noexcept
+        {
+            while(__blocks)
+            {
+                __block* next = __blocks->next;
+                slot_allocator::deallocate(reinterpret_cast<__slot*>(__blocks), __blocks->slots);
+                __blocks = next;
+            }
+            __free = __cur = __cur_end = nullptr;
+            __live = __reserved = 0;
+        }
+
+        size_t live()           const noexcept {return __live;}
+        size_t live_bytes()     const noexcept {return __live * sizeof(__slot);}
+        size_t reserved_bytes() const noexcept {return __reserved;}
+
+    private:
+        void __new_block()
+        {
+            size_t bytes = __blocks ? __blocks->slots * sizeof(__slot) * 2 : __min_block_bytes;
+            if(bytes > __max_block_bytes) bytes = __max_block_bytes;
+            size_t slots = bytes / sizeof(__slot);
+            if(slots < __header_slots + 1) slots = __header_slots + 1;
+
+            __slot* mem = slot_allocator::allocate(slots);
+            __block* b = reinterpret_cast<__block*>(mem);
+            b->next = __blocks;
+            b->slots = slots;
+            __blocks = b;
+            __cur = mem + __header_slots;
+            __cur_end = mem + slots;
+            __reserved += slots * sizeof(__slot);
+        }
+    };
+}
+#endif // __NODE_POOL_H__
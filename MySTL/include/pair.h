@@ -1,13 +1,24 @@
 #ifndef __PAIR_H__
 #define __PAIR_H__
 
-namespace mySTL 
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include "type_traits.h"
+#include "utils.h"
+
+namespace mySTL
 {
+    // piecewise构造的标记
+    struct piecewise_construct_t { explicit piecewise_construct_t() = default; };
+    constexpr piecewise_construct_t piecewise_construct = piecewise_construct_t();
+
     /**
-     * @brief pair 
+     * @brief pair
      * 保存2种不同类型数据
-     * @tparam T1 
-     * @tparam T2 
+     * 拷贝/移动构造和赋值都是默认的, 两个成员都平凡可拷贝时pair也平凡可拷贝
+     * @tparam T1
+     * @tparam T2
      */
     template <class T1, class T2>
     struct pair
@@ -18,10 +29,166 @@ namespace mySTL
         first_type  first;    // 保存第一个数据
         second_type second;   // 保存第二个数据
 
-        // default constructor
-        
+        // default constructor, 值初始化两个成员
+        constexpr pair() : first(), second() {}
+
+        constexpr pair(const T1& a, const T2& b) : first(a), second(b) {}
+
+        // 完美转发构造
+        template <class U1, class U2, class = typename mySTL::enable_if<
+            mySTL::is_constructible<T1, U1&&>::value && mySTL::is_constructible<T2, U2&&>::value>::type>
+        constexpr pair(U1&& a, U2&& b)
+            : first(mySTL::forward<U1>(a)), second(mySTL::forward<U2>(b)) {}
+
+        // 从其他类型的pair转换
+        template <class U1, class U2, class = typename mySTL::enable_if<
+            mySTL::is_constructible<T1, const U1&>::value && mySTL::is_constructible<T2, const U2&>::value>::type>
+        constexpr pair(const pair<U1, U2>& other) : first(other.first), second(other.second) {}
+
+        template <class U1, class U2, class = typename mySTL::enable_if<
+            mySTL::is_constructible<T1, U1&&>::value && mySTL::is_constructible<T2, U2&&>::value>::type>
+        constexpr pair(pair<U1, U2>&& other)
+            : first(mySTL::forward<U1>(other.first)), second(mySTL::forward<U2>(other.second)) {}
+
+        // 分别用两个tuple里的参数就地构造first和second
+        template <class... Args1, class... Args2>
+        pair(piecewise_construct_t, std::tuple<Args1...> args1, std::tuple<Args2...> args2)
+            : pair(args1, args2, std::index_sequence_for<Args1...>(), std::index_sequence_for<Args2...>()) {}
+
+        pair(const pair&) = default;
+        pair(pair&&) = default;
+        pair& operator=(const pair&) = default;
+        pair& operator=(pair&&) = default;
+
+        template <class U1, class U2>
+        pair& operator=(const pair<U1, U2>& other)
+        {
+            first = other.first;
+            second = other.second;
+            return *this;
+        }
+
+        template <class U1, class U2>
+        pair& operator=(pair<U1, U2>&& other)
+        {
+            first = mySTL::forward<U1>(other.first);
+            second = mySTL::forward<U2>(other.second);
+            return *this;
+        }
+
+        void swap(pair& other)
+        {
+            mySTL::swap(first, other.first);
+            mySTL::swap(second, other.second);
+        }
+
+    private:
+        template <class Tuple1, class Tuple2, size_t... I1, size_t... I2>
+        pair(Tuple1& args1, Tuple2& args2, std::index_sequence<I1...>, std::index_sequence<I2...>)
+            : first(mySTL::forward<typename std::tuple_element<I1, Tuple1>::type>(std::get<I1>(args1))...),
+              second(mySTL::forward<typename std::tuple_element<I2, Tuple2>::type>(std::get<I2>(args2))...) {}
+    };
+
+    // 比较操作, 按字典序
+    template <class T1, class T2>
+    constexpr bool operator==(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs)
+    {return lhs.first == rhs.first && lhs.second == rhs.second;}
+
+    template <class T1, class T2>
+    constexpr bool operator!=(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs)
+    {return !(lhs == rhs);}
+
+    template <class T1, class T2>
+    constexpr bool operator<(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs)
+    {return lhs.first < rhs.first || (!(rhs.first < lhs.first) && lhs.second < rhs.second);}
+
+    template <class T1, class T2>
+    constexpr bool operator>(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs)
+    {return rhs < lhs;}
+
+    template <class T1, class T2>
+    constexpr bool operator<=(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs)
+    {return !(rhs < lhs);}
+
+    template <class T1, class T2>
+    constexpr bool operator>=(const pair<T1, T2>& lhs, const pair<T1, T2>& rhs)
+    {return !(lhs < rhs);}
+
+    template <class T1, class T2>
+    void swap(pair<T1, T2>& lhs, pair<T1, T2>& rhs)
+    {
+        lhs.swap(rhs);
+    }
+
+    // make_pair, 参数类型退化 (数组->指针, 去掉引用和cv)
+    template <class T1, class T2>
+    constexpr pair<typename mySTL::decay<T1>::type, typename mySTL::decay<T2>::type>
+    make_pair(T1&& a, T2&& b)
+    {
+        return pair<typename mySTL::decay<T1>::type, typename mySTL::decay<T2>::type>(
+            mySTL::forward<T1>(a), mySTL::forward<T2>(b));
+    }
+
+    /**
+     * @brief compressed_pair
+     * 与pair相同的两个成员, 但空类 (无状态的allocator/hasher/comparator) 通过
+     * 空基类优化 (EBO) 不占空间, 通过first()/second()访问
+     */
+    template <class T, size_t Index, bool = mySTL::is_empty<T>::value && !mySTL::is_final<T>::value>
+    class __compressed_pair_elem
+    {
+    public:
+        constexpr __compressed_pair_elem() : __value() {}
+        template <class U>
+        constexpr explicit __compressed_pair_elem(U&& u) : __value(mySTL::forward<U>(u)) {}
+
+        T&       get() noexcept       {return __value;}
+        const T& get() const noexcept {return __value;}
+
+    private:
+        T __value;
+    };
+
+    // 空类: 继承而不是持有成员
+    template <class T, size_t Index>
+    class __compressed_pair_elem<T, Index, true> : private T
+    {
+    public:
+        constexpr __compressed_pair_elem() : T() {}
+        template <class U>
+        constexpr explicit __compressed_pair_elem(U&& u) : T(mySTL::forward<U>(u)) {}
+
+        T&       get() noexcept       {return *this;}
+        const T& get() const noexcept {return *this;}
+    };
+
+    template <class T1, class T2>
+    class compressed_pair : private __compressed_pair_elem<T1, 0>,
+                            private __compressed_pair_elem<T2, 1>
+    {
+        typedef __compressed_pair_elem<T1, 0> base1;
+        typedef __compressed_pair_elem<T2, 1> base2;
+
+    public:
+        typedef T1 first_type;
+        typedef T2 second_type;
+
+        constexpr compressed_pair() : base1(), base2() {}
+
+        template <class U1, class U2>
+        constexpr compressed_pair(U1&& a, U2&& b)
+            : base1(mySTL::forward<U1>(a)), base2(mySTL::forward<U2>(b)) {}
 
+        T1&       first() noexcept        {return base1::get();}
+        const T1& first() const noexcept  {return base1::get();}
+        T2&       second() noexcept       {return base2::get();}
+        const T2& second() const noexcept {return base2::get();}
 
+        void swap(compressed_pair& other)
+        {
+            mySTL::swap(first(), other.first());
+            mySTL::swap(second(), other.second());
+        }
     };
 }
-#endif // __PAIR_H__
\ No newline at end of file
+#endif // __PAIR_H__
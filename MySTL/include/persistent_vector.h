@@ -0,0 +1,690 @@
+#ifndef __PERSISTENT_VECTOR_H__
+#define __PERSISTENT_VECTOR_H__
+
+// 持久化vector: 32叉的位划分trie (下标每5位选一层), 加上最多32个元素的尾部叶子
+// 复制只增加根和尾部的引用计数, O(1); 修改沿路径复制被共享的节点, O(log32 n), 其余子树和旧版本共享
+// 节点只有一个引用时直接原地修改: transient_vector的连续修改只在第一次经过某条路径时复制
+// 引用计数是原子的, 不同线程可以各自持有和释放同一棵树的不同版本
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include "allocator.h"
+#include "construct.h"
+#include "iterator.h"
+#include "utils.h"
+
+namespace mySTL
+{
+    static constexpr unsigned __pv_bits  = 5;
+    static constexpr size_t   __pv_width = size_t(1) << __pv_bits;
+    static constexpr size_t   __pv_mask  = __pv_width - 1;
+
+    struct __pv_node
+    {
+        std::atomic<uint32_t>   refs;
+        uint32_t                count;      // 叶子中已构造的元素数, 内部节点不用
+
+        __pv_node() noexcept : refs(1), count(0) {}
+    };
+
+    struct __pv_inner : __pv_node
+    {
+        __pv_node* children[__pv_width];
+    };
+
+    template <class T>
+    struct __pv_leaf : __pv_node
+    {
+        alignas(T) unsigned char storage[sizeof(T) * __pv_width];
+
+        T*       data()       noexcept {return reinterpret_cast<T*>(storage);}
+        const T* data() const noexcept {return reinterpret_cast<const T*>(storage);}
+    };
+
+    template <class T> class persistent_vector;
+    template <class T> class transient_vector;
+
+    /**
+     * @brief __pvector_base
+     * persistent_vector和transient_vector共用的树结构, 所有修改都是写时复制:
+     * 从根往下, 引用计数为1的节点 (只被这个版本引用) 原地修改, 否则先复制再修改
+     */
+    template <class T>
+    class __pvector_base
+    {
+    public:
+        typedef T           value_type;
+        typedef const T*    const_pointer;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        // 只读的随机访问迭代器, 缓存当前叶子, 顺序遍历时每32个元素才走一次树
+        class const_iterator : public mySTL::iterator<mySTL::random_access_iterator_tag, T, ptrdiff_t, const T*, const T&>
+        {
+        private:
+            const __pvector_base*   __vec;
+            size_t                  __i;
+            const T*                __block;    // 下标__i所在叶子的第一个元素
+
+            void __refresh() noexcept {__block = __i < __vec->__size ? __vec->__leaf_for(__i) : nullptr;}
+
+        public:
+            typedef const T*    pointer;
+            typedef const T&    reference;
+
+            const_iterator() noexcept : __vec(nullptr), __i(0), __block(nullptr) {}
+            const_iterator(const __pvector_base* vec, size_t i) noexcept : __vec(vec), __i(i) {__refresh();}
+
+            reference operator*()  const noexcept {return __block[__i & __pv_mask];}
+            pointer   operator->() const noexcept {return &__block[__i & __pv_mask];}
+            reference operator[](difference_type n) const noexcept {return (*__vec)[__i + n];}
+
+            const_iterator& operator++() noexcept
+            {
+                if((++__i & __pv_mask) == 0) __refresh();
+                return *this;
+            }
+            const_iterator& operator--() noexcept
+            {
+                // 从end()往回走时__block可能为空
+                if((--__i & __pv_mask) == __pv_mask || !__block) __refresh();
+                return *this;
+            }
+            const_iterator  operator++(int) noexcept {const_iterator tmp = *this; ++*this; return tmp;}
+            const_iterator  operator--(int) noexcept {const_iterator tmp = *this; --*this; return tmp;}
+
+            const_iterator& operator+=(difference_type n) noexcept {__i += n; __refresh(); return *this;}
+            const_iterator& operator-=(difference_type n) noexcept {__i -= n; __refresh(); return *this;}
+            const_iterator  operator+(difference_type n)  const noexcept {const_iterator tmp = *this; return tmp += n;}
+            const_iterator  operator-(difference_type n)  const noexcept {const_iterator tmp = *this; return tmp -= n;}
+            difference_type operator-(const const_iterator& other) const noexcept
+            {
+                return static_cast<difference_type>(__i) - static_cast<difference_type>(other.__i);
+            }
+
+            bool operator==(const const_iterator& other) const noexcept {return __i == other.__i;}
+            bool operator!=(const const_iterator& other) const noexcept {return __i != other.__i;}
+            bool operator<(const const_iterator& other)  const noexcept {return __i < other.__i;}
+            bool operator>(const const_iterator& other)  const noexcept {return __i > other.__i;}
+            bool operator<=(const const_iterator& other) const noexcept {return __i <= other.__i;}
+            bool operator>=(const const_iterator& other) const noexcept {return __i >= other.__i;}
+        };
+
+        typedef const_iterator iterator;
+
+    protected:
+        typedef __pv_leaf<T>                    leaf;
+        typedef mySTL::allocator<leaf>          leaf_allocator;
+        typedef mySTL::allocator<__pv_inner>    inner_allocator;
+
+        __pv_node*  __root;     // trie, 保存下标 [0, __tail_offset()) 的元素; 为空时是nullptr
+        __pv_node*  __tail;     // 最后不满32个 (或正好32个) 元素, size为0时是nullptr
+        size_t      __size;
+        unsigned    __shift;    // 根节点那一层的下标位移, 至少为5
+
+    public:
+        __pvector_base() noexcept : __root(nullptr), __tail(nullptr), __size(0), __shift(__pv_bits) {}
+
+        // 共享整棵树
+        __pvector_base(const __pvector_base& other) noexcept
+            : __root(other.__root), __tail(other.__tail), __size(other.__size), __shift(other.__shift)
+        {
+            __retain(__root);
+            __retain(__tail);
+        }
+
+        __pvector_base(__pvector_base&& other) noexcept
+            : __root(other.__root), __tail(other.__tail), __size(other.__size), __shift(other.__shift)
+        {
+            other.__reset();
+        }
+
+        ~__pvector_base() {__clear();}
+
+        size_type size()  const noexcept {return __size;}
+        bool      empty() const noexcept {return __size == 0;}
+
+        const_reference operator[](size_type i) const noexcept
+        {
+            assert(i < __size);
+            return __leaf_for(i)[i & __pv_mask];
+        }
+
+        const_reference at(size_type i) const
+        {
+            if(i >= __size) throw std::out_of_range("persistent_vector::at");
+            return (*this)[i];
+        }
+
+        const_reference front() const noexcept {return (*this)[0];}
+        const_reference back()  const noexcept {return (*this)[__size - 1];}
+
+        const_iterator begin()  const noexcept {return const_iterator(this, 0);}
+        const_iterator end()    const noexcept {return const_iterator(this, __size);}
+        const_iterator cbegin() const noexcept {return begin();}
+        const_iterator cend()   const noexcept {return end();}
+
+        // 两个版本共享同一棵树 (比如一个是另一个的快照, 之后都没有修改)
+        bool shares_with(const __pvector_base& other) const noexcept
+        {
+            return __root == other.__root && __tail == other.__tail && __size == other.__size;
+        }
+
+    protected:
+        void __reset() noexcept
+        {
+            __root = __tail = nullptr;
+            __size = 0;
+            __shift = __pv_bits;
+        }
+
+        void __clear() noexcept
+        {
+            __release(__root, __shift);
+            __release(__tail, 0);
+            __reset();
+        }
+
+        void __assign(const __pvector_base& other) noexcept
+        {
+            __retain(other.__root);
+            __retain(other.__tail);
+            __clear();
+            __root = other.__root;
+            __tail = other.__tail;
+            __size = other.__size;
+            __shift = other.__shift;
+        }
+
+        void __swap(__pvector_base& other) noexcept
+        {
+            mySTL::swap(__root, other.__root);
+            mySTL::swap(__tail, other.__tail);
+            mySTL::swap(__size, other.__size);
+            mySTL::swap(__shift, other.__shift);
+        }
+
+        size_t __tail_offset() const noexcept {return __size < __pv_width ? 0 : ((__size - 1) >> __pv_bits) << __pv_bits;}
+
+        // 下标i所在叶子的元素数组
+        const T* __leaf_for(size_t i) const noexcept
+        {
+            if(i >= __tail_offset()) return static_cast<const leaf*>(__tail)->data();
+            const __pv_node* n = __root;
+            for(unsigned level = __shift; level > 0; level -= __pv_bits)
+                n = static_cast<const __pv_inner*>(n)->children[(i >> level) & __pv_mask];
+            return static_cast<const leaf*>(n)->data();
+        }
+
+        /*** 引用计数 ***/
+
+        static void __retain(__pv_node* n) noexcept
+        {
+            if(n) n->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // level为0表示叶子
+        static void __release(__pv_node* n, unsigned level) noexcept
+        {
+            if(!n || n->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            if(level == 0)
+            {
+                leaf* l = static_cast<leaf*>(n);
+                mySTL::destroy(l->data(), l->data() + l->count);
+                l->~leaf();
+                leaf_allocator::deallocate(l);
+                return;
+            }
+            __pv_inner* in = static_cast<__pv_inner*>(n);
+            for(size_t i = 0; i < __pv_width; i++) __release(in->children[i], level - __pv_bits);
+            in->~__pv_inner();
+            inner_allocator::deallocate(in);
+        }
+
+        // 引用计数为1时只有当前版本能访问这个节点 (沿着已经独占的路径到达), 可以原地修改
+        static bool __unique(const __pv_node* n) noexcept {return n->refs.load(std::memory_order_acquire) == 1;}
+
+        /*** 节点分配 ***/
+
+        static __pv_inner* __new_inner()
+        {
+            return ::new (static_cast<void*>(inner_allocator::allocate(1))) __pv_inner();    // 子节点全为空
+        }
+
+        static leaf* __new_leaf()
+        {
+            return ::new (static_cast<void*>(leaf_allocator::allocate(1))) leaf;
+        }
+
+        static void __free_leaf(leaf* l) noexcept
+        {
+            l->~leaf();
+            leaf_allocator::deallocate(l);
+        }
+
+        // 复制叶子的前n个元素
+        static leaf* __copy_leaf(const leaf* src, size_t n)
+        {
+            leaf* l = __new_leaf();
+            try
+            {
+                mySTL::uninitialized_copy(src->data(), src->data() + n, l->data());
+            }
+            catch(...)
+            {
+                __free_leaf(l);
+                throw;
+            }
+            l->count = static_cast<uint32_t>(n);
+            return l;
+        }
+
+        // 让slot指向的内部节点可以修改, slot为空时新建
+        static __pv_inner* __editable_inner(__pv_node*& slot, unsigned level)
+        {
+            if(!slot) return static_cast<__pv_inner*>(slot = __new_inner());
+            if(__unique(slot)) return static_cast<__pv_inner*>(slot);
+            __pv_inner* src = static_cast<__pv_inner*>(slot);
+            __pv_inner* n = __new_inner();
+            for(size_t i = 0; i < __pv_width; i++)
+            {
+                n->children[i] = src->children[i];
+                __retain(n->children[i]);
+            }
+            __release(slot, level);
+            slot = n;
+            return n;
+        }
+
+        static leaf* __editable_leaf(__pv_node*& slot)
+        {
+            if(__unique(slot)) return static_cast<leaf*>(slot);
+            leaf* l = __copy_leaf(static_cast<leaf*>(slot), slot->count);
+            __release(slot, 0);
+            slot = l;
+            return l;
+        }
+
+        // 从level层开始只有一条路径, 最底下是叶子l
+        static __pv_node* __new_path(unsigned level, __pv_node* l)
+        {
+            if(level == 0) return l;
+            __pv_inner* n = __new_inner();
+            try
+            {
+                n->children[0] = __new_path(level - __pv_bits, l);
+            }
+            catch(...)
+            {
+                inner_allocator::deallocate(n);
+                throw;
+            }
+            return n;
+        }
+
+        /*** 修改 ***/
+
+        template <class... Args>
+        void __emplace_back(Args&&... args)
+        {
+            size_t tail_count = __size - __tail_offset();
+            if(__tail && tail_count < __pv_width)
+            {
+                leaf* t = static_cast<leaf*>(__tail);
+                if(__unique(t)) mySTL::construct(t->data() + tail_count, mySTL::forward<Args>(args)...);
+                else
+                {
+                    // 尾部被共享, 复制后再追加; 构造失败时丢弃副本, 原尾部不变
+                    t = __copy_leaf(t, tail_count);
+                    try
+                    {
+                        mySTL::construct(t->data() + tail_count, mySTL::forward<Args>(args)...);
+                    }
+                    catch(...)
+                    {
+                        __release(t, 0);
+                        throw;
+                    }
+                    __release(__tail, 0);
+                    __tail = t;
+                }
+                ++t->count;
+                ++__size;
+                return;
+            }
+
+            // 空, 或尾部已满: 新元素放进新的尾部, 满的尾部放进trie
+            leaf* t = __new_leaf();
+            try
+            {
+                mySTL::construct(t->data(), mySTL::forward<Args>(args)...);
+            }
+            catch(...)
+            {
+                __free_leaf(t);
+                throw;
+            }
+            t->count = 1;
+            if(__tail)
+            {
+                try
+                {
+                    __push_tail();
+                }
+                catch(...)
+                {
+                    __release(t, 0);
+                    throw;
+                }
+            }
+            __tail = t;
+            ++__size;
+        }
+
+        // 把满的尾部 (下标 [__size - 32, __size)) 挂到trie上, trie接管尾部的引用
+        void __push_tail()
+        {
+            if(!__root)
+            {
+                __pv_inner* r = __new_inner();
+                r->children[0] = __tail;
+                __root = r;
+                return;
+            }
+            // 根已满, 树长高一层
+            if((__size >> __pv_bits) > (size_t(1) << __shift))
+            {
+                __pv_node* path = __new_path(__shift, __tail);
+                __pv_inner* r;
+                try
+                {
+                    r = __new_inner();
+                }
+                catch(...)
+                {
+                    // 路径上只有刚分配的内部节点, 尾部仍归当前版本所有
+                    for(__pv_node* n = path; n != __tail;)
+                    {
+                        __pv_node* next = static_cast<__pv_inner*>(n)->children[0];
+                        inner_allocator::deallocate(static_cast<__pv_inner*>(n));
+                        n = next;
+                    }
+                    throw;
+                }
+                r->children[0] = __root;
+                r->children[1] = path;
+                __root = r;
+                __shift += __pv_bits;
+                return;
+            }
+            __push_tail_at(__root, __shift);
+        }
+
+        void __push_tail_at(__pv_node*& slot, unsigned level)
+        {
+            __pv_inner* n = __editable_inner(slot, level);
+            __pv_node*& child = n->children[((__size - 1) >> level) & __pv_mask];
+            if(level == __pv_bits) child = __tail;
+            else if(child) __push_tail_at(child, level - __pv_bits);
+            else child = __new_path(level - __pv_bits, __tail);
+        }
+
+        template <class U>
+        void __set(size_t i, U&& value)
+        {
+            assert(i < __size);
+            if(i >= __tail_offset())
+            {
+                __editable_leaf(__tail)->data()[i & __pv_mask] = mySTL::forward<U>(value);
+                return;
+            }
+            __pv_node** slot = &__root;
+            for(unsigned level = __shift; level > 0; level -= __pv_bits)
+                slot = &__editable_inner(*slot, level)->children[(i >> level) & __pv_mask];
+            __editable_leaf(*slot)->data()[i & __pv_mask] = mySTL::forward<U>(value);
+        }
+
+        void __pop_back()
+        {
+            assert(__size > 0);
+            size_t tail_count = __size - __tail_offset();
+            if(tail_count > 1)
+            {
+                leaf* t = static_cast<leaf*>(__tail);
+                if(__unique(t))
+                {
+                    mySTL::destroy(t->data() + tail_count - 1);
+                    --t->count;
+                }
+                else
+                {
+                    t = __copy_leaf(t, tail_count - 1);
+                    __release(__tail, 0);
+                    __tail = t;
+                }
+                --__size;
+                return;
+            }
+            if(__size == 1)
+            {
+                __clear();
+                return;
+            }
+
+            // 尾部只剩一个元素: trie的最后一个叶子成为新的尾部
+            __pv_node* new_tail = __last_trie_leaf();
+            __retain(new_tail);
+            try
+            {
+                __pop_tail_at(__root, __shift);
+            }
+            catch(...)
+            {
+                __release(new_tail, 0);
+                throw;
+            }
+            __release(__tail, 0);
+            __tail = new_tail;
+            --__size;
+
+            // 根只剩一个子节点时树降低一层
+            if(__root && __shift > __pv_bits && !static_cast<__pv_inner*>(__root)->children[1])
+            {
+                __pv_node* child = static_cast<__pv_inner*>(__root)->children[0];
+                __retain(child);
+                __release(__root, __shift);
+                __root = child;
+                __shift -= __pv_bits;
+            }
+            if(!__root) __shift = __pv_bits;
+        }
+
+        __pv_node* __last_trie_leaf() const noexcept
+        {
+            size_t i = __size - 2;
+            __pv_node* n = __root;
+            for(unsigned level = __shift; level > 0; level -= __pv_bits)
+                n = static_cast<__pv_inner*>(n)->children[(i >> level) & __pv_mask];
+            return n;
+        }
+
+        // 从trie中去掉最后一个叶子, 节点变空时删除节点并返回true
+        bool __pop_tail_at(__pv_node*& slot, unsigned level)
+        {
+            __pv_inner* n = __editable_inner(slot, level);
+            size_t sub = ((__size - 2) >> level) & __pv_mask;
+            bool child_empty;
+            if(level > __pv_bits) child_empty = __pop_tail_at(n->children[sub], level - __pv_bits);
+            else
+            {
+                __release(n->children[sub], 0);
+                n->children[sub] = nullptr;
+                child_empty = true;
+            }
+            if(child_empty && sub == 0)
+            {
+                __release(slot, level);
+                slot = nullptr;
+                return true;
+            }
+            return false;
+        }
+
+        template <class InputIter>
+        void __append(InputIter first, InputIter last)
+        {
+            for(; first != last; ++first) __emplace_back(*first);
+        }
+    };
+
+    /**
+     * @brief persistent_vector
+     * 不可变的vector: 修改操作返回新版本, 原版本不变; 复制 (拍快照) 是O(1)的
+     * 对右值调用修改操作时, 不被其他版本共享的节点直接原地修改
+     * @tparam T 需要可复制构造
+     */
+    template <class T>
+    class persistent_vector : public __pvector_base<T>
+    {
+        friend class transient_vector<T>;
+
+    private:
+        typedef __pvector_base<T> base;
+
+    public:
+        persistent_vector() noexcept = default;
+        persistent_vector(const persistent_vector&) noexcept = default;
+        persistent_vector(persistent_vector&&) noexcept = default;
+
+        persistent_vector(std::initializer_list<T> ilist) {this->__append(ilist.begin(), ilist.end());}
+
+        template <class InputIter, class = typename mySTL::enable_if<!mySTL::is_integral<InputIter>::value>::type>
+        persistent_vector(InputIter first, InputIter last) {this->__append(first, last);}
+
+        persistent_vector(size_t n, const T& value)
+        {
+            for(size_t i = 0; i < n; i++) this->__emplace_back(value);
+        }
+
+        persistent_vector& operator=(const persistent_vector& other) noexcept
+        {
+            if(this != &other) this->__assign(other);
+            return *this;
+        }
+
+        persistent_vector& operator=(persistent_vector&& other) noexcept
+        {
+            if(this != &other)
+            {
+                this->__clear();
+                this->__swap(other);
+            }
+            return *this;
+        }
+
+        persistent_vector push_back(const T& value) const& {persistent_vector r(*this); r.__emplace_back(value); return r;}
+        persistent_vector push_back(T&& value)      const& {persistent_vector r(*this); r.__emplace_back(mySTL::move(value)); return r;}
+        persistent_vector push_back(const T& value) &&     {this->__emplace_back(value); return mySTL::move(*this);}
+        persistent_vector push_back(T&& value)      &&     {this->__emplace_back(mySTL::move(value)); return mySTL::move(*this);}
+
+        template <class U>
+        persistent_vector set(size_t i, U&& value) const& {persistent_vector r(*this); r.__set(i, mySTL::forward<U>(value)); return r;}
+        template <class U>
+        persistent_vector set(size_t i, U&& value) &&     {this->__set(i, mySTL::forward<U>(value)); return mySTL::move(*this);}
+
+        persistent_vector pop_back() const& {persistent_vector r(*this); r.__pop_back(); return r;}
+        persistent_vector pop_back() &&     {this->__pop_back(); return mySTL::move(*this);}
+
+        // 批量修改用的可变版本, 和当前版本共享树
+        transient_vector<T> transient() const& {return transient_vector<T>(*this);}
+        transient_vector<T> transient() &&     {return transient_vector<T>(mySTL::move(*this));}
+
+        void swap(persistent_vector& other) noexcept {this->__swap(other);}
+    };
+
+    /**
+     * @brief transient_vector
+     * persistent_vector的可变版本: 修改原地进行, 只在第一次修改被共享的节点时复制
+     * snapshot() 随时得到一个O(1)的不可变快照, 之后的修改不会影响快照
+     * 同一个transient_vector不能在多个线程中同时修改
+     */
+    template <class T>
+    class transient_vector : public __pvector_base<T>
+    {
+        friend class persistent_vector<T>;
+
+    private:
+        typedef __pvector_base<T> base;
+
+        explicit transient_vector(const persistent_vector<T>& v) noexcept : base(v) {}
+        explicit transient_vector(persistent_vector<T>&& v) noexcept : base(mySTL::move(v)) {}
+
+    public:
+        transient_vector() noexcept = default;
+        transient_vector(const transient_vector&) = delete;
+        transient_vector& operator=(const transient_vector&) = delete;
+        transient_vector(transient_vector&&) noexcept = default;
+
+        transient_vector& operator=(transient_vector&& other) noexcept
+        {
+            if(this != &other)
+            {
+                this->__clear();
+                this->__swap(other);
+            }
+            return *this;
+        }
+
+        void push_back(const T& value) {this->__emplace_back(value);}
+        void push_back(T&& value)      {this->__emplace_back(mySTL::move(value));}
+
+        template <class... Args>
+        void emplace_back(Args&&... args) {this->__emplace_back(mySTL::forward<Args>(args)...);}
+
+        template <class U>
+        void set(size_t i, U&& value) {this->__set(i, mySTL::forward<U>(value));}
+
+        void pop_back() {this->__pop_back();}
+        void clear() noexcept {this->__clear();}
+
+        // 与当前内容共享的不可变版本
+        persistent_vector<T> snapshot() const
+        {
+            persistent_vector<T> r;
+            r.__assign(*this);
+            return r;
+        }
+
+        // 把内容转交给不可变版本, 自己变为空
+        persistent_vector<T> persistent() noexcept
+        {
+            persistent_vector<T> r;
+            r.__swap(*this);
+            return r;
+        }
+    };
+
+    template <class T>
+    inline void swap(persistent_vector<T>& lhs, persistent_vector<T>& rhs) noexcept {lhs.swap(rhs);}
+
+    template <class T>
+    bool operator==(const __pvector_base<T>& lhs, const __pvector_base<T>& rhs)
+    {
+        if(lhs.size() != rhs.size()) return false;
+        if(lhs.shares_with(rhs)) return true;
+        auto a = lhs.begin();
+        for(auto b = rhs.begin(); b != rhs.end(); ++a, ++b)
+            if(!(*a == *b)) return false;
+        return true;
+    }
+
+    template <class T>
+    bool operator!=(const __pvector_base<T>& lhs, const __pvector_base<T>& rhs) {return !(lhs == rhs);}
+}
+#endif // __PERSISTENT_VECTOR_H__
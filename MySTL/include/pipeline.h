@@ -0,0 +1,267 @@
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+
+// 基于generator的流式处理流水线, 需要 -std=c++20 和线程库
+//     auto out = parse(file) | stages::async(4) | stages::filter(pred) | stages::map(f);
+//     for(auto& x : out) ...
+// 每个阶段是一个generator, 逐个 (或按批) 拉取上一阶段的元素, 不把整个数据集放进容器
+// stages::async 把上游放到工作线程上运行, 两个线程之间用有界队列按批传递, 队列满时上游阻塞 (背压),
+// 所以无论数据多少, 内存占用都不超过 队列容量 * 批大小 个元素
+
+#include <cstddef>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
+#include "allocator.h"
+#include "construct.h"
+#include "type_traits.h"
+#include "utils.h"
+#include "generator.h"
+#include "static_vector.h"
+#include "ranges.h"
+
+namespace mySTL
+{
+    /**
+     * @brief bounded_queue
+     * 多生产者多消费者的有界阻塞队列 (环形缓冲区 + 互斥锁)
+     * 满时push阻塞, 空时pop阻塞; close之后push失败, pop取完剩余元素后失败
+     * @tparam T
+     */
+    template <class T>
+    class bounded_queue
+    {
+    private:
+        typedef mySTL::allocator<T> data_allocator;
+
+        T*                      __buf;
+        size_t                  __cap;
+        size_t                  __head;
+        size_t                  __size;
+        bool                    __closed;
+        size_t                  __full_waits;   // push因为队列满而等待的次数
+        mutable std::mutex      __mutex;
+        std::condition_variable __not_full;
+        std::condition_variable __not_empty;
+
+    public:
+        explicit bounded_queue(size_t capacity)
+            : __buf(data_allocator::allocate(capacity ? capacity : 1)), __cap(capacity ? capacity : 1),
+              __head(0), __size(0), __closed(false), __full_waits(0) {}
+
+        bounded_queue(const bounded_queue&) = delete;
+        bounded_queue& operator=(const bounded_queue&) = delete;
+
+        ~bounded_queue()
+        {
+            for(size_t i = 0; i < __size; i++) mySTL::destroy(__buf + (__head + i) % __cap);
+            data_allocator::deallocate(__buf, __cap);
+        }
+
+        bool push(const T& value) {return __push(value);}
+        bool push(T&& value)      {return __push(mySTL::move(value));}
+
+        // 取出队首放到out中; 队列已关闭且为空时返回false
+        bool pop(T& out)
+        {
+            std::unique_lock<std::mutex> lock(__mutex);
+            __not_empty.wait(lock, [this] {return __size != 0 || __closed;});
+            if(__size == 0) return false;
+            T* p = __buf + __head;
+            out = mySTL::move(*p);
+            mySTL::destroy(p);
+            __head = (__head + 1) % __cap;
+            --__size;
+            lock.unlock();
+            __not_full.notify_one();
+            return true;
+        }
+
+        // 唤醒所有等待的线程
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(__mutex);
+                __closed = true;
+            }
+            __not_full.notify_all();
+            __not_empty.notify_all();
+        }
+
+        size_t capacity() const noexcept {return __cap;}
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(__mutex);
+            return __size;
+        }
+        size_t full_waits() const
+        {
+            std::lock_guard<std::mutex> lock(__mutex);
+            return __full_waits;
+        }
+
+    private:
+        template <class U>
+        bool __push(U&& value)
+        {
+            std::unique_lock<std::mutex> lock(__mutex);
+            if(__size == __cap && !__closed)
+            {
+                ++__full_waits;
+                __not_full.wait(lock, [this] {return __size != __cap || __closed;});
+            }
+            if(__closed) return false;
+            mySTL::construct(__buf + (__head + __size) % __cap, mySTL::forward<U>(value));
+            ++__size;
+            lock.unlock();
+            __not_empty.notify_one();
+            return true;
+        }
+    };
+
+    /**
+     * @brief __async_worker
+     * 在工作线程上遍历source, 按Batch个元素一批放入队列
+     * 析构时关闭队列 (上游阻塞的push立即返回) 并等待线程结束, 所以下游提前停止也不会泄漏线程
+     */
+    template <class T, size_t Batch>
+    class __async_worker
+    {
+    public:
+        typedef static_vector<T, Batch> batch_type;
+
+    private:
+        generator<T>            __source;
+        bounded_queue<batch_type> __queue;
+        std::exception_ptr      __exception;
+        std::thread             __worker;
+
+    public:
+        __async_worker(generator<T> source, size_t capacity)
+            : __source(mySTL::move(source)), __queue(capacity), __exception(), __worker([this] {__run();}) {}
+
+        ~__async_worker()
+        {
+            __queue.close();
+            __worker.join();
+        }
+
+        bool pop(batch_type& batch) {return __queue.pop(batch);}
+
+        // 队列取空之后调用, 上游的异常在下游重新抛出
+        void rethrow_if_failed()
+        {
+            if(__exception) std::rethrow_exception(__exception);
+        }
+
+    private:
+        void __run()
+        {
+            try
+            {
+                batch_type batch;
+                for(T& x : __source)
+                {
+                    batch.push_back(mySTL::move(x));
+                    if(batch.size() == Batch)
+                    {
+                        if(!__queue.push(mySTL::move(batch))) return;
+                        batch.clear();
+                    }
+                }
+                if(!batch.empty()) __queue.push(mySTL::move(batch));
+            }
+            catch(...)
+            {
+                __exception = std::current_exception();  // close之后下游才会读取
+            }
+            __queue.close();
+        }
+    };
+
+    namespace stages
+    {
+        // 对每个元素调用f
+        template <class T, class F>
+        generator<typename mySTL::decay<decltype(mySTL::declval<F&>()(mySTL::declval<T&>()))>::type>
+        map(generator<T> in, F f)
+        {
+            for(T& x : in) co_yield f(x);
+        }
+
+        template <class F>
+        inline auto map(F f)
+        {
+            return __make_closure([f](auto&& in) {return map(mySTL::move(in), f);});
+        }
+
+        // 只保留满足pred的元素
+        template <class T, class Pred>
+        generator<T> filter(generator<T> in, Pred pred)
+        {
+            for(T& x : in)
+                if(pred(x)) co_yield x;
+        }
+
+        template <class Pred>
+        inline auto filter(Pred pred)
+        {
+            return __make_closure([pred](auto&& in) {return filter(mySTL::move(in), pred);});
+        }
+
+        // 每Batch个元素打包成一个static_vector, 最后一批可能不满
+        template <size_t Batch, class T>
+        generator<static_vector<T, Batch>> batch(generator<T> in)
+        {
+            static_vector<T, Batch> b;
+            for(T& x : in)
+            {
+                b.push_back(mySTL::move(x));
+                if(b.size() == Batch)
+                {
+                    co_yield mySTL::move(b);
+                    b.clear();
+                }
+            }
+            if(!b.empty()) co_yield mySTL::move(b);
+        }
+
+        template <size_t Batch>
+        inline auto batch()
+        {
+            return __make_closure([](auto&& in) {return batch<Batch>(mySTL::move(in));});
+        }
+
+        // batch的逆操作
+        template <class T, size_t N>
+        generator<T> unbatch(generator<static_vector<T, N>> in)
+        {
+            for(static_vector<T, N>& b : in)
+                for(T& x : b) co_yield x;
+        }
+
+        inline auto unbatch()
+        {
+            return __make_closure([](auto&& in) {return unbatch(mySTL::move(in));});
+        }
+
+        // 上游在工作线程上运行, 中间最多缓存capacity批, 每批Batch个元素
+        template <size_t Batch = 64, class T>
+        generator<T> async(generator<T> in, size_t capacity = 4)
+        {
+            __async_worker<T, Batch> worker(mySTL::move(in), capacity);
+            typename __async_worker<T, Batch>::batch_type b;
+            while(worker.pop(b))
+                for(T& x : b) co_yield x;
+            worker.rethrow_if_failed();
+        }
+
+        template <size_t Batch = 64>
+        inline auto async(size_t capacity = 4)
+        {
+            return __make_closure([capacity](auto&& in) {return async<Batch>(mySTL::move(in), capacity);});
+        }
+    }
+}
+#endif // __PIPELINE_H__
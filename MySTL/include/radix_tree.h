@@ -0,0 +1,1138 @@
+#ifndef __RADIX_TREE_H__
+#define __RADIX_TREE_H__
+
+// 自适应基数树 (Adaptive Radix Tree, Leis et al. 2013)
+// key按字节逐层分叉, 内部节点按子节点数在 Node4/16/48/256 之间切换, 只有一个子节点的路径压缩成节点前缀
+// 节点只存前缀的前 __art_max_prefix 个字节, 更长的前缀需要时从子树中的任一叶子取 (叶子保存完整的key)
+// 所有叶子按key的顺序串成双向链表: 遍历, lower_bound 和前缀扫描得到起点之后只沿链表走
+// 节点和叶子都从node_pool分配
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <stdexcept>
+#include <tuple>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "construct.h"
+#include "iterator.h"
+#include "node_pool.h"
+#include "pair.h"
+#include "type_traits.h"
+#include "utils.h"
+
+namespace mySTL
+{
+    static constexpr uint32_t __art_max_prefix = 8;
+
+    enum __art_kind : uint8_t {__art_node4, __art_node16, __art_node48, __art_node256};
+
+    // 内部节点的公共头部, 24字节
+    struct __art_node
+    {
+        uint8_t     kind;
+        uint8_t     __pad;
+        uint16_t    count;                      // 子节点数
+        uint32_t    prefix_len;                 // 压缩的路径长度, 可能大于__art_max_prefix
+        uint8_t     prefix[__art_max_prefix];
+        void*       end;                        // 正好在这个节点结束的key的叶子, 比所有子节点都小
+    };
+
+    // Node4/Node16: 有序的keys和对应的children
+    struct __art_node_4 : __art_node
+    {
+        uint8_t keys[4];
+        void*   children[4];
+    };
+
+    struct __art_node_16 : __art_node
+    {
+        uint8_t keys[16];
+        void*   children[16];
+    };
+
+    // Node48: 按字节索引到children的下标 + 1, 0表示没有
+    struct __art_node_48 : __art_node
+    {
+        uint8_t index[256];
+        void*   children[48];
+    };
+
+    struct __art_node_256 : __art_node
+    {
+        void* children[256];
+    };
+
+    // 叶子之间的链表, 树里的哨兵也是一个__art_link
+    struct __art_link
+    {
+        __art_link* prev;
+        __art_link* next;
+    };
+
+    // 子节点指针的最低位为1表示叶子
+    inline bool __art_is_leaf(const void* p) noexcept {return reinterpret_cast<uintptr_t>(p) & 1;}
+    inline __art_link* __art_leaf_of(const void* p) noexcept
+    {
+        return reinterpret_cast<__art_link*>(reinterpret_cast<uintptr_t>(p) & ~uintptr_t(1));
+    }
+    inline void* __art_tag(__art_link* l) noexcept {return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(l) | 1);}
+    inline __art_node* __art_node_of(void* p) noexcept {return static_cast<__art_node*>(p);}
+
+    /**
+     * @brief key的字节序列
+     * 字符串按字节比较 (和std::string的顺序相同), 整数转成大端序, 有符号数翻转符号位, 字节序就是数值顺序
+     * 不可复制, 因为整数key的data()指向自己内部的缓冲区
+     */
+    class __art_key
+    {
+    private:
+        const uint8_t*  __ptr;
+        size_t          __size;
+        uint8_t         __buf[8];
+
+    public:
+        template <class K>
+        explicit __art_key(const K& key) noexcept
+        {
+            if constexpr(mySTL::is_integral<K>::value)
+            {
+                typedef typename mySTL::make_unsigned<K>::type U;
+                U u = static_cast<U>(key);
+                if constexpr(mySTL::is_signed<K>::value) u ^= U(1) << (sizeof(K) * 8 - 1);
+                for(size_t i = 0; i < sizeof(K); i++) __buf[i] = static_cast<uint8_t>(u >> (8 * (sizeof(K) - 1 - i)));
+                __ptr = __buf;
+                __size = sizeof(K);
+            }
+            else
+            {
+                static_assert(sizeof(*key.data()) == 1, "radix_tree string keys must use a single-byte character type");
+                __ptr = reinterpret_cast<const uint8_t*>(key.data());
+                __size = key.size();
+            }
+        }
+
+        __art_key(const __art_key&) = delete;
+        __art_key& operator=(const __art_key&) = delete;
+
+        const uint8_t* data()              const noexcept {return __ptr;}
+        size_t         size()              const noexcept {return __size;}
+        uint8_t        operator[](size_t i) const noexcept {return __ptr[i];}
+
+        // 字典序, 较短的前缀排在前面
+        int compare(const __art_key& other) const noexcept
+        {
+            size_t n = __size < other.__size ? __size : other.__size;
+            int c = n ? std::memcmp(__ptr, other.__ptr, n) : 0;
+            if(c) return c;
+            return __size < other.__size ? -1 : (__size > other.__size ? 1 : 0);
+        }
+
+        bool operator==(const __art_key& other) const noexcept
+        {
+            return __size == other.__size && (__size == 0 || std::memcmp(__ptr, other.__ptr, __size) == 0);
+        }
+    };
+
+    /*** 节点操作, 与key和value类型无关 ***/
+
+    // Node16中大于b的第一个key的位置
+    inline unsigned __art_upper16(const __art_node_16* n, uint8_t b) noexcept
+    {
+#if defined(__SSE2__)
+        // SSE2只有有符号比较, 两边都翻转最高位
+        const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+        __m128i keys = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys)), flip);
+        __m128i key  = _mm_xor_si128(_mm_set1_epi8(static_cast<char>(b)), flip);
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmplt_epi8(key, keys))) & ((1u << n->count) - 1);
+        return mask ? static_cast<unsigned>(__builtin_ctz(mask)) : n->count;
+#else
+        unsigned i = 0;
+        while(i < n->count && n->keys[i] <= b) i++;
+        return i;
+#endif
+    }
+
+    // 字节b对应的子节点槽, 没有时返回nullptr
+    inline void** __art_find_child(__art_node* n, uint8_t b) noexcept
+    {
+        switch(n->kind)
+        {
+        case __art_node4:
+        {
+            __art_node_4* m = static_cast<__art_node_4*>(n);
+            for(unsigned i = 0; i < m->count; i++)
+                if(m->keys[i] == b) return &m->children[i];
+            return nullptr;
+        }
+        case __art_node16:
+        {
+            __art_node_16* m = static_cast<__art_node_16*>(n);
+#if defined(__SSE2__)
+            // 一次比较16个key
+            __m128i eq = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(b)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(m->keys)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq)) & ((1u << m->count) - 1);
+            return mask ? &m->children[__builtin_ctz(mask)] : nullptr;
+#else
+            for(unsigned i = 0; i < m->count; i++)
+                if(m->keys[i] == b) return &m->children[i];
+            return nullptr;
+#endif
+        }
+        case __art_node48:
+        {
+            __art_node_48* m = static_cast<__art_node_48*>(n);
+            return m->index[b] ? &m->children[m->index[b] - 1] : nullptr;
+        }
+        default:
+        {
+            __art_node_256* m = static_cast<__art_node_256*>(n);
+            return m->children[b] ? &m->children[b] : nullptr;
+        }
+        }
+    }
+
+    // 字节大于b的第一个子节点, 没有时返回nullptr; b == -1 时返回第一个子节点
+    inline void* __art_next_child(__art_node* n, int b) noexcept
+    {
+        switch(n->kind)
+        {
+        case __art_node4:
+        {
+            __art_node_4* m = static_cast<__art_node_4*>(n);
+            for(unsigned i = 0; i < m->count; i++)
+                if(int(m->keys[i]) > b) return m->children[i];
+            return nullptr;
+        }
+        case __art_node16:
+        {
+            __art_node_16* m = static_cast<__art_node_16*>(n);
+            if(b < 0) return m->count ? m->children[0] : nullptr;
+            unsigned i = __art_upper16(m, static_cast<uint8_t>(b));
+            return i < m->count ? m->children[i] : nullptr;
+        }
+        case __art_node48:
+        {
+            __art_node_48* m = static_cast<__art_node_48*>(n);
+            for(int i = b + 1; i < 256; i++)
+                if(m->index[i]) return m->children[m->index[i] - 1];
+            return nullptr;
+        }
+        default:
+        {
+            __art_node_256* m = static_cast<__art_node_256*>(n);
+            for(int i = b + 1; i < 256; i++)
+                if(m->children[i]) return m->children[i];
+            return nullptr;
+        }
+        }
+    }
+
+    inline void* __art_last_child(__art_node* n) noexcept
+    {
+        switch(n->kind)
+        {
+        case __art_node4:  return n->count ? static_cast<__art_node_4*>(n)->children[n->count - 1] : nullptr;
+        case __art_node16: return n->count ? static_cast<__art_node_16*>(n)->children[n->count - 1] : nullptr;
+        case __art_node48:
+        {
+            __art_node_48* m = static_cast<__art_node_48*>(n);
+            for(int i = 255; i >= 0; i--)
+                if(m->index[i]) return m->children[m->index[i] - 1];
+            return nullptr;
+        }
+        default:
+        {
+            __art_node_256* m = static_cast<__art_node_256*>(n);
+            for(int i = 255; i >= 0; i--)
+                if(m->children[i]) return m->children[i];
+            return nullptr;
+        }
+        }
+    }
+
+    // 子树中最小/最大的叶子
+    inline __art_link* __art_minimum(void* p) noexcept
+    {
+        while(!__art_is_leaf(p))
+        {
+            __art_node* n = __art_node_of(p);
+            p = n->end ? n->end : __art_next_child(n, -1);
+        }
+        return __art_leaf_of(p);
+    }
+
+    inline __art_link* __art_maximum(void* p) noexcept
+    {
+        while(!__art_is_leaf(p))
+        {
+            __art_node* n = __art_node_of(p);
+            p = n->count ? __art_last_child(n) : n->end;
+        }
+        return __art_leaf_of(p);
+    }
+
+    // 节点还有空位时插入子节点
+    inline void __art_add_child(__art_node* n, uint8_t b, void* child) noexcept
+    {
+        switch(n->kind)
+        {
+        case __art_node4:
+        {
+            __art_node_4* m = static_cast<__art_node_4*>(n);
+            unsigned i = 0;
+            while(i < m->count && m->keys[i] < b) i++;
+            std::memmove(m->keys + i + 1, m->keys + i, m->count - i);
+            std::memmove(m->children + i + 1, m->children + i, (m->count - i) * sizeof(void*));
+            m->keys[i] = b;
+            m->children[i] = child;
+            break;
+        }
+        case __art_node16:
+        {
+            __art_node_16* m = static_cast<__art_node_16*>(n);
+            unsigned i = __art_upper16(m, b);
+            std::memmove(m->keys + i + 1, m->keys + i, m->count - i);
+            std::memmove(m->children + i + 1, m->children + i, (m->count - i) * sizeof(void*));
+            m->keys[i] = b;
+            m->children[i] = child;
+            break;
+        }
+        case __art_node48:
+        {
+            // 删除不会压缩children, 找一个空槽
+            __art_node_48* m = static_cast<__art_node_48*>(n);
+            unsigned slot = 0;
+            while(m->children[slot]) slot++;
+            m->children[slot] = child;
+            m->index[b] = static_cast<uint8_t>(slot + 1);
+            break;
+        }
+        default:
+            static_cast<__art_node_256*>(n)->children[b] = child;
+            break;
+        }
+        ++n->count;
+    }
+
+    inline void __art_remove_child(__art_node* n, uint8_t b) noexcept
+    {
+        switch(n->kind)
+        {
+        case __art_node4:
+        case __art_node16:
+        {
+            uint8_t* keys;
+            void**   children;
+            if(n->kind == __art_node4)
+            {
+                keys = static_cast<__art_node_4*>(n)->keys;
+                children = static_cast<__art_node_4*>(n)->children;
+            }
+            else
+            {
+                keys = static_cast<__art_node_16*>(n)->keys;
+                children = static_cast<__art_node_16*>(n)->children;
+            }
+            unsigned i = 0;
+            while(keys[i] != b) i++;
+            std::memmove(keys + i, keys + i + 1, n->count - i - 1);
+            std::memmove(children + i, children + i + 1, (n->count - i - 1) * sizeof(void*));
+            break;
+        }
+        case __art_node48:
+        {
+            __art_node_48* m = static_cast<__art_node_48*>(n);
+            m->children[m->index[b] - 1] = nullptr;
+            m->index[b] = 0;
+            break;
+        }
+        default:
+            static_cast<__art_node_256*>(n)->children[b] = nullptr;
+            break;
+        }
+        --n->count;
+    }
+
+    inline bool __art_full(const __art_node* n) noexcept
+    {
+        static constexpr uint16_t capacity[4] = {4, 16, 48, 256};
+        return n->count == capacity[n->kind];
+    }
+
+    // 按节点类型统计
+    struct radix_tree_stats
+    {
+        size_t leaves;
+        size_t node4;
+        size_t node16;
+        size_t node48;
+        size_t node256;
+        size_t bytes;           // 池中保留的全部内存, 包括空闲槽
+    };
+
+    /**
+     * @brief radix_tree
+     * 有序关联容器, 接口类似map; 查找的代价只和key的长度有关, 和元素个数无关
+     * 插入不会使迭代器失效, 删除只使指向被删元素的迭代器失效
+     * @tparam Key 整数类型, 或者有data()/size()的单字节字符串类型 (如std::string)
+     * @tparam T
+     */
+    template <class Key, class T>
+    class radix_tree
+    {
+    public:
+        typedef Key                 key_type;
+        typedef T                   mapped_type;
+        typedef pair<const Key, T>  value_type;
+        typedef size_t              size_type;
+        typedef ptrdiff_t           difference_type;
+
+    private:
+        struct __leaf : __art_link
+        {
+            value_type value;
+
+            template <class K, class... Args>
+            __leaf(K&& key, Args&&... args)
+                : value(piecewise_construct, std::forward_as_tuple(mySTL::forward<K>(key)),
+                        std::forward_as_tuple(mySTL::forward<Args>(args)...)) {}
+        };
+
+        static __leaf* __as_leaf(const void* p) noexcept {return static_cast<__leaf*>(__art_leaf_of(p));}
+
+        template <bool Const>
+        class __iterator : public mySTL::iterator<mySTL::bidirectional_iterator_tag, value_type>
+        {
+            friend class radix_tree;
+
+        private:
+            __art_link* __node;
+
+        public:
+            typedef typename mySTL::conditional<Const, const value_type*, value_type*>::type pointer;
+            typedef typename mySTL::conditional<Const, const value_type&, value_type&>::type reference;
+
+            __iterator() noexcept : __node(nullptr) {}
+            explicit __iterator(__art_link* node) noexcept : __node(node) {}
+            // iterator 到 const_iterator 的转换
+            template <bool C, class = typename mySTL::enable_if<Const && !C>::type>
+            __iterator(const __iterator<C>& other) noexcept : __node(other.__node) {}
+
+            reference operator*()  const noexcept {return static_cast<__leaf*>(__node)->value;}
+            pointer   operator->() const noexcept {return &static_cast<__leaf*>(__node)->value;}
+
+            __iterator& operator++() noexcept {__node = __node->next; return *this;}
+            __iterator& operator--() noexcept {__node = __node->prev; return *this;}
+            __iterator  operator++(int) noexcept {__iterator tmp = *this; ++*this; return tmp;}
+            __iterator  operator--(int) noexcept {__iterator tmp = *this; --*this; return tmp;}
+
+            friend bool operator==(const __iterator& a, const __iterator& b) noexcept {return a.__node == b.__node;}
+            friend bool operator!=(const __iterator& a, const __iterator& b) noexcept {return a.__node != b.__node;}
+        };
+
+    public:
+        typedef __iterator<false>   iterator;
+        typedef __iterator<true>    const_iterator;
+
+    private:
+        void*                       __root;
+        __art_link                  __head;     // 叶子链表的哨兵, end()
+        size_t                      __size;
+        node_pool<__leaf>           __leaves;
+        node_pool<__art_node_4>     __pool4;
+        node_pool<__art_node_16>    __pool16;
+        node_pool<__art_node_48>    __pool48;
+        node_pool<__art_node_256>   __pool256;
+
+    public:
+        radix_tree() noexcept : __root(nullptr), __size(0) {__head.prev = __head.next = &__head;}
+
+        radix_tree(const radix_tree& other) : radix_tree()
+        {
+            // 按顺序插入, 每次插入都在链表尾部
+            try
+            {
+                for(const value_type& v : other) try_emplace(v.first, v.second);
+            }
+            catch(...)
+            {
+                clear();
+                throw;
+            }
+        }
+
+        radix_tree(radix_tree&& other) noexcept : radix_tree() {swap(other);}
+
+        radix_tree& operator=(const radix_tree& other)
+        {
+            if(this != &other)
+            {
+                radix_tree tmp(other);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        radix_tree& operator=(radix_tree&& other) noexcept
+        {
+            if(this != &other)
+            {
+                clear();
+                swap(other);
+            }
+            return *this;
+        }
+
+        ~radix_tree() {clear();}
+
+        iterator       begin()        noexcept {return iterator(__head.next);}
+        const_iterator begin()  const noexcept {return const_iterator(__head.next);}
+        const_iterator cbegin() const noexcept {return begin();}
+        iterator       end()          noexcept {return iterator(&__head);}
+        const_iterator end()    const noexcept {return const_iterator(const_cast<__art_link*>(&__head));}
+        const_iterator cend()   const noexcept {return end();}
+
+        size_type size()  const noexcept {return __size;}
+        bool      empty() const noexcept {return __size == 0;}
+
+        /*** 查找 ***/
+
+        iterator find(const Key& key)
+        {
+            __leaf* l = __find(key);
+            return l ? iterator(l) : end();
+        }
+        const_iterator find(const Key& key) const {return const_cast<radix_tree*>(this)->find(key);}
+
+        bool      contains(const Key& key) const {return __find(key) != nullptr;}
+        size_type count(const Key& key)    const {return __find(key) ? 1 : 0;}
+
+        T& at(const Key& key)
+        {
+            __leaf* l = __find(key);
+            if(!l) throw std::out_of_range("radix_tree::at");
+            return l->value.second;
+        }
+        const T& at(const Key& key) const {return const_cast<radix_tree*>(this)->at(key);}
+
+        T& operator[](const Key& key) {return try_emplace(key).first->second;}
+
+        // 第一个不小于key的元素
+        iterator lower_bound(const Key& key)
+        {
+            __art_key k(key);
+            return iterator(__lower_bound(k));
+        }
+        const_iterator lower_bound(const Key& key) const {return const_cast<radix_tree*>(this)->lower_bound(key);}
+
+        // 第一个大于key的元素
+        iterator upper_bound(const Key& key)
+        {
+            __art_key k(key);
+            __art_link* l = __lower_bound(k);
+            if(l != &__head && __art_key(static_cast<__leaf*>(l)->value.first) == k) l = l->next;
+            return iterator(l);
+        }
+        const_iterator upper_bound(const Key& key) const {return const_cast<radix_tree*>(this)->upper_bound(key);}
+
+        /**
+         * @brief 以prefix开头的所有元素, 按顺序排列在 [first, second) 中
+         * 只下降到前缀对应的子树, 然后取子树的最小和最大叶子, 不需要逐个比较
+         */
+        pair<iterator, iterator> prefix_range(const Key& prefix)
+        {
+            static_assert(!mySTL::is_integral<Key>::value, "prefix_range requires a string key");
+            __art_key k(prefix);
+            void* p = __root;
+            size_t depth = 0;
+            while(p)
+            {
+                if(__art_is_leaf(p))
+                {
+                    __art_key lk(__as_leaf(p)->value.first);
+                    if(lk.size() >= k.size() && (k.size() == 0 || std::memcmp(lk.data(), k.data(), k.size()) == 0)) break;
+                    return pair<iterator, iterator>(end(), end());
+                }
+                __art_node* n = __art_node_of(p);
+                size_t i = __prefix_mismatch(n, k, depth);
+                // key在节点前缀中间结束, 整个子树都以它开头
+                if(i == k.size() - depth) break;
+                if(i < n->prefix_len) return pair<iterator, iterator>(end(), end());
+                depth += n->prefix_len;
+                if(depth == k.size()) break;
+                void** c = __art_find_child(n, k[depth]);
+                if(!c) return pair<iterator, iterator>(end(), end());
+                p = *c;
+                ++depth;
+            }
+            if(!p) return pair<iterator, iterator>(end(), end());
+            return pair<iterator, iterator>(iterator(__art_minimum(p)), iterator(__art_maximum(p)->next));
+        }
+
+        /*** 修改 ***/
+
+        // key不存在时用args构造value并插入
+        template <class... Args>
+        pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            return __insert(key, mySTL::forward<Args>(args)...);
+        }
+
+        template <class K, class... Args>
+        pair<iterator, bool> emplace(K&& key, Args&&... args)
+        {
+            return __insert(mySTL::forward<K>(key), mySTL::forward<Args>(args)...);
+        }
+
+        pair<iterator, bool> insert(const value_type& value) {return __insert(value.first, value.second);}
+
+        template <class M>
+        pair<iterator, bool> insert_or_assign(const Key& key, M&& obj)
+        {
+            pair<iterator, bool> r = __insert(key, mySTL::forward<M>(obj));
+            if(!r.second) r.first->second = mySTL::forward<M>(obj);
+            return r;
+        }
+
+        size_type erase(const Key& key)
+        {
+            __art_key k(key);
+            void** ref = &__root;
+            void** parent_ref = nullptr;
+            uint8_t parent_byte = 0;
+            size_t depth = 0;
+            for(;;)
+            {
+                void* p = *ref;
+                if(!p) return 0;
+                if(__art_is_leaf(p))
+                {
+                    __leaf* l = __as_leaf(p);
+                    if(!(__art_key(l->value.first) == k)) return 0;
+                    if(parent_ref) __remove_child(parent_ref, parent_byte);
+                    else *ref = nullptr;
+                    __destroy_leaf(l);
+                    return 1;
+                }
+                __art_node* n = __art_node_of(p);
+                if(!__prefix_matches(n, k, depth)) return 0;
+                depth += n->prefix_len;
+                if(depth == k.size())
+                {
+                    if(!n->end) return 0;
+                    __leaf* l = __as_leaf(n->end);
+                    if(!(__art_key(l->value.first) == k)) return 0;
+                    n->end = nullptr;
+                    if(n->count == 1) __collapse(ref);
+                    __destroy_leaf(l);
+                    return 1;
+                }
+                void** c = __art_find_child(n, k[depth]);
+                if(!c) return 0;
+                parent_ref = ref;
+                parent_byte = k[depth];
+                ref = c;
+                ++depth;
+            }
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            iterator next(pos.__node->next);
+            erase(static_cast<__leaf*>(pos.__node)->value.first);
+            return next;
+        }
+
+        void clear() noexcept
+        {
+            // 节点都是平凡类型, 只需析构叶子中的元素, 然后整体归还内存池
+            for(__art_link* l = __head.next; l != &__head; l = l->next)
+                mySTL::destroy(&static_cast<__leaf*>(l)->value);
+            __leaves.release();
+            __pool4.release();
+            __pool16.release();
+            __pool48.release();
+            __pool256.release();
+            __root = nullptr;
+            __head.prev = __head.next = &__head;
+            __size = 0;
+        }
+
+        void swap(radix_tree& other) noexcept
+        {
+            mySTL::swap(__root, other.__root);
+            mySTL::swap(__head, other.__head);
+            mySTL::swap(__size, other.__size);
+            mySTL::swap(__leaves, other.__leaves);
+            mySTL::swap(__pool4, other.__pool4);
+            mySTL::swap(__pool16, other.__pool16);
+            mySTL::swap(__pool48, other.__pool48);
+            mySTL::swap(__pool256, other.__pool256);
+            __fix_head();
+            other.__fix_head();
+        }
+
+        radix_tree_stats stats() const noexcept
+        {
+            radix_tree_stats s;
+            s.leaves = __leaves.live();
+            s.node4 = __pool4.live();
+            s.node16 = __pool16.live();
+            s.node48 = __pool48.live();
+            s.node256 = __pool256.live();
+            s.bytes = sizeof(*this) + __leaves.reserved_bytes() + __pool4.reserved_bytes() + __pool16.reserved_bytes()
+                    + __pool48.reserved_bytes() + __pool256.reserved_bytes();
+            return s;
+        }
+
+    private:
+        void __fix_head() noexcept
+        {
+            if(__size == 0) __head.prev = __head.next = &__head;
+            else __head.next->prev = __head.prev->next = &__head;
+        }
+
+        static void __link_before(__art_link* pos, __art_link* x) noexcept
+        {
+            x->prev = pos->prev;
+            x->next = pos;
+            pos->prev->next = x;
+            pos->prev = x;
+        }
+
+        __leaf* __find(const Key& key) const
+        {
+            __art_key k(key);
+            void* p = __root;
+            size_t depth = 0;
+            while(p)
+            {
+                if(__art_is_leaf(p))
+                {
+                    __leaf* l = __as_leaf(p);
+                    return __art_key(l->value.first) == k ? l : nullptr;
+                }
+                __art_node* n = __art_node_of(p);
+                if(!__prefix_matches(n, k, depth)) return nullptr;
+                depth += n->prefix_len;
+                if(depth == k.size()) p = n->end;
+                else
+                {
+                    void** c = __art_find_child(n, k[depth]);
+                    if(!c) return nullptr;
+                    p = *c;
+                    ++depth;
+                }
+            }
+            return nullptr;
+        }
+
+        // 只比较节点中存下的前缀字节, 超出的部分留给最后的叶子比较 (乐观比较)
+        static bool __prefix_matches(const __art_node* n, const __art_key& k, size_t depth) noexcept
+        {
+            if(n->prefix_len == 0) return true;
+            if(depth + n->prefix_len > k.size()) return false;
+            size_t m = n->prefix_len < __art_max_prefix ? n->prefix_len : __art_max_prefix;
+            return std::memcmp(n->prefix, k.data() + depth, m) == 0;
+        }
+
+        // 节点前缀的第i个字节, 超出存储部分时从子树的叶子中取
+        static uint8_t __prefix_byte(__art_node* n, size_t depth, size_t i) noexcept
+        {
+            if(i < __art_max_prefix) return n->prefix[i];
+            __art_key lk(static_cast<__leaf*>(__art_minimum(n))->value.first);
+            return lk[depth + i];
+        }
+
+        // 节点前缀和key从depth开始的第一个不同的位置; key先结束时返回key剩下的长度, 完全相同时返回prefix_len
+        static size_t __prefix_mismatch(__art_node* n, const __art_key& k, size_t depth) noexcept
+        {
+            size_t len = k.size() - depth < n->prefix_len ? k.size() - depth : n->prefix_len;
+            size_t stored = len < __art_max_prefix ? len : __art_max_prefix;
+            size_t i = 0;
+            for(; i < stored; i++)
+                if(n->prefix[i] != k[depth + i]) return i;
+            if(i < len)
+            {
+                __art_key lk(static_cast<__leaf*>(__art_minimum(n))->value.first);
+                for(; i < len; i++)
+                    if(lk[depth + i] != k[depth + i]) return i;
+            }
+            return i;
+        }
+
+        __art_link* __lower_bound(const __art_key& k)
+        {
+            void* p = __root;
+            size_t depth = 0;
+            if(!p) return &__head;
+            for(;;)
+            {
+                if(__art_is_leaf(p))
+                {
+                    __leaf* l = __as_leaf(p);
+                    return __art_key(l->value.first).compare(k) >= 0 ? static_cast<__art_link*>(l) : l->next;
+                }
+                __art_node* n = __art_node_of(p);
+                if(n->prefix_len)
+                {
+                    size_t i = __prefix_mismatch(n, k, depth);
+                    if(i < n->prefix_len)
+                    {
+                        // key更短, 或者在第i个字节更小: 整个子树都不小于key; 否则整个子树都小于key
+                        if(depth + i == k.size() || k[depth + i] < __prefix_byte(n, depth, i)) return __art_minimum(p);
+                        return __art_maximum(p)->next;
+                    }
+                    depth += n->prefix_len;
+                }
+                if(depth == k.size()) return __art_minimum(p);
+                uint8_t b = k[depth];
+                void** c = __art_find_child(n, b);
+                if(c)
+                {
+                    p = *c;
+                    ++depth;
+                    continue;
+                }
+                void* next = __art_next_child(n, b);
+                return next ? __art_minimum(next) : __art_maximum(p)->next;
+            }
+        }
+
+        /*** 节点分配 ***/
+
+        template <class Node>
+        static Node* __construct_node(node_pool<Node>& pool, __art_kind kind)
+        {
+            Node* n = ::new (static_cast<void*>(pool.allocate())) Node();    // 值初始化, 所有子节点为空
+            n->kind = kind;
+            return n;
+        }
+
+        void __free_node(__art_node* n) noexcept
+        {
+            switch(n->kind)
+            {
+            case __art_node4:  __pool4.deallocate(static_cast<__art_node_4*>(n)); break;
+            case __art_node16: __pool16.deallocate(static_cast<__art_node_16*>(n)); break;
+            case __art_node48: __pool48.deallocate(static_cast<__art_node_48*>(n)); break;
+            default:           __pool256.deallocate(static_cast<__art_node_256*>(n)); break;
+            }
+        }
+
+        static void __copy_header(__art_node* to, const __art_node* from) noexcept
+        {
+            to->count = from->count;
+            to->prefix_len = from->prefix_len;
+            std::memcpy(to->prefix, from->prefix, __art_max_prefix);
+            to->end = from->end;
+        }
+
+        // 换成更大的节点类型, *ref 指向新节点
+        void __grow(void** ref)
+        {
+            __art_node* n = __art_node_of(*ref);
+            __art_node* bigger;
+            switch(n->kind)
+            {
+            case __art_node4:
+            {
+                __art_node_4* m = static_cast<__art_node_4*>(n);
+                __art_node_16* g = __construct_node(__pool16, __art_node16);
+                std::memcpy(g->keys, m->keys, m->count);
+                std::memcpy(g->children, m->children, m->count * sizeof(void*));
+                bigger = g;
+                break;
+            }
+            case __art_node16:
+            {
+                __art_node_16* m = static_cast<__art_node_16*>(n);
+                __art_node_48* g = __construct_node(__pool48, __art_node48);
+                for(unsigned i = 0; i < m->count; i++)
+                {
+                    g->index[m->keys[i]] = static_cast<uint8_t>(i + 1);
+                    g->children[i] = m->children[i];
+                }
+                bigger = g;
+                break;
+            }
+            default:
+            {
+                __art_node_48* m = static_cast<__art_node_48*>(n);
+                __art_node_256* g = __construct_node(__pool256, __art_node256);
+                for(unsigned b = 0; b < 256; b++)
+                    if(m->index[b]) g->children[b] = m->children[m->index[b] - 1];
+                bigger = g;
+                break;
+            }
+            }
+            __copy_header(bigger, n);
+            __free_node(n);
+            *ref = bigger;
+        }
+
+        // 子节点数降到阈值以下时换成更小的节点类型; 阈值低于增长的边界, 避免在边界上反复转换
+        void __shrink(void** ref)
+        {
+            __art_node* n = __art_node_of(*ref);
+            __art_node* smaller;
+            switch(n->kind)
+            {
+            case __art_node16:
+            {
+                if(n->count > 3) return;
+                __art_node_16* m = static_cast<__art_node_16*>(n);
+                __art_node_4* s = __pool4.allocate();
+                std::memcpy(s->keys, m->keys, m->count);
+                std::memcpy(s->children, m->children, m->count * sizeof(void*));
+                s->kind = __art_node4;
+                smaller = s;
+                break;
+            }
+            case __art_node48:
+            {
+                if(n->count > 12) return;
+                __art_node_48* m = static_cast<__art_node_48*>(n);
+                __art_node_16* s = __pool16.allocate();
+                unsigned j = 0;
+                for(unsigned b = 0; b < 256; b++)
+                {
+                    if(!m->index[b]) continue;
+                    s->keys[j] = static_cast<uint8_t>(b);
+                    s->children[j++] = m->children[m->index[b] - 1];
+                }
+                s->kind = __art_node16;
+                smaller = s;
+                break;
+            }
+            case __art_node256:
+            {
+                if(n->count > 36) return;
+                __art_node_256* m = static_cast<__art_node_256*>(n);
+                __art_node_48* s = __construct_node(__pool48, __art_node48);
+                unsigned j = 0;
+                for(unsigned b = 0; b < 256; b++)
+                {
+                    if(!m->children[b]) continue;
+                    s->index[b] = static_cast<uint8_t>(j + 1);
+                    s->children[j++] = m->children[b];
+                }
+                smaller = s;
+                break;
+            }
+            default:
+                return;
+            }
+            __copy_header(smaller, n);
+            __free_node(n);
+            *ref = smaller;
+        }
+
+        // 只剩一个子节点且没有end的节点和子节点合并: 前缀 = 节点前缀 + 分支字节 + 子节点前缀
+        void __collapse(void** ref) noexcept
+        {
+            __art_node* n = __art_node_of(*ref);
+            // 更大的节点类型在子节点数降到这里之前已经缩小成了Node4
+            assert(n->kind == __art_node4 && n->count == 1 && !n->end);
+            __art_node_4* m = static_cast<__art_node_4*>(n);
+            uint8_t b = m->keys[0];
+            void* child = m->children[0];
+            if(!__art_is_leaf(child))
+            {
+                __art_node* c = __art_node_of(child);
+                uint8_t buf[__art_max_prefix];
+                size_t len = 0;
+                for(size_t i = 0; i < n->prefix_len && len < __art_max_prefix; i++) buf[len++] = n->prefix[i];
+                if(len < __art_max_prefix) buf[len++] = b;
+                for(size_t i = 0; i < c->prefix_len && len < __art_max_prefix; i++) buf[len++] = c->prefix[i];
+                std::memcpy(c->prefix, buf, len);
+                c->prefix_len += n->prefix_len + 1;
+            }
+            *ref = child;
+            __free_node(n);
+        }
+
+        // 从*ref节点中删除字节b的子节点 (一个叶子), 之后按需要缩小或合并
+        void __remove_child(void** ref, uint8_t b) noexcept
+        {
+            __art_node* n = __art_node_of(*ref);
+            __art_remove_child(n, b);
+            if(n->count == 0)
+            {
+                // 只剩end
+                *ref = n->end;
+                __free_node(n);
+            }
+            else if(n->count == 1 && !n->end) __collapse(ref);
+            else __shrink(ref);
+        }
+
+        template <class K, class... Args>
+        __leaf* __make_leaf(K&& key, Args&&... args)
+        {
+            __leaf* l = __leaves.allocate();
+            try
+            {
+                ::new (static_cast<void*>(l)) __leaf(mySTL::forward<K>(key), mySTL::forward<Args>(args)...);
+            }
+            catch(...)
+            {
+                __leaves.deallocate(l);
+                throw;
+            }
+            ++__size;
+            return l;
+        }
+
+        void __destroy_leaf(__leaf* l) noexcept
+        {
+            l->prev->next = l->next;
+            l->next->prev = l->prev;
+            mySTL::destroy(l);
+            __leaves.deallocate(l);
+            --__size;
+        }
+
+        // 新的Node4, 前缀是key从depth开始的len个字节
+        __art_node_4* __new_split_node(const uint8_t* bytes, size_t len)
+        {
+            __art_node_4* n = __construct_node(__pool4, __art_node4);
+            n->prefix_len = static_cast<uint32_t>(len);
+            std::memcpy(n->prefix, bytes, len < __art_max_prefix ? len : __art_max_prefix);
+            return n;
+        }
+
+        template <class K, class... Args>
+        pair<iterator, bool> __insert(K&& key, Args&&... args)
+        {
+            __art_key k(key);
+            void** ref = &__root;
+            size_t depth = 0;
+            for(;;)
+            {
+                void* p = *ref;
+                if(!p)
+                {
+                    __leaf* l = __make_leaf(mySTL::forward<K>(key), mySTL::forward<Args>(args)...);
+                    __link_before(&__head, l);
+                    *ref = __art_tag(l);
+                    return pair<iterator, bool>(iterator(l), true);
+                }
+
+                if(__art_is_leaf(p))
+                {
+                    // 和已有的叶子分开: 新节点的前缀是两个key从depth开始的公共部分
+                    __leaf* e = __as_leaf(p);
+                    __art_key ek(e->value.first);
+                    size_t limit = ek.size() < k.size() ? ek.size() : k.size();
+                    size_t lcp = depth;
+                    while(lcp < limit && ek[lcp] == k[lcp]) lcp++;
+                    if(lcp == ek.size() && lcp == k.size()) return pair<iterator, bool>(iterator(e), false);
+
+                    // key可能被移动到新叶子中, 需要的字节先取出来
+                    bool k_ends = lcp == k.size();
+                    uint8_t kb = k_ends ? 0 : k[lcp];
+                    bool after = ek.compare(k) < 0;
+                    __art_node_4* n = __new_split_node(k.data() + depth, lcp - depth);
+                    __leaf* l;
+                    try
+                    {
+                        l = __make_leaf(mySTL::forward<K>(key), mySTL::forward<Args>(args)...);
+                    }
+                    catch(...)
+                    {
+                        __pool4.deallocate(n);
+                        throw;
+                    }
+                    if(lcp == ek.size()) n->end = p;
+                    else __art_add_child(n, ek[lcp], p);
+                    if(k_ends) n->end = __art_tag(l);
+                    else __art_add_child(n, kb, __art_tag(l));
+                    __link_before(after ? e->next : e, l);
+                    *ref = n;
+                    return pair<iterator, bool>(iterator(l), true);
+                }
+
+                __art_node* n = __art_node_of(p);
+                if(n->prefix_len)
+                {
+                    size_t i = __prefix_mismatch(n, k, depth);
+                    if(i < n->prefix_len)
+                    {
+                        // 在第i个字节处拆开节点前缀
+                        uint8_t b = __prefix_byte(n, depth, i);
+                        bool k_ends = depth + i == k.size();
+                        uint8_t kb = k_ends ? 0 : k[depth + i];
+                        __art_node_4* s = __new_split_node(k.data() + depth, i);
+                        __leaf* l;
+                        try
+                        {
+                            l = __make_leaf(mySTL::forward<K>(key), mySTL::forward<Args>(args)...);
+                        }
+                        catch(...)
+                        {
+                            __pool4.deallocate(s);
+                            throw;
+                        }
+                        __link_before(k_ends || kb < b ? __art_minimum(n) : __art_maximum(n)->next, l);
+
+                        // 原节点的前缀去掉前i + 1个字节
+                        size_t rest = n->prefix_len - i - 1;
+                        if(n->prefix_len <= __art_max_prefix) std::memmove(n->prefix, n->prefix + i + 1, rest);
+                        else
+                        {
+                            __art_key lk(static_cast<__leaf*>(__art_minimum(n))->value.first);
+                            std::memcpy(n->prefix, lk.data() + depth + i + 1, rest < __art_max_prefix ? rest : __art_max_prefix);
+                        }
+                        n->prefix_len = static_cast<uint32_t>(rest);
+
+                        __art_add_child(s, b, n);
+                        if(k_ends) s->end = __art_tag(l);
+                        else __art_add_child(s, kb, __art_tag(l));
+                        *ref = s;
+                        return pair<iterator, bool>(iterator(l), true);
+                    }
+                    depth += n->prefix_len;
+                }
+
+                if(depth == k.size())
+                {
+                    if(n->end) return pair<iterator, bool>(iterator(__as_leaf(n->end)), false);
+                    __leaf* l = __make_leaf(mySTL::forward<K>(key), mySTL::forward<Args>(args)...);
+                    __link_before(__art_minimum(n), l);
+                    n->end = __art_tag(l);
+                    return pair<iterator, bool>(iterator(l), true);
+                }
+
+                uint8_t b = k[depth];
+                void** c = __art_find_child(n, b);
+                if(c)
+                {
+                    ref = c;
+                    ++depth;
+                    continue;
+                }
+
+                // 先扩容再构造叶子, 构造失败时树仍然完整
+                if(__art_full(n))
+                {
+                    __grow(ref);
+                    n = __art_node_of(*ref);
+                }
+                __leaf* l = __make_leaf(mySTL::forward<K>(key), mySTL::forward<Args>(args)...);
+                void* next = __art_next_child(n, b);
+                __link_before(next ? __art_minimum(next) : __art_maximum(n)->next, l);
+                __art_add_child(n, b, __art_tag(l));
+                return pair<iterator, bool>(iterator(l), true);
+            }
+        }
+    };
+
+    template <class Key, class T>
+    inline void swap(radix_tree<Key, T>& lhs, radix_tree<Key, T>& rhs) noexcept {lhs.swap(rhs);}
+}
+#endif // __RADIX_TREE_H__
@@ -0,0 +1,610 @@
+#ifndef __RANGES_H__
+#define __RANGES_H__
+
+// 惰性视图 (transform, filter, take, drop, zip, enumerate), 用管道语法组合:
+//     for(auto x : lst | views::filter(pred) | views::transform(f) | views::take(10))
+// 视图只保存底层范围的引用 (左值容器) 或者拷贝 (视图/右值), 遍历时逐个计算, 不分配内存也不产生中间容器
+// 视图迭代器的类别由底层迭代器决定 (最高到random_access), 随机访问的视图distance/advance仍然是O(1)
+// 视图的迭代器指向视图本身, 视图必须比迭代器活得久
+
+#include <cstddef>
+#include "type_traits.h"
+#include "utils.h"
+#include "iterator.h"
+#include "pair.h"
+
+namespace mySTL
+{
+    // 所有视图的基类, 用于区分视图和容器
+    struct view_base {};
+
+    template <class R>
+    struct __is_view : bool_constant<mySTL::is_base_of<view_base, typename mySTL::decay<R>::type>::value> {};
+
+    template <class R>
+    using __range_iterator_t = decltype(mySTL::declval<R&>().begin());
+
+    template <class Iterator>
+    using __iter_category_t = typename iterator_traits<Iterator>::iterator_category;
+
+    template <class Iterator>
+    using __iter_reference_t = decltype(*mySTL::declval<Iterator&>());
+
+    // 类别不超过Max (例如contiguous计算之后只能是random_access)
+    template <class Category, class Max>
+    using __cap_category_t = typename conditional<mySTL::is_base_of<Max, Category>::value, Max, Category>::type;
+
+    // 两个类别中较弱的一个
+    template <class C1, class C2>
+    using __min_category_t = typename conditional<mySTL::is_base_of<C1, C2>::value, C1, C2>::type;
+
+    template <class Category>
+    struct __is_random_access : bool_constant<mySTL::is_base_of<random_access_iterator_tag, Category>::value> {};
+
+    /**
+     * @brief ref_view
+     * 引用一个左值容器
+     */
+    template <class R>
+    class ref_view : public view_base
+    {
+    private:
+        R* __r;
+
+    public:
+        ref_view(R& r) noexcept : __r(&r) {}
+
+        auto begin() const -> decltype(__r->begin()) {return __r->begin();}
+        auto end()   const -> decltype(__r->end())   {return __r->end();}
+        R&   base()  const noexcept {return *__r;}
+    };
+
+    /**
+     * @brief owning_view
+     * 保存一个右值容器, 例如 make_list() | views::filter(...)
+     */
+    template <class R>
+    class owning_view : public view_base
+    {
+    private:
+        R __r;
+
+    public:
+        owning_view(R&& r) : __r(mySTL::move(r)) {}
+
+        auto begin()       -> decltype(__r.begin()) {return __r.begin();}
+        auto end()         -> decltype(__r.end())   {return __r.end();}
+        R&   base() noexcept {return __r;}
+    };
+
+    // 视图按值保存, 左值容器用ref_view, 右值容器用owning_view
+    template <class R, bool = __is_view<R>::value, bool = mySTL::is_lvalue_reference<R>::value>
+    struct __all {typedef typename mySTL::decay<R>::type type;};
+
+    template <class R>
+    struct __all<R, false, true> {typedef ref_view<typename mySTL::remove_reference<R>::type> type;};
+
+    template <class R>
+    struct __all<R, false, false> {typedef owning_view<typename mySTL::remove_reference<R>::type> type;};
+
+    template <class R>
+    using __all_t = typename __all<R>::type;
+
+    // 视图的大小, 底层为随机访问时O(1)
+    template <class View>
+    inline auto __view_size(View& v) -> decltype(v.end() - v.begin())
+    {
+        return v.end() - v.begin();
+    }
+
+    // begin()的缓存: 拷贝/移动视图时不带走缓存, 因为缓存的迭代器指向原视图的底层范围
+    // (owning_view拷贝后是另一个容器, 沿用原来的迭代器会悬空)
+    template <class It>
+    struct __begin_cache
+    {
+        It   it;
+        bool valid;
+
+        __begin_cache() : it(), valid(false) {}
+        __begin_cache(const __begin_cache&) : it(), valid(false) {}
+        __begin_cache& operator=(const __begin_cache&) {it = It(); valid = false; return *this;}
+    };
+
+    /**
+     * @brief __view_iterator_base
+     * 用Derived的 ++/--/+=/- 和比较实现其余运算符, 视图迭代器都继承它
+     */
+    template <class Derived, class Category, class Value, class Reference>
+    struct __view_iterator_base
+    {
+        typedef Category        iterator_category;
+        typedef Value           value_type;
+        typedef void            pointer;
+        typedef Reference       reference;
+        typedef ptrdiff_t       difference_type;
+
+        Derived&       __self()       {return static_cast<Derived&>(*this);}
+        const Derived& __self() const {return static_cast<const Derived&>(*this);}
+
+        Derived operator++(int) {Derived tmp = __self(); ++__self(); return tmp;}
+        Derived operator--(int) {Derived tmp = __self(); --__self(); return tmp;}
+        Derived& operator-=(difference_type n) {return __self() += -n;}
+        Derived operator+(difference_type n) const {Derived tmp = __self(); return tmp += n;}
+        Derived operator-(difference_type n) const {Derived tmp = __self(); return tmp += -n;}
+        friend Derived operator+(difference_type n, const Derived& it) {return it + n;}
+        reference operator[](difference_type n) const {return *(__self() + n);}
+
+        friend bool operator!=(const Derived& a, const Derived& b) {return !(a == b);}
+        friend bool operator< (const Derived& a, const Derived& b) {return b - a > 0;}
+        friend bool operator> (const Derived& a, const Derived& b) {return b < a;}
+        friend bool operator<=(const Derived& a, const Derived& b) {return !(b < a);}
+        friend bool operator>=(const Derived& a, const Derived& b) {return !(a < b);}
+    };
+
+    /**
+     * @brief transform_view
+     * 对每个元素调用f, 解引用时计算, 不缓存结果
+     */
+    template <class V, class F>
+    class transform_view : public view_base
+    {
+    private:
+        typedef __range_iterator_t<V> base_iterator;
+
+        V __base;
+        F __f;
+
+    public:
+        class iterator : public __view_iterator_base<iterator,
+                             __cap_category_t<__iter_category_t<base_iterator>, random_access_iterator_tag>,
+                             typename mySTL::decay<decltype(mySTL::declval<F&>()(mySTL::declval<__iter_reference_t<base_iterator>>()))>::type,
+                             decltype(mySTL::declval<F&>()(mySTL::declval<__iter_reference_t<base_iterator>>()))>
+        {
+            friend class transform_view;
+
+        private:
+            const transform_view* __parent;
+            base_iterator         __it;
+
+        public:
+            typedef ptrdiff_t difference_type;
+            typedef decltype(mySTL::declval<F&>()(mySTL::declval<__iter_reference_t<base_iterator>>())) reference;
+
+            iterator() : __parent(nullptr), __it() {}
+            iterator(const transform_view* parent, base_iterator it) : __parent(parent), __it(it) {}
+
+            reference operator*() const {return const_cast<F&>(__parent->__f)(*__it);}
+            iterator& operator++() {++__it; return *this;}
+            iterator& operator--() {--__it; return *this;}
+            iterator& operator+=(difference_type n) {__it += n; return *this;}
+            friend difference_type operator-(const iterator& a, const iterator& b) {return a.__it - b.__it;}
+            friend bool operator==(const iterator& a, const iterator& b) {return a.__it == b.__it;}
+
+            const base_iterator& base() const noexcept {return __it;}
+        };
+
+    public:
+        transform_view(V base, F f) : __base(mySTL::move(base)), __f(mySTL::move(f)) {}
+
+        iterator begin() const {return iterator(this, const_cast<V&>(__base).begin());}
+        iterator end()   const {return iterator(this, const_cast<V&>(__base).end());}
+        template <class T = V>
+        auto size() const -> decltype(__view_size(const_cast<T&>(__base))) {return __view_size(const_cast<T&>(__base));}
+    };
+
+    /**
+     * @brief filter_view
+     * 只保留满足pred的元素, 最高为双向迭代器
+     * 第一个满足条件的位置在第一次begin()时求出并缓存, 多次遍历不会重复查找; 拷贝出的视图重新查找
+     */
+    template <class V, class Pred>
+    class filter_view : public view_base
+    {
+    private:
+        typedef __range_iterator_t<V> base_iterator;
+
+        V                                      __base;
+        Pred                                   __pred;
+        mutable __begin_cache<base_iterator>   __first;
+
+    public:
+        class iterator : public __view_iterator_base<iterator,
+                             __cap_category_t<__iter_category_t<base_iterator>, bidirectional_iterator_tag>,
+                             typename iterator_traits<base_iterator>::value_type,
+                             __iter_reference_t<base_iterator>>
+        {
+            friend class filter_view;
+
+        private:
+            const filter_view* __parent;
+            base_iterator      __it;
+
+        public:
+            iterator() : __parent(nullptr), __it() {}
+            iterator(const filter_view* parent, base_iterator it) : __parent(parent), __it(it) {}
+
+            __iter_reference_t<base_iterator> operator*() const {return *__it;}
+            iterator& operator++()
+            {
+                base_iterator last = const_cast<V&>(__parent->__base).end();
+                do ++__it; while(__it != last && !__parent->__satisfy(*__it));
+                return *this;
+            }
+            iterator& operator--()
+            {
+                do --__it; while(!__parent->__satisfy(*__it));
+                return *this;
+            }
+            friend bool operator==(const iterator& a, const iterator& b) {return a.__it == b.__it;}
+
+            const base_iterator& base() const noexcept {return __it;}
+        };
+
+    public:
+        filter_view(V base, Pred pred)
+            : __base(mySTL::move(base)), __pred(mySTL::move(pred)), __first() {}
+
+        iterator begin() const
+        {
+            if(!__first.valid)
+            {
+                base_iterator it = const_cast<V&>(__base).begin(), last = const_cast<V&>(__base).end();
+                while(it != last && !__satisfy(*it)) ++it;
+                __first.it = it;
+                __first.valid = true;
+            }
+            return iterator(this, __first.it);
+        }
+        iterator end() const {return iterator(this, const_cast<V&>(__base).end());}
+
+    private:
+        template <class Ref>
+        bool __satisfy(Ref&& x) const {return const_cast<Pred&>(__pred)(mySTL::forward<Ref>(x));}
+    };
+
+    /**
+     * @brief take_view
+     * 最多前n个元素; 底层为随机访问时仍是随机访问 (结束位置直接算出), 否则最高为单向迭代器
+     */
+    template <class V>
+    class take_view : public view_base
+    {
+    private:
+        typedef __range_iterator_t<V> base_iterator;
+        typedef __cap_category_t<__iter_category_t<base_iterator>, random_access_iterator_tag> base_category;
+        static constexpr bool __random = __is_random_access<base_category>::value;
+
+        V         __base;
+        ptrdiff_t __count;
+
+    public:
+        class iterator : public __view_iterator_base<iterator,
+                             typename conditional<__random, random_access_iterator_tag,
+                                 __cap_category_t<base_category, forward_iterator_tag>>::type,
+                             typename iterator_traits<base_iterator>::value_type,
+                             __iter_reference_t<base_iterator>>
+        {
+        private:
+            base_iterator __it;
+            ptrdiff_t     __index;  // 已经走过的元素个数
+
+        public:
+            typedef ptrdiff_t difference_type;
+
+            iterator() : __it(), __index(0) {}
+            iterator(base_iterator it, ptrdiff_t index) : __it(it), __index(index) {}
+
+            __iter_reference_t<base_iterator> operator*() const {return *__it;}
+            iterator& operator++() {++__it; ++__index; return *this;}
+            iterator& operator--() {--__it; --__index; return *this;}
+            iterator& operator+=(difference_type n) {__it += n; __index += n; return *this;}
+            friend difference_type operator-(const iterator& a, const iterator& b) {return a.__index - b.__index;}
+            // 走满n个, 或者底层范围先结束
+            friend bool operator==(const iterator& a, const iterator& b) {return a.__index == b.__index || a.__it == b.__it;}
+
+            const base_iterator& base() const noexcept {return __it;}
+        };
+
+    public:
+        take_view(V base, ptrdiff_t count) : __base(mySTL::move(base)), __count(count < 0 ? 0 : count) {}
+
+        iterator begin() const {return iterator(const_cast<V&>(__base).begin(), 0);}
+        iterator end() const {return __end(bool_constant<__random>());}
+        template <bool R = __random, class = typename enable_if<R>::type>
+        ptrdiff_t size() const {return end() - begin();}
+
+    private:
+        iterator __end(true_type) const
+        {
+            base_iterator first = const_cast<V&>(__base).begin();
+            ptrdiff_t n = const_cast<V&>(__base).end() - first;
+            if(n > __count) n = __count;
+            return iterator(first + n, n);
+        }
+
+        iterator __end(false_type) const {return iterator(const_cast<V&>(__base).end(), __count);}
+    };
+
+    /**
+     * @brief drop_view
+     * 跳过前n个元素, 迭代器就是底层迭代器, 类别不变
+     * 非随机访问时跳过后的起点在第一次begin()时缓存
+     */
+    template <class V>
+    class drop_view : public view_base
+    {
+    private:
+        typedef __range_iterator_t<V> base_iterator;
+
+        V                                      __base;
+        ptrdiff_t                              __count;
+        mutable __begin_cache<base_iterator>   __first;
+
+    public:
+        typedef base_iterator iterator;
+
+        drop_view(V base, ptrdiff_t count)
+            : __base(mySTL::move(base)), __count(count < 0 ? 0 : count), __first() {}
+
+        iterator begin() const
+        {
+            if(!__first.valid)
+            {
+                __first.it = __begin(__iter_category_t<base_iterator>());
+                __first.valid = true;
+            }
+            return __first.it;
+        }
+        iterator end() const {return const_cast<V&>(__base).end();}
+        template <class T = V>
+        auto size() const -> decltype(__view_size(const_cast<T&>(__base))) {return end() - begin();}
+
+    private:
+        iterator __begin(input_iterator_tag) const
+        {
+            base_iterator it = const_cast<V&>(__base).begin(), last = end();
+            for(ptrdiff_t i = 0; i < __count && it != last; ++i) ++it;
+            return it;
+        }
+
+        iterator __begin(random_access_iterator_tag) const
+        {
+            base_iterator first = const_cast<V&>(__base).begin();
+            ptrdiff_t n = end() - first;
+            return first + (n < __count ? n : __count);
+        }
+    };
+
+    /**
+     * @brief zip_view
+     * 同时遍历两个范围, 元素为 pair<引用1, 引用2>, 长度取较短的一个
+     * 两者都随机访问时为随机访问, 否则最高为单向迭代器
+     */
+    template <class V1, class V2>
+    class zip_view : public view_base
+    {
+    private:
+        typedef __range_iterator_t<V1> base_iterator1;
+        typedef __range_iterator_t<V2> base_iterator2;
+        typedef __min_category_t<__cap_category_t<__iter_category_t<base_iterator1>, random_access_iterator_tag>,
+                                 __cap_category_t<__iter_category_t<base_iterator2>, random_access_iterator_tag>> base_category;
+        static constexpr bool __random = __is_random_access<base_category>::value;
+
+        V1 __base1;
+        V2 __base2;
+
+    public:
+        typedef pair<__iter_reference_t<base_iterator1>, __iter_reference_t<base_iterator2>> reference;
+
+        class iterator : public __view_iterator_base<iterator,
+                             typename conditional<__random, random_access_iterator_tag,
+                                 __cap_category_t<base_category, forward_iterator_tag>>::type,
+                             pair<typename iterator_traits<base_iterator1>::value_type,
+                                  typename iterator_traits<base_iterator2>::value_type>,
+                             reference>
+        {
+        private:
+            base_iterator1 __it1;
+            base_iterator2 __it2;
+
+        public:
+            typedef ptrdiff_t difference_type;
+
+            iterator() : __it1(), __it2() {}
+            iterator(base_iterator1 it1, base_iterator2 it2) : __it1(it1), __it2(it2) {}
+
+            reference operator*() const {return reference(*__it1, *__it2);}
+            iterator& operator++() {++__it1; ++__it2; return *this;}
+            iterator& operator--() {--__it1; --__it2; return *this;}
+            iterator& operator+=(difference_type n) {__it1 += n; __it2 += n; return *this;}
+            friend difference_type operator-(const iterator& a, const iterator& b) {return a.__it1 - b.__it1;}
+            // 任意一个到达结尾就结束
+            friend bool operator==(const iterator& a, const iterator& b) {return a.__it1 == b.__it1 || a.__it2 == b.__it2;}
+        };
+
+    public:
+        zip_view(V1 base1, V2 base2) : __base1(mySTL::move(base1)), __base2(mySTL::move(base2)) {}
+
+        iterator begin() const {return iterator(const_cast<V1&>(__base1).begin(), const_cast<V2&>(__base2).begin());}
+        iterator end() const {return __end(bool_constant<__random>());}
+        template <bool R = __random, class = typename enable_if<R>::type>
+        ptrdiff_t size() const {return end() - begin();}
+
+    private:
+        iterator __end(true_type) const
+        {
+            base_iterator1 first1 = const_cast<V1&>(__base1).begin();
+            base_iterator2 first2 = const_cast<V2&>(__base2).begin();
+            ptrdiff_t n1 = const_cast<V1&>(__base1).end() - first1;
+            ptrdiff_t n2 = const_cast<V2&>(__base2).end() - first2;
+            ptrdiff_t n = n1 < n2 ? n1 : n2;
+            return iterator(first1 + n, first2 + n);
+        }
+
+        iterator __end(false_type) const
+        {
+            return iterator(const_cast<V1&>(__base1).end(), const_cast<V2&>(__base2).end());
+        }
+    };
+
+    /**
+     * @brief enumerate_view
+     * 元素为 pair<下标, 引用>; 底层随机访问时为随机访问, 否则最高为单向迭代器
+     */
+    template <class V>
+    class enumerate_view : public view_base
+    {
+    private:
+        typedef __range_iterator_t<V> base_iterator;
+        typedef __cap_category_t<__iter_category_t<base_iterator>, random_access_iterator_tag> base_category;
+        static constexpr bool __random = __is_random_access<base_category>::value;
+
+        V __base;
+
+    public:
+        typedef pair<size_t, __iter_reference_t<base_iterator>> reference;
+
+        class iterator : public __view_iterator_base<iterator,
+                             typename conditional<__random, random_access_iterator_tag,
+                                 __cap_category_t<base_category, forward_iterator_tag>>::type,
+                             pair<size_t, typename iterator_traits<base_iterator>::value_type>,
+                             reference>
+        {
+        private:
+            base_iterator __it;
+            ptrdiff_t     __index;
+
+        public:
+            typedef ptrdiff_t difference_type;
+
+            iterator() : __it(), __index(0) {}
+            iterator(base_iterator it, ptrdiff_t index) : __it(it), __index(index) {}
+
+            reference operator*() const {return reference(static_cast<size_t>(__index), *__it);}
+            iterator& operator++() {++__it; ++__index; return *this;}
+            iterator& operator--() {--__it; --__index; return *this;}
+            iterator& operator+=(difference_type n) {__it += n; __index += n; return *this;}
+            friend difference_type operator-(const iterator& a, const iterator& b) {return a.__index - b.__index;}
+            friend bool operator==(const iterator& a, const iterator& b) {return a.__it == b.__it;}
+
+            const base_iterator& base() const noexcept {return __it;}
+        };
+
+    public:
+        explicit enumerate_view(V base) : __base(mySTL::move(base)) {}
+
+        iterator begin() const {return iterator(const_cast<V&>(__base).begin(), 0);}
+        iterator end() const {return __end(bool_constant<__random>());}
+        template <bool R = __random, class = typename enable_if<R>::type>
+        ptrdiff_t size() const {return end() - begin();}
+
+    private:
+        iterator __end(true_type) const
+        {
+            base_iterator first = const_cast<V&>(__base).begin(), last = const_cast<V&>(__base).end();
+            return iterator(last, last - first);
+        }
+
+        // 结束位置的下标未知, 只比较底层迭代器
+        iterator __end(false_type) const {return iterator(const_cast<V&>(__base).end(), 0);}
+    };
+
+    /**
+     * @brief __range_adaptor_closure
+     * 保存除范围以外的参数, r | closure 等价于 closure(r); 两个closure可以先组合再作用于范围
+     */
+    template <class Fn>
+    struct __range_adaptor_closure
+    {
+        Fn __fn;
+
+        template <class R>
+        auto operator()(R&& r) const -> decltype(__fn(mySTL::forward<R>(r))) {return __fn(mySTL::forward<R>(r));}
+    };
+
+    template <class Fn>
+    inline __range_adaptor_closure<Fn> __make_closure(Fn fn) {return __range_adaptor_closure<Fn>{mySTL::move(fn)};}
+
+    template <class T>
+    struct __is_range_adaptor_closure : false_type {};
+
+    template <class Fn>
+    struct __is_range_adaptor_closure<__range_adaptor_closure<Fn>> : true_type {};
+
+    template <class R, class Fn, class = typename enable_if<
+        !__is_range_adaptor_closure<typename mySTL::decay<R>::type>::value>::type>
+    inline auto operator|(R&& r, const __range_adaptor_closure<Fn>& c) -> decltype(c(mySTL::forward<R>(r)))
+    {
+        return c(mySTL::forward<R>(r));
+    }
+
+    template <class Fn1, class Fn2>
+    inline auto operator|(__range_adaptor_closure<Fn1> c1, __range_adaptor_closure<Fn2> c2)
+    {
+        return __make_closure([c1, c2](auto&& r) {
+            return c2(c1(mySTL::forward<decltype(r)>(r)));
+        });
+    }
+
+    namespace views
+    {
+        template <class R>
+        inline __all_t<R> all(R&& r) {return __all_t<R>(mySTL::forward<R>(r));}
+
+        template <class R, class F>
+        inline transform_view<__all_t<R>, typename mySTL::decay<F>::type> transform(R&& r, F&& f)
+        {
+            return {all(mySTL::forward<R>(r)), mySTL::forward<F>(f)};
+        }
+
+        template <class F>
+        inline auto transform(F f)
+        {
+            return __make_closure([f](auto&& r) {return transform(mySTL::forward<decltype(r)>(r), f);});
+        }
+
+        template <class R, class Pred>
+        inline filter_view<__all_t<R>, typename mySTL::decay<Pred>::type> filter(R&& r, Pred&& pred)
+        {
+            return {all(mySTL::forward<R>(r)), mySTL::forward<Pred>(pred)};
+        }
+
+        template <class Pred>
+        inline auto filter(Pred pred)
+        {
+            return __make_closure([pred](auto&& r) {return filter(mySTL::forward<decltype(r)>(r), pred);});
+        }
+
+        template <class R>
+        inline take_view<__all_t<R>> take(R&& r, ptrdiff_t n) {return {all(mySTL::forward<R>(r)), n};}
+
+        inline auto take(ptrdiff_t n)
+        {
+            return __make_closure([n](auto&& r) {return take(mySTL::forward<decltype(r)>(r), n);});
+        }
+
+        template <class R>
+        inline drop_view<__all_t<R>> drop(R&& r, ptrdiff_t n) {return {all(mySTL::forward<R>(r)), n};}
+
+        inline auto drop(ptrdiff_t n)
+        {
+            return __make_closure([n](auto&& r) {return drop(mySTL::forward<decltype(r)>(r), n);});
+        }
+
+        template <class R1, class R2>
+        inline zip_view<__all_t<R1>, __all_t<R2>> zip(R1&& r1, R2&& r2)
+        {
+            return {all(mySTL::forward<R1>(r1)), all(mySTL::forward<R2>(r2))};
+        }
+
+        template <class R>
+        inline enumerate_view<__all_t<R>> enumerate(R&& r) {return enumerate_view<__all_t<R>>(all(mySTL::forward<R>(r)));}
+
+        // r | views::enumerate
+        inline auto enumerate()
+        {
+            return __make_closure([](auto&& r) {return enumerate(mySTL::forward<decltype(r)>(r));});
+        }
+    }
+}
+#endif // __RANGES_H__
@@ -0,0 +1,448 @@
+#ifndef __SERIALIZATION_H__
+#define __SERIALIZATION_H__
+
+// 二进制序列化, 连续存储且元素平凡可拷贝的容器整块写入, 读取时直接在缓冲区 (或mmap) 上得到视图, 不拷贝
+// 格式: [文件头 16B] 之后是若干块, 每块为 [块头 16B][填充到元素对齐][元素数组][填充到8字节]
+// 块头记录元素个数、sizeof和alignof, 读取时校验类型大小; 文件头记录字节序, 不同字节序的机器之间不能直接读
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include "type_traits.h"
+#include "utils.h"
+#include "pair.h"
+#include "mmap_resource.h"
+
+namespace mySTL
+{
+    struct __serial_file_header
+    {
+        char     magic[8];   // "MYSTLSER"
+        uint32_t version;
+        uint32_t endian;     // 写入0x01020304, 读到其他值说明字节序不同
+    };
+
+    struct __serial_block_header
+    {
+        uint64_t count;      // 元素个数
+        uint32_t elem_size;
+        uint32_t elem_align;
+    };
+
+    static constexpr uint32_t __serial_version = 1;
+    static constexpr uint32_t __serial_endian  = 0x01020304;
+    static constexpr size_t   __serial_align   = 8;  // 块头的对齐
+    static constexpr size_t   __serial_buffer_align = 64; // writer缓冲区的对齐, 也是支持的最大元素对齐
+
+    constexpr size_t __serial_align_up(size_t n, size_t align)
+    {
+        return (n + align - 1) & ~(align - 1);
+    }
+
+    // 数据相对块头的偏移
+    constexpr size_t __serial_data_offset(size_t header_offset, size_t elem_align)
+    {
+        return __serial_align_up(header_offset + sizeof(__serial_block_header),
+                                 elem_align > __serial_align ? elem_align : __serial_align);
+    }
+
+    // 是否是可以整块写入的连续容器: 有data()和size(), 元素平凡可拷贝
+    template <class C, class = void>
+    struct __is_serial_contiguous : false_type {};
+
+    template <class C>
+    struct __is_serial_contiguous<C, mySTL::void_t<decltype(mySTL::declval<const C&>().data()),
+                                            decltype(mySTL::declval<const C&>().size())>>
+        : bool_constant<mySTL::is_trivially_copyable<
+              typename mySTL::remove_cv<typename mySTL::remove_pointer<
+                  decltype(mySTL::declval<const C&>().data())>::type>::type>::value> {};
+
+    /**
+     * @brief serial_view
+     * 指向序列化缓冲区内部的只读数组视图, 不拥有内存, 缓冲区释放后失效
+     * @tparam T
+     */
+    template <class T>
+    class serial_view
+    {
+    public:
+        typedef T           value_type;
+        typedef const T*    const_pointer;
+        typedef const T&    const_reference;
+        typedef const T*    const_iterator;
+        typedef const T*    iterator;
+        typedef size_t      size_type;
+
+    private:
+        const T*  __data;
+        size_type __size;
+
+    public:
+        constexpr serial_view() noexcept : __data(nullptr), __size(0) {}
+        constexpr serial_view(const T* data, size_type n) noexcept : __data(data), __size(n) {}
+
+        const_iterator  begin() const noexcept {return __data;}
+        const_iterator  end()   const noexcept {return __data + __size;}
+        const_pointer   data()  const noexcept {return __data;}
+        size_type       size()  const noexcept {return __size;}
+        bool            empty() const noexcept {return __size == 0;}
+        const_reference operator[](size_type i) const noexcept {return __data[i];}
+    };
+
+    class binary_writer;
+
+    /**
+     * @brief serial_stream
+     * 流式写入一个块, 元素个数事先未知 (例如list等节点容器), 结束时回填块头中的个数
+     * 析构时自动finish; 流finish之前不能对同一个binary_writer调用其他写入接口 (包括再开一个流),
+     * 否则那些数据会写进这个块的中间
+     * @tparam T 平凡可拷贝类型
+     */
+    template <class T>
+    class serial_stream
+    {
+        static_assert(mySTL::is_trivially_copyable<T>::value, "serial_stream requires trivially copyable T");
+
+    private:
+        binary_writer* __writer;
+        size_t         __header;  // 块头在缓冲区中的偏移, 缓冲区扩容后依然有效
+        uint64_t       __count;
+
+    public:
+        serial_stream(binary_writer& writer);
+        serial_stream(serial_stream&& other) noexcept
+            : __writer(other.__writer), __header(other.__header), __count(other.__count)
+        {
+            other.__writer = nullptr;
+        }
+        serial_stream(const serial_stream&) = delete;
+        serial_stream& operator=(const serial_stream&) = delete;
+        ~serial_stream() {finish();}
+
+        void push(const T& value);
+        uint64_t count() const noexcept {return __count;}
+
+        // 回填个数并补齐块尾, 之后不能再push; 块尾填充在push时已经预留, 不会分配内存
+        void finish() noexcept;
+    };
+
+    /**
+     * @brief binary_writer
+     * 把数据写入内存缓冲区, 缓冲区按64字节对齐, 完成后可以save到文件或直接交给binary_reader
+     */
+    class binary_writer
+    {
+        template <class T> friend class serial_stream;
+
+    private:
+        char*  __buf;
+        size_t __size;
+        size_t __cap;
+
+    public:
+        binary_writer() : __buf(nullptr), __size(0), __cap(0)
+        {
+            __serial_file_header h;
+            std::memcpy(h.magic, "MYSTLSER", 8);
+            h.version = __serial_version;
+            h.endian = __serial_endian;
+            __append(&h, sizeof(h));
+        }
+
+        binary_writer(const binary_writer&) = delete;
+        binary_writer& operator=(const binary_writer&) = delete;
+
+        ~binary_writer()
+        {
+            if(__buf) ::operator delete(__buf, std::align_val_t(__serial_buffer_align));
+        }
+
+        const void* data() const noexcept {return __buf;}
+        size_t      size() const noexcept {return __size;}
+
+        void reserve(size_t bytes)
+        {
+            if(bytes > __cap) __reallocate(bytes);
+        }
+
+    public:
+        /*** 写入接口 ***/
+
+        // 一段平凡可拷贝的数组, 整块memcpy
+        template <class T>
+        void write_array(const T* data, size_t n)
+        {
+            static_assert(mySTL::is_trivially_copyable<T>::value, "write_array requires trivially copyable T");
+            static_assert(alignof(T) <= __serial_buffer_align, "element alignment is too large");
+            size_t header = __begin_block(sizeof(T), alignof(T));
+            __block_header(header)->count = n;
+            if(n) __append(data, n * sizeof(T));
+            __end_block();
+        }
+
+        // 平凡可拷贝的单个值, 写成只有一个元素的块
+        template <class T>
+        typename enable_if<!__is_serial_contiguous<T>::value>::type
+        write(const T& value)
+        {
+            write_array(&value, 1);
+        }
+
+        // 连续容器 (basic_string, static_vector, mapped_vector, std::vector ...)
+        template <class C>
+        typename enable_if<__is_serial_contiguous<C>::value>::type
+        write(const C& c)
+        {
+            write_array(c.data(), static_cast<size_t>(c.size()));
+        }
+
+        // pair依次写入两个成员, 成员平凡可拷贝时整个pair也可以作为值写入, 这里优先按成员写
+        template <class T1, class T2>
+        void write(const pair<T1, T2>& p)
+        {
+            write(p.first);
+            write(p.second);
+        }
+
+        // 任意迭代器区间 (节点容器), 逐个元素写入
+        template <class InputIterator>
+        void write_range(InputIterator first, InputIterator last)
+        {
+            typedef typename mySTL::remove_cv<typename mySTL::remove_reference<decltype(*first)>::type>::type T;
+            serial_stream<T> s(*this);
+            for(; first != last; ++first) s.push(*first);
+        }
+
+        // 返回的流finish之前不能调用其他写入接口
+        template <class T>
+        serial_stream<T> stream() {return serial_stream<T>(*this);}
+
+        // 写到文件, 失败抛出system_error
+        void save(const char* path) const
+        {
+            int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if(fd < 0) throw std::system_error(errno, std::generic_category(), "open");
+            size_t done = 0;
+            while(done < __size)
+            {
+                ssize_t n = ::write(fd, __buf + done, __size - done);
+                if(n < 0)
+                {
+                    if(errno == EINTR) continue;
+                    int err = errno;
+                    ::close(fd);
+                    throw std::system_error(err, std::generic_category(), "write");
+                }
+                done += static_cast<size_t>(n);
+            }
+            if(::close(fd) != 0) throw std::system_error(errno, std::generic_category(), "close");
+        }
+
+    private:
+        __serial_block_header* __block_header(size_t offset) noexcept
+        {
+            return reinterpret_cast<__serial_block_header*>(__buf + offset);
+        }
+
+        // 写块头和填充, 返回块头偏移
+        size_t __begin_block(size_t elem_size, size_t elem_align)
+        {
+            size_t header = __size;
+            size_t data = __serial_data_offset(header, elem_align);
+            __reserve_more(data - header);
+            __serial_block_header h;
+            h.count = 0;
+            h.elem_size = static_cast<uint32_t>(elem_size);
+            h.elem_align = static_cast<uint32_t>(elem_align);
+            std::memcpy(__buf + header, &h, sizeof(h));
+            std::memset(__buf + header + sizeof(h), 0, data - header - sizeof(h));
+            __size = data;
+            return header;
+        }
+
+        void __end_block()
+        {
+            size_t end = __serial_align_up(__size, __serial_align);
+            __reserve_more(end - __size);
+            std::memset(__buf + __size, 0, end - __size);
+            __size = end;
+        }
+
+        void __append(const void* src, size_t bytes)
+        {
+            __reserve_more(bytes);
+            std::memcpy(__buf + __size, src, bytes);
+            __size += bytes;
+        }
+
+        void __reserve_more(size_t bytes)
+        {
+            if(__cap - __size < bytes)
+            {
+                size_t cap = __cap * 2;
+                if(cap < __size + bytes) cap = __size + bytes;
+                if(cap < 256) cap = 256;
+                __reallocate(cap);
+            }
+        }
+
+        void __reallocate(size_t cap)
+        {
+            char* buf = static_cast<char*>(::operator new(cap, std::align_val_t(__serial_buffer_align)));
+            if(__size) std::memcpy(buf, __buf, __size);
+            if(__buf) ::operator delete(__buf, std::align_val_t(__serial_buffer_align));
+            __buf = buf;
+            __cap = cap;
+        }
+    };
+
+    template <class T>
+    serial_stream<T>::serial_stream(binary_writer& writer)
+        : __writer(&writer), __header(writer.__begin_block(sizeof(T), alignof(T))), __count(0) {}
+
+    template <class T>
+    void serial_stream<T>::push(const T& value)
+    {
+        // 连同块尾填充 (最多__serial_align - 1个字节) 一起预留, finish时不需要扩容
+        __writer->__reserve_more(sizeof(T) + __serial_align - 1);
+        __writer->__append(&value, sizeof(T));
+        ++__count;
+    }
+
+    template <class T>
+    void serial_stream<T>::finish() noexcept
+    {
+        if(!__writer) return;
+        __writer->__block_header(__header)->count = __count;
+        // 空的流数据起点已经对齐, 不需要填充; 否则push时已经预留了填充的空间
+        __writer->__end_block();
+        __writer = nullptr;
+    }
+
+    /**
+     * @brief binary_reader
+     * 按写入顺序读取各个块, 不拷贝缓冲区; 格式错误或类型不匹配时抛出runtime_error
+     * 缓冲区需要按元素对齐 (writer的缓冲区和mmap都满足)
+     */
+    class binary_reader
+    {
+    private:
+        const char* __buf;
+        size_t      __size;
+        size_t      __pos;
+
+    public:
+        binary_reader(const void* data, size_t size)
+            : __buf(static_cast<const char*>(data)), __size(size), __pos(sizeof(__serial_file_header))
+        {
+            __serial_file_header h;
+            if(size < sizeof(h)) throw std::runtime_error("binary_reader: buffer too small");
+            std::memcpy(&h, data, sizeof(h));
+            if(std::memcmp(h.magic, "MYSTLSER", 8) != 0) throw std::runtime_error("binary_reader: bad magic");
+            if(h.endian != __serial_endian) throw std::runtime_error("binary_reader: byte order mismatch");
+            if(h.version != __serial_version) throw std::runtime_error("binary_reader: unsupported version");
+        }
+
+        explicit binary_reader(const binary_writer& writer) : binary_reader(writer.data(), writer.size()) {}
+        explicit binary_reader(const mmap_resource& res) : binary_reader(res.data(), res.size()) {}
+
+        bool   at_end()    const noexcept {return __pos >= __size;}
+        size_t position()  const noexcept {return __pos;}
+
+    public:
+        /*** 读取接口 ***/
+
+        // 零拷贝: 返回指向缓冲区内部的视图
+        template <class T>
+        serial_view<T> read_view()
+        {
+            static_assert(mySTL::is_trivially_copyable<T>::value, "read_view requires trivially copyable T");
+            size_t header = __pos;
+            if(header + sizeof(__serial_block_header) > __size)
+                throw std::runtime_error("binary_reader: unexpected end of buffer");
+            __serial_block_header h;
+            std::memcpy(&h, __buf + header, sizeof(h));
+            if(h.elem_size != sizeof(T) || h.elem_align != alignof(T))
+                throw std::runtime_error("binary_reader: element type mismatch");
+            size_t data = __serial_data_offset(header, alignof(T));
+            if(data > __size || h.count > (__size - data) / sizeof(T))
+                throw std::runtime_error("binary_reader: block exceeds buffer");
+            const char* p = __buf + data;
+            if(reinterpret_cast<uintptr_t>(p) % alignof(T) != 0)
+                throw std::runtime_error("binary_reader: misaligned buffer");
+            size_t n = static_cast<size_t>(h.count);
+            __pos = __serial_align_up(data + n * sizeof(T), __serial_align);
+            return serial_view<T>(reinterpret_cast<const T*>(p), n);
+        }
+
+        // 单个值 (拷贝)
+        template <class T>
+        T read_value()
+        {
+            serial_view<T> v = read_view<T>();
+            if(v.size() != 1) throw std::runtime_error("binary_reader: expected a single value");
+            return v[0];
+        }
+
+        // 拷贝到容器中: 优先用assign(first, last), 否则用assign(ptr, n) (basic_string)
+        template <class C>
+        typename enable_if<__is_serial_contiguous<C>::value>::type
+        read_into(C& c)
+        {
+            typedef typename mySTL::remove_cv<typename mySTL::remove_pointer<
+                decltype(mySTL::declval<const C&>().data())>::type>::type T;
+            serial_view<T> v = read_view<T>();
+            __assign(c, v, 0);
+        }
+
+        // 节点容器等, 只要求有assign(first, last)
+        template <class C, class T = typename C::value_type>
+        auto read_into(C& c) -> typename enable_if<!__is_serial_contiguous<C>::value,
+                                    decltype(c.assign(mySTL::declval<const T*>(), mySTL::declval<const T*>()))>::type
+        {
+            serial_view<typename C::value_type> v = read_view<typename C::value_type>();
+            c.assign(v.begin(), v.end());
+        }
+
+        template <class T1, class T2>
+        void read_into(pair<T1, T2>& p)
+        {
+            __read_member(p.first, 0);
+            __read_member(p.second, 0);
+        }
+
+    private:
+        template <class C, class T>
+        static auto __assign(C& c, const serial_view<T>& v, int) -> decltype(c.assign(v.begin(), v.end()), void())
+        {
+            c.assign(v.begin(), v.end());
+        }
+
+        template <class C, class T>
+        static auto __assign(C& c, const serial_view<T>& v, long) -> decltype(c.assign(v.data(), v.size()), void())
+        {
+            c.assign(v.data(), v.size());
+        }
+
+        // 没有assign的容器 (static_vector)
+        template <class C, class T>
+        static void __assign(C& c, const serial_view<T>& v, ...)
+        {
+            c.clear();
+            for(const T& x : v) c.push_back(x);
+        }
+
+        template <class T>
+        auto __read_member(T& x, int) -> decltype(read_into(x), void()) {read_into(x);}
+
+        template <class T>
+        void __read_member(T& x, long) {x = read_value<T>();}
+    };
+}
+#endif // __SERIALIZATION_H__
@@ -0,0 +1,373 @@
+#ifndef __SLOT_MAP_H__
+#define __SLOT_MAP_H__
+
+// slot_map: 元素连续存放的对象池, 用带代数的64位句柄访问
+// 句柄 = (槽下标, 代数), 槽里记录元素在稠密数组中的位置; 删除时用最后一个元素填补空位并更新它的槽,
+// 同时槽的代数加1, 之后旧句柄的代数对不上, 查找返回nullptr
+// 插入/删除/查找都是O(1), 遍历就是遍历一段连续数组
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+#include "allocator.h"
+#include "construct.h"
+#include "type_traits.h"
+#include "utils.h"
+
+namespace mySTL
+{
+    /**
+     * @brief slot_map的句柄
+     * 默认构造的句柄 (代数为0) 永远无效
+     */
+    struct slot_map_handle
+    {
+        uint32_t index;
+        uint32_t generation;
+
+        constexpr slot_map_handle() noexcept : index(0), generation(0) {}
+        constexpr slot_map_handle(uint32_t index, uint32_t generation) noexcept : index(index), generation(generation) {}
+
+        // 打包成一个64位整数, 方便存放到别处
+        constexpr uint64_t value() const noexcept {return (uint64_t(generation) << 32) | index;}
+        static constexpr slot_map_handle from_value(uint64_t v) noexcept
+        {
+            return slot_map_handle(static_cast<uint32_t>(v), static_cast<uint32_t>(v >> 32));
+        }
+
+        constexpr bool operator==(const slot_map_handle& other) const noexcept {return value() == other.value();}
+        constexpr bool operator!=(const slot_map_handle& other) const noexcept {return value() != other.value();}
+    };
+
+    /**
+     * @brief slot_map
+     * 元素顺序不稳定 (删除会把最后一个元素移到空位), 元素地址在插入/删除后可能改变, 只有句柄是稳定的
+     * 迭代器是原生指针, 按稠密数组顺序遍历
+     * @tparam T 需要可移动构造 (扩容时搬移) 和可移动赋值 (删除时用最后一个元素填补空位)
+     */
+    template <class T>
+    class slot_map
+    {
+    public:
+        typedef T                   value_type;
+        typedef T*                  pointer;
+        typedef const T*            const_pointer;
+        typedef T&                  reference;
+        typedef const T&            const_reference;
+        typedef size_t              size_type;
+        typedef ptrdiff_t           difference_type;
+        typedef slot_map_handle     handle_type;
+
+        typedef T*                  iterator;
+        typedef const T*            const_iterator;
+
+    private:
+        // 使用中: pos为元素在稠密数组中的位置; 空闲: pos为空闲链表的下一个槽
+        struct __slot
+        {
+            uint32_t pos;
+            uint32_t generation;
+        };
+
+        typedef mySTL::allocator<T>         data_allocator;
+        typedef mySTL::allocator<__slot>    slot_allocator;
+        typedef mySTL::allocator<uint32_t>  index_allocator;
+
+        static constexpr uint32_t __npos = 0xFFFFFFFFu;
+
+        T*          __data;         // 稠密数组
+        uint32_t*   __owner;        // __owner[i]: 稠密数组第i个元素所在的槽
+        __slot*     __slots;
+        uint32_t    __size;
+        uint32_t    __capacity;     // 稠密数组和槽数组的容量相同
+        uint32_t    __slot_count;   // 已经启用过的槽
+        uint32_t    __free;         // 空闲槽链表 (后进先出)
+
+    public:
+        slot_map() noexcept
+            : __data(nullptr), __owner(nullptr), __slots(nullptr), __size(0), __capacity(0), __slot_count(0), __free(__npos) {}
+
+        explicit slot_map(size_type n) : slot_map() {reserve(n);}
+
+        // 不委托给默认构造: 拷贝元素抛异常时析构函数不会运行, 在这里归还三个数组
+        slot_map(const slot_map& other)
+            : __data(nullptr), __owner(nullptr), __slots(nullptr), __size(0), __capacity(0), __slot_count(0), __free(__npos)
+        {
+            reserve(other.__slot_count);
+            try
+            {
+                mySTL::uninitialized_copy(other.__data, other.__data + other.__size, __data);
+            }
+            catch(...)
+            {
+                __deallocate();
+                throw;
+            }
+            for(uint32_t i = 0; i < other.__size; i++) __owner[i] = other.__owner[i];
+            for(uint32_t i = 0; i < other.__slot_count; i++) __slots[i] = other.__slots[i];
+            __size = other.__size;
+            __slot_count = other.__slot_count;
+            __free = other.__free;
+        }
+
+        slot_map(slot_map&& other) noexcept
+            : __data(other.__data), __owner(other.__owner), __slots(other.__slots), __size(other.__size),
+              __capacity(other.__capacity), __slot_count(other.__slot_count), __free(other.__free)
+        {
+            other.__data = nullptr;
+            other.__owner = nullptr;
+            other.__slots = nullptr;
+            other.__size = other.__capacity = other.__slot_count = 0;
+            other.__free = __npos;
+        }
+
+        slot_map& operator=(slot_map other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~slot_map()
+        {
+            mySTL::destroy(__data, __data + __size);
+            __deallocate();
+        }
+
+        void swap(slot_map& other) noexcept
+        {
+            mySTL::swap(__data, other.__data);
+            mySTL::swap(__owner, other.__owner);
+            mySTL::swap(__slots, other.__slots);
+            mySTL::swap(__size, other.__size);
+            mySTL::swap(__capacity, other.__capacity);
+            mySTL::swap(__slot_count, other.__slot_count);
+            mySTL::swap(__free, other.__free);
+        }
+
+    public:
+        iterator       begin()       noexcept {return __data;}
+        iterator       end()         noexcept {return __data + __size;}
+        const_iterator begin() const noexcept {return __data;}
+        const_iterator end()   const noexcept {return __data + __size;}
+
+        pointer       data()       noexcept {return __data;}
+        const_pointer data() const noexcept {return __data;}
+
+        size_type size()     const noexcept {return __size;}
+        size_type capacity() const noexcept {return __capacity;}
+        bool      empty()    const noexcept {return __size == 0;}
+
+        void reserve(size_type n)
+        {
+            if(n > __capacity) __reallocate(n);
+        }
+
+    public:
+        /*** 插入 ***/
+
+        handle_type insert(const T& value) {return emplace(value);}
+        handle_type insert(T&& value)      {return emplace(mySTL::move(value));}
+
+        // args可以引用容器中的元素: 需要扩容时先在新空间构造新元素, 再搬移旧元素
+        template <class... Args>
+        handle_type emplace(Args&&... args)
+        {
+            if(__size == __capacity) __grow_emplace(mySTL::forward<Args>(args)...);
+            else mySTL::construct(__data + __size, mySTL::forward<Args>(args)...);
+            uint32_t s;
+            if(__free != __npos)
+            {
+                s = __free;
+                __free = __slots[s].pos;
+            }
+            else
+            {
+                s = __slot_count++;
+                __slots[s].generation = 1;
+            }
+            __slots[s].pos = __size;
+            __owner[__size] = s;
+            ++__size;
+            return handle_type(s, __slots[s].generation);
+        }
+
+        /*** 查找 ***/
+
+        bool contains(handle_type h) const noexcept {return __valid(h);}
+
+        // 句柄失效时返回nullptr
+        pointer find(handle_type h) noexcept
+        {
+            return __valid(h) ? __data + __slots[h.index].pos : nullptr;
+        }
+        const_pointer find(handle_type h) const noexcept
+        {
+            return __valid(h) ? __data + __slots[h.index].pos : nullptr;
+        }
+
+        reference operator[](handle_type h) noexcept
+        {
+            assert(__valid(h));
+            return __data[__slots[h.index].pos];
+        }
+        const_reference operator[](handle_type h) const noexcept
+        {
+            assert(__valid(h));
+            return __data[__slots[h.index].pos];
+        }
+
+        reference at(handle_type h)
+        {
+            if(!__valid(h)) throw std::out_of_range("slot_map::at: stale handle");
+            return __data[__slots[h.index].pos];
+        }
+
+        // 遍历时取得当前元素的句柄
+        handle_type handle_of(const_iterator it) const noexcept
+        {
+            uint32_t s = __owner[it - __data];
+            return handle_type(s, __slots[s].generation);
+        }
+
+        /*** 删除 ***/
+
+        // 句柄失效时返回false
+        bool erase(handle_type h)
+        {
+            if(!__valid(h)) return false;
+            __erase_at(__slots[h.index].pos);
+            return true;
+        }
+
+        // 删除it指向的元素, 返回的迭代器指向原来的最后一个元素 (已移到it的位置)
+        iterator erase(const_iterator it)
+        {
+            uint32_t pos = static_cast<uint32_t>(it - __data);
+            __erase_at(pos);
+            return __data + pos;
+        }
+
+        // 所有句柄失效
+        void clear() noexcept
+        {
+            while(__size) __erase_at(__size - 1);
+        }
+
+    private:
+        bool __valid(handle_type h) const noexcept
+        {
+            return h.index < __slot_count && __slots[h.index].generation == h.generation;
+        }
+
+        // 最后一个元素移到pos, 槽的代数加1后放入空闲链表
+        void __erase_at(uint32_t pos)
+        {
+            uint32_t s = __owner[pos];
+            uint32_t last = __size - 1;
+            if(pos != last)
+            {
+                __data[pos] = mySTL::move(__data[last]);
+                __owner[pos] = __owner[last];
+                __slots[__owner[pos]].pos = pos;
+            }
+            mySTL::destroy(__data + last);
+            --__size;
+            // 代数为0的句柄表示空句柄, 回绕时跳过0
+            if(++__slots[s].generation == 0) __slots[s].generation = 1;
+            __slots[s].pos = __free;
+            __free = s;
+        }
+
+        // 扩容, 并在新空间的__size位置构造新元素
+        template <class... Args>
+        void __grow_emplace(Args&&... args)
+        {
+            if(__capacity == __npos - 1) throw std::length_error("slot_map: too many elements");
+            size_type n = __capacity ? size_type(__capacity) * 2 : 16;
+            if(n >= __npos) n = __npos - 1;
+            T* data = data_allocator::allocate(n);
+            bool constructed = false;
+            try
+            {
+                mySTL::construct(data + __size, mySTL::forward<Args>(args)...);
+                constructed = true;
+                __adopt(data, n);
+            }
+            catch(...)
+            {
+                if(constructed) mySTL::destroy(data + __size);
+                data_allocator::deallocate(data, n);
+                throw;
+            }
+        }
+
+        void __reallocate(size_type n)
+        {
+            if(n >= __npos) throw std::length_error("slot_map: too many elements");
+            T* data = data_allocator::allocate(n);
+            try
+            {
+                __adopt(data, n);
+            }
+            catch(...)
+            {
+                data_allocator::deallocate(data, n);
+                throw;
+            }
+        }
+
+        // 把元素搬到容量为n的新稠密数组data并换上新的槽数组; 失败时原数据不变, data由调用者释放
+        void __adopt(T* data, size_type n)
+        {
+            uint32_t* owner = nullptr;
+            __slot* slots = nullptr;
+            try
+            {
+                owner = index_allocator::allocate(n);
+                slots = slot_allocator::allocate(n);
+                __relocate(__data, __data + __size, data);
+            }
+            catch(...)
+            {
+                if(slots) slot_allocator::deallocate(slots, n);
+                if(owner) index_allocator::deallocate(owner, n);
+                throw;
+            }
+            for(uint32_t i = 0; i < __size; i++) owner[i] = __owner[i];
+            for(uint32_t i = 0; i < __slot_count; i++) slots[i] = __slots[i];
+            mySTL::destroy(__data, __data + __size);
+            __deallocate();
+            __data = data;
+            __owner = owner;
+            __slots = slots;
+            __capacity = static_cast<uint32_t>(n);
+        }
+
+        // noexcept移动时移动, 否则拷贝, 保证扩容失败时原数据不变
+        static void __relocate(T* first, T* last, T* dest)
+        {
+            T* cur = dest;
+            try
+            {
+                for(; first != last; ++first, ++cur)
+                    mySTL::construct(cur, std::move_if_noexcept(*first));
+            }
+            catch(...)
+            {
+                mySTL::destroy(dest, cur);
+                throw;
+            }
+        }
+
+        void __deallocate() noexcept
+        {
+            if(!__capacity) return;
+            data_allocator::deallocate(__data, __capacity);
+            index_allocator::deallocate(__owner, __capacity);
+            slot_allocator::deallocate(__slots, __capacity);
+        }
+    };
+}
+#endif // __SLOT_MAP_H__
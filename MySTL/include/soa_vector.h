@@ -0,0 +1,484 @@
+#ifndef __SOA_VECTOR_H__
+#define __SOA_VECTOR_H__
+
+// 结构体数组 (SoA) 形式的vector: 每个字段单独存放在一段连续数组中
+// 只扫描一个字段时每个cache line都是有用的数据, 列也可以直接交给向量化的循环
+// 所有列在同一次分配中, 每列起始地址按64字节对齐, 一起扩容
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+#include "utils.h"
+
+namespace mySTL
+{
+    /**
+     * @brief column_span
+     * 一列数据的视图 (指针 + 长度), 不拥有数据
+     * @tparam T
+     */
+    template <class T>
+    class column_span
+    {
+    private:
+        T*      __data;
+        size_t  __size;
+
+    public:
+        typedef T           value_type;
+        typedef T*          iterator;
+        typedef size_t      size_type;
+
+        constexpr column_span() noexcept : __data(nullptr), __size(0) {}
+        constexpr column_span(T* data, size_t size) noexcept : __data(data), __size(size) {}
+
+        constexpr T*     data()  const noexcept {return __data;}
+        constexpr size_t size()  const noexcept {return __size;}
+        constexpr bool   empty() const noexcept {return __size == 0;}
+        constexpr T*     begin() const noexcept {return __data;}
+        constexpr T*     end()   const noexcept {return __data + __size;}
+        constexpr T&     operator[](size_t i) const noexcept {return __data[i];}
+    };
+
+    /**
+     * @brief soa_row_ref
+     * 一行的代理引用, get<I>() 返回第I列元素的引用, 支持结构化绑定:
+     *     for(auto [id, price] : v) price *= 2;
+     * @tparam Vec soa_vector 或 const soa_vector
+     */
+    template <class Vec>
+    class soa_row_ref
+    {
+    private:
+        Vec*    __vec;
+        size_t  __index;
+
+    public:
+        typedef typename mySTL::remove_const<Vec>::type::value_type value_type;
+
+        soa_row_ref(Vec* vec, size_t index) noexcept : __vec(vec), __index(index) {}
+
+        template <size_t I>
+        decltype(auto) get() const noexcept {return __vec->template data<I>()[__index];}
+
+        // 拷贝出整行
+        operator value_type() const {return __to_tuple(std::make_index_sequence<std::tuple_size<value_type>::value>());}
+
+        // 整行赋值 (写入被引用的行)
+        const soa_row_ref& operator=(const value_type& row) const
+        {
+            __assign(row, std::make_index_sequence<std::tuple_size<value_type>::value>());
+            return *this;
+        }
+        const soa_row_ref& operator=(const soa_row_ref& other) const
+        {
+            return *this = static_cast<value_type>(other);
+        }
+
+    private:
+        template <size_t... I>
+        value_type __to_tuple(std::index_sequence<I...>) const {return value_type(get<I>()...);}
+
+        template <size_t... I>
+        void __assign(const value_type& row, std::index_sequence<I...>) const
+        {
+            ((get<I>() = std::get<I>(row)), ...);
+        }
+    };
+
+    template <size_t I, class Vec>
+    decltype(auto) get(const soa_row_ref<Vec>& row) noexcept {return row.template get<I>();}
+
+    // 随机访问迭代器, 解引用得到soa_row_ref
+    template <class Vec>
+    class __soa_iterator : public mySTL::iterator<mySTL::random_access_iterator_tag, typename Vec::value_type,
+                                                  ptrdiff_t, void, soa_row_ref<Vec>>
+    {
+    private:
+        Vec*    __vec;
+        size_t  __index;
+
+    public:
+        typedef soa_row_ref<Vec>    reference;
+        typedef ptrdiff_t           difference_type;
+
+        __soa_iterator() noexcept : __vec(nullptr), __index(0) {}
+        __soa_iterator(Vec* vec, size_t index) noexcept : __vec(vec), __index(index) {}
+
+        reference operator*() const noexcept {return reference(__vec, __index);}
+        reference operator[](difference_type n) const noexcept {return reference(__vec, __index + n);}
+        size_t    index() const noexcept {return __index;}
+
+        __soa_iterator& operator++() noexcept {++__index; return *this;}
+        __soa_iterator& operator--() noexcept {--__index; return *this;}
+        __soa_iterator  operator++(int) noexcept {__soa_iterator tmp = *this; ++__index; return tmp;}
+        __soa_iterator  operator--(int) noexcept {__soa_iterator tmp = *this; --__index; return tmp;}
+        __soa_iterator& operator+=(difference_type n) noexcept {__index += n; return *this;}
+        __soa_iterator& operator-=(difference_type n) noexcept {__index -= n; return *this;}
+        __soa_iterator  operator+(difference_type n) const noexcept {return __soa_iterator(__vec, __index + n);}
+        __soa_iterator  operator-(difference_type n) const noexcept {return __soa_iterator(__vec, __index - n);}
+        difference_type operator-(const __soa_iterator& other) const noexcept
+        {
+            return static_cast<difference_type>(__index) - static_cast<difference_type>(other.__index);
+        }
+
+        bool operator==(const __soa_iterator& other) const noexcept {return __index == other.__index;}
+        bool operator!=(const __soa_iterator& other) const noexcept {return __index != other.__index;}
+        bool operator< (const __soa_iterator& other) const noexcept {return __index <  other.__index;}
+    };
+
+    /**
+     * @brief soa_vector
+     * 行类型为 std::tuple<Fields...>, 第I列可以用 data<I>() / column<I>() 直接访问
+     * 扩容时所有列一起搬到新的内存块, 指针、span和迭代器失效
+     * @tparam Fields 每列的元素类型
+     */
+    template <class... Fields>
+    class soa_vector
+    {
+        static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+
+    public:
+        typedef std::tuple<Fields...>               value_type;
+        typedef size_t                              size_type;
+        typedef ptrdiff_t                           difference_type;
+        typedef soa_row_ref<soa_vector>             reference;
+        typedef soa_row_ref<const soa_vector>       const_reference;
+        typedef __soa_iterator<soa_vector>          iterator;
+        typedef __soa_iterator<const soa_vector>    const_iterator;
+
+        template <size_t I>
+        using field_type = typename std::tuple_element<I, value_type>::type;
+
+        static constexpr size_t field_count  = sizeof...(Fields);
+        static constexpr size_t column_align = 64;
+
+    private:
+        typedef std::make_index_sequence<sizeof...(Fields)> __indices;
+
+        unsigned char*          __buf;
+        std::tuple<Fields*...>  __cols;
+        size_type               __size;
+        size_type               __cap;
+
+    public:
+        soa_vector() noexcept : __buf(nullptr), __cols(), __size(0), __cap(0) {}
+
+        explicit soa_vector(size_type n) : soa_vector() {resize(n);}
+
+        soa_vector(const soa_vector& other) : soa_vector()
+        {
+            reserve(other.__size);
+            for(size_type i = 0; i < other.__size; i++) __construct_row(i, other.row(i));
+        }
+
+        soa_vector(soa_vector&& other) noexcept : __buf(other.__buf), __cols(other.__cols), __size(other.__size), __cap(other.__cap)
+        {
+            other.__buf = nullptr;
+            other.__cols = std::tuple<Fields*...>();
+            other.__size = other.__cap = 0;
+        }
+
+        soa_vector& operator=(soa_vector other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~soa_vector()
+        {
+            clear();
+            __deallocate(__buf);
+        }
+
+        void swap(soa_vector& other) noexcept
+        {
+            mySTL::swap(__buf, other.__buf);
+            std::swap(__cols, other.__cols);
+            mySTL::swap(__size, other.__size);
+            mySTL::swap(__cap, other.__cap);
+        }
+
+    public:
+        /*** 容量 ***/
+        size_type size()     const noexcept {return __size;}
+        size_type capacity() const noexcept {return __cap;}
+        bool      empty()    const noexcept {return __size == 0;}
+
+        void reserve(size_type n)
+        {
+            if(n > __cap) __reallocate(n);
+        }
+
+        void shrink_to_fit()
+        {
+            if(__cap > __size) __reallocate(__size);
+        }
+
+        /*** 列访问 ***/
+
+        // 第I列的起始地址, 总是64字节对齐
+        template <size_t I>
+        field_type<I>* data() noexcept {return __assume_aligned(std::get<I>(__cols));}
+        template <size_t I>
+        const field_type<I>* data() const noexcept {return __assume_aligned(std::get<I>(__cols));}
+
+        template <size_t I>
+        column_span<field_type<I>> column() noexcept {return column_span<field_type<I>>(data<I>(), __size);}
+        template <size_t I>
+        column_span<const field_type<I>> column() const noexcept {return column_span<const field_type<I>>(data<I>(), __size);}
+
+        /*** 行访问 ***/
+        reference       operator[](size_type i) noexcept       {assert(i < __size); return reference(this, i);}
+        const_reference operator[](size_type i) const noexcept {assert(i < __size); return const_reference(this, i);}
+        reference       front() noexcept {return (*this)[0];}
+        reference       back()  noexcept {return (*this)[__size - 1];}
+
+        // 拷贝出第i行
+        value_type row(size_type i) const {return (*this)[i];}
+
+        iterator       begin()       noexcept {return iterator(this, 0);}
+        iterator       end()         noexcept {return iterator(this, __size);}
+        const_iterator begin() const noexcept {return const_iterator(this, 0);}
+        const_iterator end()   const noexcept {return const_iterator(this, __size);}
+
+        /*** 修改 ***/
+
+        // 参数可以引用本容器中的元素: 扩容时先在新内存块中构造新行, 再搬移旧数据
+        void push_back(const Fields&... values)
+        {
+            if(__size == __cap) __grow_emplace(values...);
+            else __construct_fields<0>(__cols, __size, values...);
+            ++__size;
+        }
+
+        void push_back(const value_type& row)
+        {
+            std::apply([this](const Fields&... values) {push_back(values...);}, row);
+        }
+
+        // 每列一个参数, 分别用来构造该列的元素
+        template <class... Args>
+        reference emplace_back(Args&&... args)
+        {
+            static_assert(sizeof...(Args) == sizeof...(Fields), "emplace_back takes one argument per field");
+            if(__size == __cap) __grow_emplace(mySTL::forward<Args>(args)...);
+            else __construct_fields<0>(__cols, __size, mySTL::forward<Args>(args)...);
+            return reference(this, __size++);
+        }
+
+        void pop_back() noexcept
+        {
+            assert(__size > 0);
+            --__size;
+            __destroy_rows(__cols, __size, __size + 1, __indices());
+        }
+
+        // 新增的行值初始化
+        void resize(size_type n)
+        {
+            if(n < __size)
+            {
+                __destroy_rows(__cols, n, __size, __indices());
+                __size = n;
+                return;
+            }
+            reserve(n);
+            for(; __size < n; ++__size) __construct_fields<0>(__cols, __size, Fields()...);
+        }
+
+        void clear() noexcept
+        {
+            __destroy_rows(__cols, 0, __size, __indices());
+            __size = 0;
+        }
+
+    private:
+        template <class T>
+        static T* __assume_aligned(T* p) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<T*>(__builtin_assume_aligned(p, column_align));
+#else
+            return p;
+#endif
+        }
+
+        static constexpr size_type __align_up(size_type n) noexcept
+        {
+            return (n + column_align - 1) & ~(column_align - 1);
+        }
+
+        // 容量为n时各列在内存块中的偏移, 以及总字节数
+        static size_type __layout(size_type n, size_type* offsets) noexcept
+        {
+            const size_type sizes[] = {sizeof(Fields)...};
+            size_type off = 0;
+            for(size_t i = 0; i < sizeof...(Fields); i++)
+            {
+                offsets[i] = off;
+                off = __align_up(off + sizes[i] * n);
+            }
+            return off;
+        }
+
+        static void __deallocate(unsigned char* p) noexcept
+        {
+            if(p) ::operator delete(p, std::align_val_t(column_align));
+        }
+
+
+        // 所有列的移动构造都是noexcept时才移动, 否则前面的列已经移走、后面的列失败时无法恢复, 只能全部复制
+        static constexpr bool __nothrow_relocate = (... && mySTL::is_nothrow_move_constructible<Fields>::value);
+
+        template <class T>
+        static typename mySTL::conditional<__nothrow_relocate || !mySTL::is_copy_constructible<T>::value, T&&, const T&>::type
+        __relocate_value(T& x) noexcept
+        {
+            return static_cast<typename mySTL::conditional<__nothrow_relocate || !mySTL::is_copy_constructible<T>::value,
+                                                         T&&, const T&>::type>(x);
+        }
+
+        // 分配容量为n的内存块, 返回各列的起始地址
+        static std::tuple<Fields*...> __allocate(size_type n, unsigned char*& buf)
+        {
+            static_assert((... && (alignof(Fields) <= column_align)), "field alignment is too large");
+            size_type offsets[sizeof...(Fields)];
+            size_type bytes = __layout(n, offsets);
+            buf = bytes ? static_cast<unsigned char*>(::operator new(bytes, std::align_val_t(column_align))) : nullptr;
+            return __make_cols(buf, offsets, __indices());
+        }
+
+        // 按列搬到新的内存块; 某一列搬移失败时销毁新块中已构造的列, 原数据不变
+        void __reallocate(size_type n)
+        {
+            unsigned char* buf;
+            std::tuple<Fields*...> cols = __allocate(n, buf);
+            try
+            {
+                __relocate_columns<0>(cols);
+            }
+            catch(...)
+            {
+                __deallocate(buf);
+                throw;
+            }
+            __adopt(buf, cols, n);
+        }
+
+        // 扩容, 并在新内存块的__size行构造新行 (参数在旧数据搬走之前使用, 可以引用旧数据)
+        template <class... Args>
+        void __grow_emplace(Args&&... args)
+        {
+            size_type n = __cap ? __cap * 2 : 16;
+            unsigned char* buf;
+            std::tuple<Fields*...> cols = __allocate(n, buf);
+            bool constructed = false;
+            try
+            {
+                __construct_fields<0>(cols, __size, mySTL::forward<Args>(args)...);
+                constructed = true;
+                __relocate_columns<0>(cols);
+            }
+            catch(...)
+            {
+                if(constructed) __destroy_rows(cols, __size, __size + 1, __indices());
+                __deallocate(buf);
+                throw;
+            }
+            __adopt(buf, cols, n);
+        }
+
+        // 旧数据已经搬到buf中: 销毁旧数据, 换成新的内存块
+        void __adopt(unsigned char* buf, const std::tuple<Fields*...>& cols, size_type n) noexcept
+        {
+            __destroy_rows(__cols, 0, __size, __indices());
+            __deallocate(__buf);
+            __buf = buf;
+            __cols = cols;
+            __cap = n;
+        }
+
+        template <size_t... I>
+        static std::tuple<Fields*...> __make_cols(unsigned char* buf, const size_type* offsets, std::index_sequence<I...>)
+        {
+            return std::tuple<Fields*...>(reinterpret_cast<Fields*>(buf + offsets[I])...);
+        }
+
+        template <size_t I>
+        void __relocate_columns(std::tuple<Fields*...>& cols)
+        {
+            if constexpr(I < sizeof...(Fields))
+            {
+                typedef field_type<I> T;
+                T* from = std::get<I>(__cols);
+                T* to = std::get<I>(cols);
+                size_type i = 0;
+                try
+                {
+                    for(; i < __size; i++) mySTL::construct(to + i, __relocate_value(from[i]));
+                    __relocate_columns<I + 1>(cols);
+                }
+                catch(...)
+                {
+                    mySTL::destroy(to, to + i);
+                    throw;
+                }
+            }
+        }
+
+        // 在cols的第i行依次构造第I列及之后的列, 构造失败时销毁本行已构造的列
+        template <size_t I, class Arg, class... Rest>
+        static void __construct_fields(const std::tuple<Fields*...>& cols, size_type i, Arg&& arg, Rest&&... rest)
+        {
+            mySTL::construct(std::get<I>(cols) + i, mySTL::forward<Arg>(arg));
+            if constexpr(sizeof...(Rest) > 0)
+            {
+                try
+                {
+                    __construct_fields<I + 1>(cols, i, mySTL::forward<Rest>(rest)...);
+                }
+                catch(...)
+                {
+                    mySTL::destroy(std::get<I>(cols) + i);
+                    throw;
+                }
+            }
+        }
+
+        void __construct_row(size_type i, const value_type& row)
+        {
+            std::apply([this, i](const Fields&... values) {__construct_fields<0>(__cols, i, values...);}, row);
+            ++__size;
+        }
+
+        template <size_t... I>
+        static void __destroy_rows(const std::tuple<Fields*...>& cols, size_type first, size_type last,
+                                   std::index_sequence<I...>) noexcept
+        {
+            (mySTL::destroy(std::get<I>(cols) + first, std::get<I>(cols) + last), ...);
+        }
+    };
+}
+
+namespace std
+{
+    // soa_row_ref的结构化绑定
+    template <class Vec>
+    struct tuple_size<mySTL::soa_row_ref<Vec>>
+        : std::integral_constant<size_t, std::tuple_size<typename mySTL::soa_row_ref<Vec>::value_type>::value> {};
+
+    template <size_t I, class Vec>
+    struct tuple_element<I, mySTL::soa_row_ref<Vec>>
+    {
+        typedef decltype(mySTL::declval<const mySTL::soa_row_ref<Vec>&>().template get<I>()) type;
+    };
+}
+#endif // __SOA_VECTOR_H__
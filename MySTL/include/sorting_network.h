@@ -0,0 +1,262 @@
+#ifndef __SORTING_NETWORK_H__
+#define __SORTING_NETWORK_H__
+
+// 编译期排序网络: 比较交换的序列只由N决定, 与数据无关, 整个网络在编译期展开成一串无分支的min/max
+// N <= 8 使用已知比较次数最少的网络, 更大的N (到32) 在编译期生成Batcher奇偶归并网络
+// sort_network_lanes 同时对很多组做排序 (第k个元素在第k行), 每个比较器是一次对整行的min/max, 可以向量化
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include "type_traits.h"
+
+namespace mySTL
+{
+    // 比较器: 比较交换 a[i] 和 a[j] (i < j), 之后 a[i] 不大于 a[j]
+    struct __comparator
+    {
+        uint8_t i;
+        uint8_t j;
+    };
+
+    template <size_t Size>
+    struct __network
+    {
+        __comparator c[Size == 0 ? 1 : Size];
+        size_t       size;
+    };
+
+    static constexpr size_t __network_max_n = 32;
+
+    // Batcher奇偶归并网络, 对任意n成立; f对每个比较器调用一次
+    template <class F>
+    constexpr void __batcher_for_each(size_t n, F&& f)
+    {
+        for(size_t p = 1; p < n; p <<= 1)
+            for(size_t k = p; k >= 1; k >>= 1)
+                for(size_t j = k % p; j + k < n; j += 2 * k)
+                    for(size_t i = 0; i < k && i + j + k < n; i++)
+                        if((i + j) / (2 * p) == (i + j + k) / (2 * p)) f(i + j, i + j + k);
+    }
+
+    constexpr size_t __batcher_size(size_t n)
+    {
+        size_t count = 0;
+        __batcher_for_each(n, [&count](size_t, size_t) {++count;});
+        return count;
+    }
+
+    template <size_t N>
+    constexpr __network<__batcher_size(N)> __make_batcher()
+    {
+        __network<__batcher_size(N)> net{};
+        __batcher_for_each(N, [&net](size_t i, size_t j) {
+            net.c[net.size++] = __comparator{static_cast<uint8_t>(i), static_cast<uint8_t>(j)};
+        });
+        return net;
+    }
+
+    /**
+     * @brief __network_table
+     * N个元素的排序网络, 默认为Batcher网络, 小的N特化为最优网络
+     */
+    template <size_t N>
+    struct __network_table
+    {
+        static_assert(N <= __network_max_n, "sorting networks are provided for N <= 32");
+        static constexpr __network<__batcher_size(N)> net = __make_batcher<N>();
+    };
+
+    // 最优网络 (Knuth, TAOCP 5.3.4), 比较次数: 1 3 5 9 12 16 19
+    template <>
+    struct __network_table<2>
+    {
+        static constexpr __network<1> net = {{{0, 1}}, 1};
+    };
+
+    template <>
+    struct __network_table<3>
+    {
+        static constexpr __network<3> net = {{{1, 2}, {0, 2}, {0, 1}}, 3};
+    };
+
+    template <>
+    struct __network_table<4>
+    {
+        static constexpr __network<5> net = {{{0, 1}, {2, 3}, {0, 2}, {1, 3}, {1, 2}}, 5};
+    };
+
+    template <>
+    struct __network_table<5>
+    {
+        static constexpr __network<9> net = {{{0, 1}, {3, 4}, {2, 4}, {2, 3}, {0, 3}, {0, 2}, {1, 4}, {1, 3}, {1, 2}}, 9};
+    };
+
+    template <>
+    struct __network_table<6>
+    {
+        static constexpr __network<12> net = {{{1, 2}, {4, 5}, {0, 2}, {3, 5}, {0, 1}, {3, 4},
+                                               {1, 4}, {0, 3}, {2, 5}, {1, 3}, {2, 4}, {2, 3}}, 12};
+    };
+
+    template <>
+    struct __network_table<7>
+    {
+        static constexpr __network<16> net = {{{1, 2}, {3, 4}, {5, 6}, {0, 2}, {3, 5}, {4, 6}, {0, 1}, {4, 5},
+                                               {2, 6}, {0, 4}, {1, 5}, {0, 3}, {2, 5}, {1, 3}, {2, 4}, {2, 3}}, 16};
+    };
+
+    template <>
+    struct __network_table<8>
+    {
+        static constexpr __network<19> net = {{{0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}, {0, 1}, {2, 3},
+                                               {4, 5}, {6, 7}, {2, 4}, {3, 5}, {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}}, 19};
+    };
+
+    // 比较次数
+    template <size_t N>
+    constexpr size_t sort_network_size() noexcept {return N < 2 ? 0 : __network_table<N>::net.size;}
+
+    // 小的平凡类型用条件选择 (编译为cmov或min/max指令), 其他类型按需交换
+    template <class T>
+    struct __select_exchange
+        : mySTL::integral_constant<bool, mySTL::is_trivially_copyable<T>::value && sizeof(T) <= 16> {};
+
+    template <class T, class Compare>
+    constexpr void __compare_exchange(T& x, T& y, Compare& comp)
+    {
+        if constexpr(__select_exchange<T>::value)
+        {
+            bool c = comp(y, x);
+            T lo = c ? y : x;
+            T hi = c ? x : y;
+            x = lo;
+            y = hi;
+        }
+        else
+        {
+            if(comp(y, x))
+            {
+                T tmp = std::move(x);
+                x = std::move(y);
+                y = std::move(tmp);
+            }
+        }
+    }
+
+    template <size_t N, class RandomIter, class Compare, size_t... I>
+    constexpr void __apply_network(RandomIter a, Compare& comp, std::index_sequence<I...>)
+    {
+        constexpr auto& net = __network_table<N>::net;
+        (__compare_exchange(a[net.c[I].i], a[net.c[I].j], comp), ...);
+    }
+
+    /**
+     * @brief 用N个元素的排序网络排序 [a, a + N)
+     * 可以在常量表达式中使用
+     */
+    template <size_t N, class RandomIter, class Compare>
+    constexpr void sort_network(RandomIter a, Compare comp)
+    {
+        if constexpr(N >= 2) __apply_network<N>(a, comp, std::make_index_sequence<sort_network_size<N>()>());
+    }
+
+    template <size_t N, class RandomIter>
+    constexpr void sort_network(RandomIter a)
+    {
+        sort_network<N>(a, std::less<>());
+    }
+
+    static constexpr size_t __lane_block = 16;
+
+    template <class T>
+    inline void __lane_exchange(T& x, T& y) noexcept
+    {
+        T a = x, b = y;
+        x = b < a ? b : a;
+        y = b < a ? a : b;
+    }
+
+    /**
+     * @brief 对count组数据同时排序, 每组N个元素, 第g组的第k个元素在 data[k * stride + g]
+     * 每个比较器对两行做逐元素min/max, 循环没有分支, 编译器可以把它向量化
+     * 只用于算术类型的自然顺序 (浮点数不能有NaN)
+     */
+    template <size_t N, class T>
+    void sort_network_lanes(T* data, size_t stride, size_t count)
+    {
+        static_assert(mySTL::is_arithmetic<T>::value, "sort_network_lanes requires an arithmetic type");
+        if constexpr(N >= 2)
+        {
+            constexpr auto& net = __network_table<N>::net;
+            for(size_t c = 0; c < net.size; c++)
+            {
+                T* __restrict x = data + net.c[c].i * stride;
+                T* __restrict y = data + net.c[c].j * stride;
+                // 内层循环次数固定, -O2的向量化代价模型也能把它变成SIMD min/max
+                size_t g = 0;
+                for(; g + __lane_block <= count; g += __lane_block)
+                    for(size_t l = g; l < g + __lane_block; l++) __lane_exchange(x[l], y[l]);
+                for(; g < count; g++) __lane_exchange(x[g], y[g]);
+            }
+        }
+    }
+
+    // 成对归约, 依赖链长度为log2(N), 比逐个比较的循环有更多指令级并行
+    template <size_t First, size_t Len, class RandomIter, class Compare>
+    constexpr auto __reduce_min(RandomIter a, Compare& comp)
+    {
+        if constexpr(Len == 1) return a[First];
+        else
+        {
+            auto l = __reduce_min<First, Len / 2>(a, comp);
+            auto r = __reduce_min<First + Len / 2, Len - Len / 2>(a, comp);
+            return comp(r, l) ? r : l;
+        }
+    }
+
+    // [a, a + N) 的最小值, 相等时取靠前的
+    template <size_t N, class RandomIter, class Compare = std::less<>>
+    constexpr auto network_min(RandomIter a, Compare comp = Compare())
+    {
+        static_assert(N > 0, "network_min of an empty range");
+        return __reduce_min<0, N>(a, comp);
+    }
+
+    // [a, a + N) 的最大值
+    template <size_t N, class RandomIter, class Compare = std::less<>>
+    constexpr auto network_max(RandomIter a, Compare comp = Compare())
+    {
+        static_assert(N > 0, "network_max of an empty range");
+        auto greater = [&comp](const auto& x, const auto& y) {return comp(y, x);};
+        return __reduce_min<0, N>(a, greater);
+    }
+
+    /**
+     * @brief 运行时长度n <= Max时调用对应的sort_network<n>, 用于通用排序的小区间
+     * 每个长度一个函数, 通过函数指针表分派
+     */
+    template <size_t Max, class RandomIter, class Compare>
+    struct __network_dispatch
+    {
+        typedef void (*fn)(RandomIter, Compare&);
+
+        template <size_t N>
+        static void __call(RandomIter a, Compare& comp) {sort_network<N>(a, comp);}
+
+        template <size_t... I>
+        static constexpr auto __make(std::index_sequence<I...>)
+        {
+            struct table {fn f[sizeof...(I)];};
+            return table{{&__call<I>...}};
+        }
+
+        static void apply(RandomIter a, size_t n, Compare& comp)
+        {
+            static constexpr auto t = __make(std::make_index_sequence<Max + 1>());
+            t.f[n](a, comp);
+        }
+    };
+}
+#endif // __SORTING_NETWORK_H__
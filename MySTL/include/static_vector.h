@@ -0,0 +1,281 @@
+#ifndef __STATIC_VECTOR_H__
+#define __STATIC_VECTOR_H__
+
+// 固定容量的vector, 元素直接存放在对象内部, 从不分配堆内存
+// T为平凡类型时所有操作都是constexpr (C++20起), 可以在编译期构造
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <initializer_list>
+#include "type_traits.h"
+#include "utils.h"
+#include "iterator.h"
+#include "construct.h"
+
+namespace mySTL
+{
+    // 能表示[0, N]的最小无符号整数类型
+    template <size_t N>
+    struct __static_vector_size
+    {
+        typedef typename conditional<(N <= 0xff), uint8_t,
+                typename conditional<(N <= 0xffff), uint16_t,
+                typename conditional<(N <= 0xffffffffull), uint32_t, size_t>::type>::type>::type type;
+    };
+
+    // 存储部分, 平凡类型: 数组放在union里, 构造时只激活空成员, 元素不做初始化
+    // 插入时对数组元素赋值才开始其生命周期, 保持平凡拷贝; C++20起可以在常量求值中切换union的活跃成员
+    template <class T, size_t N, bool = mySTL::is_trivial<T>::value>
+    class __static_vector_base
+    {
+    protected:
+        typedef typename __static_vector_size<N>::type stored_size_type;
+
+        union __storage
+        {
+            char __none;
+            T    __elems[N == 0 ? 1 : N];
+
+            constexpr __storage() : __none() {}
+        };
+
+        __storage        __store;
+        stored_size_type __size;
+
+        constexpr __static_vector_base() : __store(), __size(0) {}
+
+        constexpr T*       __data()       {return __store.__elems;}
+        constexpr const T* __data() const {return __store.__elems;}
+
+        template <class... Args>
+        constexpr void __construct_at(size_t i, Args&&... args)
+        {__store.__elems[i] = T(mySTL::forward<Args>(args)...);}
+
+        constexpr void __destroy_range(size_t, size_t) {}
+    };
+
+    // 存储部分, 非平凡类型: 未初始化的对齐内存, 用construct/destroy管理对象生命周期
+    template <class T, size_t N>
+    class __static_vector_base<T, N, false>
+    {
+    protected:
+        typedef typename __static_vector_size<N>::type stored_size_type;
+
+        alignas(T) unsigned char __buf[sizeof(T) * (N == 0 ? 1 : N)];
+        stored_size_type         __size;
+
+        __static_vector_base() : __size(0) {}
+
+        __static_vector_base(const __static_vector_base& other) : __size(0)
+        {
+            mySTL::uninitialized_copy(other.__data(), other.__data() + other.__size, __data());
+            __size = other.__size;
+        }
+
+        __static_vector_base(__static_vector_base&& other) : __size(0)
+        {
+            for(; __size < other.__size; ++__size)
+                mySTL::construct(__data() + __size, mySTL::move(other.__data()[__size]));
+        }
+
+        __static_vector_base& operator=(const __static_vector_base& other)
+        {
+            if(this != &other)
+            {
+                __destroy_range(0, __size);
+                __size = 0;
+                mySTL::uninitialized_copy(other.__data(), other.__data() + other.__size, __data());
+                __size = other.__size;
+            }
+            return *this;
+        }
+
+        __static_vector_base& operator=(__static_vector_base&& other)
+        {
+            if(this != &other)
+            {
+                __destroy_range(0, __size);
+                for(__size = 0; __size < other.__size; ++__size)
+                    mySTL::construct(__data() + __size, mySTL::move(other.__data()[__size]));
+            }
+            return *this;
+        }
+
+        ~__static_vector_base() {__destroy_range(0, __size);}
+
+        T*       __data()       {return reinterpret_cast<T*>(__buf);}
+        const T* __data() const {return reinterpret_cast<const T*>(__buf);}
+
+        template <class... Args>
+        void __construct_at(size_t i, Args&&... args)
+        {mySTL::construct(__data() + i, mySTL::forward<Args>(args)...);}
+
+        void __destroy_range(size_t first, size_t last)
+        {mySTL::destroy(__data() + first, __data() + last);}
+    };
+
+    /**
+     * @brief static_vector
+     * 容量固定为N, 超出容量时push_back抛出length_error, try_push_back返回false
+     * 迭代器就是原生指针, size字段按N选择最小的整数类型 (N<=255时为uint8_t)
+     * @tparam T
+     * @tparam N 容量
+     */
+    template <class T, size_t N>
+    class static_vector : private __static_vector_base<T, N>
+    {
+        typedef __static_vector_base<T, N> base;
+        typedef typename base::stored_size_type stored_size_type;
+        using base::__size;
+        using base::__data;
+        using base::__construct_at;
+        using base::__destroy_range;
+
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef const T*    const_pointer;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        typedef T*          iterator;
+        typedef const T*    const_iterator;
+
+    public:
+        // 构造函数
+        constexpr static_vector() = default;
+
+        constexpr static_vector(size_type n, const_reference value)
+        {
+            assert(n <= N);
+            for(size_type i = 0; i < n; i++) push_back(value);
+        }
+
+        constexpr static_vector(std::initializer_list<value_type> ilist)
+        {
+            assert(ilist.size() <= N);
+            for(const_reference x : ilist) push_back(x);
+        }
+
+        template <class InputIterator, class = typename mySTL::enable_if<
+            !mySTL::is_integral<InputIterator>::value>::type>
+        constexpr static_vector(InputIterator first, InputIterator last)
+        {
+            for(; first != last; ++first) push_back(*first);
+        }
+
+    public:
+        /*** 访问接口 ***/
+        constexpr iterator        begin()       noexcept {return __data();}
+        constexpr const_iterator  begin() const noexcept {return __data();}
+        constexpr iterator        end()         noexcept {return __data() + __size;}
+        constexpr const_iterator  end()   const noexcept {return __data() + __size;}
+        constexpr pointer         data()        noexcept {return __data();}
+        constexpr const_pointer   data()  const noexcept {return __data();}
+
+        constexpr size_type size()     const noexcept {return __size;}
+        static constexpr size_type capacity() noexcept {return N;}
+        static constexpr size_type max_size() noexcept {return N;}
+        constexpr bool      empty()    const noexcept {return __size == 0;}
+        constexpr bool      full()     const noexcept {return __size == N;}
+
+        constexpr reference       operator[](size_type i)       {assert(i < __size); return __data()[i];}
+        constexpr const_reference operator[](size_type i) const {assert(i < __size); return __data()[i];}
+        constexpr reference       front()       {assert(!empty()); return __data()[0];}
+        constexpr const_reference front() const {assert(!empty()); return __data()[0];}
+        constexpr reference       back()        {assert(!empty()); return __data()[__size - 1];}
+        constexpr const_reference back()  const {assert(!empty()); return __data()[__size - 1];}
+
+        constexpr reference at(size_type i)
+        {
+            if(i >= __size) throw std::out_of_range("static_vector::at");
+            return __data()[i];
+        }
+        constexpr const_reference at(size_type i) const
+        {
+            if(i >= __size) throw std::out_of_range("static_vector::at");
+            return __data()[i];
+        }
+
+    public:
+        /*** 修改元素接口 ***/
+        // 满了就抛出 length_error
+        template <class... Args>
+        constexpr reference emplace_back(Args&&... args)
+        {
+            if(full()) throw std::length_error("static_vector is full");
+            return unchecked_emplace_back(mySTL::forward<Args>(args)...);
+        }
+
+        constexpr void push_back(const_reference x) {emplace_back(x);}
+        constexpr void push_back(value_type&& x)    {emplace_back(mySTL::move(x));}
+
+        // 满了返回nullptr / false, 不抛出异常
+        template <class... Args>
+        constexpr pointer try_emplace_back(Args&&... args)
+        {
+            if(full()) return nullptr;
+            return &unchecked_emplace_back(mySTL::forward<Args>(args)...);
+        }
+
+        constexpr bool try_push_back(const_reference x) {return try_emplace_back(x) != nullptr;}
+        constexpr bool try_push_back(value_type&& x)    {return try_emplace_back(mySTL::move(x)) != nullptr;}
+
+        // 调用者保证 !full()
+        template <class... Args>
+        constexpr reference unchecked_emplace_back(Args&&... args)
+        {
+            assert(!full());
+            __construct_at(__size, mySTL::forward<Args>(args)...);
+            ++__size;
+            return __data()[__size - 1];
+        }
+
+        constexpr void pop_back()
+        {
+            assert(!empty());
+            --__size;
+            __destroy_range(__size, __size + 1);
+        }
+
+        constexpr void clear() noexcept
+        {
+            __destroy_range(0, __size);
+            __size = 0;
+        }
+
+        constexpr void resize(size_type n, const_reference value = value_type())
+        {
+            if(n > N) throw std::length_error("static_vector::resize");
+            if(n < __size)
+            {
+                __destroy_range(n, __size);
+                __size = static_cast<stored_size_type>(n);
+            }
+            else
+            {
+                while(__size < n) unchecked_emplace_back(value);
+            }
+        }
+    };
+
+    template <class T, size_t N>
+    constexpr bool operator==(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+    {
+        if(lhs.size() != rhs.size()) return false;
+        for(size_t i = 0; i < lhs.size(); i++)
+            if(!(lhs[i] == rhs[i])) return false;
+        return true;
+    }
+
+    template <class T, size_t N>
+    constexpr bool operator!=(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+}
+#endif // __STATIC_VECTOR_H__
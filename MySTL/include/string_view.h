@@ -0,0 +1,304 @@
+#ifndef __STRING_VIEW_H__
+#define __STRING_VIEW_H__
+
+// 只读字符串视图 (指针 + 长度), 以及字符串查找的底层函数
+// 单字节字符的查找先用 memchr / SSE2 过滤首字符 (和尾字符), 再比较剩余部分; 反向查找同样按16字节一块从后往前过滤
+// 比较直接用Traits::compare, char/wchar_t时就是C库的memcmp/wmemcmp (已经是向量化实现)
+
+#include <cstddef>
+#include <cstring>
+#include <cassert>
+#include <string>
+#include <ostream>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "iterator.h"
+
+namespace mySTL
+{
+    /**
+     * @brief 在[hay, hay+hay_len)中查找[needle, needle+len)第一次出现的位置, 找不到返回nullptr
+     * 通用版本: 按字符比较
+     */
+    template <class CharT, class Traits>
+    inline const CharT* __str_search(const CharT* hay, size_t hay_len, const CharT* needle, size_t len)
+    {
+        if(len == 0) return hay;
+        if(len > hay_len) return nullptr;
+        const CharT* last = hay + (hay_len - len) + 1;
+        for(const CharT* p = hay; p != last; ++p)
+        {
+            p = Traits::find(p, static_cast<size_t>(last - p), needle[0]);
+            if(!p) return nullptr;
+            if(Traits::compare(p + 1, needle + 1, len - 1) == 0) return p;
+        }
+        return nullptr;
+    }
+
+    // 单字节版本: memchr过滤首字符
+    inline const char* __memchr_search(const char* hay, size_t hay_len, const char* needle, size_t len)
+    {
+        const char* last = hay + (hay_len - len) + 1;
+        for(const char* p = hay; p < last; ++p)
+        {
+            p = static_cast<const char*>(std::memchr(p, needle[0], static_cast<size_t>(last - p)));
+            if(!p) return nullptr;
+            if(std::memcmp(p + 1, needle + 1, len - 1) == 0) return p;
+        }
+        return nullptr;
+    }
+
+    // 单字节版本: SSE2每次同时检查16个候选位置的首字符和尾字符, 两者都匹配才比较中间部分
+    template <>
+    inline const char* __str_search<char, std::char_traits<char>>(const char* hay, size_t hay_len,
+                                                                  const char* needle, size_t len)
+    {
+        if(len == 0) return hay;
+        if(len > hay_len) return nullptr;
+#if defined(__SSE2__)
+        if(len >= 2)
+        {
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last  = _mm_set1_epi8(needle[len - 1]);
+            size_t i = 0;
+            for(; i + len - 1 + 16 <= hay_len; i += 16)
+            {
+                __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+                __m128i block_last  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + len - 1));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(
+                    _mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))));
+                while(mask)
+                {
+                    unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+                    if(std::memcmp(hay + i + bit + 1, needle + 1, len - 2) == 0)
+                        return hay + i + bit;
+                    mask &= mask - 1;
+                }
+            }
+            // 剩下不足16个候选位置
+            return __memchr_search(hay + i, hay_len - i, needle, len);
+        }
+#endif
+        return __memchr_search(hay, hay_len, needle, len);
+    }
+
+    // 在[s, s+n)中查找字符ch最后一次出现的位置, 找不到返回nullptr
+    template <class CharT, class Traits>
+    inline const CharT* __str_rfind_char(const CharT* s, size_t n, CharT ch)
+    {
+        while(n > 0)
+        {
+            --n;
+            if(Traits::eq(s[n], ch)) return s + n;
+        }
+        return nullptr;
+    }
+
+    // 单字节版本: SSE2从后往前每次检查16个字节, 相当于memrchr
+    template <>
+    inline const char* __str_rfind_char<char, std::char_traits<char>>(const char* s, size_t n, char ch)
+    {
+#if defined(__SSE2__)
+        const __m128i c = _mm_set1_epi8(ch);
+        while(n >= 16)
+        {
+            n -= 16;
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + n)))));
+            if(mask) return s + n + (31 - __builtin_clz(mask));
+        }
+#endif
+        while(n > 0)
+        {
+            --n;
+            if(s[n] == ch) return s + n;
+        }
+        return nullptr;
+    }
+
+    // 从后往前查找, 起点不超过pos, 找不到返回nullptr
+    template <class CharT, class Traits>
+    inline const CharT* __str_rsearch(const CharT* hay, size_t hay_len, const CharT* needle, size_t len, size_t pos)
+    {
+        if(len > hay_len) return nullptr;
+        size_t start = hay_len - len;
+        if(pos < start) start = pos;
+        if(len == 0) return hay + start;
+        // 候选起点为[0, count), 每次用反向的字符查找过滤首字符
+        for(size_t count = start + 1; count > 0; )
+        {
+            const CharT* p = __str_rfind_char<CharT, Traits>(hay, count, needle[0]);
+            if(!p) return nullptr;
+            if(Traits::compare(p + 1, needle + 1, len - 1) == 0) return p;
+            count = static_cast<size_t>(p - hay);
+        }
+        return nullptr;
+    }
+
+    // 单字节版本: SSE2每次从后往前检查16个候选位置的首字符和尾字符, 和__str_search对称
+    template <>
+    inline const char* __str_rsearch<char, std::char_traits<char>>(const char* hay, size_t hay_len,
+                                                                   const char* needle, size_t len, size_t pos)
+    {
+        if(len > hay_len) return nullptr;
+        size_t start = hay_len - len;
+        if(pos < start) start = pos;
+        if(len == 0) return hay + start;
+        size_t count = start + 1;
+#if defined(__SSE2__)
+        if(len >= 2)
+        {
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last  = _mm_set1_epi8(needle[len - 1]);
+            while(count >= 16)
+            {
+                count -= 16; // 候选起点[count, count + 16)
+                __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + count));
+                __m128i block_last  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + count + len - 1));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(
+                    _mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))));
+                while(mask)
+                {
+                    unsigned bit = 31 - static_cast<unsigned>(__builtin_clz(mask));
+                    if(std::memcmp(hay + count + bit + 1, needle + 1, len - 2) == 0)
+                        return hay + count + bit;
+                    mask &= ~(1u << bit);
+                }
+            }
+        }
+#endif
+        // 剩下不足16个候选位置 (或单字符needle)
+        while(count > 0)
+        {
+            const char* p = __str_rfind_char<char, std::char_traits<char>>(hay, count, needle[0]);
+            if(!p) return nullptr;
+            if(std::memcmp(p + 1, needle + 1, len - 1) == 0) return p;
+            count = static_cast<size_t>(p - hay);
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief basic_string_view
+     * 不持有内存的字符串视图, 迭代器为原生指针
+     */
+    template <class CharT, class Traits = std::char_traits<CharT>>
+    class basic_string_view
+    {
+    public:
+        typedef Traits          traits_type;
+        typedef CharT           value_type;
+        typedef const CharT*    pointer;
+        typedef const CharT*    const_pointer;
+        typedef const CharT&    reference;
+        typedef const CharT&    const_reference;
+        typedef const CharT*    iterator;
+        typedef const CharT*    const_iterator;
+        typedef size_t          size_type;
+        typedef ptrdiff_t       difference_type;
+
+        static constexpr size_type npos = size_type(-1);
+
+    private:
+        const CharT* __data;
+        size_type    __size;
+
+    public:
+        constexpr basic_string_view() noexcept : __data(nullptr), __size(0) {}
+        constexpr basic_string_view(const CharT* str, size_type n) : __data(str), __size(n) {}
+        basic_string_view(const CharT* str) : __data(str), __size(Traits::length(str)) {}
+
+        constexpr const_iterator begin() const noexcept {return __data;}
+        constexpr const_iterator end()   const noexcept {return __data + __size;}
+        constexpr const_pointer  data()  const noexcept {return __data;}
+        constexpr size_type      size()  const noexcept {return __size;}
+        constexpr size_type      length() const noexcept {return __size;}
+        constexpr bool           empty() const noexcept {return __size == 0;}
+
+        constexpr const_reference operator[](size_type i) const {return __data[i];}
+        const_reference at(size_type i) const
+        {
+            if(i >= __size) throw std::out_of_range("basic_string_view::at");
+            return __data[i];
+        }
+        constexpr const_reference front() const {return __data[0];}
+        constexpr const_reference back()  const {return __data[__size - 1];}
+
+        void remove_prefix(size_type n) {assert(n <= __size); __data += n; __size -= n;}
+        void remove_suffix(size_type n) {assert(n <= __size); __size -= n;}
+
+        basic_string_view substr(size_type pos = 0, size_type n = npos) const
+        {
+            if(pos > __size) throw std::out_of_range("basic_string_view::substr");
+            return basic_string_view(__data + pos, n < __size - pos ? n : __size - pos);
+        }
+
+        int compare(basic_string_view other) const noexcept
+        {
+            size_type n = __size < other.__size ? __size : other.__size;
+            int res = n ? Traits::compare(__data, other.__data, n) : 0;
+            if(res != 0) return res;
+            return __size < other.__size ? -1 : (__size > other.__size ? 1 : 0);
+        }
+
+        bool starts_with(basic_string_view prefix) const noexcept
+        {return __size >= prefix.__size && Traits::compare(__data, prefix.__data, prefix.__size) == 0;}
+        bool ends_with(basic_string_view suffix) const noexcept
+        {
+            return __size >= suffix.__size &&
+                   Traits::compare(__data + __size - suffix.__size, suffix.__data, suffix.__size) == 0;
+        }
+
+        // 查找子串/字符, 返回下标, 找不到返回npos
+        size_type find(basic_string_view str, size_type pos = 0) const noexcept
+        {
+            if(pos > __size) return npos;
+            const CharT* p = __str_search<CharT, Traits>(__data + pos, __size - pos, str.__data, str.__size);
+            return p ? static_cast<size_type>(p - __data) : npos;
+        }
+        size_type find(CharT ch, size_type pos = 0) const noexcept
+        {
+            if(pos >= __size) return npos;
+            const CharT* p = Traits::find(__data + pos, __size - pos, ch);
+            return p ? static_cast<size_type>(p - __data) : npos;
+        }
+        size_type rfind(basic_string_view str, size_type pos = npos) const noexcept
+        {
+            const CharT* p = __str_rsearch<CharT, Traits>(__data, __size, str.__data, str.__size, pos);
+            return p ? static_cast<size_type>(p - __data) : npos;
+        }
+        size_type rfind(CharT ch, size_type pos = npos) const noexcept
+        {
+            const CharT* p = __str_rfind_char<CharT, Traits>(__data, pos < __size ? pos + 1 : __size, ch);
+            return p ? static_cast<size_type>(p - __data) : npos;
+        }
+    };
+
+    template <class CharT, class Traits>
+    constexpr typename basic_string_view<CharT, Traits>::size_type basic_string_view<CharT, Traits>::npos;
+
+    template <class CharT, class Traits>
+    inline bool operator==(basic_string_view<CharT, Traits> lhs, basic_string_view<CharT, Traits> rhs) noexcept
+    {return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;}
+
+    template <class CharT, class Traits>
+    inline bool operator!=(basic_string_view<CharT, Traits> lhs, basic_string_view<CharT, Traits> rhs) noexcept
+    {return !(lhs == rhs);}
+
+    template <class CharT, class Traits>
+    inline bool operator<(basic_string_view<CharT, Traits> lhs, basic_string_view<CharT, Traits> rhs) noexcept
+    {return lhs.compare(rhs) < 0;}
+
+    template <class CharT, class Traits>
+    inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os,
+                                                         basic_string_view<CharT, Traits> sv)
+    {
+        return os.write(sv.data(), static_cast<std::streamsize>(sv.size()));
+    }
+
+    typedef basic_string_view<char>     string_view;
+    typedef basic_string_view<wchar_t>  wstring_view;
+}
+#endif // __STRING_VIEW_H__
@@ -2,8 +2,30 @@
 #define __TYPE_TRAITS_H__
 
 // 模板元编程， 通过模板自动推导条件
-
-namespace mySTL 
+// 逻辑组合 (__or_ / __and_) 用折叠表达式, 一次实例化, 不再逐个参数递归
+// 需要编译器支持的性质 (平凡, 可构造, 空类, 基类...) 直接用内建函数 (__is_trivially_copyable 等), 不实例化辅助模板
+// 定义 MYSTL_NO_TRAIT_BUILTINS 后这些性质改由<type_traits>实现 (编译器没有__has_builtin时也是如此), 用于对比编译开销
+
+#include <cstddef>
+#include <new>
+
+#if !defined(MYSTL_NO_TRAIT_BUILTINS) && defined(__has_builtin)
+#define __MYSTL_HAS_TRAIT(x) __has_builtin(x)
+#else
+#define __MYSTL_HAS_TRAIT(x) 0
+#endif
+
+#if !__MYSTL_HAS_TRAIT(__is_class) || !__MYSTL_HAS_TRAIT(__is_union) || !__MYSTL_HAS_TRAIT(__is_enum) || \
+    !__MYSTL_HAS_TRAIT(__is_empty) || !__MYSTL_HAS_TRAIT(__is_final) || !__MYSTL_HAS_TRAIT(__is_polymorphic) || \
+    !__MYSTL_HAS_TRAIT(__is_trivial) || !__MYSTL_HAS_TRAIT(__is_trivially_copyable) || \
+    !__MYSTL_HAS_TRAIT(__is_standard_layout) || !__MYSTL_HAS_TRAIT(__is_base_of) || \
+    !__MYSTL_HAS_TRAIT(__is_constructible) || !__MYSTL_HAS_TRAIT(__has_trivial_destructor) || \
+    !__MYSTL_HAS_TRAIT(__underlying_type)
+#define __MYSTL_STD_TRAITS 1
+#include <type_traits>
+#endif
+
+namespace mySTL
 {
     // remove reference by using partial specialization
     template <class T>
@@ -27,6 +49,31 @@ namespace mySTL
     struct remove_pointer<T*>
     {typedef T type;};
 
+    template <class T> struct remove_pointer<T* const>          {typedef T type;};
+    template <class T> struct remove_pointer<T* volatile>       {typedef T type;};
+    template <class T> struct remove_pointer<T* const volatile> {typedef T type;};
+
+    // remove const / volatile
+    template <class T> struct remove_const             {typedef T type;};
+    template <class T> struct remove_const<const T>    {typedef T type;};
+
+    template <class T> struct remove_volatile             {typedef T type;};
+    template <class T> struct remove_volatile<volatile T> {typedef T type;};
+
+    template <class T> struct remove_cv                   {typedef T type;};
+    template <class T> struct remove_cv<const T>          {typedef T type;};
+    template <class T> struct remove_cv<volatile T>       {typedef T type;};
+    template <class T> struct remove_cv<const volatile T> {typedef T type;};
+
+    // remove array extent
+    template <class T>           struct remove_extent       {typedef T type;};
+    template <class T>           struct remove_extent<T[]>  {typedef T type;};
+    template <class T, size_t N> struct remove_extent<T[N]> {typedef T type;};
+
+    template <class T>           struct remove_all_extents       {typedef T type;};
+    template <class T>           struct remove_all_extents<T[]>  {typedef typename remove_all_extents<T>::type type;};
+    template <class T, size_t N> struct remove_all_extents<T[N]> {typedef typename remove_all_extents<T>::type type;};
+
     // integral constant to store the value
     // 因为模板参数只能是bool/int
     // 用于继承， 自动推导模板
@@ -36,7 +83,7 @@ namespace mySTL
         static constexpr T value = var;
         typedef T value_type;
         typedef integral_constant<T,var> type;
-        constexpr operator value_type() const noexcept {return value;} // function ? 
+        constexpr operator value_type() const noexcept {return value;} // function ?
     };
     template <class T, T var>
     constexpr T integral_constant<T, var>::value; // static define
@@ -52,12 +99,12 @@ namespace mySTL
 
     /**
      * @brief 根据模板推导， 判断条件
-     * 
+     *
      */
-    
+
     // conditional判断， <bool, type1, type2>, if true, type=type1, else false = type2
     template <bool cond, class B1, class B2>
-    struct conditional 
+    struct conditional
     {typedef B1 type;};
 
     template <class B1, class B2>
@@ -74,59 +121,37 @@ namespace mySTL
     // 如果条件不为true, 则编译器找不到type则不会生成模板函数
     template <class T>
     struct enable_if<true, T>
-    {typedef T type;}; 
-
-    // 用conditional实现 or
-    template <class...> // 申明__or_的模板参数可变
-    struct __or_;
-
-    template <>
-    struct __or_<> : public false_type {};
-
-    template <class B1> // 注意B1应该继承 true_type/false type
-    struct __or_<B1> : public B1 {};
-
-    /* 注意or的逻辑， B1/B2只要一个为真，则结果为真，如果B1::value = true,
-       则__or_::value = true, 如果B1::value = false, 则__or_::value = B2::value,
-       最后结果由B2::value决定
-    */
-    template <class B1, class B2> 
-    struct __or_<B1, B2> : public conditional<B1::value, B1, B2>::type {};
-
-    template <class B1, class B2, class B3, class... Bn> // 我都惊了， 模板参数也能递归？
-    struct __or_<B1, B2, B3, Bn...>
-        : public conditional<B1::value, B1, __or_<B2, B3, Bn...>>::type {};
+    {typedef T type;};
 
-    // 用conditional实现and
     template <class...>
-    struct __and_;
-
-    template <>
-    struct __and_<> : public true_type {};
+    using void_t = void;
 
-    template <class B1>
-    struct __and_<B1> : public B1 {};
-
-    // 我又惊了， 这个and逻辑， if B1::value = true, 则结果由B2::value决定，else 直接返回false
-    template <class B1, class B2>
-    struct __and_<B1, B2> : public conditional<B1::value, B2, B1>::type {};
+    /**
+     * @brief 逻辑组合
+     * 折叠表达式一次算出结果: N个参数只实例化一个类, 原来的递归写法要实例化N个 __or_ 和N个 conditional
+     * 代价是不再短路: 所有参数的 ::value 都会被实例化, 参数里不能放对某些类型无效的trait
+     */
+    template <class... Bn>
+    struct __or_ : public bool_constant<(bool(Bn::value) || ...)> {};
 
-    template <class B1, class B2, class B3, class... Bn>
-    struct __and_<B1, B2, B3, Bn...>
-        : public conditional<B1::value, B2, __and_<B3, Bn...>>::type {};
+    template <class... Bn>
+    struct __and_ : public bool_constant<(bool(Bn::value) && ...)> {};
 
     template <class B>
     struct __not_
         : public bool_constant<!bool(B::value)> {};
 
-    // 
-
     // is same type
+#if __MYSTL_HAS_TRAIT(__is_same)
+    template <class T, class U>
+    struct is_same : public bool_constant<__is_same(T, U)> {};
+#else
     template <class, class>
     struct is_same : public false_type {};
 
     template <class T>
     struct is_same<T, T> : public true_type {};
+#endif
 
     // is lvalue reference
     template <class T>
@@ -142,7 +167,268 @@ namespace mySTL
     template <class T>
     struct is_rvalue_reference<T&&>:public true_type {};
 
+    template <class T> struct is_reference      : public false_type {};
+    template <class T> struct is_reference<T&>  : public true_type {};
+    template <class T> struct is_reference<T&&> : public true_type {};
+
+    template <class T> struct is_const          : public false_type {};
+    template <class T> struct is_const<const T> : public true_type {};
+
+    template <class T>           struct is_array       : public false_type {};
+    template <class T>           struct is_array<T[]>  : public true_type {};
+    template <class T, size_t N> struct is_array<T[N]> : public true_type {};
+
+    // 只有函数类型和引用加上const之后仍然不是const
+    template <class T>
+    struct is_function : public bool_constant<!is_const<const T>::value && !is_reference<T>::value> {};
+
+    template <class T> struct is_void : public is_same<typename remove_cv<T>::type, void> {};
+
+    /**
+     * @brief 添加引用 / 指针, void 和带cv限定的函数类型保持不变
+     */
+    template <class T> struct __type_identity {typedef T type;};
+
+    template <class T> __type_identity<T&>  __try_add_lref(int);
+    template <class T> __type_identity<T>   __try_add_lref(...);
+    template <class T> __type_identity<T&&> __try_add_rref(int);
+    template <class T> __type_identity<T>   __try_add_rref(...);
+
+    template <class T> struct add_lvalue_reference : public decltype(mySTL::__try_add_lref<T>(0)) {};
+    template <class T> struct add_rvalue_reference : public decltype(mySTL::__try_add_rref<T>(0)) {};
+
+    template <class T> struct add_pointer {typedef typename remove_reference<T>::type* type;};
+
+    // 只能用在不求值的表达式中
+    template <class T>
+    typename add_rvalue_reference<T>::type declval() noexcept;
+
+    // 数组退化成指针, 函数退化成函数指针, 其他去掉引用和cv
+    template <class T, class U = typename remove_reference<T>::type,
+              bool = is_array<U>::value, bool = is_function<U>::value>
+    struct __decay {typedef typename remove_cv<U>::type type;};
+
+    template <class T, class U, bool F>
+    struct __decay<T, U, true, F> {typedef typename remove_extent<U>::type* type;};
+
+    template <class T, class U>
+    struct __decay<T, U, false, true> {typedef U* type;};
+
+    template <class T>
+    struct decay {typedef typename __decay<T>::type type;};
+
+    /**
+     * @brief 基本类型的分类
+     */
+    template <class T> struct __is_integral_base                     : public false_type {};
+    template <> struct __is_integral_base<bool>                      : public true_type {};
+    template <> struct __is_integral_base<char>                      : public true_type {};
+    template <> struct __is_integral_base<signed char>               : public true_type {};
+    template <> struct __is_integral_base<unsigned char>             : public true_type {};
+    template <> struct __is_integral_base<wchar_t>                   : public true_type {};
+    template <> struct __is_integral_base<char16_t>                  : public true_type {};
+    template <> struct __is_integral_base<char32_t>                  : public true_type {};
+    template <> struct __is_integral_base<short>                     : public true_type {};
+    template <> struct __is_integral_base<unsigned short>            : public true_type {};
+    template <> struct __is_integral_base<int>                       : public true_type {};
+    template <> struct __is_integral_base<unsigned int>              : public true_type {};
+    template <> struct __is_integral_base<long>                      : public true_type {};
+    template <> struct __is_integral_base<unsigned long>             : public true_type {};
+    template <> struct __is_integral_base<long long>                 : public true_type {};
+    template <> struct __is_integral_base<unsigned long long>        : public true_type {};
+#if defined(__cpp_char8_t)
+    template <> struct __is_integral_base<char8_t>                   : public true_type {};
+#endif
+
+    template <class T>
+    struct is_integral : public __is_integral_base<typename remove_cv<T>::type> {};
+
+    template <class T> struct __is_floating_point_base               : public false_type {};
+    template <> struct __is_floating_point_base<float>               : public true_type {};
+    template <> struct __is_floating_point_base<double>              : public true_type {};
+    template <> struct __is_floating_point_base<long double>         : public true_type {};
+
+    template <class T>
+    struct is_floating_point : public __is_floating_point_base<typename remove_cv<T>::type> {};
+
+    template <class T>
+    struct is_arithmetic : public bool_constant<is_integral<T>::value || is_floating_point<T>::value> {};
+
+    template <class T, bool = is_arithmetic<T>::value>
+    struct __is_signed : public bool_constant<T(-1) < T(0)> {};
+
+    template <class T>
+    struct __is_signed<T, false> : public false_type {};
+
+    template <class T>
+    struct is_signed : public __is_signed<T> {};
+
+    template <class T> struct __is_pointer_base     : public false_type {};
+    template <class T> struct __is_pointer_base<T*> : public true_type {};
+
+    template <class T>
+    struct is_pointer : public __is_pointer_base<typename remove_cv<T>::type> {};
+
+    /**
+     * @brief make_unsigned
+     * 标准整数类型映射到对应的无符号类型, 字符类型映射到同样大小的无符号类型, 保留cv限定 (不支持枚举)
+     */
+    template <size_t Size>
+    struct __unsigned_of_size
+    {
+        typedef typename conditional<Size == sizeof(unsigned char), unsigned char,
+                typename conditional<Size == sizeof(unsigned short), unsigned short,
+                typename conditional<Size == sizeof(unsigned int), unsigned int,
+                typename conditional<Size == sizeof(unsigned long), unsigned long,
+                                     unsigned long long>::type>::type>::type>::type type;
+    };
+
+    template <class T> struct __make_unsigned {typedef typename __unsigned_of_size<sizeof(T)>::type type;};
+    template <> struct __make_unsigned<signed char>        {typedef unsigned char type;};
+    template <> struct __make_unsigned<short>              {typedef unsigned short type;};
+    template <> struct __make_unsigned<int>                {typedef unsigned int type;};
+    template <> struct __make_unsigned<long>               {typedef unsigned long type;};
+    template <> struct __make_unsigned<long long>          {typedef unsigned long long type;};
+    template <> struct __make_unsigned<unsigned short>     {typedef unsigned short type;};
+    template <> struct __make_unsigned<unsigned int>       {typedef unsigned int type;};
+    template <> struct __make_unsigned<unsigned long>      {typedef unsigned long type;};
+    template <> struct __make_unsigned<unsigned long long> {typedef unsigned long long type;};
+
+    template <class T>
+    struct make_unsigned
+    {
+        static_assert(is_integral<T>::value && !is_same<typename remove_cv<T>::type, bool>::value,
+                      "make_unsigned requires a non-bool integral type");
+        typedef typename __make_unsigned<T>::type type;
+    };
+
+    template <class T> struct make_unsigned<const T>          {typedef const typename make_unsigned<T>::type type;};
+    template <class T> struct make_unsigned<volatile T>       {typedef volatile typename make_unsigned<T>::type type;};
+    template <class T> struct make_unsigned<const volatile T> {typedef const volatile typename make_unsigned<T>::type type;};
+
+    /**
+     * @brief 需要编译器支持的性质
+     * 有内建函数时直接用, 否则转发给<type_traits>
+     */
+#if __MYSTL_STD_TRAITS
+#define __MYSTL_TRAIT_1(name, builtin) \
+    template <class T> struct name : public bool_constant<std::name<T>::value> {};
+#define __MYSTL_TRAIT_2(name, builtin) \
+    template <class T, class U> struct name : public bool_constant<std::name<T, U>::value> {};
+#else
+#define __MYSTL_TRAIT_1(name, builtin) \
+    template <class T> struct name : public bool_constant<builtin(T)> {};
+#define __MYSTL_TRAIT_2(name, builtin) \
+    template <class T, class U> struct name : public bool_constant<builtin(T, U)> {};
+#endif
+
+    __MYSTL_TRAIT_1(is_class,               __is_class)
+    __MYSTL_TRAIT_1(is_union,               __is_union)
+    __MYSTL_TRAIT_1(is_enum,                __is_enum)
+    __MYSTL_TRAIT_1(is_empty,               __is_empty)
+    __MYSTL_TRAIT_1(is_final,               __is_final)
+    __MYSTL_TRAIT_1(is_polymorphic,         __is_polymorphic)
+    __MYSTL_TRAIT_1(is_trivial,             __is_trivial)
+    __MYSTL_TRAIT_1(is_trivially_copyable,  __is_trivially_copyable)
+    __MYSTL_TRAIT_1(is_standard_layout,     __is_standard_layout)
+    __MYSTL_TRAIT_2(is_base_of,             __is_base_of)
+
+#undef __MYSTL_TRAIT_1
+#undef __MYSTL_TRAIT_2
+
+#if __MYSTL_STD_TRAITS
+    template <class T, class... Args>
+    struct is_constructible : public bool_constant<std::is_constructible<T, Args...>::value> {};
+
+    template <class T>
+    struct is_trivially_destructible : public bool_constant<std::is_trivially_destructible<T>::value> {};
+
+    template <class T, class... Args>
+    struct is_nothrow_constructible : public bool_constant<std::is_nothrow_constructible<T, Args...>::value> {};
+
+    template <class T, bool = is_enum<T>::value>
+    struct __underlying_type_impl {typedef typename std::underlying_type<T>::type type;};
+#else
+    template <class T, class... Args>
+    struct is_constructible : public bool_constant<__is_constructible(T, Args...)> {};
+
+    /**
+     * @brief is_trivially_destructible
+     * GCC没有 __is_trivially_destructible, 用 __has_trivial_destructor 加上能否析构的判断
+     * (__has_trivial_destructor 对析构函数被删除的类, void 和 T[] 也返回true)
+     */
+#if __MYSTL_HAS_TRAIT(__is_trivially_destructible)
+    template <class T>
+    struct is_trivially_destructible : public bool_constant<__is_trivially_destructible(T)> {};
+#else
+    template <class T, class = void>
+    struct __is_destructible_object : public false_type {};
+
+    template <class T>
+    struct __is_destructible_object<T, void_t<decltype(mySTL::declval<T&>().~T())>> : public true_type {};
+
+    // 引用总是可以析构; 定长数组看元素; void, 函数和T[]不能析构
+    template <class T, bool = is_reference<T>::value, bool = is_array<T>::value>
+    struct __is_destructible : public __is_destructible_object<T> {};
+
+    template <class T, bool A>
+    struct __is_destructible<T, true, A> : public true_type {};
+
+    template <class T>
+    struct __is_destructible<T, false, true>
+        : public bool_constant<!is_same<T, typename remove_extent<T>::type[]>::value &&
+                               __is_destructible_object<typename remove_all_extents<T>::type>::value> {};
+
+    template <class T>
+    struct is_trivially_destructible : public bool_constant<__is_destructible<T>::value && __has_trivial_destructor(T)> {};
+#endif
+
+#if __MYSTL_HAS_TRAIT(__is_nothrow_constructible)
+    template <class T, class... Args>
+    struct is_nothrow_constructible : public bool_constant<__is_nothrow_constructible(T, Args...)> {};
+#else
+    // 对象类型看placement new表达式, 不计入析构; 引用只可能是一个参数的绑定
+    template <bool, bool, class T, class... Args>
+    struct __is_nothrow_constructible_impl : public false_type {};
+
+    template <class T, class... Args>
+    struct __is_nothrow_constructible_impl<true, false, T, Args...>
+        : public bool_constant<noexcept(::new (static_cast<void*>(nullptr)) T(mySTL::declval<Args>()...))> {};
+
+    template <class T, class Arg>
+    struct __is_nothrow_constructible_impl<true, true, T, Arg>
+        : public bool_constant<noexcept(static_cast<T>(mySTL::declval<Arg>()))> {};
+
+    template <class T, class... Args>
+    struct is_nothrow_constructible
+        : public __is_nothrow_constructible_impl<__is_constructible(T, Args...), is_reference<T>::value, T, Args...> {};
+#endif
+
+    template <class T, bool = is_enum<T>::value>
+    struct __underlying_type_impl {typedef __underlying_type(T) type;};
+#endif
+
+    template <class T>
+    struct __underlying_type_impl<T, false> {};
+
+    // 非枚举类型没有type成员 (SFINAE友好)
+    template <class T>
+    struct underlying_type : public __underlying_type_impl<T> {};
+
+    template <class T>
+    struct is_copy_constructible
+        : public is_constructible<T, typename add_lvalue_reference<const T>::type> {};
+
+    template <class T>
+    struct is_move_constructible
+        : public is_constructible<T, typename add_rvalue_reference<T>::type> {};
 
+    template <class T>
+    struct is_nothrow_move_constructible
+        : public is_nothrow_constructible<T, typename add_rvalue_reference<T>::type> {};
 }
 
-#endif // __TYPE_TRAITS_H__
\ No newline at end of file
+#undef __MYSTL_HAS_TRAIT
+#undef __MYSTL_STD_TRAITS
+
+#endif // __TYPE_TRAITS_H__
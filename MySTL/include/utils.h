@@ -4,6 +4,7 @@
 // 实现一些通用工具，如 move, forward, swap, pair
 
 #include <cstddef>
+#include <cstdint>
 #include "type_traits.h"
 
 namespace mySTL
@@ -11,7 +12,7 @@ namespace mySTL
     // move, convert any value to rvalue
     // T&& 是万能引用， 既可以引用左值， 也可以引用右值， 注意template申明
     template <class T>
-    typename mySTL::remove_reference<T>::type&& move(T&& arg) noexcept
+    constexpr typename mySTL::remove_reference<T>::type&& move(T&& arg) noexcept
     {
         return static_cast<typename mySTL::remove_reference<T>::type&&>(arg);
     }
@@ -22,14 +23,14 @@ namespace mySTL
     // 如果用f(forward(1))后， 就不会改变 （触发了引用折叠， && && = &&）
     // 详细可见 https://zhuanlan.zhihu.com/p/161039484
     template <class T>
-    T&& forward(typename mySTL::remove_reference<T>::type& arg) noexcept
+    constexpr T&& forward(typename mySTL::remove_reference<T>::type& arg) noexcept
     {
         return static_cast<T&&>(arg);
     }
 
     // forward, convert rvalue to the specified type
     template <class T>
-    T&& forward(typename mySTL::remove_reference<T>::type&& arg) noexcept
+    constexpr T&& forward(typename mySTL::remove_reference<T>::type&& arg) noexcept
     {
         static_assert(!mySTL::is_lvalue_reference<T>::value, "Right value reference should be used.");
         return static_cast<T&&>(arg);
@@ -68,7 +69,37 @@ namespace mySTL
     template <class T, size_t N>
     constexpr size_t getArrayLen(T(&arr)[N]) {return N;}
 
-    
+    // 预取addr所在的cache line, 编译器不支持时为空操作
+    inline void prefetch(const void* addr) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(addr);
+#else
+        (void)addr;
+#endif
+    }
+
+    // 哈希值再混合一次 (MurmurHash3的fmix64): std::hash对整数是恒等映射, 混合后每一位都依赖输入的所有位
+    inline uint64_t __hash_mix(uint64_t h) noexcept
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // 自旋等待时降低功耗, 并让出流水线给同一核心上的另一个超线程
+    inline void cpu_relax() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+#endif
+    }
+
 }
 
 #endif // __UTILS_H__
\ No newline at end of file
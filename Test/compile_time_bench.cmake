@@ -0,0 +1,29 @@
+# 编译期开销测量, 由 compile_time_bench 目标调用:
+#   cmake -DCXX=<编译器> -DSRC=<ut_type_traits.cpp> -DINC=<MySTL/include> [-DTYPES=<元素类型组数>] -P compile_time_bench.cmake
+# 用 MYSTL_COMPILE_BENCH 编译 ut_type_traits.cpp (实例化 TYPES 组元素类型的全部容器), 只做语法分析和模板实例化 (-fsyntax-only)
+# 分别用编译器内建函数和 MYSTL_NO_TRAIT_BUILTINS (<type_traits>) 实现的traits各编译一次, 输出 -ftime-report 的总计
+# GCC的总计行依次是 user / sys / wall 秒数和GC堆内存
+
+if (NOT TYPES)
+    set(TYPES 64)
+endif ()
+
+foreach (mode builtin std)
+    set(defs -DMYSTL_COMPILE_BENCH -DMYSTL_COMPILE_BENCH_TYPES=${TYPES})
+    if (mode STREQUAL "std")
+        list(APPEND defs -DMYSTL_NO_TRAIT_BUILTINS)
+    endif ()
+    execute_process(
+        COMMAND ${CXX} -std=c++17 -fsyntax-only -ftime-report ${defs} -I${INC} ${SRC}
+        RESULT_VARIABLE rc
+        OUTPUT_VARIABLE out
+        ERROR_VARIABLE report)
+    if (NOT rc EQUAL 0)
+        message(FATAL_ERROR "compile_time_bench (${mode}) failed:\n${report}")
+    endif ()
+    string(REGEX MATCHALL "[^\n]*(TOTAL|template instantiation|Total Execution Time)[^\n]*" lines "${report}")
+    message("[${mode} traits, ${TYPES} element types]")
+    foreach (line ${lines})
+        message("  ${line}")
+    endforeach ()
+endforeach ()
@@ -3,6 +3,20 @@
 
 #include <chrono>
 #include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define __TEST_AUX_HAS_PERF 1
+#else
+#define __TEST_AUX_HAS_PERF 0
+#endif
+
 #define COUNT_FUN_TIME(FUN) \
     auto t1 = std::chrono::steady_clock::now();\
     FUN();\
@@ -10,6 +24,141 @@
     std::cout << "Time Cost: " << std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count() \
               << " [s]";\
 
+/**
+ * @brief 硬件性能计数器 (Linux perf_event_open)
+ * 每个事件单独打开, 不支持的事件 (容器/虚拟机中常见) 只显示 n/a, 不影响其他事件和计时
+ * 计数结果按 TIME_ENABLED/TIME_RUNNING 缩放, 以修正多路复用
+ */
+class PerfCounter
+{
+public:
+    enum Event {CYCLES = 0, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, DTLB_MISSES, EVENT_NUM};
+
+    PerfCounter()
+    {
+        for(int i = 0; i < EVENT_NUM; i++)
+        {
+            fds[i] = -1;
+            counts[i] = 0;
+        }
+#if __TEST_AUX_HAS_PERF
+        const uint64_t cache_read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        fds[CYCLES]        = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[INSTRUCTIONS]  = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[L1D_MISSES]    = open_event(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cache_read_miss);
+        fds[LLC_MISSES]    = open_event(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | cache_read_miss);
+        fds[BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        fds[DTLB_MISSES]   = open_event(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | cache_read_miss);
+#endif
+    }
+
+    ~PerfCounter()
+    {
+#if __TEST_AUX_HAS_PERF
+        for(int i = 0; i < EVENT_NUM; i++)
+            if(fds[i] >= 0) close(fds[i]);
+#endif
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    // 至少有一个事件可用
+    bool available() const
+    {
+        for(int i = 0; i < EVENT_NUM; i++)
+            if(fds[i] >= 0) return true;
+        return false;
+    }
+
+    bool available(Event e) const {return fds[e] >= 0;}
+
+    void start()
+    {
+#if __TEST_AUX_HAS_PERF
+        for(int i = 0; i < EVENT_NUM; i++)
+        {
+            if(fds[i] < 0) continue;
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop()
+    {
+#if __TEST_AUX_HAS_PERF
+        for(int i = 0; i < EVENT_NUM; i++)
+        {
+            if(fds[i] < 0) continue;
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t buf[3] = {0, 0, 0}; // value, time_enabled, time_running
+            if(read(fds[i], buf, sizeof(buf)) != sizeof(buf))
+            {
+                counts[i] = 0;
+                continue;
+            }
+            counts[i] = buf[2] ? static_cast<uint64_t>(static_cast<double>(buf[0]) * buf[1] / buf[2]) : 0;
+        }
+#endif
+    }
+
+    uint64_t count(Event e) const {return counts[e];}
+
+    // 输出每个元素平均的计数, n为本次测试处理的元素个数
+    void report(size_t n, std::ostream& os = std::cout) const
+    {
+        static const char* names[EVENT_NUM] = {"cycles", "instructions", "L1d-miss",
+                                               "LLC-miss", "branch-miss", "dTLB-miss"};
+        if(n == 0) n = 1;
+        os << "[per elem]";
+        for(int i = 0; i < EVENT_NUM; i++)
+        {
+            os << " " << names[i] << ": ";
+            if(fds[i] < 0)
+                os << "n/a";
+            else
+                os << std::fixed << std::setprecision(3) << static_cast<double>(counts[i]) / n;
+        }
+        os.unsetf(std::ios::floatfield);
+    }
+
+private:
+    int      fds[EVENT_NUM];
+    uint64_t counts[EVENT_NUM];
+
+#if __TEST_AUX_HAS_PERF
+    static int open_event(uint32_t type, uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = type;
+        attr.config         = config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        long fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        return static_cast<int>(fd);
+    }
+#endif
+};
+
+// 同时统计时间和硬件计数器, N为处理的元素个数, 可在同一作用域内多次使用
+#define COUNT_FUN_PERF(FUN, N) \
+    {\
+        PerfCounter __perf;\
+        auto __t1 = std::chrono::steady_clock::now();\
+        __perf.start();\
+        FUN();\
+        __perf.stop();\
+        auto __t2 = std::chrono::steady_clock::now();\
+        std::cout << "Time Cost: " << std::chrono::duration_cast<std::chrono::duration<double>>(__t2 - __t1).count() \
+                  << " [s] ";\
+        __perf.report(N);\
+    }
 
 template <class T>
 void printContainer(T& container)
@@ -18,4 +167,4 @@ void printContainer(T& container)
         std::cout << i << " ";
     std::cout << "\t [size]: " << container.size();
 }
-#endif // __TEST_AUX_H__
\ No newline at end of file
+#endif // __TEST_AUX_H__
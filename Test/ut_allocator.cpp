@@ -1,5 +1,8 @@
+#define MYSTL_ALLOC_TRACKING
 #include <iostream>
+#include <cassert>
 #include "allocator.h"
+#include "list.h"
 
 
 int main(int argc, char *argv[])
@@ -10,5 +13,26 @@ int main(int argc, char *argv[])
         std::cout << *(p+i) << " ";
     std::cout << std::endl;
     mySTL::allocator<int>::deallocate(p);
+
+    // 分配统计
+    mySTL::alloc_stats_reset();
+    double* d = mySTL::allocator<double>::allocate(100);
+    assert(mySTL::get_alloc_stats<double>().allocs == 1);
+    assert(mySTL::get_alloc_stats<double>().live_bytes == 100 * sizeof(double));
+    mySTL::allocator<double>::deallocate(d, 100);
+    assert(mySTL::get_alloc_stats<double>().live_bytes == 0);
+    assert(mySTL::get_alloc_stats<double>().peak_bytes == 100 * sizeof(double));
+
+    {
+        mySTL::list<int> l;
+        for(int i = 0; i < 1000; i++) l.push_back(i);
+        std::cout << "list<int> with 1000 elements, memory footprint: "
+                  << l.memory_footprint() << " [B]" << std::endl;
+        assert(mySTL::get_alloc_stats<mySTL::__list_node<int>>().live_bytes + sizeof(l)
+               == l.memory_footprint());
+    }
+    assert(mySTL::get_alloc_stats<mySTL::__list_node<int>>().allocs ==
+           mySTL::get_alloc_stats<mySTL::__list_node<int>>().deallocs);
+    mySTL::alloc_stats_report(std::cout);
     return 0;
-}
\ No newline at end of file
+}
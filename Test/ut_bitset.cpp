@@ -0,0 +1,94 @@
+#include "test_aux.h"
+#include "bitset.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+void test_bitset()
+{
+    mySTL::bitset<130> a, b;
+    a.set(0).set(64).set(129);
+    b.set(64).set(100);
+    assert(a.count() == 3 && a.test(129) && !a.test(128));
+    assert((a & b).count() == 1 && (a | b).count() == 4 && (a ^ b).count() == 3);
+    assert(a.find_first() == 0 && a.find_next(0) == 64 && a.find_next(64) == 129 && a.find_next(129) == a.npos);
+    assert((~a).count() == 127);
+    mySTL::bitset<130> all;
+    all.set();
+    assert(all.all() && all.count() == 130);
+
+    std::vector<size_t> bits;
+    for(size_t i : a) bits.push_back(i);
+    assert(bits.size() == 3 && bits[2] == 129);
+
+    mySTL::dynamic_bitset d(200);
+    d.set(3).set(70).set(199);
+    d.resize(300, true);
+    assert(d.count() == 103 && d.test(250) && !d.test(198));
+    d.resize(71);
+    assert(d.count() == 2);
+    for(int i = 0; i < 100; i++) d.push_back(i % 2 == 0);
+    assert(d.size() == 171 && d.count() == 52);
+
+    mySTL::dynamic_bitset e(171);
+    e.set(3).set(71).set(72);
+    assert(d.intersect_count(e) == 2 && (d & e).count() == 2);
+
+    mySTL::rank_select_index idx(d);
+    assert(idx.count() == d.count());
+    assert(idx.rank(0) == 0 && idx.rank(4) == 1 && idx.rank(71) == 2 && idx.rank(171) == 52);
+    size_t k = 0;
+    for(size_t pos : d)
+    {
+        assert(idx.select(k) == pos && idx.rank(pos) == k);
+        ++k;
+    }
+    assert(idx.select(52) == idx.npos);
+}
+
+int main(int argc, char *argv[])
+{
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    // -mavx2编译的版本在不支持AVX2的CPU上直接跳过
+    if(!__builtin_cpu_supports("avx2"))
+    {
+        std::cout << "AVX2 not supported by this CPU, skipped" << std::endl;
+        return 0;
+    }
+#endif
+    test_bitset();
+
+    // benchmark: 默认2^27位, 传入参数可以指定位数 (例如 1000000000)
+    size_t nbits = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (size_t(1) << 27);
+    mySTL::dynamic_bitset a(nbits), b(nbits);
+    std::mt19937_64 gen(1);
+    for(size_t i = 0; i < a.word_count(); i++)
+    {
+        a.words()[i] = gen() & gen();
+        b.words()[i] = gen() | gen();
+    }
+    a.resize(nbits);
+    b.resize(nbits);
+
+    size_t sink = 0;
+    std::cout << "bits: " << nbits << std::endl;
+    auto bench_and = [&]() { mySTL::dynamic_bitset c(a); c &= b; sink += c.word_count(); };
+    auto bench_count = [&]() { sink += a.count(); };
+    auto bench_intersect = [&]() { sink += a.intersect_count(b); };
+    auto bench_iterate = [&]() { for(size_t i : a) sink += i; };
+    size_t nwords = a.word_count();
+    std::cout << "copy + &=:       "; COUNT_FUN_PERF(bench_and, nwords);
+    std::cout << std::endl << "count:           "; COUNT_FUN_PERF(bench_count, nwords);
+    std::cout << std::endl << "intersect_count: "; COUNT_FUN_PERF(bench_intersect, nwords);
+    std::cout << std::endl << "iterate set bits:"; COUNT_FUN_PERF(bench_iterate, nwords);
+
+    mySTL::rank_select_index idx(a);
+    auto bench_rank = [&]() { for(size_t i = 0; i < 1000000; i++) sink += idx.rank((i * 7919) % nbits); };
+    auto bench_select = [&]() { for(size_t i = 0; i < 1000000; i++) sink += idx.select((i * 7919) % idx.count()); };
+    std::cout << std::endl << "1M rank:         "; COUNT_FUN_PERF(bench_rank, 1000000);
+    std::cout << std::endl << "1M select:       "; COUNT_FUN_PERF(bench_select, 1000000);
+    std::cout << std::endl << "sink: " << sink << std::endl;
+    return 0;
+}
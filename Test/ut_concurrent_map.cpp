@@ -0,0 +1,274 @@
+#define MYSTL_ALLOC_TRACKING
+#include "test_aux.h"
+#include "concurrent_unordered_map.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace mySTL;
+
+struct big_value
+{
+    uint64_t a, b, c;   // 读者检查三个字段一致, 用于发现读到一半被修改的值
+};
+
+// 有状态的hasher
+struct seeded_hash
+{
+    uint64_t seed;
+    size_t operator()(int x) const {return static_cast<size_t>(x) ^ seed;}
+};
+
+// 无状态的Hash和KeyEqual不占空间 (EBO), 有状态的只增加自身大小
+static_assert(sizeof(concurrent_unordered_map<int, int>) ==
+              3 * sizeof(void*) + 2 * sizeof(size_t) + sizeof(std::mutex), "EBO");
+static_assert(sizeof(concurrent_unordered_map<int, int, seeded_hash>) ==
+              sizeof(concurrent_unordered_map<int, int>) + sizeof(seeded_hash), "EBO");
+
+void test_basic()
+{
+    concurrent_unordered_map<int, int> m;
+    assert(m.empty());
+    assert(m.insert(1, 10));
+    assert(!m.insert(1, 11));
+    int v = 0;
+    assert(m.find(1, v) && v == 10);
+    assert(!m.insert_or_assign(1, 12));
+    assert(m.find(1, v) && v == 12);
+    assert(m.update(1, [](int& x) {x += 1;}));
+    assert(m.find(1, v) && v == 13);
+    assert(!m.update(2, [](int& x) {x += 1;}));
+    assert(m.erase(1) && !m.erase(1) && !m.contains(1));
+    assert(m.size() == 0);
+
+    // 有状态的hasher
+    {
+        concurrent_unordered_map<int, int, seeded_hash> h(16, 64, seeded_hash{0x1234});
+        for(int i = 0; i < 100; i++) assert(h.insert(i, i));
+        assert(h.find(42, v) && v == 42 && !h.contains(100));
+    }
+
+    // 多次扩容
+    const int n = 100000;
+    for(int i = 0; i < n; i++) assert(m.insert(i, i * 2));
+    assert(m.size() == n);
+    for(int i = 0; i < n; i++) assert(m.find(i, v) && v == i * 2);
+    assert(!m.contains(n));
+
+    // 反复插入删除产生的墓碑通过重建回收, 容量不会一直增长
+    for(int round = 0; round < 20; round++)
+    {
+        for(int i = 0; i < n; i++) assert(m.erase(i + round * n));
+        for(int i = 0; i < n; i++) assert(m.insert(i + (round + 1) * n, i));
+    }
+    assert(m.size() == n && m.capacity() <= 1 << 19);
+    // 重建后废弃的旧表通过epoch回收, 存活的槽位内存不超过当前表加上少量待释放的旧表
+    typedef __cmap_slot<int, int> slot_type;
+    alloc_stats& slots = get_alloc_stats<slot_type>();
+    assert(slots.live_bytes <= 4 * m.capacity() * sizeof(slot_type));
+
+    // 少量存活key的长时间插入删除: 每次重建都退休一整张表, 内存不能随操作数增长
+    {
+        epoch_domain domain;
+        concurrent_unordered_map<int, int> small(16, 64, std::hash<int>(), std::equal_to<int>(), domain);
+        size_t before = slots.live_bytes;
+        for(int i = 0; i < 1000000; i++)
+        {
+            assert(small.insert(i, i));
+            if(i >= 100) assert(small.erase(i - 100));
+        }
+        assert(small.size() == 100 && small.capacity() <= 512);
+        size_t live = slots.live_bytes - before;
+        assert(live <= 4 * small.capacity() * sizeof(slot_type) && domain.pending() <= 2);
+    }
+
+    // find_many
+    std::vector<int> keys;
+    for(int i = 0; i < 1000; i++) keys.push_back(i % 2 ? 20 * n + i : i);  // 奇数下标存在
+    std::vector<int> out(keys.size());
+    bool found[1000];
+    assert(m.find_many(keys.data(), keys.size(), out.data(), found) == 500);
+    for(int i = 0; i < 1000; i++) assert(found[i] == (i % 2 == 1) && (!found[i] || out[i] == i));
+}
+
+void test_concurrent(int threads)
+{
+    concurrent_unordered_map<uint64_t, big_value> m(16, 16);
+    const uint64_t per_thread = 20000;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> torn(0);
+
+    // 读者在写者插入和扩容期间不断读取
+    std::thread reader([&] {
+        uint64_t k = 0;
+        while(!done.load())
+        {
+            big_value v;
+            if(m.find(k, v) && !(v.a == k && v.b == k * 2 && v.c == k * 3)) ++torn;
+            k = (k + 7919) % (per_thread * threads);
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for(int t = 0; t < threads; t++)
+        writers.emplace_back([&, t] {
+            for(uint64_t i = t * per_thread; i < (t + 1) * per_thread; i++)
+                m.insert(i, big_value{i, i * 2, i * 3});
+            // 对同一组key并发覆盖
+            for(uint64_t i = 0; i < per_thread; i++)
+                m.insert_or_assign(i, big_value{i, i * 2, i * 3});
+        });
+    for(auto& w : writers) w.join();
+    done = true;
+    reader.join();
+
+    assert(torn == 0);
+    assert(m.size() == per_thread * threads);
+    for(uint64_t i = 0; i < per_thread * threads; i++)
+    {
+        big_value v;
+        assert(m.find(i, v) && v.a == i && v.c == i * 3);
+    }
+
+    // 并发的计数器更新
+    concurrent_unordered_map<int, long> counters;
+    std::vector<std::thread> incs;
+    for(int t = 0; t < threads; t++)
+        incs.emplace_back([&] {
+            for(int i = 0; i < 10000; i++)
+            {
+                counters.insert(i % 10, 0);
+                counters.update(i % 10, [](long& c) {++c;});
+            }
+        });
+    for(auto& th : incs) th.join();
+    long total = 0;
+    for(int i = 0; i < 10; i++)
+    {
+        long c = 0;
+        assert(counters.find(i, c));
+        total += c;
+    }
+    assert(total == 10000L * threads);
+}
+
+// std::mutex + std::unordered_map 对照
+class locked_map
+{
+private:
+    std::mutex __m;
+    std::unordered_map<uint64_t, uint64_t> __map;
+
+public:
+    bool find(uint64_t k, uint64_t& v)
+    {
+        std::lock_guard<std::mutex> lock(__m);
+        auto it = __map.find(k);
+        if(it == __map.end()) return false;
+        v = it->second;
+        return true;
+    }
+    void insert_or_assign(uint64_t k, uint64_t v)
+    {
+        std::lock_guard<std::mutex> lock(__m);
+        __map[k] = v;
+    }
+    bool erase(uint64_t k)
+    {
+        std::lock_guard<std::mutex> lock(__m);
+        return __map.erase(k) != 0;
+    }
+};
+
+// 每个线程执行ops次操作, 其中write_percent%是写 (插入/删除各一半), 返回Mops/s
+template <class Map>
+double run_mix(Map& m, int threads, size_t ops, uint64_t key_space, int write_percent)
+{
+    std::vector<std::thread> ts;
+    std::atomic<uint64_t> sink(0);
+    auto t1 = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++)
+        ts.emplace_back([&, t] {
+            uint64_t x = 0x9E3779B97F4A7C15ull * (t + 1), local = 0;
+            for(size_t i = 0; i < ops; i++)
+            {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                uint64_t k = x % key_space;
+                int r = static_cast<int>((x >> 40) % 100);
+                if(r >= write_percent)
+                {
+                    uint64_t v;
+                    if(m.find(k, v)) local += v;
+                }
+                else if(r & 1) m.insert_or_assign(k, i);
+                else m.erase(k);
+            }
+            sink += local;
+        });
+    for(auto& th : ts) th.join();
+    auto t2 = std::chrono::steady_clock::now();
+    double s = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
+    return threads * ops / s / 1e6;
+}
+
+void benchmark(int max_threads, size_t ops)
+{
+    const uint64_t key_space = 1 << 16;
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    for(int write_percent : {5, 50})
+    {
+        std::cout << (write_percent == 5 ? "read-heavy (95% find)" : "write-heavy (50% write)") << std::endl;
+        for(int threads = 1; threads <= max_threads; threads *= 2)
+        {
+            concurrent_unordered_map<uint64_t, uint64_t> cm;
+            locked_map lm;
+            for(uint64_t k = 0; k < key_space; k += 2)
+            {
+                cm.insert(k, k);
+                lm.insert_or_assign(k, k);
+            }
+            double a = run_mix(cm, threads, ops, key_space, write_percent);
+            double b = run_mix(lm, threads, ops, key_space, write_percent);
+            std::cout << "  threads " << threads << ": concurrent_unordered_map " << a
+                      << " Mops/s, mutex + unordered_map " << b << " Mops/s" << std::endl;
+        }
+    }
+
+    // find vs find_many (预取流水线), 表远大于cache
+    concurrent_unordered_map<uint64_t, uint64_t> big(1 << 22);
+    const uint64_t n = 1 << 20;
+    for(uint64_t k = 0; k < n; k++) big.insert(k * 2654435761ull, k);
+    std::vector<uint64_t> keys(n), out(n);
+    std::vector<char> found(n);
+    uint64_t x = 88172645463325252ull;
+    for(auto& k : keys)
+    {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        k = (x % n) * 2654435761ull;
+    }
+    size_t hit1 = 0, hit2 = 0;
+    auto single = [&]() {for(uint64_t i = 0; i < n; i++) hit1 += big.find(keys[i], out[i]);};
+    auto batch = [&]() {hit2 = big.find_many(keys.data(), n, out.data(), reinterpret_cast<bool*>(found.data()));};
+    std::cout << "find:      ";
+    COUNT_FUN_PERF(single, n);
+    std::cout << std::endl << "find_many: ";
+    COUNT_FUN_PERF(batch, n);
+    std::cout << std::endl;
+    assert(hit1 == n && hit2 == n);
+}
+
+int main(int argc, char *argv[])
+{
+    test_basic();
+    test_concurrent(4);
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : 4;
+    size_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+    benchmark(max_threads, ops);
+    return 0;
+}
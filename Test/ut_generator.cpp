@@ -0,0 +1,198 @@
+#include "test_aux.h"
+#include "generator.h"
+#include "pipeline.h"
+#include "ranges.h"
+#include "basic_string.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+using namespace mySTL;
+
+generator<int> iota(int first, int last)
+{
+    for(int i = first; i < last; i++) co_yield i;
+}
+
+generator<string> words()
+{
+    string s("a fairly long string that does not fit in the small buffer");
+    co_yield s;                  // 非const左值, 不拷贝
+    const string c("const");
+    co_yield c;                  // const左值, 拷贝一份
+    co_yield string("temporary");
+}
+
+generator<int> failing()
+{
+    co_yield 1;
+    throw std::runtime_error("stage failed");
+}
+
+static int g_alive = 0;
+struct guard
+{
+    guard()  {++g_alive;}
+    ~guard() {--g_alive;}
+};
+
+generator<int> guarded()
+{
+    guard g;
+    for(int i = 0;; i++) co_yield i;  // 无限序列
+}
+
+void test_generator()
+{
+    int sum = 0;
+    for(int x : iota(0, 10)) sum += x;
+    assert(sum == 45);
+
+    static_assert(std::is_same<iterator_traits<generator<int>::iterator>::iterator_category,
+                               input_iterator_tag>::value, "");
+
+    std::vector<string> w;
+    for(string& s : words()) w.push_back(mySTL::move(s));
+    assert(w.size() == 3 && w[1] == "const" && w[2] == "temporary");
+
+    // 与ranges.h中的视图组合
+    int total = 0;
+    for(int x : iota(0, 100) | views::filter([](int x) {return x % 10 == 0;}) | views::take(3)) total += x;
+    assert(total == 30);
+
+    // 异常
+    bool thrown = false;
+    try {for(int x : failing()) (void)x;} catch(const std::runtime_error&) {thrown = true;}
+    assert(thrown);
+
+    // 提前停止时销毁协程帧
+    {
+        generator<int> g = guarded();
+        for(int x : g) if(x == 5) break;
+        assert(g_alive == 1);
+    }
+    assert(g_alive == 0);
+}
+
+void test_pipeline()
+{
+    // 同步的各个阶段
+    long long sum = 0;
+    for(int x : iota(0, 1000) | stages::filter([](int x) {return x % 2 == 0;})
+                              | stages::map([](int x) {return x * 3;}))
+        sum += x;
+    assert(sum == 3 * 249500);
+
+    // batch / unbatch
+    size_t batches = 0, n = 0;
+    for(auto& b : iota(0, 100) | stages::batch<32>())
+    {
+        ++batches;
+        n += b.size();
+    }
+    assert(batches == 4 && n == 100);
+    sum = 0;
+    for(int x : iota(0, 100) | stages::batch<8>() | stages::unbatch()) sum += x;
+    assert(sum == 4950);
+
+    // 异步阶段, 顺序不变
+    int expect = 0;
+    for(int x : iota(0, 10000) | stages::async<16>(2) | stages::map([](int x) {return x + 1;}) | stages::async(3))
+        assert(x == ++expect);
+    assert(expect == 10000);
+
+    // 上游异常传到下游
+    bool thrown = false;
+    try {for(int x : failing() | stages::async()) (void)x;} catch(const std::runtime_error&) {thrown = true;}
+    assert(thrown);
+
+    // 下游提前停止, 工作线程退出并销毁上游
+    {
+        generator<int> g = guarded() | stages::async<4>(1);
+        for(int x : g) if(x == 100) break;
+    }
+    assert(g_alive == 0);
+
+    // 背压
+    bounded_queue<int> q(2);
+    assert(q.push(1) && q.push(2));
+    std::thread consumer([&q] {
+        int v;
+        while(q.pop(v)) {}
+    });
+    for(int i = 0; i < 1000; i++) q.push(i);
+    q.close();
+    consumer.join();
+    assert(!q.push(0));
+}
+
+// 模拟CPU较重的解析阶段
+struct record
+{
+    unsigned long long key;
+    unsigned long long value;
+};
+
+record parse_one(unsigned long long i)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu,%llu", i, i * 2654435761ull % 1000);
+    record r{0, 0};
+    char* p = buf;
+    r.key = std::strtoull(p, &p, 10);
+    r.value = std::strtoull(p + 1, nullptr, 10);
+    return r;
+}
+
+generator<unsigned long long> source(size_t n)
+{
+    for(size_t i = 0; i < n; i++) co_yield static_cast<unsigned long long>(i);
+}
+
+bool keep(const record& r) {return r.value % 3 == 0;}
+
+void benchmark(size_t n)
+{
+    std::cout << "records: " << n << std::endl;
+    unsigned long long r1 = 0, r2 = 0, r3 = 0;
+
+    // 每个阶段先填满整个容器
+    auto materialized = [&]() {
+        std::vector<record> parsed;
+        for(size_t i = 0; i < n; i++) parsed.push_back(parse_one(i));
+        std::vector<record> kept;
+        for(const record& r : parsed) if(keep(r)) kept.push_back(r);
+        for(const record& r : kept) r1 += r.value;
+        std::cout << "materialized peak elements: " << parsed.capacity() + kept.capacity() << " ";
+    };
+    COUNT_FUN_PERF(materialized, n);
+    std::cout << std::endl;
+
+    auto streaming = [&]() {
+        for(const record& r : source(n) | stages::map(parse_one) | stages::filter(keep)) r2 += r.value;
+    };
+    std::cout << "generator pipeline: ";
+    COUNT_FUN_PERF(streaming, n);
+    std::cout << std::endl;
+
+    auto parallel = [&]() {
+        for(const record& r : source(n) | stages::map(parse_one) | stages::async<256>(4) | stages::filter(keep))
+            r3 += r.value;
+    };
+    std::cout << "async pipeline (bounded to 4 x 256 records): ";
+    COUNT_FUN_PERF(parallel, n);
+    std::cout << std::endl;
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    assert(r1 == r2 && r2 == r3);
+}
+
+int main(int argc, char *argv[])
+{
+    test_generator();
+    test_pipeline();
+    benchmark(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "test_aux.h"
+#include "huge_page_resource.h"
+#include "allocator.h"
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+// 当前进程使用的透明大页 (kB)
+std::string anon_huge_pages()
+{
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string line;
+    while(std::getline(in, line))
+        if(line.compare(0, 14, "AnonHugePages:") == 0) return line.substr(14);
+    return " n/a";
+}
+
+template <class Alloc>
+void bench_random_lookup(const char* name, size_t n, size_t lookups)
+{
+    uint64_t* table = Alloc::allocate(n);
+    for(size_t i = 0; i < n; i++) table[i] = i;
+    uint64_t sum = 0;
+    auto lookup = [&]() {
+        uint64_t x = 88172645463325252ull;
+        for(size_t i = 0; i < lookups; i++)
+        {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift
+            sum += table[x % n];
+        }
+    };
+    std::cout << name;
+    COUNT_FUN_PERF(lookup, lookups);
+    std::cout << " AnonHugePages:" << anon_huge_pages() << " sum: " << sum << std::endl;
+    Alloc::deallocate(table, n);
+}
+
+int main(int argc, char *argv[])
+{
+    // 对齐和回退
+    void* p = mySTL::huge_page_resource::allocate(100);
+    assert(reinterpret_cast<uintptr_t>(p) % mySTL::huge_page_size == 0);
+    static_cast<char*>(p)[mySTL::huge_page_size - 1] = 1;
+    mySTL::huge_page_resource::deallocate(p, 100);
+
+    int* small = mySTL::huge_page_allocator<int>::allocate(10);
+    small[9] = 9;
+    mySTL::huge_page_allocator<int>::deallocate(small, 10);
+
+    mySTL::huge_page_arena arena;
+    int* a = arena.allocate_array<int>(1000);
+    double* d = arena.allocate_array<double>(1 << 20); // 超过一个区域
+    a[999] = 1;
+    d[(1 << 20) - 1] = 1.0;
+    assert(reinterpret_cast<uintptr_t>(d) % alignof(double) == 0);
+    arena.release();
+
+    // benchmark: 随机查找, 默认256MB, 传入参数指定MB数 (例如 4096)
+    size_t mb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+    size_t n = (mb << 20) / sizeof(uint64_t), lookups = 10000000;
+    std::cout << "table: " << mb << " MB, random lookups: " << lookups << std::endl;
+    bench_random_lookup<mySTL::allocator<uint64_t>>("mySTL::allocator:     ", n, lookups);
+    bench_random_lookup<mySTL::huge_page_allocator<uint64_t>>("huge_page_allocator:  ", n, lookups);
+    std::cout << "MAP_HUGETLB: " << mySTL::huge_page_resource::get_stats().hugetlb
+              << " MADV_HUGEPAGE fallback: " << mySTL::huge_page_resource::get_stats().transparent << std::endl;
+    return 0;
+}
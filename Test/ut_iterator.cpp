@@ -0,0 +1,55 @@
+#include "iterator.h"
+#include "construct.h"
+#include "list.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <type_traits>
+
+// 包装原生指针的连续迭代器, 用于测试unwrap
+template <class T>
+struct wrap_iter: public mySTL::iterator<mySTL::contiguous_iterator_tag, T>
+{
+    T* ptr;
+    explicit wrap_iter(T* p) : ptr(p) {}
+    T& operator*() const {return *ptr;}
+    T* operator->() const {return ptr;}
+    wrap_iter& operator++() {++ptr; return *this;}
+    wrap_iter operator+(ptrdiff_t n) const {return wrap_iter(ptr + n);}
+    ptrdiff_t operator-(const wrap_iter& other) const {return ptr - other.ptr;}
+    bool operator!=(const wrap_iter& other) const {return ptr != other.ptr;}
+};
+
+int main(int argc, char *argv[])
+{
+    // iterator_traits 读取标准成员名
+    typedef mySTL::iterator_traits<mySTL::__list_iterator<int>> list_traits;
+    static_assert(std::is_same<list_traits::pointer, int*>::value, "pointer");
+    static_assert(std::is_same<list_traits::difference_type, ptrdiff_t>::value, "difference_type");
+    static_assert(std::is_same<mySTL::iterator_traits<int*>::iterator_category,
+                               mySTL::contiguous_iterator_tag>::value, "raw pointer is contiguous");
+
+    // unwrap
+    int a[4] = {1, 2, 3, 4};
+    wrap_iter<int> w(a);
+    static_assert(std::is_same<decltype(mySTL::__unwrap_iter(w)), int*>::value, "unwrap to pointer");
+    assert(mySTL::to_address(w + 2) == a + 2);
+    assert(mySTL::__rewrap_iter(w, a + 3).ptr == a + 3);
+
+    // 连续迭代器走memmove, 链表迭代器走逐个构造
+    int b[4] = {0, 0, 0, 0};
+    wrap_iter<int> res = mySTL::uninitialized_copy(w, w + 4, wrap_iter<int>(b));
+    assert(res.ptr == b + 4 && b[3] == 4);
+
+    mySTL::list<std::string> l;
+    l.push_back("hello");
+    l.push_back("world");
+    std::string* s = static_cast<std::string*>(::operator new(2 * sizeof(std::string)));
+    std::string* end = mySTL::uninitialized_copy(l.begin(), l.end(), s);
+    assert(end == s + 2 && s[1] == "world");
+    mySTL::destroy(s, end);
+    ::operator delete(s);
+
+    std::cout << "iterator tests passed" << std::endl;
+    return 0;
+}
@@ -1,12 +1,359 @@
+#define MYSTL_ALLOC_TRACKING
 #include "test_aux.h"
 #include "list.h"
 #include "iterator"
 #include "utils.h"
 #include <iostream>
+#include <cassert>
 #include <string>
 #include <list>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+typedef mySTL::__list_node<std::string> string_node;
+
+template <class List>
+bool equal_to(const List& l, std::initializer_list<std::string> expect)
+{
+    if(l.size() != expect.size()) return false;
+    auto it = expect.begin();
+    for(auto& x : l)
+        if(x != *it++) return false;
+    return true;
+}
+
+void test_slab()
+{
+    mySTL::alloc_stats& node_stats = mySTL::get_alloc_stats<string_node>();
+    mySTL::alloc_stats_reset();
+    {
+        // 批量构造: 哨兵 + 1个slab
+        mySTL::list<std::string> l(100, "x");
+        assert(l.size() == 100);
+        assert(node_stats.allocs == 2);
+        // 新建的链表节点在内存中顺序排列
+        auto it = l.begin();
+        auto prev = &*it;
+        for(++it; it != l.end(); ++it)
+        {
+            assert(reinterpret_cast<char*>(&*it) - reinterpret_cast<char*>(prev) == sizeof(string_node));
+            prev = &*it;
+        }
+
+        // slab中的节点可以正常删除
+        l.erase(l.begin());
+        l.pop_back();
+        l.pop_front();
+        assert(l.size() == 97);
+
+        // 短插入不创建slab
+        std::string small[3] = {"a", "b", "c"};
+        l.insert(l.begin(), small, small + 3);
+        assert(l.front() == "a" && l.size() == 100);
+
+        mySTL::list<std::string> copy(l);
+        assert(copy.size() == 100 && copy.front() == "a" && copy.back() == "x");
+        copy.erase(copy.begin(), copy.end());
+        assert(copy.empty());
+        copy.insert(copy.end(), {"1", "2", "3", "4", "5", "6", "7", "8", "9"});
+        assert(equal_to(copy, {"1", "2", "3", "4", "5", "6", "7", "8", "9"}));
+        copy.assign(small, small + 2);
+        assert(equal_to(copy, {"a", "b"}));
+        std::cout << "list<string>(100) footprint: " << l.memory_footprint() << " [B]" << std::endl;
+    }
+    assert(node_stats.live_bytes == 0);
+    assert(mySTL::get_alloc_stats<mySTL::__list_slab<std::string>>().live_bytes == 0);
+}
+
+// 大量小slab: 释放成批进行, 不逐个节点查找所属slab; 所有节点都空出来的slab整块归还
+void test_many_slabs()
+{
+    typedef mySTL::__list_slab<int> int_slab;
+    mySTL::alloc_stats& slab_stats = mySTL::get_alloc_stats<int_slab>();
+    mySTL::alloc_stats_reset();
+    const size_t slabs = 20000;
+    {
+        int a[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+        mySTL::list<int> l;
+        for(size_t i = 0; i < slabs; i++) l.insert(l.end(), a, a + 8);
+        assert(l.size() == slabs * 8 && slab_stats.live_bytes == slabs * sizeof(int_slab));
+
+        // 删掉前一半的节点和后一半中每个slab的一个节点: 只有前一半的slab可以归还
+        auto mid = l.begin();
+        mySTL::advance(mid, static_cast<ptrdiff_t>(slabs * 4));
+        l.erase(l.begin(), mid);
+        for(auto it = l.begin(); it != l.end(); )
+        {
+            auto next = it;
+            mySTL::advance(next, 8);
+            l.erase(it);
+            it = next;
+        }
+        l.shrink_to_fit();
+        assert(l.capacity() == slabs / 2 * 7);
+        assert(slab_stats.live_bytes == slabs / 2 * sizeof(int_slab));
+        for(int& x : l) assert(x != 0);
+
+        // 再插入不会复用已释放的slab节点, relayout后旧slab全部归还
+        l.push_front(-1);
+        l.relayout();
+        assert(l.front() == -1 && l.size() == slabs / 2 * 7 + 1);
+        assert(slab_stats.live_bytes == sizeof(int_slab));
+    }
+    assert(slab_stats.live_bytes == 0);
+    assert(mySTL::get_alloc_stats<mySTL::__list_node<int>>().live_bytes == 0);
+}
+
+// 构造抛出的异常原样传给调用者, 节点内存留在spare cache
+struct throw_on_copy
+{
+    int v;
+    explicit throw_on_copy(int v = 0) : v(v) {}
+    throw_on_copy(const throw_on_copy& other) : v(other.v) {if(v < 0) throw std::runtime_error("copy");}
+};
+
+void test_construct_throw()
+{
+    mySTL::list<throw_on_copy> l;
+    l.emplace_back(1);
+    bool thrown = false;
+    try {l.push_back(throw_on_copy(-1));} catch(const std::runtime_error&) {thrown = true;}
+    assert(thrown && l.size() == 1 && l.capacity() == 2);
+    l.push_back(throw_on_copy(2));
+    assert(l.size() == 2 && l.back().v == 2 && l.capacity() == 2);
+}
+
+// 只能单遍遍历的迭代器, 走copy_insert_aux的input_iterator_tag版本
+template <class T>
+struct single_pass_iterator
+{
+    typedef std::input_iterator_tag iterator_category;
+    typedef T                       value_type;
+    typedef ptrdiff_t               difference_type;
+    typedef const T*                pointer;
+    typedef const T&                reference;
+
+    const T* p;
+    reference operator*() const {return *p;}
+    single_pass_iterator& operator++() {++p; return *this;}
+    bool operator==(const single_pass_iterator& other) const {return p == other.p;}
+    bool operator!=(const single_pass_iterator& other) const {return p != other.p;}
+};
+
+void test_input_insert_throw()
+{
+    typedef mySTL::__list_slab<throw_on_copy> slab_type;
+    mySTL::alloc_stats& slab_stats = mySTL::get_alloc_stats<slab_type>();
+    mySTL::alloc_stats_reset();
+    {
+        // slab中只剩最后一个空闲节点, 插入时它成为head, 第三个元素拷贝失败
+        mySTL::list<throw_on_copy> l;
+        l.reserve(8);
+        for(int i = 0; i < 7; i++) l.emplace_back(i);
+        throw_on_copy src[3] = {throw_on_copy(7), throw_on_copy(8), throw_on_copy(-1)};
+        single_pass_iterator<throw_on_copy> first{src}, last{src + 3};
+        bool thrown = false;
+        try {l.insert(l.end(), first, last);} catch(const std::runtime_error&) {thrown = true;}
+        assert(thrown && l.size() == 7);
+
+        // head仍在spare cache中, relayout不能归还它所在的slab
+        l.relayout();
+        assert(slab_stats.live_bytes == 2 * sizeof(slab_type));
+        for(int i = 7; i < 10; i++) l.emplace_back(i);
+        int expect = 0;
+        for(auto& x : l) assert(x.v == expect++);
+        assert(expect == 10);
+    }
+    assert(slab_stats.live_bytes == 0);
+}
+
+// 第budget次拷贝时抛出异常
+struct throw_after
+{
+    static int budget;
+    int v;
+    explicit throw_after(int v = 0) : v(v) {}
+    throw_after(const throw_after& other) : v(other.v) {if(--budget == 0) throw std::runtime_error("copy");}
+};
+int throw_after::budget = 0;
+
+void test_init_throw()
+{
+    mySTL::alloc_stats& node_stats = mySTL::get_alloc_stats<mySTL::__list_node<throw_after>>();
+    mySTL::alloc_stats& slab_stats = mySTL::get_alloc_stats<mySTL::__list_slab<throw_after>>();
+    mySTL::alloc_stats_reset();
+    std::vector<throw_after> src(40);
+    single_pass_iterator<throw_after> first{src.data()}, last{src.data() + 40};
+    for(int kind = 0; kind < 3; kind++)
+    {
+        throw_after::budget = 20;
+        bool thrown = false;
+        try
+        {
+            if(kind == 0) mySTL::list<throw_after> l(40, throw_after(1));
+            else if(kind == 1) mySTL::list<throw_after> l(src.begin(), src.end());
+            else mySTL::list<throw_after> l(first, last);
+        }
+        catch(const std::runtime_error&) {thrown = true;}
+        assert(thrown);
+        // 节点, slab和虚拟节点都已归还
+        assert(node_stats.live_bytes == 0 && slab_stats.live_bytes == 0);
+    }
+}
+
+void test_spare_cache()
+{
+    mySTL::alloc_stats& node_stats = mySTL::get_alloc_stats<string_node>();
+    mySTL::list<std::string> l;
+    l.reserve(64);
+    assert(l.capacity() == 64 && l.empty());
+    mySTL::alloc_stats_reset();
+    for(int i = 0; i < 64; i++) l.push_back("v");
+    l.erase(l.begin());
+    l.pop_back();
+    l.pop_front();
+    l.resize(10);
+    l.assign(50, "w");
+    l.resize(64, "r");
+    l.clear();
+    l.insert(l.end(), 64, "z");
+    assert(node_stats.allocs == 0 && node_stats.deallocs == 0);
+    assert(l.size() == 64 && l.back() == "z");
+
+    l.resize(4);
+    assert(l.capacity() == 64);
+    l.shrink_to_fit();
+    assert(l.capacity() == 4);
+
+    mySTL::list<std::string> other;
+    other = l;
+    assert(equal_to(other, {"z", "z", "z", "z"}));
+}
+
+void test_relayout()
+{
+    mySTL::list<std::string> l;
+    for(int i = 0; i < 20; i++) l.push_back(std::to_string(i));
+    l.erase(l.begin());
+    l.insert(l.begin(), "a");
+    l.relayout();
+    std::string joined;
+    l.for_each([&](const std::string& x) { joined += x; });
+    assert(joined == "a12345678910111213141516171819");
+    auto it = l.begin();
+    auto prev = &*it;
+    for(++it; it != l.end(); ++it)
+    {
+        assert(reinterpret_cast<char*>(&*it) - reinterpret_cast<char*>(prev) == sizeof(string_node));
+        prev = &*it;
+    }
+    assert(l.back() == "19" && l.size() == 20);
+}
+
+// 把list的节点打乱成随机的内存顺序: 随机顺序删除进入spare cache, 再按该顺序取出
+void fragment(mySTL::list<int>& l, size_t n)
+{
+    l.clear();
+    l.shrink_to_fit();
+    l.resize(n, 0);
+    std::vector<mySTL::list<int>::iterator> its;
+    for(auto it = l.begin(); it != l.end(); ++it) its.push_back(it);
+    std::vector<size_t> order(n);
+    for(size_t i = 0; i < n; i++) order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    for(size_t i : order) l.erase(its[i]);
+    for(size_t i = 0; i < n; i++) l.push_back(static_cast<int>(i));
+}
+
+void bench_relayout()
+{
+    const size_t N = 1 << 20;
+    mySTL::list<int> l;
+    fragment(l, N);
+    long long sum = 0;
+    auto traverse = [&]() { for(auto& i : l) sum += i; };
+    auto prefetch_traverse = [&]() { l.for_each([&](int i) { sum += i; }); };
+    std::cout << "fragmented traverse:          ";
+    COUNT_FUN_PERF(traverse, N);
+    std::cout << std::endl << "fragmented for_each+prefetch: ";
+    COUNT_FUN_PERF(prefetch_traverse, N);
+    auto relayout = [&]() { l.relayout(); };
+    std::cout << std::endl << "relayout:                     ";
+    COUNT_FUN_PERF(relayout, N);
+    std::cout << std::endl << "relayout traverse:            ";
+    COUNT_FUN_PERF(traverse, N);
+    std::cout << std::endl << "sum: " << sum << std::endl;
+}
 
 int main(int argc, char *argv[])
 {
+    test_slab();
+    test_many_slabs();
+    test_construct_throw();
+    test_input_insert_throw();
+    test_init_throw();
+    test_spare_cache();
+    test_relayout();
+    bench_relayout();
+
+    const size_t N = 1000000;
+    mySTL::list<int> l;
+    std::list<int>   sl;
+    for(size_t i = 0; i < N; i++)
+    {
+        l.push_back(static_cast<int>(i));
+        sl.push_back(static_cast<int>(i));
+    }
+
+    // 遍历性能, 附带硬件计数器 (不可用时显示n/a)
+    long long sum = 0;
+    auto traverse = [&]() { for(auto& i : l) sum += i; };
+    auto std_traverse = [&]() { for(auto& i : sl) sum += i; };
+    std::cout << "mySTL::list traverse: ";
+    COUNT_FUN_PERF(traverse, N);
+    std::cout << std::endl << "std::list traverse:   ";
+    COUNT_FUN_PERF(std_traverse, N);
+    std::cout << std::endl << "sum: " << sum << std::endl;
+
+    // 批量构造
+    mySTL::alloc_stats_reset();
+    auto build = [&]() { mySTL::list<int> tmp(sl.begin(), sl.end()); sum += tmp.size(); };
+    auto std_build = [&]() { std::list<int> tmp(sl.begin(), sl.end()); sum += tmp.size(); };
+    std::cout << "mySTL::list range build: ";
+    COUNT_FUN_TIME(build);
+    std::cout << " allocs: " << mySTL::get_alloc_stats<mySTL::__list_node<int>>().allocs << std::endl;
+    std::cout << "std::list range build:   ";
+    {COUNT_FUN_TIME(std_build);}
+    std::cout << std::endl;
+
+    // 稳态队列: 每轮填满再清空, 节点全部来自spare cache
+    const size_t cycles = 100, depth = 5000;
+    mySTL::list<int> queue;
+    queue.reserve(depth);
+    mySTL::alloc_stats_reset();
+    auto steady = [&]() {
+        for(size_t c = 0; c < cycles; c++)
+        {
+            for(size_t i = 0; i < depth; i++) queue.push_back(static_cast<int>(i));
+            while(!queue.empty()) { sum += queue.front(); queue.pop_front(); }
+        }
+    };
+    std::cout << "mySTL::list steady-state queue: ";
+    {COUNT_FUN_TIME(steady);}
+    std::cout << " allocs per cycle: "
+              << mySTL::get_alloc_stats<mySTL::__list_node<int>>().allocs / cycles << std::endl;
+    std::list<int> std_queue;
+    auto std_steady = [&]() {
+        for(size_t c = 0; c < cycles; c++)
+        {
+            for(size_t i = 0; i < depth; i++) std_queue.push_back(static_cast<int>(i));
+            while(!std_queue.empty()) { sum += std_queue.front(); std_queue.pop_front(); }
+        }
+    };
+    std::cout << "std::list steady-state queue:   ";
+    {COUNT_FUN_TIME(std_steady);}
+    std::cout << std::endl;
     return 0;
-}
\ No newline at end of file
+}
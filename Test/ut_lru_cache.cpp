@@ -0,0 +1,262 @@
+#include "test_aux.h"
+#include "lru_cache.h"
+#include "list.h"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace mySTL;
+
+// 有状态的hasher
+struct seeded_hash
+{
+    uint64_t seed;
+    size_t operator()(int x) const {return static_cast<size_t>(x) ^ seed;}
+};
+
+// 无状态的Hash和KeyEqual不占空间 (EBO), 有状态的只增加自身大小
+static_assert(sizeof(lru_cache<int, int, seeded_hash>) == sizeof(lru_cache<int, int>) + sizeof(seeded_hash), "EBO");
+static_assert(sizeof(clock_cache<int, int, seeded_hash>) == sizeof(clock_cache<int, int>) + sizeof(seeded_hash), "EBO");
+
+struct counted
+{
+    static int live;
+    int v;
+    counted(int v) : v(v) {++live;}
+    counted(const counted& o) : v(o.v) {++live;}
+    counted& operator=(const counted& o) {v = o.v; return *this;}
+    ~counted() {--live;}
+};
+int counted::live = 0;
+
+void test_lru()
+{
+    // 有状态的hasher
+    {
+        lru_cache<int, int, seeded_hash> h(4, seeded_hash{7});
+        for(int i = 0; i < 6; i++) assert(h.put(i, i));
+        assert(!h.contains(1) && *h.get(5) == 5);
+    }
+
+    lru_cache<int, std::string> c(3);
+    assert(c.empty() && c.capacity() == 3);
+    assert(c.put(1, "a") && c.put(2, "b") && c.put(3, "c"));
+    assert(c.full() && c.get(4) == nullptr);
+    assert(*c.get(1) == "a");                   // 顺序变为 1 3 2
+    assert(c.put(4, "d"));                      // 淘汰2
+    assert(!c.contains(2) && c.evictions() == 1);
+    std::string order;
+    for(auto& kv : c) order += kv.second;
+    assert(order == "dac" && c.back().first == 3);
+
+    assert(!c.put(3, "C"));                     // 覆盖并移到最前
+    assert(*c.peek(3) == "C" && c.begin()->first == 3);
+    assert(c.get_or_put(5, [] {return std::string("e");}) == "e");  // 淘汰1
+    assert(!c.contains(1) && c.size() == 3);
+    assert(c.hits() == 1 && c.misses() == 2);
+
+    assert(c.erase(4) && !c.erase(4) && c.size() == 2);
+    assert(c.put(6, "f") && c.size() == 3);
+    order.clear();
+    for(auto& kv : c) order += kv.second;
+    assert(order == "feC");
+    c.clear();
+    assert(c.empty() && c.begin() == c.end());
+
+    // 索引的后移删除: 大量插入/删除/淘汰之后和参照实现一致
+    lru_cache<int, counted> big(1000);
+    std::unordered_map<int, int> ref;
+    mySTL::list<int> order_ref;     // 最前为最近访问
+    uint64_t x = 12345;
+    for(int i = 0; i < 200000; i++)
+    {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        int k = static_cast<int>(x % 3000);
+        int op = static_cast<int>((x >> 32) % 4);
+        if(op == 0)
+        {
+            bool erased = big.erase(k);
+            assert(erased == (ref.erase(k) != 0));
+            if(erased)
+                for(auto it = order_ref.begin(); it != order_ref.end(); ++it)
+                    if(*it == k) {order_ref.erase(it); break;}
+        }
+        else if(op == 1)
+        {
+            counted* p = big.get(k);
+            assert((p != nullptr) == (ref.count(k) != 0));
+            if(p)
+            {
+                assert(p->v == ref[k]);
+                for(auto it = order_ref.begin(); it != order_ref.end(); ++it)
+                    if(*it == k) {order_ref.erase(it); break;}
+                order_ref.push_front(k);
+            }
+        }
+        else
+        {
+            bool is_new = big.put(k, counted(i));
+            assert(is_new == (ref.count(k) == 0));
+            if(!is_new)
+                for(auto it = order_ref.begin(); it != order_ref.end(); ++it)
+                    if(*it == k) {order_ref.erase(it); break;}
+            if(is_new && ref.size() == 1000)
+            {
+                ref.erase(order_ref.back());
+                order_ref.pop_back();
+            }
+            ref[k] = i;
+            order_ref.push_front(k);
+        }
+        assert(big.size() == ref.size());
+    }
+    auto it = order_ref.begin();
+    for(auto& kv : big)
+    {
+        assert(kv.first == *it);
+        ++it;
+    }
+    assert(counted::live == static_cast<int>(big.size()));
+}
+
+void test_clock()
+{
+    clock_cache<int, int> c(3);
+    assert(c.put(1, 10) && c.put(2, 20) && c.put(3, 30));
+    assert(*c.get(1) == 10 && *c.get(2) == 20);
+    assert(c.put(4, 40));                       // 3没有被访问过, 被淘汰
+    assert(!c.contains(3) && c.contains(1) && c.contains(2));
+    assert(c.put(5, 50));                       // 1, 2的访问位在上一轮被清除, 淘汰1
+    assert(!c.contains(1) && c.size() == 3 && c.evictions() == 2);
+    assert(c.erase(5) && c.size() == 2);
+    assert(c.get_or_put(6, [] {return 60;}) == 60 && c.size() == 3);
+    int sum = 0;
+    c.for_each([&](const pair<const int, int>& kv) {sum += kv.second;});
+    assert(sum == 20 + 40 + 60);
+
+    {
+        clock_cache<int, counted> cc(100);
+        for(int i = 0; i < 1000; i++)
+        {
+            cc.put(i, counted(i));
+            if(i % 3 == 0) cc.get(i / 2);
+            if(i % 7 == 0) cc.erase(i - 1);
+        }
+        assert(counted::live == static_cast<int>(cc.size()));
+        for(int i = 900; i < 1000; i++)
+            if(cc.contains(i)) assert(cc.peek(i)->v == i);
+    }
+    assert(counted::live == 0);
+}
+
+// 常见写法: list保存访问顺序 + 哈希表保存key到迭代器的映射, 每个条目分配两次
+class list_map_lru
+{
+private:
+    typedef mySTL::list<pair<uint64_t, uint64_t>> list_type;
+    size_t                                                  __cap;
+    list_type                                               __list;
+    std::unordered_map<uint64_t, list_type::iterator>       __map;
+    size_t                                                  __hits = 0, __misses = 0;
+
+public:
+    explicit list_map_lru(size_t cap) : __cap(cap) {__map.reserve(cap);}
+
+    uint64_t* get(uint64_t k)
+    {
+        auto it = __map.find(k);
+        if(it == __map.end()) {++__misses; return nullptr;}
+        ++__hits;
+        // list的splice还没有实现, 只能删除后重新插入
+        pair<uint64_t, uint64_t> kv = *it->second;
+        __list.erase(it->second);
+        __list.push_front(kv);
+        it->second = __list.begin();
+        return &__list.begin()->second;
+    }
+
+    void put(uint64_t k, uint64_t v)
+    {
+        if(__list.size() == __cap)
+        {
+            __map.erase(__list.back().first);
+            __list.pop_back();
+        }
+        __list.push_front(pair<uint64_t, uint64_t>(k, v));
+        __map[k] = __list.begin();
+    }
+
+    double hit_rate() const {return double(__hits) / (__hits + __misses);}
+};
+
+// 近似zipf分布的访问序列: 排名为r的key的概率正比于 1 / r^s
+std::vector<uint64_t> zipf_trace(size_t n, uint64_t universe, double s)
+{
+    std::vector<double> cdf(universe);
+    double sum = 0;
+    for(uint64_t r = 0; r < universe; r++) cdf[r] = (sum += 1.0 / std::pow(r + 1.0, s));
+    std::vector<uint64_t> trace(n);
+    uint64_t x = 88172645463325252ull;
+    for(auto& k : trace)
+    {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        double u = (x >> 11) * (1.0 / 9007199254740992.0) * sum;
+        uint64_t r = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        k = r * 2654435761ull;     // 打散排名
+    }
+    return trace;
+}
+
+// 按访问序列执行 get, 未命中时put, 返回Mops/s
+template <class Cache>
+double replay(Cache& c, const std::vector<uint64_t>& trace)
+{
+    uint64_t sink = 0;
+    auto t1 = std::chrono::steady_clock::now();
+    for(uint64_t k : trace)
+    {
+        uint64_t* v = c.get(k);
+        if(v) sink += *v;
+        else c.put(k, k);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    assert(sink != 1);
+    return trace.size() / std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count() / 1e6;
+}
+
+void benchmark(size_t n)
+{
+    const uint64_t universe = 1 << 20;
+    for(double s : {0.8, 1.0})
+    {
+        std::vector<uint64_t> trace = zipf_trace(n, universe, s);
+        std::cout << "zipf s = " << s << ", " << n << " accesses over " << universe << " keys" << std::endl;
+        for(size_t cap : {1u << 12, 1u << 16})
+        {
+            lru_cache<uint64_t, uint64_t> lru(cap);
+            clock_cache<uint64_t, uint64_t> clk(cap);
+            list_map_lru base(cap);
+            double a = replay(lru, trace), b = replay(clk, trace), c = replay(base, trace);
+            std::cout << "  capacity " << cap << ":" << std::endl
+                      << "    lru_cache         hit rate " << lru.hit_rate() << ", " << a << " Mops/s" << std::endl
+                      << "    clock_cache       hit rate " << clk.hit_rate() << ", " << b << " Mops/s" << std::endl
+                      << "    list + hash map   hit rate " << base.hit_rate() << ", " << c << " Mops/s" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    test_lru();
+    test_clock();
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    if(n) benchmark(n);
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "test_aux.h"
+#include "mapped_vector.h"
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <system_error>
+#include <unistd.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+struct record
+{
+    uint64_t id;
+    double   value;
+};
+
+std::string temp_path()
+{
+    char path[] = "/tmp/mystl_mapped_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    return path;
+}
+
+void test_mapped_vector(const std::string& path)
+{
+    {
+        mySTL::mapped_vector<record> v(path.c_str(), mySTL::mmap_resource::create);
+        assert(v.empty() && v.writable());
+        for(uint64_t i = 0; i < 1000; i++) v.push_back(record{i, i * 0.5});
+        v.push_back(v[10]); // 元素指向映射内部
+        assert(v.size() == 1001 && v.capacity() >= 1001 && v.back().id == 10);
+    }
+    // 文件长度被截断为size()
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    assert(static_cast<size_t>(in.tellg()) == 1001 * sizeof(record));
+
+    {
+        mySTL::mmap_options options;
+        options.advice = mySTL::mmap_advice::random;
+        mySTL::mapped_vector<record> v(path.c_str(), mySTL::mmap_resource::read_only, options);
+        assert(v.size() == 1001 && v[999].id == 999 && v[999].value == 499.5 && !v.writable());
+    }
+    {
+        mySTL::mapped_vector<record> v(path.c_str(), mySTL::mmap_resource::read_write);
+        v.resize(5000, record{7, 7.0});
+        v.sync();
+        assert(v.size() == 5000 && v[4999].id == 7 && v[500].id == 500);
+    }
+    mySTL::mapped_vector<record> v(path.c_str());
+    assert(v.size() == 5000);
+
+    // 匿名映射
+    mySTL::mapped_vector<int> anon;
+    for(int i = 0; i < 100000; i++) anon.push_back(i);
+    assert(anon.size() == 100000 && anon[99999] == 99999);
+}
+
+// 匿名映射resize后内容保留 (移动映射时也一样)
+void test_anonymous_resize()
+{
+    mySTL::mmap_resource m(4096);
+    unsigned char* p = static_cast<unsigned char*>(m.data());
+    for(size_t i = 0; i < 4096; i++) p[i] = static_cast<unsigned char>(i * 7);
+    m.resize(1 << 20);
+    p = static_cast<unsigned char*>(m.data());
+    for(size_t i = 0; i < 4096; i++) assert(p[i] == static_cast<unsigned char>(i * 7));
+    assert(p[(1 << 20) - 1] == 0);
+    m.resize(1000);
+    p = static_cast<unsigned char*>(m.data());
+    assert(m.size() == 1000);
+    for(size_t i = 0; i < 1000; i++) assert(p[i] == static_cast<unsigned char>(i * 7));
+}
+
+// 扩大映射失败时文件长度和原映射都不变
+void test_resize_failure(const std::string& path)
+{
+#if defined(__linux__)
+    mySTL::mmap_resource m(path.c_str(), mySTL::mmap_resource::create);
+    m.resize(4096);
+    static_cast<unsigned char*>(m.data())[4095] = 42;
+
+    // 限制地址空间只比当前多64MB, 扩大到1GB时映射失败
+    size_t pages = 0;
+    std::ifstream("/proc/self/statm") >> pages;
+    rlimit old_limit;
+    assert(getrlimit(RLIMIT_AS, &old_limit) == 0);
+    rlimit limit = old_limit;
+    limit.rlim_cur = static_cast<rlim_t>(pages * sysconf(_SC_PAGESIZE) + (64 << 20));
+    if(limit.rlim_cur > old_limit.rlim_cur) return;   // 已经有更严的限制, 无法构造失败
+    assert(setrlimit(RLIMIT_AS, &limit) == 0);
+    bool thrown = false;
+    try {m.resize(size_t(1) << 30);} catch(const std::system_error&) {thrown = true;}
+    assert(setrlimit(RLIMIT_AS, &old_limit) == 0);
+
+    struct stat st;
+    assert(thrown && m.size() == 4096 && static_cast<unsigned char*>(m.data())[4095] == 42);
+    assert(stat(path.c_str(), &st) == 0 && st.st_size == 4096);
+    m.resize(8192);
+    assert(stat(path.c_str(), &st) == 0 && st.st_size == 8192);
+#else
+    (void)path;
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    std::string path = temp_path();
+    test_mapped_vector(path);
+    test_anonymous_resize();
+    test_resize_failure(path);
+
+    // benchmark: 打开已有数据文件并扫描一遍, 对比流读入std::vector
+    const size_t N = size_t(1) << 22; // 64MB
+    {
+        mySTL::mapped_vector<record> v(path.c_str(), mySTL::mmap_resource::create);
+        v.reserve(N);
+        for(uint64_t i = 0; i < N; i++) v.push_back(record{i, 1.0});
+    }
+    double sum = 0;
+    auto open_mapped = [&]() {
+        mySTL::mmap_options options;
+        options.advice = mySTL::mmap_advice::sequential;
+        mySTL::mapped_vector<record> v(path.c_str(), mySTL::mmap_resource::read_only, options);
+        sum += v.size();
+    };
+    auto scan_mapped = [&]() {
+        mySTL::mmap_options options;
+        options.advice = mySTL::mmap_advice::sequential;
+        mySTL::mapped_vector<record> v(path.c_str(), mySTL::mmap_resource::read_only, options);
+        for(auto& r : v) sum += r.value;
+    };
+    auto scan_stream = [&]() {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        std::vector<record> v(static_cast<size_t>(in.tellg()) / sizeof(record));
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(record)));
+        for(auto& r : v) sum += r.value;
+    };
+    std::cout << "mapped_vector open:          "; {COUNT_FUN_TIME(open_mapped);}
+    std::cout << std::endl << "mapped_vector open + scan:   "; {COUNT_FUN_TIME(scan_mapped);}
+    std::cout << std::endl << "ifstream -> vector + scan:   "; {COUNT_FUN_TIME(scan_stream);}
+    std::cout << std::endl << "sum: " << sum << std::endl;
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,277 @@
+#include "test_aux.h"
+#include "membership_filter.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace mySTL;
+
+// 有状态的hasher
+struct seeded_hash
+{
+    uint64_t seed;
+    size_t operator()(uint64_t x) const {return static_cast<size_t>(x ^ seed);}
+};
+
+// 无状态的Hash不占空间 (EBO): 布隆过滤器的标量字段放在第一个cache line, 后面是两个32字节对齐的表
+static_assert(sizeof(blocked_bloom_filter<uint64_t>) == 64 + 2 * sizeof(uint32_t[16]), "EBO");
+static_assert(sizeof(cuckoo_filter<uint64_t, seeded_hash>) ==
+              sizeof(cuckoo_filter<uint64_t>) + sizeof(seeded_hash), "EBO");
+
+static uint64_t xorshift(uint64_t& x)
+{
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return x;
+}
+
+// 前n个是成员, 后n个是非成员 (互不相同)
+static std::vector<uint64_t> make_keys(size_t n, uint64_t seed)
+{
+    std::unordered_set<uint64_t> seen;
+    std::vector<uint64_t> keys;
+    keys.reserve(2 * n);
+    while(keys.size() < 2 * n)
+    {
+        uint64_t k = xorshift(seed);
+        if(seen.insert(k).second) keys.push_back(k);
+    }
+    return keys;
+}
+
+template <class Filter>
+static double measure_fpr(const Filter& f, const std::vector<uint64_t>& keys, size_t n)
+{
+    size_t fp = 0;
+    for(size_t i = n; i < 2 * n; i++) fp += f.contains(keys[i]);
+    return static_cast<double>(fp) / static_cast<double>(n);
+}
+
+void test_bloom()
+{
+    const size_t n = 50000;
+    std::vector<uint64_t> keys = make_keys(n, 1);
+    const double rates[] = {0.2, 0.05, 0.01, 0.001, 0.0001};
+    for(double fpr : rates)
+    {
+        blocked_bloom_filter<uint64_t> f(n, fpr);
+        assert(f.size() == 0 && !f.contains(keys[0]));
+        f.insert_many(keys.data(), n / 2);
+        for(size_t i = n / 2; i < n; i++) f.insert(keys[i]);
+        assert(f.size() == n);
+        for(size_t i = 0; i < n; i++) assert(f.contains(keys[i]));
+
+        // 实测误报率接近目标 (模型是精确的, 只留出抽样误差)
+        double measured = measure_fpr(f, keys, n);
+        assert(measured <= fpr * 1.3 + 5.0 / n);
+        assert(f.expected_fpr() <= fpr * 1.01);
+
+        // 批量查询和逐个查询一致
+        std::vector<char> found(2 * n);
+        size_t hit = f.contains_many(keys.data(), 2 * n, reinterpret_cast<bool*>(found.data()));
+        size_t expect = 0;
+        for(size_t i = 0; i < 2 * n; i++)
+        {
+            assert(static_cast<bool>(found[i]) == f.contains(keys[i]));
+            expect += found[i];
+        }
+        assert(hit == expect && hit >= n);
+
+        blocked_bloom_filter<uint64_t> g(f);
+        blocked_bloom_filter<uint64_t> h(std::move(g));
+        assert(h.memory_bytes() == f.memory_bytes() && h.hash_count() == f.hash_count());
+        for(size_t i = 0; i < 2 * n; i++) assert(h.contains(keys[i]) == f.contains(keys[i]));
+        f.clear();
+        assert(f.size() == 0 && !f.contains(keys[0]));
+        swap(f, h);
+        assert(f.contains(keys[0]) && !h.contains(keys[0]));
+    }
+
+    // 误报率越低, 每个key的位数和探测数越多
+    blocked_bloom_filter<uint64_t> loose(n, 0.1), tight(n, 0.0001);
+    assert(loose.memory_bytes() < tight.memory_bytes() && loose.hash_count() <= tight.hash_count());
+
+    blocked_bloom_filter<std::string> s(100, 0.01);
+    s.insert("apple");
+    s.insert(std::string("banana"));
+    assert(s.contains("apple") && s.contains("banana"));
+
+    blocked_bloom_filter<uint64_t, seeded_hash> seeded(100, 0.01, seeded_hash{7});
+    seeded.insert(1);
+    assert(seeded.contains(1));
+
+    bool thrown = false;
+    try {blocked_bloom_filter<int> bad(10, 1.0);} catch(const std::invalid_argument&) {thrown = true;}
+    assert(thrown);
+}
+
+void test_cuckoo()
+{
+    const size_t n = 50000;
+    std::vector<uint64_t> keys = make_keys(n, 2);
+    const double rates[] = {0.05, 0.01, 0.001, 0.0002};     // f最多16位, 满载时误报率下限约1.2e-4
+    for(double fpr : rates)
+    {
+        cuckoo_filter<uint64_t> f(n, fpr);
+        assert(f.empty());
+        for(size_t i = 0; i < n; i++) assert(f.insert(keys[i]));
+        assert(f.size() == n);
+        for(size_t i = 0; i < n; i++) assert(f.contains(keys[i]));
+        double measured = measure_fpr(f, keys, n);
+        assert(measured <= f.expected_fpr() * 1.3 + 5.0 / n);
+        assert(f.expected_fpr() <= fpr);
+
+        std::vector<char> found(2 * n);
+        size_t hit = f.contains_many(keys.data(), 2 * n, reinterpret_cast<bool*>(found.data()));
+        size_t expect = 0;
+        for(size_t i = 0; i < 2 * n; i++)
+        {
+            assert(static_cast<bool>(found[i]) == f.contains(keys[i]));
+            expect += found[i];
+        }
+        assert(hit == expect);
+
+        // 删除一半后, 剩下的仍然都在, 删掉的只剩误报
+        cuckoo_filter<uint64_t> g(f);
+        for(size_t i = 0; i < n; i += 2) assert(g.erase(keys[i]));
+        assert(g.size() == n / 2);
+        size_t stale = 0;
+        for(size_t i = 0; i < n; i++)
+        {
+            if(i & 1) assert(g.contains(keys[i]));
+            else stale += g.contains(keys[i]);
+        }
+        assert(stale <= n * fpr + 20);
+        for(size_t i = 1; i < n; i += 2) assert(g.erase(keys[i]));
+        assert(g.empty());
+        for(size_t i = 0; i < 2 * n; i++) assert(!g.contains(keys[i]));
+
+        // 原过滤器不受影响
+        for(size_t i = 0; i < n; i++) assert(f.contains(keys[i]));
+        cuckoo_filter<uint64_t> h(std::move(f));
+        assert(h.size() == n && h.contains(keys[0]));
+        h.clear();
+        assert(h.empty() && !h.contains(keys[0]));
+    }
+
+    // 插满: insert失败之前插入的key都不会丢, 删除后可以继续插入
+    {
+        cuckoo_filter<uint64_t> f(1000, 0.01);
+        size_t inserted = 0;
+        while(inserted < 2 * n && f.insert(keys[inserted])) ++inserted;
+        assert(inserted < 2 * n && inserted > f.slot_count() * 9 / 10);
+        assert(f.size() == inserted);
+        for(size_t i = 0; i < inserted; i++) assert(f.contains(keys[i]));
+        assert(!f.insert(keys[inserted]));
+        for(size_t i = 0; i < inserted; i += 3) assert(f.erase(keys[i]));
+        for(size_t i = 0; i < inserted; i++) if(i % 3) assert(f.contains(keys[i]));
+        assert(f.insert(keys[inserted]) && f.contains(keys[inserted]));
+    }
+
+    // 随机插入/删除 (包括重复的key), 和计数表对比: 计数大于0的key一定存在
+    {
+        cuckoo_filter<uint64_t> f(4000, 0.001);
+        std::unordered_map<uint64_t, int> count;
+        uint64_t x = 99;
+        size_t total = 0;
+        for(int step = 0; step < 200000; step++)
+        {
+            uint64_t key = keys[xorshift(x) % 3000];
+            if(xorshift(x) % 2 == 0)
+            {
+                if(count[key] < 4 && f.insert(key)) {++count[key]; ++total;}
+            }
+            else if(count[key] > 0)
+            {
+                assert(f.erase(key));
+                --count[key];
+                --total;
+            }
+            if(step % 1000 == 0)
+                for(auto& kv : count) if(kv.second > 0) assert(f.contains(kv.first));
+        }
+        assert(f.size() == total);
+    }
+
+    cuckoo_filter<std::string> s(100);
+    assert(s.insert("apple") && s.contains("apple"));
+    assert(s.erase("apple") && !s.contains("apple") && s.empty());
+
+    cuckoo_filter<uint64_t, seeded_hash> seeded(100, 0.01, seeded_hash{7});
+    assert(seeded.insert(1) && seeded.contains(1));
+
+    bool thrown = false;
+    try {cuckoo_filter<int> bad(10, 0.0);} catch(const std::invalid_argument&) {thrown = true;}
+    assert(thrown);
+}
+
+void benchmark(size_t n)
+{
+    std::vector<uint64_t> keys = make_keys(n, 3);
+    // 查询序列: 成员和非成员各一半, 随机交错
+    std::vector<uint64_t> queries(keys);
+    uint64_t x = 5;
+    for(size_t i = queries.size(); i > 1; i--) mySTL::swap(queries[i - 1], queries[xorshift(x) % i]);
+    std::vector<char> found(queries.size());
+    bool* out = reinterpret_cast<bool*>(found.data());
+    size_t sink = 0;
+
+    std::unordered_set<uint64_t> us(keys.begin(), keys.begin() + n);
+    // 节点 (next指针 + key) 加上桶数组
+    double us_bytes = static_cast<double>(us.size() * (sizeof(void*) + sizeof(uint64_t)) + us.bucket_count() * sizeof(void*));
+    auto query_us = [&] {for(uint64_t k : queries) sink += us.count(k);};
+    std::cout << n << " keys, " << queries.size() << " queries (half members)" << std::endl;
+    std::cout << "unordered_set:   " << us_bytes * 8 / n << " bits/key" << std::endl;
+    std::cout << "  query:         "; COUNT_FUN_PERF(query_us, queries.size()); std::cout << std::endl;
+
+    const double rates[] = {0.05, 0.01, 0.001};
+    for(double fpr : rates)
+    {
+        blocked_bloom_filter<uint64_t> bf(n, fpr);
+        cuckoo_filter<uint64_t> cf(n, fpr);
+        auto build_bf = [&] {bf.insert_many(keys.data(), n);};
+        auto build_cf = [&] {for(size_t i = 0; i < n; i++) cf.insert(keys[i]);};
+        auto query_bf = [&] {for(uint64_t k : queries) sink += bf.contains(k);};
+        auto query_cf = [&] {for(uint64_t k : queries) sink += cf.contains(k);};
+        auto batch_bf = [&] {sink += bf.contains_many(queries.data(), queries.size(), out);};
+        auto batch_cf = [&] {sink += cf.contains_many(queries.data(), queries.size(), out);};
+        auto erase_cf = [&] {for(size_t i = 0; i < n; i += 2) cf.erase(keys[i]);};
+
+        std::cout << "target fpr " << fpr << std::endl;
+        std::cout << "  bloom  build:  "; COUNT_FUN_PERF(build_bf, n); std::cout << std::endl;
+        std::cout << "  bloom  query:  "; COUNT_FUN_PERF(query_bf, queries.size()); std::cout << std::endl;
+        std::cout << "  bloom  batch:  "; COUNT_FUN_PERF(batch_bf, queries.size()); std::cout << std::endl;
+        std::cout << "  bloom  " << bf.memory_bytes() * 8.0 / n << " bits/key, k = " << bf.hash_count()
+                  << ", fpr " << measure_fpr(bf, keys, n) << std::endl;
+        std::cout << "  cuckoo build:  "; COUNT_FUN_PERF(build_cf, n); std::cout << std::endl;
+        std::cout << "  cuckoo query:  "; COUNT_FUN_PERF(query_cf, queries.size()); std::cout << std::endl;
+        std::cout << "  cuckoo batch:  "; COUNT_FUN_PERF(batch_cf, queries.size()); std::cout << std::endl;
+        std::cout << "  cuckoo " << cf.memory_bytes() * 8.0 / n << " bits/key, f = " << cf.fingerprint_bits()
+                  << ", load " << cf.load_factor() << ", fpr " << measure_fpr(cf, keys, n) << std::endl;
+        std::cout << "  cuckoo erase:  "; COUNT_FUN_PERF(erase_cf, n / 2); std::cout << std::endl;
+    }
+    assert(sink != 0);
+}
+
+int main(int argc, char *argv[])
+{
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    // -mavx2编译的版本在不支持AVX2的CPU上直接跳过
+    if(!__builtin_cpu_supports("avx2"))
+    {
+        std::cout << "AVX2 not supported by this CPU, skipped" << std::endl;
+        return 0;
+    }
+#endif
+    test_bloom();
+    test_cuckoo();
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    if(n) benchmark(n);
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "pair.h"
+#include "list.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <memory>
+#include <type_traits>
+
+struct empty_hasher { size_t operator()(int x) const {return static_cast<size_t>(x);} };
+
+int main(int argc, char *argv[])
+{
+    // 平凡性
+    typedef mySTL::pair<int, double> pod_pair;
+    static_assert(std::is_trivially_copyable<pod_pair>::value, "pair of PODs is trivially copyable");
+    static_assert(std::is_trivially_destructible<pod_pair>::value, "trivially destructible");
+    static_assert(!std::is_trivially_copyable<mySTL::pair<int, std::string>>::value, "string pair is not");
+
+    // 构造
+    constexpr pod_pair cp(1, 2.5);
+    static_assert(cp.first == 1 && cp.second == 2.5, "constexpr pair");
+    pod_pair def;
+    assert(def.first == 0 && def.second == 0.0);
+
+    auto p = mySTL::make_pair("key", 42);
+    static_assert(std::is_same<decltype(p), mySTL::pair<const char*, int>>::value, "make_pair decays");
+    mySTL::pair<std::string, long> converted(p);
+    assert(converted.first == "key" && converted.second == 42);
+
+    mySTL::pair<std::unique_ptr<int>, int> moved(std::unique_ptr<int>(new int(7)), 1);
+    mySTL::pair<std::unique_ptr<int>, int> moved2(mySTL::move(moved));
+    assert(*moved2.first == 7 && !moved.first);
+
+    mySTL::pair<std::string, std::string> pw(mySTL::piecewise_construct,
+        std::forward_as_tuple(3, 'a'), std::forward_as_tuple("bc"));
+    assert(pw.first == "aaa" && pw.second == "bc");
+
+    assert(mySTL::make_pair(1, 2) < mySTL::make_pair(1, 3));
+    assert(mySTL::make_pair(2, 0) > mySTL::make_pair(1, 3));
+    mySTL::pair<int, int> a(1, 2), b(3, 4);
+    mySTL::swap(a, b);
+    assert(a.first == 3 && b.second == 2);
+
+    // compressed_pair: 空类不占空间
+    static_assert(sizeof(mySTL::compressed_pair<empty_hasher, size_t>) == sizeof(size_t), "EBO");
+    static_assert(sizeof(mySTL::compressed_pair<size_t, empty_hasher>) == sizeof(size_t), "EBO");
+    mySTL::compressed_pair<empty_hasher, size_t> cpair(empty_hasher(), 5);
+    assert(cpair.first()(3) == 3 && cpair.second() == 5);
+
+    // list中的allocator不占空间: 哨兵, size, slabs, spare, spare_size
+    static_assert(sizeof(mySTL::list<int>) == 3 * sizeof(void*) + 2 * sizeof(size_t), "list has no allocator overhead");
+
+    std::cout << "pair tests passed" << std::endl;
+    return 0;
+}
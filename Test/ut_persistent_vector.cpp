@@ -0,0 +1,371 @@
+#include "test_aux.h"
+#include "persistent_vector.h"
+#include "list.h"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mySTL;
+
+uint64_t rng = 88172645463325252ull;
+uint64_t next_rand()
+{
+    rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+    return rng;
+}
+
+struct counted
+{
+    static std::atomic<int> live;
+    static int countdown;   // 复制构造到0时抛异常
+    int v;
+    counted(int v = 0) : v(v) {++live;}
+    counted(const counted& o) : v(o.v)
+    {
+        if(countdown > 0 && --countdown == 0) throw 1;
+        ++live;
+    }
+    counted& operator=(const counted& o) {v = o.v; return *this;}
+    ~counted() {--live;}
+    bool operator==(const counted& o) const {return v == o.v;}
+};
+std::atomic<int> counted::live(0);
+int counted::countdown = 0;
+
+template <class Vec>
+bool same(const Vec& v, const std::vector<int>& model)
+{
+    if(v.size() != model.size()) return false;
+    size_t i = 0;
+    for(auto& x : v)
+        if(x.v != model[i++]) return false;
+    for(size_t j = 0; j < model.size(); j += 1 + model.size() / 50)
+        if(v[j].v != model[j]) return false;
+    return true;
+}
+
+void test_basic()
+{
+    persistent_vector<int> empty;
+    assert(empty.empty() && empty.begin() == empty.end());
+    persistent_vector<int> a = empty.push_back(1).push_back(2).push_back(3);
+    assert(empty.empty() && a.size() == 3 && a[0] == 1 && a.back() == 3);
+    persistent_vector<int> b = a.set(1, 20);
+    assert(a[1] == 2 && b[1] == 20 && b[2] == 3);
+    persistent_vector<int> c = b.pop_back();
+    assert(c.size() == 2 && b.size() == 3);
+    persistent_vector<int> d = {1, 2, 3};
+    assert(d == a && d != b);
+    persistent_vector<int> snap = a;
+    assert(snap.shares_with(a));
+    bool thrown = false;
+    try {a.at(3);} catch(const std::out_of_range&) {thrown = true;}
+    assert(thrown);
+
+    // 跨过尾部和每一层的边界, 每个版本都保留并检查
+    std::vector<persistent_vector<int>> versions;
+    persistent_vector<int> v;
+    const int n = 32 * 32 * 32 + 100;
+    for(int i = 0; i < n; i++)
+    {
+        v = v.push_back(i);
+        if(i % 97 == 0 || i == 31 || i == 32 || i == 1055 || i == 1056 || i == 32799 || i == 32800) versions.push_back(v);
+    }
+    for(auto& ver : versions)
+        for(size_t i = 0; i < ver.size(); i += 7) assert(ver[i] == static_cast<int>(i));
+    assert(v.size() == static_cast<size_t>(n) && v.back() == n - 1);
+
+    // 迭代器
+    auto it = v.begin() + 1000;
+    assert(*it == 1000 && it[50] == 1050 && v.end() - it == n - 1000);
+    auto last = v.end();
+    --last;
+    assert(*last == n - 1 && *(last - 40) == n - 41);
+    int expected = 0;
+    for(int x : v) assert(x == expected++);
+    assert(std::is_sorted(v.begin(), v.end()));
+
+    // 逐个删除直到为空, 经过树降低高度的情况
+    persistent_vector<int> p = v;
+    for(int i = n; i > 0; i--)
+    {
+        assert(p.size() == static_cast<size_t>(i) && p.back() == i - 1);
+        p = mySTL::move(p).pop_back();
+        if(i % 1000 == 0) assert(p[i / 2 - 1] == i / 2 - 1);
+    }
+    assert(p.empty() && v.size() == static_cast<size_t>(n));
+}
+
+// 随机修改, 和std::vector对照; 旧快照在之后的修改中保持不变
+void test_random()
+{
+    {
+        transient_vector<counted> t;
+        std::vector<int> model;
+        std::vector<std::pair<persistent_vector<counted>, std::vector<int>>> snaps;
+        for(int step = 0; step < 200000; step++)
+        {
+            int op = static_cast<int>(next_rand() % 10);
+            if(op < 5 || model.empty())
+            {
+                int x = static_cast<int>(next_rand() % 1000);
+                t.push_back(counted(x));
+                model.push_back(x);
+            }
+            else if(op < 8)
+            {
+                size_t i = next_rand() % model.size();
+                int x = static_cast<int>(next_rand() % 1000);
+                t.set(i, counted(x));
+                model[i] = x;
+            }
+            else
+            {
+                t.pop_back();
+                model.pop_back();
+            }
+            if(step % 4000 == 0)
+            {
+                snaps.emplace_back(t.snapshot(), model);
+                assert(same(t, model));
+            }
+        }
+        assert(same(t, model));
+        for(auto& s : snaps) assert(same(s.first, s.second));
+
+        // 不可变接口上的修改
+        persistent_vector<counted> p = t.persistent();
+        assert(t.empty() && same(p, model));
+        std::vector<int> m2 = model;
+        persistent_vector<counted> q = p;
+        for(int step = 0; step < 2000; step++)
+        {
+            size_t i = next_rand() % m2.size();
+            q = q.set(i, counted(step));
+            m2[i] = step;
+        }
+        assert(same(p, model) && same(q, m2));
+    }
+    assert(counted::live == 0);
+}
+
+// 复制被共享的尾部或路径时构造失败, 两个版本都不变
+void test_exception()
+{
+    {
+        transient_vector<counted> t;
+        for(int i = 0; i < 1000; i++) t.push_back(counted(i));
+        std::vector<int> model;
+        for(int i = 0; i < 1000; i++) model.push_back(i);
+        // 共享时的复制次数: 尾部8个 + 新元素1个, 第5个元素的路径上的叶子32个
+        for(int k = 1; k < 50; k += 2)
+        {
+            persistent_vector<counted> snap = t.snapshot();
+            counted::countdown = k;
+            bool thrown = false;
+            try
+            {
+                t.push_back(counted(-1));
+                t.pop_back();
+                t.set(5, counted(-2));
+                t.set(5, counted(5));
+            }
+            catch(int) {thrown = true;}
+            counted::countdown = 0;
+            assert(same(snap, model));
+            // 抛出之前完成的操作保留, 之后的没有发生
+            assert(t.size() == 1000 || t.size() == 1001);
+            if(t.size() == 1001) t.pop_back();
+            t.set(5, counted(5));
+            assert(same(t, model) && thrown == (k <= 41));
+        }
+    }
+    assert(counted::live == 0);
+}
+
+// 一个写线程修改并定期发布快照, 读线程拿快照遍历; 快照内容必须和发布时记录的和一致
+void test_threads()
+{
+    std::mutex m;
+    persistent_vector<int> published;
+    long long published_sum = 0;
+    std::atomic<bool> done(false);
+
+    auto reader = [&] {
+        size_t checks = 0;
+        while(!done.load() || checks < 10)
+        {
+            persistent_vector<int> snap;
+            long long expected;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                snap = published;
+                expected = published_sum;
+            }
+            long long sum = 0;
+            for(int x : snap) sum += x;
+            assert(sum == expected);
+            ++checks;
+        }
+    };
+
+    std::thread r1(reader), r2(reader);
+    transient_vector<int> t;
+    long long sum = 0;
+    for(int step = 0; step < 100000; step++)
+    {
+        if(t.size() < 5000 || next_rand() % 2)
+        {
+            int x = static_cast<int>(next_rand() % 100);
+            t.push_back(x);
+            sum += x;
+        }
+        else
+        {
+            size_t i = next_rand() % t.size();
+            int x = static_cast<int>(next_rand() % 100);
+            sum += x - t[i];
+            t.set(i, x);
+        }
+        if(step % 500 == 0)
+        {
+            persistent_vector<int> snap = t.snapshot();
+            std::lock_guard<std::mutex> lock(m);
+            published = mySTL::move(snap);
+            published_sum = sum;
+        }
+    }
+    done = true;
+    r1.join();
+    r2.join();
+}
+
+/*** benchmark ***/
+
+// 写入n个元素, 每k次写入给读者一个快照
+void benchmark_append(size_t n, size_t k)
+{
+    size_t snaps = 0, s1 = 0, s2 = 0, s3 = 0;
+    auto pv = [&] {
+        transient_vector<int> t;
+        persistent_vector<int> reader;
+        for(size_t i = 0; i < n; i++)
+        {
+            t.push_back(static_cast<int>(i));
+            if(i % k == 0) {reader = t.snapshot(); s1 += reader.size(); ++snaps;}
+        }
+    };
+    auto vec = [&] {
+        std::vector<int> v;
+        std::vector<int> reader;
+        for(size_t i = 0; i < n; i++)
+        {
+            v.push_back(static_cast<int>(i));
+            if(i % k == 0) {reader = v; s2 += reader.size();}
+        }
+    };
+    auto lst = [&] {
+        mySTL::list<int> l;
+        for(size_t i = 0; i < n; i++)
+        {
+            l.push_back(static_cast<int>(i));
+            if(i % k == 0) {mySTL::list<int> reader(l); s3 += reader.size();}
+        }
+    };
+    std::cout << "append " << n << ", snapshot every " << k << " writes" << std::endl;
+    std::cout << "  persistent_vector:     "; COUNT_FUN_PERF(pv, n); std::cout << std::endl;
+    std::cout << "  std::vector copy:      "; COUNT_FUN_PERF(vec, n); std::cout << std::endl;
+    // list的复制要逐个分配节点, 快照很频繁时太慢, 不参与
+    if(k >= 1000) {std::cout << "  mySTL::list copy:      "; COUNT_FUN_PERF(lst, n); std::cout << std::endl;}
+    else s3 = s2;
+    assert(s1 == s2 && s2 == s3);
+}
+
+// 对n个元素做随机更新, 每次更新后都保留一个快照 (最近16个)
+void benchmark_update(size_t n, size_t updates)
+{
+    std::vector<int> base(n);
+    for(size_t i = 0; i < n; i++) base[i] = static_cast<int>(i);
+    persistent_vector<int> start(base.begin(), base.end());
+    std::vector<size_t> idx(updates);
+    for(auto& i : idx) i = next_rand() % n;
+    long long s1 = 0, s2 = 0;
+
+    auto pv = [&] {
+        std::vector<persistent_vector<int>> ring(16);
+        persistent_vector<int> v = start;
+        for(size_t u = 0; u < updates; u++)
+        {
+            v = v.set(idx[u], static_cast<int>(u));
+            ring[u % 16] = v;
+        }
+        for(auto& r : ring) s1 += r[idx[0]];
+    };
+    auto vec = [&] {
+        std::vector<std::vector<int>> ring(16);
+        std::vector<int> v = base;
+        for(size_t u = 0; u < updates; u++)
+        {
+            v[idx[u]] = static_cast<int>(u);
+            ring[u % 16] = v;
+        }
+        for(auto& r : ring) s2 += r[idx[0]];
+    };
+    std::cout << updates << " random updates of " << n << " elements, snapshot after each" << std::endl;
+    std::cout << "  persistent_vector set: "; COUNT_FUN_PERF(pv, updates); std::cout << std::endl;
+    std::cout << "  std::vector copy:      "; COUNT_FUN_PERF(vec, updates); std::cout << std::endl;
+    assert(s1 == s2);
+}
+
+void benchmark_build_and_read(size_t n)
+{
+    long long s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+    persistent_vector<int> p1, p2;
+    transient_vector<int> t;
+    std::vector<int> v;
+    auto by_value = [&] {for(size_t i = 0; i < n; i++) p1 = p1.push_back(static_cast<int>(i));};
+    auto by_move  = [&] {for(size_t i = 0; i < n; i++) p2 = mySTL::move(p2).push_back(static_cast<int>(i));};
+    auto trans    = [&] {for(size_t i = 0; i < n; i++) t.push_back(static_cast<int>(i));};
+    auto stdvec   = [&] {for(size_t i = 0; i < n; i++) v.push_back(static_cast<int>(i));};
+    std::cout << "build " << n << " elements" << std::endl;
+    std::cout << "  push_back (copy):      "; COUNT_FUN_PERF(by_value, n); std::cout << std::endl;
+    std::cout << "  push_back (rvalue):    "; COUNT_FUN_PERF(by_move, n); std::cout << std::endl;
+    std::cout << "  transient push_back:   "; COUNT_FUN_PERF(trans, n); std::cout << std::endl;
+    std::cout << "  std::vector push_back: "; COUNT_FUN_PERF(stdvec, n); std::cout << std::endl;
+
+    persistent_vector<int> p = t.persistent();
+    auto iter_pv  = [&] {for(int x : p) s1 += x;};
+    auto iter_vec = [&] {for(int x : v) s2 += x;};
+    auto rand_pv  = [&] {for(size_t i = 0; i < n; i++) s3 += p[(i * 7919) % n];};
+    auto rand_vec = [&] {for(size_t i = 0; i < n; i++) s4 += v[(i * 7919) % n];};
+    std::cout << "read " << n << " elements" << std::endl;
+    std::cout << "  iterate persistent:    "; COUNT_FUN_PERF(iter_pv, n); std::cout << std::endl;
+    std::cout << "  iterate std::vector:   "; COUNT_FUN_PERF(iter_vec, n); std::cout << std::endl;
+    std::cout << "  random persistent:     "; COUNT_FUN_PERF(rand_pv, n); std::cout << std::endl;
+    std::cout << "  random std::vector:    "; COUNT_FUN_PERF(rand_vec, n); std::cout << std::endl;
+    assert(s1 == s2 && s3 == s4 && p1 == p && p2 == p);
+}
+
+int main(int argc, char *argv[])
+{
+    test_basic();
+    test_random();
+    test_exception();
+    test_threads();
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    if(n)
+    {
+        benchmark_append(n / 5, 1000);
+        benchmark_append(n / 5, 10);
+        benchmark_update(n, 20000);
+        benchmark_build_and_read(n);
+    }
+    return 0;
+}
@@ -0,0 +1,415 @@
+#include "test_aux.h"
+#include "radix_tree.h"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace mySTL;
+
+uint64_t rng = 88172645463325252ull;
+uint64_t next_rand()
+{
+    rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+    return rng;
+}
+
+struct counted
+{
+    static int live;
+    int v;
+    counted(int v = 0) : v(v) {++live;}
+    counted(const counted& o) : v(o.v) {++live;}
+    counted& operator=(const counted& o) {v = o.v; return *this;}
+    ~counted() {--live;}
+};
+int counted::live = 0;
+
+template <class Tree, class Map>
+void check_equal(const Tree& t, const Map& m)
+{
+    assert(t.size() == m.size());
+    auto it = t.begin();
+    for(auto& kv : m)
+    {
+        assert(it != t.end() && it->first == kv.first && it->second.v == kv.second);
+        ++it;
+    }
+    assert(it == t.end());
+    // 反向遍历
+    auto rit = m.rbegin();
+    for(auto jt = t.end(); jt != t.begin();)
+    {
+        --jt;
+        assert(jt->first == rit->first);
+        ++rit;
+    }
+}
+
+void test_basic()
+{
+    radix_tree<std::string, int> t;
+    assert(t.empty() && t.begin() == t.end() && t.find("a") == t.end());
+    assert(t.try_emplace("romane", 1).second);
+    assert(t.try_emplace("romanus", 2).second);
+    assert(t.try_emplace("romulus", 3).second);
+    assert(t.try_emplace("rubens", 4).second);
+    assert(t.try_emplace("ruber", 5).second);
+    assert(t.try_emplace("rubicon", 6).second);
+    assert(t.try_emplace("rubicundus", 7).second);
+    assert(!t.try_emplace("ruber", 50).second && t.at("ruber") == 5);
+    // 一个key是另一个的前缀, 空串
+    assert(t.try_emplace("rom", 8).second);
+    assert(t.try_emplace("", 9).second);
+    assert(t.try_emplace("r", 10).second);
+    assert(t.size() == 10);
+    t["rubens"] = 40;
+    t.insert_or_assign("romulus", 30);
+    assert(t.at("rubens") == 40 && t["romulus"] == 30 && t.count("roma") == 0);
+
+    std::string order;
+    for(auto& kv : t) order += kv.first + ",";
+    assert(order == ",r,rom,romane,romanus,romulus,rubens,ruber,rubicon,rubicundus,");
+
+    assert(t.lower_bound("rom")->first == "rom");
+    assert(t.lower_bound("roma")->first == "romane");
+    assert(t.upper_bound("rom")->first == "romane");
+    assert(t.lower_bound("rubicz") == t.end());
+    assert(t.lower_bound("ra")->first == "rom");
+
+    auto r = t.prefix_range("rub");
+    int n = 0;
+    for(auto it = r.first; it != r.second; ++it) ++n;
+    assert(n == 4 && r.first->first == "rubens");
+    r = t.prefix_range("roman");
+    assert(r.first->first == "romane" && r.second->first == "romulus");
+    r = t.prefix_range("x");
+    assert(r.first == r.second);
+    r = t.prefix_range("");
+    assert(r.first == t.begin() && r.second == t.end());
+
+    assert(t.erase("rom") == 1 && t.erase("rom") == 0 && t.erase("ro") == 0);
+    assert(t.erase("") == 1 && t.erase("r") == 1);
+    assert(t.find("romane")->second == 1 && t.size() == 7);
+    auto it = t.erase(t.find("romanus"));
+    assert(it->first == "romulus");
+
+    bool thrown = false;
+    try {t.at("nope");} catch(const std::out_of_range&) {thrown = true;}
+    assert(thrown);
+
+    // 拷贝和移动
+    radix_tree<std::string, int> c(t);
+    assert(c.size() == t.size() && c.at("rubicon") == 6);
+    radix_tree<std::string, int> m(mySTL::move(c));
+    assert(c.empty() && c.begin() == c.end() && m.size() == t.size());
+    c = m;
+    assert(c.size() == m.size() && (--c.end())->first == "rubicundus");
+    t.clear();
+    assert(t.empty() && t.begin() == t.end());
+}
+
+// 长于节点中存储的前缀, 需要从叶子恢复
+void test_long_prefix()
+{
+    radix_tree<std::string, counted> t;
+    std::map<std::string, int> m;
+    std::string base(40, 'p');
+    std::vector<std::string> keys;
+    for(int i = 0; i < 300; i++)
+    {
+        std::string k = base;
+        k[5 + (i % 30)] = static_cast<char>('a' + i % 7);
+        k += std::to_string(i % 50);
+        if(i % 11 == 0) k.resize(10 + i % 25);
+        keys.push_back(k);
+    }
+    for(size_t i = 0; i < keys.size(); i++)
+    {
+        bool a = t.try_emplace(keys[i], static_cast<int>(i)).second;
+        bool b = m.emplace(keys[i], static_cast<int>(i)).second;
+        assert(a == b);
+    }
+    check_equal(t, m);
+    for(auto& k : keys)
+    {
+        auto lb = t.lower_bound(k.substr(0, 20) + "q");
+        auto mb = m.lower_bound(k.substr(0, 20) + "q");
+        assert((lb == t.end()) == (mb == m.end()) && (lb == t.end() || lb->first == mb->first));
+    }
+    for(size_t i = 0; i < keys.size(); i += 2)
+    {
+        assert(t.erase(keys[i]) == m.erase(keys[i]));
+        check_equal(t, m);
+    }
+}
+
+// 随机操作, 和std::map对照; 字节取值范围大时会经过所有节点类型
+template <class Key, class MakeKey>
+void test_random(MakeKey make, int ops)
+{
+    {
+        radix_tree<Key, counted> t;
+        std::map<Key, int> m;
+        for(int i = 0; i < ops; i++)
+        {
+            Key k = make();
+            int op = static_cast<int>(next_rand() % 10);
+            if(op < 6)
+            {
+                bool a = t.try_emplace(k, i).second;
+                bool b = m.emplace(k, i).second;
+                assert(a == b);
+            }
+            else if(op < 9) assert(t.erase(k) == m.erase(k));
+            else
+            {
+                auto lb = t.lower_bound(k);
+                auto mb = m.lower_bound(k);
+                assert((lb == t.end()) == (mb == m.end()) && (lb == t.end() || lb->first == mb->first));
+                auto ub = t.upper_bound(k);
+                auto nb = m.upper_bound(k);
+                assert((ub == t.end()) == (nb == m.end()) && (ub == t.end() || ub->first == nb->first));
+            }
+            if(i % 997 == 0) check_equal(t, m);
+        }
+        check_equal(t, m);
+        assert(counted::live == static_cast<int>(m.size()));
+
+        // 全部删除, 节点逐级缩小和合并
+        std::vector<Key> keys;
+        for(auto& kv : m) keys.push_back(kv.first);
+        std::reverse(keys.begin(), keys.end());
+        for(size_t i = 0; i < keys.size(); i++)
+        {
+            assert(t.erase(keys[i]) == 1 && m.erase(keys[i]) == 1);
+            if(i % 101 == 0) check_equal(t, m);
+        }
+        assert(t.empty() && t.stats().node4 == 0 && t.stats().node256 == 0 && t.stats().leaves == 0);
+    }
+    assert(counted::live == 0);
+}
+
+void test_node_types()
+{
+    radix_tree<uint32_t, int> t;
+    for(uint32_t i = 0; i < 256; i++) t.try_emplace(i, static_cast<int>(i));
+    radix_tree_stats s = t.stats();
+    assert(s.node256 == 1 && s.leaves == 256);
+    // 缩小的阈值低于增长的边界
+    uint32_t next = 0;
+    while(t.size() > 37) t.erase(next++);
+    assert(t.stats().node256 == 1);
+    t.erase(next++);
+    assert(t.stats().node256 == 0 && t.stats().node48 == 1);
+    while(t.size() > 12) t.erase(next++);
+    assert(t.stats().node48 == 0 && t.stats().node16 == 1);
+    while(t.size() > 3) t.erase(next++);
+    assert(t.stats().node16 == 0 && t.stats().node4 == 1);
+    while(t.size() > 1) t.erase(next++);
+    assert(t.stats().node4 == 0 && t.begin()->first == 255 && t.find(255)->second == 255);
+    // 再长回去
+    for(uint32_t i = 0; i < 255; i++) t.try_emplace(i << 8, 0);
+    assert(t.stats().node256 == 1 && t.size() == 256);
+
+    // 有符号整数按数值排序
+    radix_tree<int64_t, int> s64;
+    for(int64_t v : std::vector<int64_t>{5, -3, 0, -1000000000000LL, 42, INT64_MAX, INT64_MIN}) s64.try_emplace(v, 0);
+    std::vector<int64_t> got;
+    for(auto& kv : s64) got.push_back(kv.first);
+    assert(std::is_sorted(got.begin(), got.end()) && got.size() == 7);
+    assert(s64.lower_bound(1)->first == 5);
+}
+
+/*** benchmark ***/
+
+size_t counted_bytes = 0;
+
+// 统计std容器节点和桶的内存
+template <class T>
+struct counting_allocator
+{
+    typedef T value_type;
+    counting_allocator() = default;
+    template <class U> counting_allocator(const counting_allocator<U>&) {}
+    T* allocate(size_t n) {counted_bytes += n * sizeof(T); return static_cast<T*>(::operator new(n * sizeof(T)));}
+    void deallocate(T* p, size_t n) {counted_bytes -= n * sizeof(T); ::operator delete(p);}
+    template <class U> bool operator==(const counting_allocator<U>&) const {return true;}
+    template <class U> bool operator!=(const counting_allocator<U>&) const {return false;}
+};
+
+// 合成的真实形态key: URL (少量热门域名 + 层级路径), 文件路径, 带固定前缀的ID
+std::vector<std::string> make_urls(size_t n)
+{
+    static const char* words[] = {"news", "sport", "article", "video", "user", "profile", "search", "images",
+                                  "2024", "2025", "world", "tech", "blog", "post", "static", "api"};
+    std::vector<std::string> domains;
+    for(int i = 0; i < 200; i++) domains.push_back("https://www." + std::string(words[i % 16]) + std::to_string(i) + ".com/");
+    std::vector<std::string> keys(n);
+    for(auto& k : keys)
+    {
+        // 近似Zipf: 热门域名占大多数
+        uint64_t r = next_rand();
+        size_t d = static_cast<size_t>((r % 1000) * (r % 1000) / 5000);
+        k = domains[d];
+        int depth = 1 + static_cast<int>(next_rand() % 3);
+        for(int j = 0; j < depth; j++) {k += words[next_rand() % 16]; k += '/';}
+        k += std::to_string(next_rand() % 10000000);
+    }
+    return keys;
+}
+
+std::vector<std::string> make_paths(size_t n)
+{
+    static const char* dirs[] = {"/usr/lib/", "/usr/share/doc/", "/usr/include/", "/home/alice/projects/", "/var/log/",
+                                 "/opt/app/releases/", "/etc/"};
+    std::vector<std::string> keys(n);
+    for(auto& k : keys)
+    {
+        k = dirs[next_rand() % 7];
+        k += "pkg" + std::to_string(next_rand() % 500) + "/";
+        if(next_rand() % 2) k += "src/module" + std::to_string(next_rand() % 40) + "/";
+        k += "file" + std::to_string(next_rand() % 100000) + (next_rand() % 3 ? ".h" : ".cpp");
+    }
+    return keys;
+}
+
+std::vector<std::string> make_ids(size_t n)
+{
+    std::vector<std::string> keys(n);
+    char buf[32];
+    for(auto& k : keys)
+    {
+        std::snprintf(buf, sizeof(buf), "user:%012llu", static_cast<unsigned long long>(next_rand() % 1000000000000ull));
+        k = buf;
+    }
+    return keys;
+}
+
+void benchmark_keys(const char* name, std::vector<std::string> keys)
+{
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    for(size_t i = keys.size(); i > 1; i--) std::swap(keys[i - 1], keys[next_rand() % i]);
+    std::vector<std::string> lookups(keys.size());
+    for(auto& k : lookups) k = keys[next_rand() % keys.size()];
+    size_t n = keys.size();
+    size_t key_bytes = 0;
+    for(auto& k : keys) key_bytes += k.size();
+
+    typedef std::unordered_map<std::string, int, std::hash<std::string>, std::equal_to<std::string>,
+                               counting_allocator<std::pair<const std::string, int>>> hash_map;
+    typedef std::map<std::string, int, std::less<std::string>, counting_allocator<std::pair<const std::string, int>>> tree_map;
+    radix_tree<std::string, int> art;
+    hash_map hm;
+    tree_map tm;
+    size_t s1 = 0, s2 = 0, s3 = 0, p1 = 0, p2 = 0;
+
+    auto art_insert = [&] {for(size_t i = 0; i < n; i++) art.try_emplace(keys[i], static_cast<int>(i));};
+    auto hm_insert  = [&] {for(size_t i = 0; i < n; i++) hm.emplace(keys[i], static_cast<int>(i));};
+    auto tm_insert  = [&] {for(size_t i = 0; i < n; i++) tm.emplace(keys[i], static_cast<int>(i));};
+    auto art_find = [&] {for(auto& k : lookups) s1 += art.find(k)->second;};
+    auto hm_find  = [&] {for(auto& k : lookups) s2 += hm.find(k)->second;};
+    auto tm_find  = [&] {for(auto& k : lookups) s3 += tm.find(k)->second;};
+    // 前缀扫描: 去掉key的最后3个字节作为前缀, 数有多少个key
+    size_t scans = n / 10 + 1;
+    auto art_prefix = [&] {
+        for(size_t i = 0; i < scans; i++)
+        {
+            std::string prefix = lookups[i].substr(0, lookups[i].size() - 3);
+            auto r = art.prefix_range(prefix);
+            for(auto it = r.first; it != r.second; ++it) ++p1;
+        }
+    };
+    auto tm_prefix = [&] {
+        for(size_t i = 0; i < scans; i++)
+        {
+            std::string prefix = lookups[i].substr(0, lookups[i].size() - 3);
+            for(auto it = tm.lower_bound(prefix); it != tm.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) ++p2;
+        }
+    };
+
+    std::cout << name << ": " << n << " keys, average length " << double(key_bytes) / n << std::endl;
+    std::cout << "  insert radix_tree:    "; COUNT_FUN_PERF(art_insert, n); std::cout << std::endl;
+    counted_bytes = 0;
+    std::cout << "  insert unordered_map: "; COUNT_FUN_PERF(hm_insert, n); std::cout << std::endl;
+    size_t hm_bytes = counted_bytes;
+    counted_bytes = 0;
+    std::cout << "  insert std::map:      "; COUNT_FUN_PERF(tm_insert, n); std::cout << std::endl;
+    size_t tm_bytes = counted_bytes;
+    std::cout << "  find radix_tree:      "; COUNT_FUN_PERF(art_find, n); std::cout << std::endl;
+    std::cout << "  find unordered_map:   "; COUNT_FUN_PERF(hm_find, n); std::cout << std::endl;
+    std::cout << "  find std::map:        "; COUNT_FUN_PERF(tm_find, n); std::cout << std::endl;
+    std::cout << "  prefix radix_tree:    "; {COUNT_FUN_TIME(art_prefix);} std::cout << std::endl;
+    std::cout << "  prefix std::map:      "; {COUNT_FUN_TIME(tm_prefix);} std::cout << std::endl;
+    assert(s1 == s2 && s2 == s3 && p1 == p2);
+
+    // 每个key的容器内存, 三者都不包括std::string自己在堆上的字符
+    radix_tree_stats st = art.stats();
+    size_t inner = st.node4 * sizeof(__art_node_4) + st.node16 * sizeof(__art_node_16)
+                 + st.node48 * sizeof(__art_node_48) + st.node256 * sizeof(__art_node_256);
+    std::cout << "  memory per key: radix_tree " << double(st.bytes) / n << " B (inner nodes " << double(inner) / n
+              << " B; node4/16/48/256 = " << st.node4 << "/" << st.node16 << "/" << st.node48 << "/" << st.node256
+              << "), unordered_map " << double(hm_bytes) / n << " B, std::map " << double(tm_bytes) / n << " B" << std::endl;
+}
+
+void benchmark_ints(size_t n)
+{
+    std::vector<uint64_t> keys(n);
+    for(auto& k : keys) k = next_rand() >> 20;
+    radix_tree<uint64_t, int> art;
+    std::unordered_map<uint64_t, int> hm;
+    std::map<uint64_t, int> tm;
+    size_t s1 = 0, s2 = 0, s3 = 0;
+    auto art_insert = [&] {for(size_t i = 0; i < n; i++) art.try_emplace(keys[i], static_cast<int>(i));};
+    auto hm_insert  = [&] {for(size_t i = 0; i < n; i++) hm.emplace(keys[i], static_cast<int>(i));};
+    auto tm_insert  = [&] {for(size_t i = 0; i < n; i++) tm.emplace(keys[i], static_cast<int>(i));};
+    auto art_find = [&] {for(size_t i = 0; i < n; i++) s1 += art.find(keys[(i * 7919) % n])->second;};
+    auto hm_find  = [&] {for(size_t i = 0; i < n; i++) s2 += hm.find(keys[(i * 7919) % n])->second;};
+    auto tm_find  = [&] {for(size_t i = 0; i < n; i++) s3 += tm.find(keys[(i * 7919) % n])->second;};
+    std::cout << "uint64 keys: " << n << std::endl;
+    std::cout << "  insert radix_tree:    "; COUNT_FUN_PERF(art_insert, n); std::cout << std::endl;
+    std::cout << "  insert unordered_map: "; COUNT_FUN_PERF(hm_insert, n); std::cout << std::endl;
+    std::cout << "  insert std::map:      "; COUNT_FUN_PERF(tm_insert, n); std::cout << std::endl;
+    std::cout << "  find radix_tree:      "; COUNT_FUN_PERF(art_find, n); std::cout << std::endl;
+    std::cout << "  find unordered_map:   "; COUNT_FUN_PERF(hm_find, n); std::cout << std::endl;
+    std::cout << "  find std::map:        "; COUNT_FUN_PERF(tm_find, n); std::cout << std::endl;
+    assert(s1 == s2 && s2 == s3);
+}
+
+int main(int argc, char *argv[])
+{
+    test_basic();
+    test_long_prefix();
+    test_node_types();
+    // 短字母表: 长公共前缀, 大量Node4; 全字节范围: 大节点
+    test_random<std::string>([] {
+        std::string k = "key/";
+        size_t len = next_rand() % 6;
+        for(size_t i = 0; i < len; i++) k += static_cast<char>('a' + next_rand() % 3);
+        return k;
+    }, 30000);
+    test_random<std::string>([] {
+        std::string k;
+        size_t len = next_rand() % 4;
+        for(size_t i = 0; i < len; i++) k += static_cast<char>(next_rand() % 256);
+        return k;
+    }, 100000);
+    test_random<int32_t>([] {return static_cast<int32_t>(next_rand() % 20000) - 10000;}, 100000);
+
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    if(n)
+    {
+        benchmark_keys("urls", make_urls(n));
+        benchmark_keys("paths", make_paths(n));
+        benchmark_keys("ids", make_ids(n));
+        benchmark_ints(n);
+    }
+    return 0;
+}
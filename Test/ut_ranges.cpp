@@ -0,0 +1,186 @@
+#include "test_aux.h"
+#include "ranges.h"
+#include "list.h"
+#include "static_vector.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// 统计全局operator new的调用次数, 视图组合和遍历不应该分配内存
+static size_t g_allocs = 0;
+
+void* operator new(size_t n)
+{
+    ++g_allocs;
+    if(void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, size_t) noexcept {std::free(p);}
+
+using namespace mySTL;
+
+void test_views()
+{
+    list<int> lst{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::vector<int> vec{10, 20, 30, 40, 50};
+
+    // filter | transform | take
+    auto v = lst | views::filter([](int x) {return x % 2 == 0;})
+                 | views::transform([](int x) {return x * x;})
+                 | views::take(3);
+    std::vector<int> out;
+    for(int x : v) out.push_back(x);
+    assert((out == std::vector<int>{4, 16, 36}));
+
+    // filter是双向的
+    auto evens = views::filter(lst, [](int x) {return x % 2 == 0;});
+    static_assert(std::is_same<decltype(evens.begin())::iterator_category, bidirectional_iterator_tag>::value, "");
+    auto last = evens.end();
+    assert(*--last == 10 && *--last == 8);
+
+    // 修改底层元素
+    for(int& x : lst | views::drop(8)) x = -x;
+    assert(lst.back() == -10);
+
+    // 随机访问视图, distance/advance为O(1)
+    auto t = vec | views::transform([](int x) {return x + 1;}) | views::drop(1) | views::take(10);
+    static_assert(std::is_same<decltype(t.begin())::iterator_category, random_access_iterator_tag>::value, "");
+    assert(t.size() == 4);
+    assert(mySTL::distance(t.begin(), t.end()) == 4);
+    auto it = t.begin();
+    mySTL::advance(it, 2);
+    assert(*it == 41 && it[1] == 51 && t.end() - it == 2 && it < t.end());
+
+    // list上的take只能是单向, 长度不足n时在底层结尾停止
+    auto lt = lst | views::take(100);
+    static_assert(std::is_same<decltype(lt.begin())::iterator_category, forward_iterator_tag>::value, "");
+    assert(mySTL::distance(lt.begin(), lt.end()) == 10);
+
+    // zip取较短的长度
+    int n = 0;
+    for(auto p : views::zip(lst, vec))
+    {
+        assert(p.second == vec[n]);
+        p.second += 1;  // 引用
+        ++n;
+    }
+    assert(n == 5 && vec[0] == 11);
+    auto z = views::zip(vec, vec | views::transform([](int x) {return x * 2;}));
+    assert(z.size() == 5 && (*(z.begin() + 4)).second == 102);
+
+    // enumerate
+    size_t expect = 0;
+    for(auto p : lst | views::enumerate())
+    {
+        assert(p.first == expect++);
+        (void)p;
+    }
+    assert(expect == 10);
+    auto e = vec | views::enumerate();
+    assert(e.size() == 5 && (*(e.end() - 1)).first == 4);
+
+    // closure先组合
+    auto pipeline = views::filter([](int x) {return x > 0;}) | views::transform([](int x) {return x * 10;});
+    int sum = 0;
+    for(int x : lst | pipeline) sum += x;
+    assert(sum == 360);
+
+    // 右值容器
+    int total = 0;
+    for(int x : list<int>{1, 2, 3} | views::transform([](int x) {return x * 2;})) total += x;
+    assert(total == 12);
+
+    // 拷贝右值容器上的视图时不带走begin()的缓存, 缓存的迭代器属于原来的容器
+    auto odd = list<int>{1, 2, 3, 4, 5} | views::filter([](int x) {return x % 2 == 1;});
+    assert(*odd.begin() == 1);
+    auto odd_copy = odd;
+    assert(*odd_copy.begin() == 1 && &*odd_copy.begin() != &*odd.begin());
+    auto dropped = list<int>{1, 2, 3, 4, 5} | views::drop(2);
+    assert(*dropped.begin() == 3);
+    auto dropped_copy = dropped;
+    assert(*dropped_copy.begin() == 3 && &*dropped_copy.begin() != &*dropped.begin());
+    auto other = list<int>{7, 8, 9, 10} | views::drop(3);
+    assert(*other.begin() == 10);
+    other = dropped;
+    assert(*other.begin() == 3 && &*other.begin() != &*dropped.begin());
+
+    // 静态容器
+    static_vector<int, 4> sv{1, 2, 3, 4};
+    assert((sv | views::drop(1) | views::take(2)).size() == 2);
+}
+
+// 手写循环
+long long hand_written(const list<int>& lst, ptrdiff_t limit)
+{
+    long long sum = 0;
+    ptrdiff_t n = 0;
+    for(auto it = lst.begin(); it != lst.end() && n < limit; ++it)
+    {
+        if(*it % 3 != 0) continue;
+        sum += static_cast<long long>(*it) * *it;
+        ++n;
+    }
+    return sum;
+}
+
+long long with_views(const list<int>& lst, ptrdiff_t limit)
+{
+    long long sum = 0;
+    for(long long x : lst | views::filter([](int x) {return x % 3 == 0;})
+                          | views::transform([](int x) {return static_cast<long long>(x) * x;})
+                          | views::take(limit))
+        sum += x;
+    return sum;
+}
+
+// 对照: 每一步都生成中间容器
+long long materialized(const list<int>& lst, ptrdiff_t limit)
+{
+    list<int> filtered;
+    for(int x : lst) if(x % 3 == 0) filtered.push_back(x);
+    list<long long> squared;
+    for(int x : filtered) squared.push_back(static_cast<long long>(x) * x);
+    long long sum = 0;
+    ptrdiff_t n = 0;
+    for(auto it = squared.begin(); it != squared.end() && n < limit; ++it, ++n) sum += *it;
+    return sum;
+}
+
+void benchmark(size_t n)
+{
+    list<int> lst;
+    for(size_t i = 0; i < n; i++) lst.push_back(static_cast<int>(i % 1000));
+    ptrdiff_t limit = static_cast<ptrdiff_t>(n / 4);
+    long long r1 = 0, r2 = 0, r3 = 0;
+    std::cout << "elements: " << n << std::endl;
+
+    size_t before = g_allocs;
+    auto f1 = [&]() {r1 = hand_written(lst, limit);};
+    std::cout << "hand-written loop: ";
+    COUNT_FUN_PERF(f1, n);
+    std::cout << " allocs: " << g_allocs - before << std::endl;
+
+    before = g_allocs;
+    auto f2 = [&]() {r2 = with_views(lst, limit);};
+    std::cout << "lazy views:        ";
+    COUNT_FUN_PERF(f2, n);
+    std::cout << " allocs: " << g_allocs - before << std::endl;
+    assert(g_allocs == before);
+
+    before = g_allocs;
+    auto f3 = [&]() {r3 = materialized(lst, limit);};
+    std::cout << "materialized:      ";
+    COUNT_FUN_PERF(f3, n);
+    std::cout << " allocs: " << g_allocs - before << std::endl;
+    assert(r1 == r2 && r2 == r3);
+}
+
+int main(int argc, char *argv[])
+{
+    test_views();
+    benchmark(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000);
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "test_aux.h"
+#include "serialization.h"
+#include "basic_string.h"
+#include "static_vector.h"
+#include "list.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+struct record
+{
+    uint64_t id;
+    double   value;
+};
+
+struct alignas(32) wide
+{
+    float v[8];
+};
+
+// 流结束时补齐块尾不会再扩容 (块头和已写入的数据不会因此失效)
+void test_stream_finish()
+{
+    for(size_t n = 0; n < 600; n++)
+    {
+        mySTL::binary_writer w;
+        w.reserve(301);                 // 容量不是8的倍数, 数据恰好写满时块尾还需要填充
+        {
+            auto s = w.stream<char>();
+            for(size_t i = 0; i < n; i++) s.push(static_cast<char>(i));
+            const void* before = w.data();
+            s.finish();
+            assert(w.data() == before && w.size() % 8 == 0);
+        }
+        w.write(uint32_t(n));
+        mySTL::binary_reader r(w);
+        mySTL::serial_view<char> v = r.read_view<char>();
+        assert(v.size() == n && (n == 0 || v[n - 1] == static_cast<char>(n - 1)));
+        assert(r.read_value<uint32_t>() == n && r.at_end());
+    }
+}
+
+void test_round_trip()
+{
+    mySTL::binary_writer w;
+    std::vector<record> recs;
+    for(uint64_t i = 0; i < 100; i++) recs.push_back({i, i * 0.5});
+    mySTL::string name("a string that is too long for the small buffer");
+    mySTL::static_vector<int, 8> sv{1, 2, 3};
+    mySTL::list<int> lst{5, 6, 7, 8};
+    mySTL::pair<mySTL::string, std::vector<double>> pr(mySTL::string("key"), std::vector<double>{1.5, 2.5});
+    wide wd[2] = {};
+    wd[1].v[7] = 3.0f;
+
+    w.write(recs);
+    w.write(name);
+    w.write(sv);
+    w.write_range(lst.begin(), lst.end());
+    w.write(pr);
+    w.write(uint16_t(7));             // 单个值后面跟需要32字节对齐的块
+    w.write_array(wd, 2);
+    {
+        auto s = w.stream<int>();      // 空的流
+    }
+    w.write(mySTL::make_pair(1, 2.0));
+
+    mySTL::binary_reader r(w);
+    mySTL::serial_view<record> rv = r.read_view<record>();
+    assert(rv.size() == 100 && rv[99].id == 99 && rv[99].value == 49.5);
+    assert(static_cast<const void*>(rv.data()) > w.data()); // 指向writer缓冲区内部
+    mySTL::serial_view<char> nv = r.read_view<char>();
+    assert(mySTL::string(nv.data(), nv.size()) == name);
+    mySTL::static_vector<int, 8> sv2;
+    r.read_into(sv2);
+    assert(sv2.size() == 3 && sv2[2] == 3);
+    mySTL::list<int> lst2;
+    r.read_into(lst2);
+    assert(lst2.size() == 4 && lst2.front() == 5 && lst2.back() == 8);
+    mySTL::pair<mySTL::string, std::vector<double>> pr2;
+    r.read_into(pr2);
+    assert(pr2.first == "key" && pr2.second.size() == 2 && pr2.second[1] == 2.5);
+    assert(r.read_value<uint16_t>() == 7);
+    mySTL::serial_view<wide> wv = r.read_view<wide>();
+    assert(reinterpret_cast<uintptr_t>(wv.data()) % 32 == 0 && wv[1].v[7] == 3.0f);
+    assert(r.read_view<int>().empty());
+    mySTL::pair<int, double> p2;
+    r.read_into(p2);
+    assert(p2.first == 1 && p2.second == 2.0);
+    assert(r.at_end());
+
+    // 类型不匹配, 越界
+    mySTL::binary_reader r2(w);
+    bool thrown = false;
+    try {r2.read_view<uint32_t>();} catch(const std::runtime_error&) {thrown = true;}
+    assert(thrown);
+    thrown = false;
+    try {mySTL::binary_reader r3(w.data(), 64); r3.read_view<record>();} catch(const std::runtime_error&) {thrown = true;}
+    assert(thrown);
+    thrown = false;
+    try {mySTL::binary_reader r4(recs.data(), 64);} catch(const std::runtime_error&) {thrown = true;}
+    assert(thrown);
+}
+
+// 写到文件后mmap读取, 不拷贝
+void test_file()
+{
+    char path[] = "/tmp/mystl_serial_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    {
+        mySTL::binary_writer w;
+        std::vector<uint64_t> v(1000);
+        for(size_t i = 0; i < v.size(); i++) v[i] = i * i;
+        w.write(v);
+        w.save(path);
+    }
+    mySTL::mmap_resource res(path, mySTL::mmap_resource::read_only);
+    mySTL::binary_reader r(res);
+    mySTL::serial_view<uint64_t> v = r.read_view<uint64_t>();
+    assert(v.size() == 1000 && v[999] == 999 * 999);
+    std::remove(path);
+}
+
+double gbps(size_t bytes, std::chrono::steady_clock::time_point t1, std::chrono::steady_clock::time_point t2)
+{
+    double s = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
+    return s > 0 ? bytes / s / 1e9 : 0;
+}
+
+// 吞吐: 连续容器整块写入/视图/拷贝读取, 对比list逐元素流式写入/读取
+void benchmark(size_t n)
+{
+    std::vector<uint64_t> v(n);
+    for(size_t i = 0; i < n; i++) v[i] = i;
+    size_t bytes = n * sizeof(uint64_t);
+    std::cout << "elements: " << n << " (" << (bytes >> 20) << " MB)" << std::endl;
+
+    mySTL::binary_writer w;
+    w.reserve(bytes + 4096);
+    auto t1 = std::chrono::steady_clock::now();
+    w.write(v);
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << "contiguous serialize:     " << gbps(bytes, t1, t2) << " GB/s" << std::endl;
+
+    t1 = std::chrono::steady_clock::now();
+    mySTL::binary_reader r(w);
+    mySTL::serial_view<uint64_t> view = r.read_view<uint64_t>();
+    t2 = std::chrono::steady_clock::now();
+    std::cout << "zero-copy view:           " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()
+              << " ns (size " << view.size() << ")" << std::endl;
+
+    std::vector<uint64_t> v2;
+    t1 = std::chrono::steady_clock::now();
+    mySTL::binary_reader(w).read_into(v2);
+    t2 = std::chrono::steady_clock::now();
+    assert(v2 == v);
+    std::cout << "contiguous deserialize:   " << gbps(bytes, t1, t2) << " GB/s" << std::endl;
+
+    mySTL::list<uint64_t> lst(v.begin(), v.end());
+    mySTL::binary_writer lw;
+    lw.reserve(bytes + 4096);
+    t1 = std::chrono::steady_clock::now();
+    lw.write_range(lst.begin(), lst.end());
+    t2 = std::chrono::steady_clock::now();
+    std::cout << "list stream serialize:    " << gbps(bytes, t1, t2) << " GB/s" << std::endl;
+
+    mySTL::list<uint64_t> lst2;
+    t1 = std::chrono::steady_clock::now();
+    mySTL::binary_reader(lw).read_into(lst2);
+    t2 = std::chrono::steady_clock::now();
+    assert(lst2.size() == n && lst2.back() == n - 1);
+    std::cout << "list deserialize:         " << gbps(bytes, t1, t2) << " GB/s" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    test_round_trip();
+    test_stream_finish();
+    test_file();
+    benchmark(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (size_t(1) << 22));
+    return 0;
+}
@@ -0,0 +1,289 @@
+#include "test_aux.h"
+#include "concurrent_skip_list.h"
+#include "epoch.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mySTL;
+
+std::atomic<int> freed(0);
+
+// 有状态的比较器
+struct seeded_less
+{
+    uint64_t seed;
+    bool operator()(int a, int b) const {return a < b;}
+};
+
+// 无状态的Compare不占空间 (EBO), 有状态的只增加自身大小
+static_assert(sizeof(concurrent_skip_list<int, int>) == 2 * sizeof(void*) + sizeof(std::atomic<size_t>), "EBO");
+static_assert(sizeof(concurrent_skip_list<int, int, seeded_less>) ==
+              sizeof(concurrent_skip_list<int, int>) + sizeof(seeded_less), "EBO");
+
+void count_free(void* p)
+{
+    delete static_cast<int*>(p);
+    ++freed;
+}
+
+void test_epoch()
+{
+    epoch_domain d;
+    {
+        epoch_guard g(d);
+        epoch_guard nested(g);
+        d.retire(new int(1), &count_free);
+        // 本线程仍在guard中, epoch最多前进一步, 对象不会被释放
+        for(int i = 0; i < 10; i++) d.collect();
+        assert(freed == 0 && d.pending() == 1);
+    }
+    for(int i = 0; i < 3; i++) d.collect();
+    assert(freed == 1 && d.pending() == 0);
+
+    // 另一个线程持有guard时同样不能释放
+    std::atomic<int> stage(0);
+    std::thread other([&] {
+        epoch_guard g(d);
+        stage = 1;
+        while(stage != 2) std::this_thread::yield();
+    });
+    while(stage != 1) std::this_thread::yield();
+    d.retire(new int(2), &count_free);
+    for(int i = 0; i < 10; i++) d.collect();
+    assert(freed == 1);
+    stage = 2;
+    other.join();
+    for(int i = 0; i < 3; i++) d.collect();
+    assert(freed == 2);
+
+    // 超过阈值时自动回收
+    for(int i = 0; i < 1000; i++) d.retire(new int(i), &count_free);
+    assert(d.pending() < 1000);
+    d.retire(new std::string("x"));
+}
+
+void test_basic()
+{
+    // 有状态的比较器
+    {
+        concurrent_skip_list<int, int, seeded_less> sl(seeded_less{5});
+        for(int i = 0; i < 100; i++) assert(sl.insert(99 - i, i));
+        assert(sl.contains(42) && !sl.contains(100) && sl.begin()->first == 0);
+    }
+
+    concurrent_skip_list<int, std::string> s;
+    assert(s.empty() && s.begin() == s.end());
+    assert(s.insert(3, "c") && s.insert(1, "a") && s.insert(2, "b"));
+    assert(!s.insert(2, "x"));
+    assert(s.size() == 3);
+    std::string v;
+    assert(s.find(2, v) && v == "b");
+    assert(!s.find(4, v) && s.contains(1) && !s.contains(0));
+    assert(s.find(3)->second == "c" && s.find(5) == s.end());
+
+    std::string all;
+    for(auto& kv : s) all += kv.second;
+    assert(all == "abc");
+
+    assert(s.erase(2) && !s.erase(2) && s.size() == 2 && !s.contains(2));
+    assert(s.emplace(2, 3, 'z'));
+    assert(s.find(2, v) && v == "zzz");
+
+    concurrent_skip_list<int, int> m;
+    const int n = 50000;
+    for(int i = 0; i < n; i++) assert(m.insert((i * 7919) % n, i));
+    assert(m.size() == n);
+    int prev = -1, cnt = 0;
+    for(auto& kv : m)
+    {
+        assert(kv.first == prev + 1);
+        prev = kv.first;
+        ++cnt;
+    }
+    assert(cnt == n);
+    for(int i = 0; i < n; i += 2) assert(m.erase(i));
+    assert(m.size() == n / 2);
+
+    // [100, 200) 中剩下的奇数
+    cnt = 0;
+    for(auto& kv : m.range(100, 200))
+    {
+        assert(kv.first >= 100 && kv.first < 200 && kv.first % 2 == 1);
+        ++cnt;
+    }
+    assert(cnt == 50);
+
+    // view是临时对象, 迭代器自己保存上界
+    concurrent_skip_list<std::string, int> names;
+    for(int i = 0; i < 26; i++) names.insert(std::string(1, char('a' + i)) + std::string(30, 'x'), i);
+    auto it = names.range(std::string("c"), std::string("f")).begin();
+    cnt = 0;
+    for(; it != names.end(); ++it) assert(it->second == 2 + cnt++);
+    assert(cnt == 3);
+
+    assert(m.lower_bound(100)->first == 101);
+    assert(m.lower_bound(n) == m.end());
+}
+
+void test_concurrent(int threads)
+{
+    concurrent_skip_list<uint64_t, uint64_t> s;
+    const uint64_t key_space = 4096;
+    for(uint64_t k = 0; k < key_space; k += 2) s.insert(k, k * 3);
+    std::atomic<bool> done(false);
+    std::atomic<size_t> bad(0);
+
+    // 扫描线程在并发插入删除期间遍历, 迭代器一直有效, 结果保持有序
+    std::thread scanner([&] {
+        while(!done.load())
+        {
+            uint64_t prev = 0;
+            bool first = true;
+            for(auto& kv : s.range(key_space / 4, key_space * 3 / 4))
+            {
+                if(kv.second != kv.first * 3 || (!first && kv.first <= prev)) ++bad;
+                prev = kv.first;
+                first = false;
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for(int t = 0; t < threads; t++)
+        writers.emplace_back([&, t] {
+            uint64_t x = 0x9E3779B97F4A7C15ull * (t + 1);
+            for(int i = 0; i < 20000; i++)
+            {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                uint64_t k = x % key_space;
+                if(x & (1ull << 40)) s.insert(k, k * 3);
+                else s.erase(k);
+            }
+        });
+    for(auto& w : writers) w.join();
+    done = true;
+    scanner.join();
+    assert(bad == 0);
+
+    size_t cnt = 0;
+    for(auto& kv : s)
+    {
+        assert(kv.second == kv.first * 3);
+        ++cnt;
+    }
+    assert(cnt == s.size());
+
+    // 同一个key的插入和删除成功次数相等, 每个线程删除自己插入过的key, 最后表为空
+    concurrent_skip_list<int, int> m;
+    std::atomic<int> inserted(0), erased(0);
+    std::vector<std::thread> ts;
+    for(int t = 0; t < threads; t++)
+        ts.emplace_back([&] {
+            for(int i = 0; i < 5000; i++) inserted += m.insert(i, i);
+            for(int i = 0; i < 5000; i++) erased += m.erase(i);
+        });
+    for(auto& th : ts) th.join();
+    assert(inserted >= 5000 && inserted == erased && m.size() == 0 && m.begin() == m.end());
+}
+
+// std::mutex + std::map 对照
+class locked_map
+{
+private:
+    std::mutex __m;
+    std::map<uint64_t, uint64_t> __map;
+
+public:
+    bool find(uint64_t k, uint64_t& v)
+    {
+        std::lock_guard<std::mutex> lock(__m);
+        auto it = __map.find(k);
+        if(it == __map.end()) return false;
+        v = it->second;
+        return true;
+    }
+    bool insert(uint64_t k, uint64_t v)
+    {
+        std::lock_guard<std::mutex> lock(__m);
+        return __map.emplace(k, v).second;
+    }
+    bool erase(uint64_t k)
+    {
+        std::lock_guard<std::mutex> lock(__m);
+        return __map.erase(k) != 0;
+    }
+};
+
+// 每个线程执行ops次操作, 其中write_percent%是写 (插入/删除各一半), 返回Mops/s
+template <class Map>
+double run_mix(Map& m, int threads, size_t ops, uint64_t key_space, int write_percent)
+{
+    std::vector<std::thread> ts;
+    std::atomic<uint64_t> sink(0);
+    auto t1 = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++)
+        ts.emplace_back([&, t] {
+            uint64_t x = 0x9E3779B97F4A7C15ull * (t + 1), local = 0;
+            for(size_t i = 0; i < ops; i++)
+            {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                uint64_t k = x % key_space;
+                int r = static_cast<int>((x >> 40) % 100);
+                if(r >= write_percent)
+                {
+                    uint64_t v;
+                    if(m.find(k, v)) local += v;
+                }
+                else if(r & 1) m.insert(k, i);
+                else m.erase(k);
+            }
+            sink += local;
+        });
+    for(auto& th : ts) th.join();
+    auto t2 = std::chrono::steady_clock::now();
+    double s = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
+    return threads * ops / s / 1e6;
+}
+
+void benchmark(int max_threads, size_t ops)
+{
+    const uint64_t key_space = 1 << 16;
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    for(int write_percent : {5, 50})
+    {
+        std::cout << (write_percent == 5 ? "read-heavy (95% find)" : "write-heavy (50% write)") << std::endl;
+        for(int threads = 1; threads <= max_threads; threads *= 2)
+        {
+            concurrent_skip_list<uint64_t, uint64_t> cs;
+            locked_map lm;
+            for(uint64_t k = 0; k < key_space; k += 2)
+            {
+                cs.insert(k, k);
+                lm.insert(k, k);
+            }
+            double a = run_mix(cs, threads, ops, key_space, write_percent);
+            double b = run_mix(lm, threads, ops, key_space, write_percent);
+            std::cout << "  threads " << threads << ": concurrent_skip_list " << a
+                      << " Mops/s, mutex + map " << b << " Mops/s" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    test_epoch();
+    test_basic();
+    test_concurrent(4);
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : 4;
+    size_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+    if(ops) benchmark(max_threads, ops);
+    return 0;
+}
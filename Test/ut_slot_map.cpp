@@ -0,0 +1,210 @@
+#include "test_aux.h"
+#include "slot_map.h"
+#include "list.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace mySTL;
+
+void test_basic()
+{
+    slot_map<std::string> m;
+    assert(m.empty() && !m.contains(slot_map_handle()));
+    slot_map_handle a = m.insert("a");
+    slot_map_handle b = m.emplace(3, 'b');
+    slot_map_handle c = m.insert(std::string("c"));
+    assert(m.size() == 3 && m[a] == "a" && *m.find(b) == "bbb" && m.at(c) == "c");
+
+    // 删除a后c被移到a的位置, 句柄不变
+    assert(m.erase(a) && !m.erase(a));
+    assert(!m.contains(a) && m.find(a) == nullptr && m.size() == 2);
+    assert(m[c] == "c" && m[b] == "bbb");
+    bool thrown = false;
+    try {m.at(a);} catch(const std::out_of_range&) {thrown = true;}
+    assert(thrown);
+
+    // 复用a的槽, 代数不同, 旧句柄仍然无效
+    slot_map_handle d = m.insert("d");
+    assert(d.index == a.index && d.generation != a.generation);
+    assert(!m.contains(a) && m[d] == "d");
+    assert(slot_map_handle::from_value(d.value()) == d);
+
+    std::string all;
+    for(auto it = m.begin(); it != m.end(); ++it)
+    {
+        assert(&m[m.handle_of(it)] == it);
+        all += *it;
+    }
+    assert(all.size() == 5);
+
+    slot_map<std::string> copy(m);
+    assert(copy[b] == "bbb" && copy[d] == "d" && !copy.contains(a));
+    slot_map<std::string> moved(mySTL::move(copy));
+    assert(moved.size() == 3 && copy.empty() && !copy.contains(b));
+
+    m.clear();
+    assert(m.empty() && !m.contains(b) && !m.contains(c) && !m.contains(d));
+    assert(moved[b] == "bbb");
+
+    // 按迭代器删除
+    slot_map<int> n;
+    for(int i = 0; i < 10; i++) n.insert(i);
+    for(auto it = n.begin(); it != n.end();)
+        if(*it % 2) it = n.erase(it);
+        else ++it;
+    assert(n.size() == 5);
+    for(int x : n) assert(x % 2 == 0);
+}
+
+// 插入的参数引用容器自己的元素, 而且插入时正好需要扩容
+void test_alias()
+{
+    slot_map<std::string> m;
+    slot_map_handle first = m.insert(std::string(100, 'x'));
+    while(m.size() < m.capacity()) m.insert("filler");
+    slot_map_handle h = m.insert(m[first]);
+    assert(m.size() > m.capacity() / 2 && m[h] == std::string(100, 'x'));
+    while(m.size() < m.capacity()) m.insert("filler");
+    h = m.emplace(m[first], 0, 10);
+    assert(m[h] == std::string(10, 'x') && m[first] == std::string(100, 'x'));
+}
+
+// 拷贝元素中途抛异常: 已拷贝的元素析构, 数组归还, 原容器不变
+struct throw_on_copy
+{
+    static int budget;
+    int v;
+    throw_on_copy(int v) : v(v) {}
+    throw_on_copy(const throw_on_copy& other) : v(other.v)
+    {
+        if(budget-- == 0) throw std::runtime_error("copy");
+    }
+    throw_on_copy(throw_on_copy&&) noexcept = default;
+    throw_on_copy& operator=(throw_on_copy&&) noexcept = default;
+};
+int throw_on_copy::budget = -1;
+
+void test_copy_throw()
+{
+    slot_map<throw_on_copy> m;
+    for(int i = 0; i < 40; i++) m.emplace(i);
+    throw_on_copy::budget = 20;
+    bool thrown = false;
+    try {slot_map<throw_on_copy> copy(m);} catch(const std::runtime_error&) {thrown = true;}
+    assert(thrown && m.size() == 40);
+    throw_on_copy::budget = -1;
+    slot_map<throw_on_copy> copy(m);
+    assert(copy.size() == 40);
+}
+
+void test_random()
+{
+    // 和 handle -> value 的参照表比较
+    slot_map<uint64_t> m;
+    std::vector<slot_map_handle> live, dead;
+    std::unordered_map<uint64_t, uint64_t> ref;
+    uint64_t x = 42;
+    for(uint64_t i = 0; i < 200000; i++)
+    {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        if(live.empty() || x % 3)
+        {
+            slot_map_handle h = m.insert(i);
+            live.push_back(h);
+            ref[h.value()] = i;
+        }
+        else
+        {
+            size_t j = (x >> 8) % live.size();
+            slot_map_handle h = live[j];
+            live[j] = live.back();
+            live.pop_back();
+            assert(m.erase(h));
+            ref.erase(h.value());
+            dead.push_back(h);
+        }
+    }
+    assert(m.size() == live.size());
+    for(slot_map_handle h : live) assert(m[h] == ref[h.value()]);
+    for(slot_map_handle h : dead) assert(!m.contains(h));
+}
+
+struct entity
+{
+    float pos[3];
+    float vel[3];
+    uint32_t id;
+};
+
+void benchmark(size_t n)
+{
+    // 先插入2n个, 随机删除一半, 模拟运行一段时间后的实体池; list的节点在堆上是分散的
+    slot_map<entity> sm;
+    mySTL::list<entity> ls;
+    std::unordered_map<uint32_t, entity> um;
+    std::vector<slot_map_handle> handles;
+    std::vector<mySTL::list<entity>::iterator> iters;
+    std::vector<uint32_t> ids;
+    uint64_t x = 7;
+    for(uint32_t i = 0; i < 2 * n; i++)
+    {
+        entity e = {{1, 2, 3}, {0.5f, 0.25f, 0.125f}, i};
+        handles.push_back(sm.insert(e));
+        ls.push_back(e);
+        iters.push_back(--ls.end());
+        um.emplace(i, e);
+        ids.push_back(i);
+    }
+    for(size_t i = 2 * n; i > 0; i--)
+    {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        size_t j = x % i;
+        mySTL::swap(handles[j], handles[i - 1]);
+        mySTL::swap(iters[j], iters[i - 1]);
+        mySTL::swap(ids[j], ids[i - 1]);
+    }
+    for(size_t i = n; i < 2 * n; i++)
+    {
+        sm.erase(handles[i]);
+        ls.erase(iters[i]);
+        um.erase(ids[i]);
+    }
+    handles.resize(n);
+    iters.resize(n);
+    ids.resize(n);
+
+    float sink = 0;
+    auto iterate_sm = [&] {for(auto& e : sm) for(int k = 0; k < 3; k++) e.pos[k] += e.vel[k];};
+    auto iterate_ls = [&] {for(auto& e : ls) for(int k = 0; k < 3; k++) e.pos[k] += e.vel[k];};
+    auto iterate_um = [&] {for(auto& kv : um) for(int k = 0; k < 3; k++) kv.second.pos[k] += kv.second.vel[k];};
+    auto random_sm = [&] {for(size_t i = 0; i < n; i++) sink += sm[handles[i]].pos[0];};
+    auto random_ls = [&] {for(size_t i = 0; i < n; i++) sink += iters[i]->pos[0];};
+    auto random_um = [&] {for(size_t i = 0; i < n; i++) sink += um.find(ids[i])->second.pos[0];};
+
+    std::cout << n << " live entities (" << sizeof(entity) << " bytes) after erasing half at random" << std::endl;
+    std::cout << "iterate  slot_map:      "; COUNT_FUN_PERF(iterate_sm, n); std::cout << std::endl;
+    std::cout << "iterate  list:          "; COUNT_FUN_PERF(iterate_ls, n); std::cout << std::endl;
+    std::cout << "iterate  unordered_map: "; COUNT_FUN_PERF(iterate_um, n); std::cout << std::endl;
+    std::cout << "random   slot_map:      "; COUNT_FUN_PERF(random_sm, n); std::cout << std::endl;
+    std::cout << "random   list:          "; COUNT_FUN_PERF(random_ls, n); std::cout << std::endl;
+    std::cout << "random   unordered_map: "; COUNT_FUN_PERF(random_um, n); std::cout << std::endl;
+    assert(sink != -1);
+}
+
+int main(int argc, char *argv[])
+{
+    test_basic();
+    test_alias();
+    test_copy_throw();
+    test_random();
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    if(n) benchmark(n);
+    return 0;
+}
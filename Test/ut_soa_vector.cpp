@@ -0,0 +1,181 @@
+#include "test_aux.h"
+#include "soa_vector.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace mySTL;
+
+void test_basic()
+{
+    soa_vector<int, std::string, double> v;
+    assert(v.empty() && v.begin() == v.end());
+    v.push_back(1, "one", 1.5);
+    v.push_back(std::make_tuple(2, std::string("two"), 2.5));
+    v.emplace_back(3, "three", 3.5);
+    assert(v.size() == 3);
+    assert(v[1].get<1>() == "two" && get<2>(v[2]) == 3.5);
+
+    // 每列64字节对齐
+    for(int round = 0; round < 100; round++) v.emplace_back(round, std::to_string(round), round * 0.5);
+    assert(reinterpret_cast<uintptr_t>(v.data<0>()) % 64 == 0);
+    assert(reinterpret_cast<uintptr_t>(v.data<1>()) % 64 == 0);
+    assert(reinterpret_cast<uintptr_t>(v.data<2>()) % 64 == 0);
+    assert(v.size() == 103 && v[50].get<1>() == "47");
+
+    // 结构化绑定通过代理修改
+    for(auto [id, name, x] : v) x = id * 2.0;
+    assert(v[0].get<2>() == 2.0 && v[102].get<2>() == 198.0);
+
+    // 整行读写
+    std::tuple<int, std::string, double> row = v.row(1);
+    assert(std::get<1>(row) == "two");
+    v[0] = std::make_tuple(7, std::string("seven"), 7.0);
+    v[2] = v[0];
+    assert(v[2].get<0>() == 7 && v[2].get<1>() == "seven");
+
+    double sum = 0;
+    for(double x : v.column<2>()) sum += x;
+    assert(sum > 0 && v.column<0>().size() == v.size());
+
+    soa_vector<int, std::string, double> copy(v);
+    assert(copy.size() == v.size() && copy[50].get<1>() == "47");
+    soa_vector<int, std::string, double> moved(mySTL::move(copy));
+    assert(copy.empty() && moved[1].get<1>() == "two");
+    copy = moved;
+    assert(copy.size() == moved.size());
+
+    v.pop_back();
+    assert(v.size() == 102);
+    v.resize(5);
+    assert(v.size() == 5);
+    v.resize(10);
+    assert(v[9].get<0>() == 0 && v[9].get<1>().empty());
+    v.shrink_to_fit();
+    assert(v.capacity() == 10);
+    v.clear();
+    assert(v.empty());
+
+    // 迭代器
+    soa_vector<int, char> w;
+    for(int i = 0; i < 10; i++) w.push_back(i, char('a' + i));
+    auto it = w.begin() + 3;
+    assert((*it).get<1>() == 'd' && it[2].get<0>() == 5 && w.end() - it == 7);
+    const soa_vector<int, char>& cw = w;
+    int total = 0;
+    for(auto r : cw) total += r.get<0>();
+    assert(total == 45);
+}
+
+// 构造时可能抛异常的字段
+struct thrower
+{
+    static int live;
+    static int countdown;
+    thrower() {if(--countdown == 0) throw 1; ++live;}
+    thrower(const thrower&) {if(--countdown == 0) throw 1; ++live;}
+    ~thrower() {--live;}
+};
+int thrower::live = 0;
+int thrower::countdown = 0;
+
+void test_exception()
+{
+    {
+        soa_vector<std::string, thrower> v;
+        thrower::countdown = 1000;
+        while(v.size() < v.capacity() || v.empty()) v.emplace_back("x", thrower());
+        size_t n = v.size();
+        // 扩容时复制第二列的第5个元素失败 (thrower没有noexcept移动构造), 原数据不变
+        thrower::countdown = 6;
+        bool thrown = false;
+        try
+        {
+            v.emplace_back("y", thrower());
+        }
+        catch(int) {thrown = true;}
+        assert(thrown && v.size() == n && v.capacity() == n && thrower::live == static_cast<int>(n));
+        for(auto r : v) assert(r.get<0>() == "x");
+        thrower::countdown = 1000;
+    }
+    assert(thrower::live == 0);
+}
+
+struct record
+{
+    uint64_t id;
+    double   price;
+    float    weight;
+    int32_t  qty;
+};
+
+void benchmark(size_t n)
+{
+    soa_vector<uint64_t, double, float, int32_t> soa;
+    std::vector<std::tuple<uint64_t, double, float, int32_t>> aos;
+    std::vector<record> aos_struct;
+    soa.reserve(n);
+    aos.reserve(n);
+    aos_struct.reserve(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        soa.emplace_back(i, i * 0.5, float(i % 7), int32_t(i % 13));
+        aos.emplace_back(i, i * 0.5, float(i % 7), int32_t(i % 13));
+        aos_struct.push_back(record{i, i * 0.5, float(i % 7), int32_t(i % 13)});
+    }
+
+    int64_t r1 = 0, r2 = 0, r3 = 0;
+    double s1 = 0, s2 = 0, s3 = 0;
+    // 整数求和可以向量化, 瓶颈在内存带宽上
+    auto col_soa = [&] {for(int32_t q : soa.column<3>()) r1 += q;};
+    auto col_aos = [&] {for(auto& t : aos) r2 += std::get<3>(t);};
+    auto col_struct = [&] {for(auto& r : aos_struct) r3 += r.qty;};
+    auto row_soa = [&] {for(auto [id, price, weight, qty] : soa) s1 += price * qty + weight;};
+    auto row_aos = [&] {for(auto& [id, price, weight, qty] : aos) s2 += price * qty + weight;};
+    auto row_struct = [&] {for(auto& r : aos_struct) s3 += r.price * r.qty + r.weight;};
+
+    std::cout << n << " records, sum of one int32 column:" << std::endl;
+    std::cout << "  soa_vector column:    "; COUNT_FUN_PERF(col_soa, n); std::cout << std::endl;
+    std::cout << "  vector<tuple>:        "; COUNT_FUN_PERF(col_aos, n); std::cout << std::endl;
+    std::cout << "  vector<struct>:       "; COUNT_FUN_PERF(col_struct, n); std::cout << std::endl;
+    std::cout << "full-row iteration (price * qty + weight):" << std::endl;
+    std::cout << "  soa_vector rows:      "; COUNT_FUN_PERF(row_soa, n); std::cout << std::endl;
+    std::cout << "  vector<tuple>:        "; COUNT_FUN_PERF(row_aos, n); std::cout << std::endl;
+    std::cout << "  vector<struct>:       "; COUNT_FUN_PERF(row_struct, n); std::cout << std::endl;
+    assert(r1 == r2 && r2 == r3 && s1 == s2 && s2 == s3);
+}
+
+// 参数引用本容器中的元素, 且恰好触发扩容
+void test_alias()
+{
+    const std::string prefix(40, 'a');     // 不走SSO, 旧内存释放后读到的是堆上已释放的内容
+    soa_vector<int, std::string> v;
+    for(int i = 0; i < 16; i++) v.push_back(i, prefix + std::to_string(i));
+    assert(v.size() == v.capacity());
+    v.push_back(v.data<0>()[3], v.data<1>()[3]);
+    assert(v.size() == 17 && v[16].get<0>() == 3 && v[16].get<1>() == prefix + "3");
+
+    while(v.size() < v.capacity()) v.emplace_back(0, "");
+    v.emplace_back(v.data<0>()[5], v.data<1>()[5]);
+    assert(v.back().get<0>() == 5 && v.back().get<1>() == prefix + "5");
+
+    while(v.size() < v.capacity()) v.emplace_back(0, "");
+    v.push_back(v[7]);
+    assert(v.back().get<0>() == 7 && v.back().get<1>() == prefix + "7");
+    for(int i = 0; i < 16; i++) assert(v[i].get<1>() == prefix + std::to_string(i));
+}
+
+int main(int argc, char *argv[])
+{
+    test_basic();
+    test_alias();
+    test_exception();
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    if(n) benchmark(n);
+    return 0;
+}
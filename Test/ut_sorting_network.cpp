@@ -0,0 +1,202 @@
+#include "test_aux.h"
+#include "array.h"
+#include "algorithm.h"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace mySTL;
+
+// 编译期排序
+constexpr array<int, 6> sorted_at_compile_time()
+{
+    array<int, 6> a = {5, 3, 6, 1, 4, 2};
+    mySTL::sort(a);
+    return a;
+}
+static_assert(sorted_at_compile_time() == array<int, 6>{1, 2, 3, 4, 5, 6}, "constexpr sort_network");
+static_assert(mySTL::min(array<int, 5>{4, 2, 7, 1, 9}) == 1 && mySTL::max(array<int, 5>{4, 2, 7, 1, 9}) == 9,
+              "constexpr min/max");
+static_assert(sort_network_size<4>() == 5 && sort_network_size<8>() == 19 && sort_network_size<16>() == 63,
+              "network sizes");
+
+uint64_t rng = 88172645463325252ull;
+uint64_t next_rand()
+{
+    rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+    return rng;
+}
+
+// 0-1原理: 网络能排好所有0/1输入就能排好任意输入; N <= 16时穷举, 更大的N随机抽样
+template <size_t N>
+void test_network()
+{
+    array<int, N> a;
+    uint64_t cases = N <= 16 ? (uint64_t(1) << N) : 200000;
+    for(uint64_t c = 0; c < cases; c++)
+    {
+        uint64_t bits = N <= 16 ? c : next_rand();
+        int ones = 0;
+        for(size_t k = 0; k < N; k++) ones += a[k] = (bits >> k) & 1;
+        mySTL::sort(a);
+        for(size_t k = 0; k < N; k++) assert(a[k] == (k >= N - ones));
+    }
+
+    // 一般输入和自定义比较
+    array<std::string, N> s;
+    for(int round = 0; round < 100; round++)
+    {
+        for(auto& x : s) x = std::to_string(next_rand() % 1000);
+        array<std::string, N> t = s;
+        mySTL::sort(s, std::greater<>());
+        std::sort(t.begin(), t.end(), std::greater<>());
+        assert(s == t);
+    }
+
+    array<double, N> d;
+    for(auto& x : d) x = double(next_rand() % 1000) - 500;
+    assert(mySTL::min(d) == *std::min_element(d.begin(), d.end()));
+    assert(mySTL::max(d) == *std::max_element(d.begin(), d.end()));
+    auto mm = mySTL::minmax(d);
+    assert(mm.first == mySTL::min(d) && mm.second == mySTL::max(d));
+
+    // 批量排序
+    const size_t count = 1000;
+    std::vector<array<int, N>> groups(count);
+    for(auto& g : groups)
+        for(auto& x : g) x = static_cast<int>(next_rand() % 100);
+    std::vector<array<int, N>> expected = groups;
+    for(auto& g : expected) std::sort(g.begin(), g.end());
+    std::vector<int> lanes(N * count);
+    for(size_t g = 0; g < count; g++)
+        for(size_t k = 0; k < N; k++) lanes[k * count + g] = groups[g][k];
+    sort_each(groups.data(), groups.size());
+    assert(groups == expected);
+
+    // 按列存放, 逐行min/max
+    sort_network_lanes<N>(lanes.data(), count, count - 3);
+    for(size_t g = 0; g < count - 3; g++)
+        for(size_t k = 0; k < N; k++) assert(lanes[k * count + g] == expected[g][k]);
+}
+
+template <size_t... N>
+void test_networks(std::index_sequence<N...>)
+{
+    (test_network<N + 1>(), ...);
+}
+
+void test_array()
+{
+    array<int, 4> a = {1, 2, 3, 4};
+    assert(a.size() == 4 && a.front() == 1 && a.back() == 4 && a[2] == 3);
+    bool thrown = false;
+    try {a.at(4);} catch(const std::out_of_range&) {thrown = true;}
+    assert(thrown);
+    array<int, 4> b;
+    b.fill(7);
+    a.swap(b);
+    assert(a[0] == 7 && b[3] == 4 && b < a && a != b);
+    array<int, 0> e = {};
+    assert(e.empty() && e.begin() == e.end());
+}
+
+void test_sort()
+{
+    for(size_t n : {0, 1, 2, 15, 16, 17, 100, 1000, 100000})
+    {
+        std::vector<int> v(n), w;
+        for(auto& x : v) x = static_cast<int>(next_rand() % (n / 4 + 1));  // 含大量重复
+        w = v;
+        mySTL::sort(v.begin(), v.end());
+        std::sort(w.begin(), w.end());
+        assert(v == w);
+        mySTL::sort(v.begin(), v.end());                    // 已排序
+        assert(v == w);
+        mySTL::sort(v.begin(), v.end(), std::greater<>());  // 逆序
+        std::sort(w.begin(), w.end(), std::greater<>());
+        assert(v == w);
+    }
+
+    std::vector<std::string> s(5000);
+    for(auto& x : s) x = std::to_string(next_rand());
+    std::vector<std::string> t = s;
+    mySTL::sort(s.begin(), s.end());
+    std::sort(t.begin(), t.end());
+    assert(s == t);
+
+    // 堆排序分支
+    std::vector<int> h(1000);
+    for(auto& x : h) x = static_cast<int>(next_rand() % 100);
+    std::vector<int> hs = h;
+    std::less<> comp;
+    mySTL::__heap_sort(h.begin(), h.end(), comp);
+    std::sort(hs.begin(), hs.end());
+    assert(h == hs);
+}
+
+// 每组N个元素, 比较不同的小数组排序方法
+template <size_t N>
+void benchmark_n(size_t total)
+{
+    size_t count = total / N;
+    std::vector<array<int, N>> src(count);
+    for(auto& g : src)
+        for(auto& x : g) x = static_cast<int>(next_rand());
+    std::vector<array<int, N>> a = src, b = src, c = src;
+    std::vector<int> d(N * count);
+    for(size_t g = 0; g < count; g++)
+        for(size_t k = 0; k < N; k++) d[k * count + g] = src[g][k];
+
+    auto std_sort = [&] {for(auto& g : a) std::sort(g.begin(), g.end());};
+    auto insertion = [&] {std::less<> comp; for(auto& g : b) mySTL::__insertion_sort(g.begin(), g.end(), comp);};
+    auto network = [&] {sort_each(c.data(), c.size());};
+    auto lanes = [&] {sort_network_lanes<N>(d.data(), count, count);};
+
+    std::cout << "N = " << N << " (" << count << " groups, " << sort_network_size<N>() << " comparators)" << std::endl;
+    std::cout << "  std::sort:       "; COUNT_FUN_PERF(std_sort, total); std::cout << std::endl;
+    std::cout << "  insertion sort:  "; COUNT_FUN_PERF(insertion, total); std::cout << std::endl;
+    std::cout << "  sort_network:    "; COUNT_FUN_PERF(network, total); std::cout << std::endl;
+    std::cout << "  column lanes:    "; COUNT_FUN_PERF(lanes, total); std::cout << std::endl;
+    assert(a == b && b == c);
+    for(size_t g = 0; g < count; g++)
+        for(size_t k = 0; k < N; k++) assert(d[k * count + g] == c[g][k]);
+}
+
+void benchmark(size_t total)
+{
+    benchmark_n<2>(total);
+    benchmark_n<3>(total);
+    benchmark_n<4>(total);
+    benchmark_n<5>(total);
+    benchmark_n<8>(total);
+    benchmark_n<12>(total);
+    benchmark_n<16>(total);
+    benchmark_n<24>(total);
+    benchmark_n<32>(total);
+
+    std::vector<int> v(total), w;
+    for(auto& x : v) x = static_cast<int>(next_rand());
+    w = v;
+    auto my = [&] {mySTL::sort(v.begin(), v.end());};
+    auto st = [&] {std::sort(w.begin(), w.end());};
+    std::cout << "sort " << total << " ints" << std::endl;
+    std::cout << "  mySTL::sort:     "; COUNT_FUN_PERF(my, total); std::cout << std::endl;
+    std::cout << "  std::sort:       "; COUNT_FUN_PERF(st, total); std::cout << std::endl;
+    assert(v == w);
+}
+
+int main(int argc, char *argv[])
+{
+    test_networks(std::make_index_sequence<32>());
+    test_array();
+    test_sort();
+    size_t total = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    if(total) benchmark(total);
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "test_aux.h"
+#include "static_vector.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 202002L
+// 编译期构造 (需要C++20: 常量求值中切换union的活跃成员)
+constexpr mySTL::static_vector<int, 8> make_primes()
+{
+    mySTL::static_vector<int, 8> v;
+    for(int i = 2; !v.full(); i++)
+    {
+        bool prime = true;
+        for(int p : v) if(i % p == 0) prime = false;
+        if(prime) v.push_back(i);
+    }
+    return v;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+#if __cplusplus >= 202002L
+    constexpr auto primes = make_primes();
+    static_assert(primes.size() == 8 && primes[7] == 19, "constexpr static_vector");
+#endif
+    static_assert(sizeof(mySTL::static_vector<uint8_t, 15>) == 16, "uint8_t size field");
+    static_assert(std::is_trivially_copyable<mySTL::static_vector<int, 4>>::value, "trivially copyable");
+    static_assert(std::is_same<mySTL::static_vector<int, 4>::iterator, int*>::value, "raw pointer iterator");
+
+    // 非平凡类型
+    mySTL::static_vector<std::string, 3> s = {"a", "b"};
+    assert(s.try_push_back("c"));
+    assert(!s.try_push_back("d"));
+    bool thrown = false;
+    try { s.push_back("d"); } catch(const std::length_error&) { thrown = true; }
+    assert(thrown);
+    mySTL::static_vector<std::string, 3> s2(s);
+    s.pop_back();
+    assert(s2.size() == 3 && s2.back() == "c" && s.size() == 2);
+    s2 = s;
+    assert(s2 == s);
+    s.resize(3, "z");
+    assert(s[2] == "z");
+    printContainer(s);
+    std::cout << std::endl;
+
+    // benchmark: 反复填充小容器
+    const size_t rounds = 50000, n = 200;
+    long long sum = 0;
+    auto bench_static = [&]() {
+        for(size_t r = 0; r < rounds; r++)
+        {
+            mySTL::static_vector<int, 256> v;
+            for(size_t i = 0; i < n; i++) v.push_back(static_cast<int>(i + r));
+            sum += v.back();
+        }
+    };
+    auto bench_std = [&]() {
+        for(size_t r = 0; r < rounds; r++)
+        {
+            std::vector<int> v;
+            v.reserve(256);
+            for(size_t i = 0; i < n; i++) v.push_back(static_cast<int>(i + r));
+            sum += v.back();
+        }
+    };
+    std::cout << "mySTL::static_vector fill:     ";
+    COUNT_FUN_PERF(bench_static, rounds * n);
+    std::cout << std::endl << "std::vector (reserve) fill:    ";
+    COUNT_FUN_PERF(bench_std, rounds * n);
+    std::cout << std::endl << "sum: " << sum << std::endl;
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "test_aux.h"
+#include "basic_string.h"
+#include "string_view.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <random>
+
+void test_string()
+{
+    static_assert(sizeof(mySTL::string) == 3 * sizeof(void*), "24-byte layout");
+
+    mySTL::string empty;
+    assert(empty.empty() && empty.is_inline() && empty.c_str()[0] == '\0');
+
+    // 23个字符以内都在对象内部
+    mySTL::string s23(23, 'a');
+    assert(s23.is_inline() && s23.size() == 23 && s23.capacity() == 23 && s23.c_str()[23] == '\0');
+    s23.push_back('b');
+    assert(!s23.is_inline() && s23.size() == 24 && s23.back() == 'b');
+
+    mySTL::string s("hello");
+    s += ", ";
+    s += mySTL::string("world");
+    s.push_back('!');
+    assert(s == "hello, world!" && s.size() == 13);
+    assert(s.find("world") == 7 && s.find('o') == 4 && s.rfind('o') == 8 && s.rfind("l") == 10);
+    assert(s.find("xyz") == mySTL::string::npos && s.find("") == 0);
+    assert(s.substr(7, 5) == "world");
+    assert(s.compare("hello") > 0 && mySTL::string("abc") < mySTL::string("abd"));
+    assert(s.starts_with("hello") && s.ends_with("!"));
+
+    // 预留容量后append不重新分配
+    mySTL::string r;
+    r.reserve(100);
+    const char* buf = r.data();
+    for(int i = 0; i < 10; i++) r.append("0123456789");
+    assert(r.data() == buf && r.size() == 100);
+
+    // 自身追加
+    r.append(r.data(), 50);
+    assert(r.size() == 150 && r.substr(100, 10) == "0123456789");
+    r.erase(10, 130);
+    assert(r.size() == 20 && r == "01234567890123456789");
+    r.shrink_to_fit();
+    assert(r.is_inline() && r == "01234567890123456789");
+
+    mySTL::string moved(mySTL::move(s23));
+    assert(moved.size() == 24 && s23.empty());
+    mySTL::string copy = moved;
+    copy.resize(3);
+    assert(copy == "aaa");
+    mySTL::swap(copy, moved);
+    assert(moved == "aaa" && copy.size() == 24);
+
+    mySTL::string_view sv("needle in a haystack, needle");
+    assert(sv.find(mySTL::string_view("needle"), 1) == 22);
+    assert(sv.rfind(mySTL::string_view("needle")) == 22);
+    assert(sv.rfind(mySTL::string_view("needle"), 21) == 0);
+    // SIMD路径: 长文本中的查找
+    std::string text(1000, 'x');
+    text.replace(997, 3, "abc");
+    mySTL::string_view tv(text.data(), text.size());
+    assert(tv.find(mySTL::string_view("abc")) == 997);
+    assert(tv.find(mySTL::string_view("xab")) == 996);
+    assert(tv.find(mySTL::string_view("abd")) == mySTL::string_view::npos);
+    assert(tv.rfind(mySTL::string_view("abc")) == 997 && tv.rfind('a') == 997 && tv.rfind('x', 996) == 996);
+    assert(tv.rfind(mySTL::string_view("xx"), 996) == 995 && tv.rfind('b', 996) == mySTL::string_view::npos);
+
+    // 反向查找: 和std::string对照, 覆盖16字节块内, 跨块和剩余部分
+    std::mt19937 gen(11);
+    std::string hay(3000, 'a');
+    for(auto& c : hay) c = static_cast<char>('a' + gen() % 3);
+    hay.replace(40, 5, "zzzzz");
+    mySTL::string_view hv(hay.data(), hay.size());
+    const char* patterns[] = {"a", "z", "ab", "cba", "abcab", "zzz", "azzzzzb", "bbbbbbbbbbbbbbbbbbbbb", "q"};
+    const size_t positions[] = {0, 5, 15, 16, 17, 31, 40, 44, 1000, 2990, 2999, std::string::npos};
+    for(const char* pat : patterns)
+    {
+        for(size_t pos : positions)
+        {
+            assert(hv.rfind(mySTL::string_view(pat), pos) == hay.rfind(pat, pos));
+            assert(hv.rfind(pat[0], pos) == hay.rfind(pat[0], pos));
+        }
+    }
+
+    // 通用版本 (非单字节字符)
+    mySTL::wstring_view wv(L"abcabcab");
+    assert(wv.rfind(mySTL::wstring_view(L"bc")) == 4 && wv.rfind(mySTL::wstring_view(L"bc"), 3) == 1);
+    assert(wv.rfind(L'c') == 5 && wv.rfind(L'c', 1) == mySTL::wstring_view::npos);
+
+    // 长字符串比较: 差异出现在开头, 16/32字节边界和末尾
+    std::string base(1000, 'm');
+    mySTL::string_view bv(base.data(), base.size());
+    const size_t diffs[] = {0, 15, 16, 31, 32, 500, 999};
+    for(size_t i : diffs)
+    {
+        std::string greater = base, less = base;
+        greater[i] = 'n';
+        less[i] = 'l';
+        assert(bv.compare(mySTL::string_view(greater.data(), greater.size())) < 0);
+        assert(bv.compare(mySTL::string_view(less.data(), less.size())) > 0);
+        assert(mySTL::string_view(greater.data(), greater.size()).compare(bv) > 0);
+    }
+    assert(bv.compare(mySTL::string_view(base.data(), 999)) > 0 && bv.compare(mySTL::string_view(base.data(), 1000)) == 0);
+}
+
+int main(int argc, char *argv[])
+{
+    test_string();
+
+    // benchmark: 短key构造, 拼接, 子串查找
+    const size_t N = 1000000;
+    std::mt19937 gen(7);
+    std::vector<std::string> keys(N);
+    for(auto& k : keys)
+    {
+        k.resize(8 + gen() % 15);
+        for(auto& c : k) c = static_cast<char>('a' + gen() % 26);
+    }
+    size_t sink = 0;
+
+    auto construct = [&]() { for(auto& k : keys) { mySTL::string s(k.data(), k.size()); sink += s.size(); } };
+    auto std_construct = [&]() { for(auto& k : keys) { std::string s(k.data(), k.size()); sink += s.size(); } };
+    std::cout << "mySTL::string construct: "; {COUNT_FUN_TIME(construct);}
+    std::cout << std::endl << "std::string construct:   "; {COUNT_FUN_TIME(std_construct);}
+
+    auto concat = [&]() { mySTL::string s; for(auto& k : keys) s.append(k.data(), k.size()); sink += s.size(); };
+    auto std_concat = [&]() { std::string s; for(auto& k : keys) s.append(k.data(), k.size()); sink += s.size(); };
+    std::cout << std::endl << "mySTL::string concat:    "; {COUNT_FUN_TIME(concat);}
+    std::cout << std::endl << "std::string concat:      "; {COUNT_FUN_TIME(std_concat);}
+
+    std::string text;
+    for(size_t i = 0; i < 100000; i++) text += keys[i];
+    mySTL::string mtext(text.data(), text.size());
+    const char* needles[] = {"zzzzq", "qwerty", "abcab", "xyz"};
+    auto search = [&]() { for(int r = 0; r < 10; r++) for(auto n : needles) sink += mtext.find(n); };
+    auto std_search = [&]() { for(int r = 0; r < 10; r++) for(auto n : needles) sink += text.find(n); };
+    std::cout << std::endl << "mySTL::string find:      "; {COUNT_FUN_TIME(search);}
+    std::cout << std::endl << "std::string find:        "; {COUNT_FUN_TIME(std_search);}
+    auto rsearch = [&]() { for(int r = 0; r < 10; r++) for(auto n : needles) sink += mtext.rfind(n); };
+    auto std_rsearch = [&]() { for(int r = 0; r < 10; r++) for(auto n : needles) sink += text.rfind(n); };
+    std::cout << std::endl << "mySTL::string rfind:     "; {COUNT_FUN_TIME(rsearch);}
+    std::cout << std::endl << "std::string rfind:       "; {COUNT_FUN_TIME(std_rsearch);}
+    std::cout << std::endl << "sink: " << sink << std::endl;
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "type_traits.h"
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// 定义 MYSTL_COMPILE_BENCH 时额外实例化大量容器, 供 compile_time_bench 目标测量编译期的时间和内存
+#ifdef MYSTL_COMPILE_BENCH
+#include "list.h"
+#include "static_vector.h"
+#include "slot_map.h"
+#include "soa_vector.h"
+#include "persistent_vector.h"
+#include "lru_cache.h"
+#include "pair.h"
+#include <utility>
+#endif
+
+struct pod {int a; double b;};
+struct nontrivial_dtor {~nontrivial_dtor() {}};
+struct deleted_dtor {~deleted_dtor() = delete;};
+struct throwing_move {throwing_move(throwing_move&&) {} throwing_move(const throwing_move&) = default;};
+struct nothrow_move {nothrow_move(nothrow_move&&) noexcept {}};
+struct move_only {move_only(move_only&&) = default; move_only(const move_only&) = delete;};
+struct no_default {explicit no_default(int) {}};
+struct empty_class {};
+struct final_class final {};
+struct base {virtual ~base() {}};
+struct derived : base {};
+union u {int a; float b;};
+enum small_enum : uint8_t {e0};
+enum class wide_enum : int64_t {e1};
+typedef void func(int);
+
+// mySTL的结果必须和标准库一致
+#define SAME_1(trait, T) static_assert(mySTL::trait<T>::value == std::trait<T>::value, #trait "<" #T ">");
+#define SAME_TYPE(trait, T) \
+    static_assert(std::is_same<typename mySTL::trait<T>::type, typename std::trait<T>::type>::value, #trait "<" #T ">");
+
+#define CHECK_ALL(T) \
+    SAME_1(is_trivially_copyable, T) SAME_1(is_trivially_destructible, T) SAME_1(is_trivial, T) \
+    SAME_1(is_copy_constructible, T) SAME_1(is_move_constructible, T) SAME_1(is_nothrow_move_constructible, T) \
+    SAME_1(is_integral, T) SAME_1(is_floating_point, T) SAME_1(is_arithmetic, T) SAME_1(is_signed, T) \
+    SAME_1(is_pointer, T) SAME_1(is_reference, T) SAME_1(is_array, T) SAME_1(is_function, T) SAME_1(is_void, T) \
+    SAME_1(is_const, T) SAME_1(is_class, T) SAME_1(is_union, T) SAME_1(is_enum, T) \
+    SAME_TYPE(decay, T) SAME_TYPE(remove_cv, T) SAME_TYPE(remove_reference, T) SAME_TYPE(remove_pointer, T) \
+    SAME_TYPE(remove_extent, T) SAME_TYPE(remove_all_extents, T) \
+    SAME_TYPE(add_lvalue_reference, T) SAME_TYPE(add_rvalue_reference, T)
+
+// 只对完整的对象类型有意义的trait
+#define CHECK_OBJECT(T) CHECK_ALL(T) \
+    SAME_1(is_empty, T) SAME_1(is_final, T) SAME_1(is_polymorphic, T) SAME_1(is_standard_layout, T)
+
+typedef const int const_int;
+typedef int int_array[3];
+typedef int int_unbounded[];
+typedef int* const const_ptr;
+typedef int& int_ref;
+typedef int&& int_rref;
+typedef const volatile char cv_char;
+typedef pod pod_array[2][3];
+typedef deleted_dtor deleted_array[2];
+
+CHECK_OBJECT(int) CHECK_OBJECT(const_int) CHECK_OBJECT(cv_char) CHECK_OBJECT(bool) CHECK_OBJECT(double)
+CHECK_OBJECT(unsigned long) CHECK_OBJECT(wchar_t) CHECK_OBJECT(char16_t) CHECK_OBJECT(const_ptr)
+CHECK_OBJECT(int_array) CHECK_OBJECT(pod_array) CHECK_OBJECT(deleted_array)
+CHECK_OBJECT(pod) CHECK_OBJECT(nontrivial_dtor) CHECK_OBJECT(deleted_dtor) CHECK_OBJECT(throwing_move)
+CHECK_OBJECT(nothrow_move) CHECK_OBJECT(move_only) CHECK_OBJECT(no_default) CHECK_OBJECT(empty_class)
+CHECK_OBJECT(final_class) CHECK_OBJECT(base) CHECK_OBJECT(derived) CHECK_OBJECT(u) CHECK_OBJECT(small_enum)
+CHECK_OBJECT(wide_enum) CHECK_OBJECT(std::string)
+CHECK_ALL(void) CHECK_ALL(func) CHECK_ALL(int_unbounded) CHECK_ALL(int_ref) CHECK_ALL(int_rref)
+
+SAME_TYPE(make_unsigned, int) SAME_TYPE(make_unsigned, const long) SAME_TYPE(make_unsigned, unsigned short)
+SAME_TYPE(make_unsigned, signed char) SAME_TYPE(make_unsigned, char) SAME_TYPE(make_unsigned, wchar_t)
+SAME_TYPE(make_unsigned, char32_t) SAME_TYPE(make_unsigned, long long)
+SAME_TYPE(underlying_type, small_enum) SAME_TYPE(underlying_type, wide_enum)
+
+static_assert(mySTL::is_base_of<base, derived>::value && !mySTL::is_base_of<derived, base>::value, "is_base_of");
+static_assert(mySTL::is_base_of<base, base>::value && !mySTL::is_base_of<int, int>::value, "is_base_of");
+static_assert(mySTL::is_constructible<no_default, int>::value && !mySTL::is_constructible<no_default>::value, "");
+static_assert(mySTL::is_constructible<std::string, const char*>::value, "is_constructible");
+static_assert(!mySTL::is_constructible<int_ref, int>::value && mySTL::is_constructible<const int&, int>::value, "");
+static_assert(mySTL::is_nothrow_constructible<int_ref, int&>::value, "binding a reference");
+static_assert(!mySTL::is_nothrow_constructible<std::string, const char*>::value, "may allocate");
+static_assert(mySTL::is_same<mySTL::add_pointer<int&>::type, int*>::value, "add_pointer");
+
+// __or_ / __and_ / __not_
+static_assert(!mySTL::__or_<>::value && mySTL::__and_<>::value, "empty");
+static_assert(mySTL::__or_<mySTL::false_type, mySTL::true_type, mySTL::false_type>::value, "or");
+static_assert(!mySTL::__and_<mySTL::true_type, mySTL::false_type, mySTL::true_type>::value, "and");
+static_assert(mySTL::__and_<mySTL::is_integral<int>, mySTL::is_class<pod>, std::true_type>::value, "mixed");
+static_assert(mySTL::__not_<mySTL::is_void<int>>::value, "not");
+
+// SFINAE
+template <class T, class = void>
+struct has_underlying : mySTL::false_type {};
+
+template <class T>
+struct has_underlying<T, mySTL::void_t<typename mySTL::underlying_type<T>::type>> : mySTL::true_type {};
+
+static_assert(has_underlying<wide_enum>::value && !has_underlying<int>::value, "underlying_type is SFINAE friendly");
+
+#ifdef MYSTL_COMPILE_BENCH
+#ifndef MYSTL_COMPILE_BENCH_TYPES
+#define MYSTL_COMPILE_BENCH_TYPES 64
+#endif
+// 每个I是一组新的元素类型, 每组都实例化一遍所有容器
+template <size_t I>
+struct bench_pod {int a; double b;};
+
+template <size_t I>
+struct bench_obj
+{
+    std::string s;
+    bench_obj() = default;
+    bench_obj(const char* p) : s(p) {}
+    bool operator==(const bench_obj& o) const {return s == o.s;}
+};
+
+template <size_t I>
+size_t exercise_one()
+{
+    size_t n = 0;
+    mySTL::list<bench_obj<I>> l;
+    l.push_back("a");
+    l.emplace_front("b");
+    mySTL::list<bench_obj<I>> l2(l);
+    n += l2.size();
+
+    mySTL::static_vector<bench_obj<I>, 8> sv;
+    sv.push_back("c");
+    sv.emplace_back("d");
+    mySTL::static_vector<bench_pod<I>, 8> sp;
+    sp.resize(3);
+    n += sv.size() + sp.size();
+
+    mySTL::slot_map<bench_obj<I>> sm;
+    auto h = sm.insert("e");
+    n += sm.contains(h);
+    sm.erase(h);
+
+    mySTL::soa_vector<bench_pod<I>, bench_obj<I>, int> soa;
+    soa.emplace_back(bench_pod<I>(), bench_obj<I>("f"), 1);
+    n += soa.size();
+
+    mySTL::persistent_vector<bench_obj<I>> pv;
+    pv = pv.push_back("g");
+    n += pv.size();
+
+    mySTL::lru_cache<int, bench_obj<I>> cache(4);
+    cache.put(1, "h");
+    n += cache.size();
+
+    auto p = mySTL::make_pair(bench_pod<I>(), bench_obj<I>("i"));
+    n += p.second.s.size();
+    return n;
+}
+
+template <size_t... I>
+size_t exercise_all(std::index_sequence<I...>)
+{
+    return (exercise_one<I>() + ...);
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    // decay 在运行时的用法
+    const char* s = "abc";
+    mySTL::decay<const char(&)[4]>::type p = "abc";
+    assert(p[0] == s[0]);
+    mySTL::make_unsigned<int8_t>::type x = static_cast<mySTL::make_unsigned<int8_t>::type>(-1);
+    assert(x == 255);
+
+#ifdef MYSTL_COMPILE_BENCH
+    size_t n = exercise_all(std::make_index_sequence<MYSTL_COMPILE_BENCH_TYPES>());
+    std::cout << MYSTL_COMPILE_BENCH_TYPES << " element types instantiated, checksum " << n << std::endl;
+#endif
+    std::cout << "type_traits tests passed" << std::endl;
+    return 0;
+}